@@ -0,0 +1,89 @@
+"""Bindings under test: ray.py itself and, when installed, other raylib bindings"""
+
+import importlib
+import os
+import struct
+import tempfile
+import zlib
+from typing import Any, Dict, Optional
+
+# module name -> binding technology, used in reports
+KNOWN_BACKENDS = {
+    "raypy": "CPython C API",
+    "pyray": "cffi (raylib-python-cffi)",
+    "raylibpy": "ctypes (raylib-py)",
+}
+
+
+class Backend:
+    """Thin wrapper resolving raylib names on the module under test"""
+
+    def __init__(self, name: str) -> None:
+        self.name = name
+        self.kind = KNOWN_BACKENDS.get(name, "unknown")
+        self.module = importlib.import_module(name)
+        self.texture = None  # type: Any
+        self._tmpdir = None  # type: Optional[tempfile.TemporaryDirectory]
+
+    def has(self, attr: str) -> bool:
+        return hasattr(self.module, attr)
+
+    def __getattr__(self, attr: str) -> Any:
+        return getattr(self.module, attr)
+
+    def color(self, r: int, g: int, b: int, a: int = 255) -> Any:
+        return self.module.Color(r, g, b, a)
+
+    def open_offscreen(self, width: int = 640, height: int = 360) -> None:
+        """Creates a hidden window so draw calls have a GL context to go to"""
+        m = self.module
+        m.set_trace_log_level(m.LOG_WARNING)
+        m.set_config_flags(m.FLAG_WINDOW_HIDDEN)
+        m.init_window(width, height, "ray.py benchmarks")
+        m.set_target_fps(0)
+
+        self._tmpdir = tempfile.TemporaryDirectory(prefix="raypy-bench-")
+        path = os.path.join(self._tmpdir.name, "checker.png")
+        write_checker_png(path, 64, 64)
+        self.texture = m.load_texture(path)
+
+    def close_offscreen(self) -> None:
+        m = self.module
+        if self.texture is not None:
+            m.unload_texture(self.texture)
+            self.texture = None
+        if m.is_window_ready():
+            m.close_window()
+        if self._tmpdir is not None:
+            self._tmpdir.cleanup()
+            self._tmpdir = None
+
+    def describe(self) -> Dict[str, Any]:
+        return {
+            "name": self.name,
+            "kind": self.kind,
+            "version": getattr(self.module, "RAYLIB_VERSION", None)
+            or getattr(self.module, "__version__", None),
+        }
+
+
+def write_checker_png(path: str, width: int, height: int) -> None:
+    """Writes an RGBA checkerboard PNG without needing any image library"""
+
+    def chunk(tag: bytes, data: bytes) -> bytes:
+        body = tag + data
+        return struct.pack(">I", len(data)) + body + struct.pack(">I", zlib.crc32(body) & 0xFFFFFFFF)
+
+    rows = bytearray()
+    for y in range(height):
+        rows.append(0)  # filter: none
+        for x in range(width):
+            on = ((x // 8) + (y // 8)) % 2
+            rows.extend((255, 255, 255, 255) if on else (230, 41, 55, 255))
+
+    png = b"\x89PNG\r\n\x1a\n"
+    png += chunk(b"IHDR", struct.pack(">IIBBBBB", width, height, 8, 6, 0, 0, 0))
+    png += chunk(b"IDAT", zlib.compress(bytes(rows), 9))
+    png += chunk(b"IEND", b"")
+    with open(path, "wb") as fp:
+        fp.write(png)
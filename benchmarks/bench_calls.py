@@ -0,0 +1,99 @@
+"""Per-call overhead of each binding calling convention (METH_NOARGS, METH_O, ...)"""
+
+from time import perf_counter_ns
+
+from harness import UNSUPPORTED, benchmark, timeit
+
+
+@benchmark("calls", "python_noop")
+def bench_python_noop(b, loops):
+    """Reference point: a pure Python function doing nothing"""
+
+    def noop():
+        pass
+
+    return timeit(noop, loops)
+
+
+@benchmark("calls", "METH_NOARGS/is_window_ready")
+def bench_noargs_is_window_ready(b, loops):
+    return timeit(b.is_window_ready, loops)
+
+
+@benchmark("calls", "METH_NOARGS/get_screen_width", needs_window=True)
+def bench_noargs_get_screen_width(b, loops):
+    return timeit(b.get_screen_width, loops)
+
+
+@benchmark("calls", "METH_NOARGS/get_time", needs_window=True)
+def bench_noargs_get_time(b, loops):
+    return timeit(b.get_time, loops)
+
+
+@benchmark("calls", "METH_O/is_key_down(int)", needs_window=True)
+def bench_o_is_key_down(b, loops):
+    f, key = b.is_key_down, b.KEY_A
+    it = range(loops)
+    t0 = perf_counter_ns()
+    for _ in it:
+        f(key)
+    return (perf_counter_ns() - t0) * 1e-9
+
+
+@benchmark("calls", "METH_O/is_window_state(int)", needs_window=True)
+def bench_o_is_window_state(b, loops):
+    f, flag = b.is_window_state, b.FLAG_WINDOW_HIDDEN
+    it = range(loops)
+    t0 = perf_counter_ns()
+    for _ in it:
+        f(flag)
+    return (perf_counter_ns() - t0) * 1e-9
+
+
+@benchmark("calls", "METH_VARARGS/get_random_value(int, int)")
+def bench_varargs_get_random_value(b, loops):
+    f = b.get_random_value
+    it = range(loops)
+    t0 = perf_counter_ns()
+    for _ in it:
+        f(0, 100)
+    return (perf_counter_ns() - t0) * 1e-9
+
+
+@benchmark("calls", "METH_KEYWORDS/set_window_size(w, h)", needs_window=True)
+def bench_keywords_set_window_size(b, loops):
+    f = b.set_window_size
+    w, h = b.get_screen_width(), b.get_screen_height()
+    it = range(loops)
+    t0 = perf_counter_ns()
+    for _ in it:
+        f(w, h)
+    return (perf_counter_ns() - t0) * 1e-9
+
+
+@benchmark("calls", "METH_KEYWORDS/set_window_size(width=, height=)", needs_window=True)
+def bench_keywords_set_window_size_kw(b, loops):
+    f = b.set_window_size
+    w, h = b.get_screen_width(), b.get_screen_height()
+    it = range(loops)
+    try:
+        f(width=w, height=h)
+    except TypeError:
+        return UNSUPPORTED
+    t0 = perf_counter_ns()
+    for _ in it:
+        f(width=w, height=h)
+    return (perf_counter_ns() - t0) * 1e-9
+
+
+@benchmark("calls", "METH_FASTCALL/draw_texture(tex, int, int, Color)", needs_window=True)
+def bench_fastcall_draw_texture(b, loops):
+    f, tex, tint = b.draw_texture, b.texture, b.WHITE
+    it = range(loops)
+    b.begin_drawing()
+    t0 = perf_counter_ns()
+    for _ in it:
+        f(tex, 0, 0, tint)
+    elapsed = (perf_counter_ns() - t0) * 1e-9
+    b.end_drawing()
+    return elapsed
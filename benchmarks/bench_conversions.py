@@ -0,0 +1,90 @@
+"""Cost of moving raylib structs (Color, Vector2, ...) across the binding layer"""
+
+from time import perf_counter_ns
+
+from harness import UNSUPPORTED, benchmark
+
+
+@benchmark("conversions", "Color(r, g, b, a)")
+def bench_color_new(b, loops):
+    cls = b.Color
+    it = range(loops)
+    t0 = perf_counter_ns()
+    for _ in it:
+        cls(245, 245, 245, 255)
+    return (perf_counter_ns() - t0) * 1e-9
+
+
+@benchmark("conversions", "Color.r read")
+def bench_color_getattr(b, loops):
+    color = b.color(245, 245, 245)
+    it = range(loops)
+    t0 = perf_counter_ns()
+    for _ in it:
+        color.r
+    return (perf_counter_ns() - t0) * 1e-9
+
+
+@benchmark("conversions", "Color == Color")
+def bench_color_compare(b, loops):
+    c1, c2 = b.color(1, 2, 3), b.color(1, 2, 3)
+    it = range(loops)
+    t0 = perf_counter_ns()
+    for _ in it:
+        c1 == c2
+    return (perf_counter_ns() - t0) * 1e-9
+
+
+@benchmark("conversions", "Vector2(x, y)")
+def bench_vector2_new(b, loops):
+    cls = b.Vector2
+    it = range(loops)
+    t0 = perf_counter_ns()
+    for _ in it:
+        cls(1.0, 2.0)
+    return (perf_counter_ns() - t0) * 1e-9
+
+
+@benchmark("conversions", "Vector3(x, y, z)")
+def bench_vector3_new(b, loops):
+    cls = b.Vector3
+    it = range(loops)
+    t0 = perf_counter_ns()
+    for _ in it:
+        cls(1.0, 2.0, 3.0)
+    return (perf_counter_ns() - t0) * 1e-9
+
+
+@benchmark("conversions", "Rectangle(x, y, w, h)")
+def bench_rectangle_new(b, loops):
+    cls = b.Rectangle
+    it = range(loops)
+    t0 = perf_counter_ns()
+    for _ in it:
+        cls(0.0, 0.0, 10.0, 10.0)
+    return (perf_counter_ns() - t0) * 1e-9
+
+
+@benchmark("conversions", "Color -> C (clear_background)", needs_window=True)
+def bench_color_to_c(b, loops):
+    f, color = b.clear_background, b.RAYWHITE
+    it = range(loops)
+    b.begin_drawing()
+    t0 = perf_counter_ns()
+    for _ in it:
+        f(color)
+    elapsed = (perf_counter_ns() - t0) * 1e-9
+    b.end_drawing()
+    return elapsed
+
+
+@benchmark("conversions", "C -> Vector2 (get_window_position)", needs_window=True)
+def bench_vector2_from_c(b, loops):
+    if not b.has("get_window_position"):
+        return UNSUPPORTED
+    f = b.get_window_position
+    it = range(loops)
+    t0 = perf_counter_ns()
+    for _ in it:
+        f()
+    return (perf_counter_ns() - t0) * 1e-9
@@ -0,0 +1,58 @@
+"""Draw throughput inside one frame, including the batch flush in end_drawing()"""
+
+from time import perf_counter_ns
+
+from harness import benchmark
+
+
+def frame(b, draw, loops):
+    """Issues `loops` draws between begin_drawing/end_drawing, returns elapsed seconds"""
+    t0 = perf_counter_ns()
+    b.begin_drawing()
+    draw(loops)
+    b.end_drawing()
+    return (perf_counter_ns() - t0) * 1e-9
+
+
+@benchmark("draw", "draw_text", unit="draws/s", needs_window=True)
+def bench_draw_text(b, loops):
+    f, color = b.draw_text, b.DARKGRAY
+
+    def draw(n):
+        for i in range(n):
+            f("ray.py", i & 511, i & 255, 20, color)
+
+    return frame(b, draw, loops)
+
+
+@benchmark("draw", "draw_texture", unit="draws/s", needs_window=True)
+def bench_draw_texture(b, loops):
+    f, tex, tint = b.draw_texture, b.texture, b.WHITE
+
+    def draw(n):
+        for i in range(n):
+            f(tex, i & 511, i & 255, tint)
+
+    return frame(b, draw, loops)
+
+
+@benchmark("draw", "draw_fps", unit="draws/s", needs_window=True)
+def bench_draw_fps(b, loops):
+    f = b.draw_fps
+
+    def draw(n):
+        for i in range(n):
+            f(i & 511, i & 255)
+
+    return frame(b, draw, loops)
+
+
+@benchmark("draw", "clear_background", unit="draws/s", needs_window=True)
+def bench_clear_background(b, loops):
+    f, color = b.clear_background, b.RAYWHITE
+
+    def draw(n):
+        for _ in range(n):
+            f(color)
+
+    return frame(b, draw, loops)
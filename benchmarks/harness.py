@@ -0,0 +1,87 @@
+"""Timing helpers and the benchmark registry shared by all bench_* modules"""
+
+import gc
+import time
+from typing import Any, Callable, Dict, List, NamedTuple, Optional
+
+BenchFunc = Callable[[Any, int], float]
+
+
+class Benchmark(NamedTuple):
+    group: str
+    name: str
+    unit: str
+    func: BenchFunc
+    needs_window: bool
+
+
+REGISTRY = []  # type: List[Benchmark]
+
+
+def benchmark(group: str, name: str, unit: str = "ns/call", needs_window: bool = False):
+    """Registers `func(backend, loops) -> seconds` under `group/name`"""
+
+    def decorator(func: BenchFunc) -> BenchFunc:
+        REGISTRY.append(Benchmark(group, name, unit, func, needs_window))
+        return func
+
+    return decorator
+
+
+def loop_overhead(loops: int) -> float:
+    """Time (in seconds) spent by an empty `for` loop of `loops` iterations"""
+    it = range(loops)
+    t0 = time.perf_counter_ns()
+    for _ in it:
+        pass
+    return (time.perf_counter_ns() - t0) * 1e-9
+
+
+def timeit(stmt: Callable[[], Any], loops: int) -> float:
+    """Calls `stmt` `loops` times, returns elapsed seconds"""
+    it = range(loops)
+    t0 = time.perf_counter_ns()
+    for _ in it:
+        stmt()
+    return (time.perf_counter_ns() - t0) * 1e-9
+
+
+def measure(bench: Benchmark, backend: Any, loops: int, repeat: int) -> Optional[Dict[str, Any]]:
+    """Runs `bench` `repeat` times and reduces it to a result dict (None if unsupported)"""
+    samples = []  # type: List[float]
+    overhead = loop_overhead(loops) if bench.unit == "ns/call" else 0.0
+    gc_enabled = gc.isenabled()
+    gc.disable()
+    try:
+        for _ in range(repeat):
+            elapsed = bench.func(backend, loops)
+            if elapsed < 0:
+                return None
+            samples.append(max(elapsed - overhead, 0.0))
+    finally:
+        if gc_enabled:
+            gc.enable()
+
+    best = min(samples)
+    samples.sort()
+    median = samples[len(samples) // 2]
+
+    if bench.unit == "ns/call":
+        value, median_value = best / loops * 1e9, median / loops * 1e9
+    else:  # draws/s
+        value = loops / best if best else float("inf")
+        median_value = loops / median if median else float("inf")
+
+    return {
+        "group": bench.group,
+        "name": bench.name,
+        "unit": bench.unit,
+        "value": value,
+        "median": median_value,
+        "loops": loops,
+        "repeat": repeat,
+    }
+
+
+UNSUPPORTED = -1.0
+"""Returned by a benchmark function when the backend lacks the measured API"""
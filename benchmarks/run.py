@@ -0,0 +1,133 @@
+"""ray.py benchmark runner
+
+usage: python benchmarks/run.py [-b raypy -b pyray] [-o results.json] [-c baseline.json]
+"""
+
+import argparse
+import datetime
+import json
+import platform
+import re
+import sys
+from typing import Any, Dict, List, Optional
+
+import bench_calls  # noqa: F401 (registers benchmarks)
+import bench_conversions  # noqa: F401
+import bench_draw  # noqa: F401
+from backends import Backend
+from harness import REGISTRY, measure
+
+
+def parse_args(argv: Optional[List[str]] = None) -> argparse.Namespace:
+    parser = argparse.ArgumentParser(description="Measure ray.py binding overhead and draw throughput")
+    parser.add_argument("-b", "--backend", action="append", default=[],
+                        help="module to benchmark, repeatable (default: raypy)")
+    parser.add_argument("-k", "--filter", default="",
+                        help="only run benchmarks whose 'group/name' matches this regex")
+    parser.add_argument("-n", "--loops", type=int, default=100_000,
+                        help="calls per sample (default: 100000)")
+    parser.add_argument("-d", "--draw-loops", type=int, default=10_000,
+                        help="draws per frame for the 'draw' group (default: 10000)")
+    parser.add_argument("-r", "--repeat", type=int, default=7,
+                        help="samples per benchmark, the best one is reported (default: 7)")
+    parser.add_argument("--no-window", action="store_true",
+                        help="skip benchmarks that need a GL context")
+    parser.add_argument("-o", "--output", help="write results as JSON to this file")
+    parser.add_argument("-c", "--compare", help="compare against a previous JSON results file")
+    parser.add_argument("-t", "--threshold", type=float, default=10.0,
+                        help="regression threshold in percent for --compare (default: 10)")
+    return parser.parse_args(argv)
+
+
+def run_backend(name: str, args: argparse.Namespace) -> Dict[str, Any]:
+    backend = Backend(name)
+    pattern = re.compile(args.filter)
+    results = []  # type: List[Dict[str, Any]]
+
+    selected = [b for b in REGISTRY if pattern.search("%s/%s" % (b.group, b.name))]
+    if args.no_window:
+        selected = [b for b in selected if not b.needs_window]
+
+    if any(b.needs_window for b in selected):
+        backend.open_offscreen()
+    try:
+        for bench in selected:
+            loops = args.draw_loops if bench.unit == "draws/s" else args.loops
+            try:
+                result = measure(bench, backend, loops, args.repeat)
+            except AttributeError as exc:
+                sys.stderr.write("%s: skipping %s/%s (%s)\n" % (name, bench.group, bench.name, exc))
+                continue
+            if result is None:
+                continue
+            results.append(result)
+            print("%-10s %-12s %-52s %14.2f %s"
+                  % (name, bench.group, bench.name, result["value"], bench.unit))
+    finally:
+        backend.close_offscreen()
+
+    return {"backend": backend.describe(), "results": results}
+
+
+def compare(current: Dict[str, Any], baseline: Dict[str, Any], threshold: float) -> int:
+    """Prints the change per benchmark and returns the number of regressions"""
+
+    def index(doc: Dict[str, Any]) -> Dict[Any, Dict[str, Any]]:
+        return {
+            (run["backend"]["name"], r["group"], r["name"]): r
+            for run in doc["runs"]
+            for r in run["results"]
+        }
+
+    old, new = index(baseline), index(current)
+    regressions = 0
+    print("\n%-10s %-12s %-52s %10s" % ("backend", "group", "benchmark", "change"))
+    for key in sorted(new):
+        if key not in old:
+            continue
+        before, after = old[key]["value"], new[key]["value"]
+        if not before:
+            continue
+        # ns/call: lower is better, draws/s: higher is better
+        if new[key]["unit"] == "ns/call":
+            change = (after - before) / before * 100.0
+        else:
+            change = (before - after) / before * 100.0
+        mark = ""
+        if change > threshold:
+            mark = "  REGRESSION"
+            regressions += 1
+        print("%-10s %-12s %-52s %+9.1f%%%s" % (key + (change, mark)))
+    return regressions
+
+
+def main(argv: Optional[List[str]] = None) -> int:
+    args = parse_args(argv)
+
+    document = {
+        "date": datetime.datetime.now(datetime.timezone.utc).isoformat(),
+        "python": sys.version,
+        "implementation": platform.python_implementation(),
+        "platform": platform.platform(),
+        "machine": platform.machine(),
+        "loops": args.loops,
+        "draw_loops": args.draw_loops,
+        "repeat": args.repeat,
+        "runs": [run_backend(name, args) for name in (args.backend or ["raypy"])],
+    }
+
+    if args.output:
+        with open(args.output, "w") as fp:
+            json.dump(document, fp, indent=2)
+
+    if args.compare:
+        with open(args.compare) as fp:
+            baseline = json.load(fp)
+        if compare(document, baseline, args.threshold):
+            return 1
+
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -1,5 +1,9 @@
 """CPython native bindings for Raylib"""
 
+from typing import Awaitable, Callable, Hashable, Sequence
+
+from _typeshed import ReadableBuffer
+
 RAYLIB_VERSION: str
 RAYLIB_VERSION_MAJOR: int
 RAYLIB_VERSION_MINOR: int
@@ -120,17 +124,57 @@ class Image:
     data: int
     """Image raw data"""
 
-    width: int
-    """Image base width"""
+    @property
+    def width(self) -> int:
+        """Image base width"""
+        ...
+
+    @property
+    def height(self) -> int:
+        """Image base height"""
+        ...
+
+    @property
+    def mipmaps(self) -> int:
+        """Mipmap levels, 1 by default"""
+        ...
+
+    @property
+    def format(self) -> int:
+        """Data format (PixelFormat type)"""
+        ...
 
-    height: int
-    """Image base height"""
+    def lazy(self) -> ImagePipeline:
+        """Start recording operations that apply() runs fused, in a single pass"""
+        ...
 
-    mipmaps: int
-    """Mipmap levels, 1 by default"""
 
-    format: int
-    """Data format (PixelFormat type)"""
+class ImagePipeline:
+    """ImagePipeline, image operations recorded by Image.lazy() and fused by apply()"""
+
+    @property
+    def width(self) -> int:
+        """Width of the result"""
+        ...
+
+    @property
+    def height(self) -> int:
+        """Height of the result"""
+        ...
+
+    def resize(self, new_width: int, new_height: int, /) -> ImagePipeline: ...
+    def resize_bilinear(self, new_width: int, new_height: int, /) -> ImagePipeline: ...
+    def resize_nn(self, new_width: int, new_height: int, /) -> ImagePipeline: ...
+    def crop(self, crop: Rectangle, /) -> ImagePipeline: ...
+    def flip_vertical(self) -> ImagePipeline: ...
+    def flip_horizontal(self) -> ImagePipeline: ...
+    def tint(self, color: Color, /) -> ImagePipeline: ...
+    def premultiply(self) -> ImagePipeline: ...
+    def to_format(self, new_format: int, /) -> ImagePipeline: ...
+
+    def apply(self) -> None:
+        """Run the recorded operations on the image in a single pass and clear them"""
+        ...
 
 
 class Texture:
@@ -138,18 +182,26 @@ class Texture:
 
     id: int
     """OpenGL texture id"""
-    
-    width: int
-    """Texture base width"""
-    
-    height: int
-    """Texture base height"""
-    
-    mipmaps: int
-    """Mipmap levels, 1 by default"""
-    
-    format: int
-    """Data format (PixelFormat type)"""
+
+    @property
+    def width(self) -> int:
+        """Texture base width"""
+        ...
+
+    @property
+    def height(self) -> int:
+        """Texture base height"""
+        ...
+
+    @property
+    def mipmaps(self) -> int:
+        """Mipmap levels, 1 by default"""
+        ...
+
+    @property
+    def format(self) -> int:
+        """Data format (PixelFormat type)"""
+        ...
 
 
 """Texture2D, same as Texture"""
@@ -159,6 +211,81 @@ Texture2D = Texture
 TextureCubemap = Texture
 
 
+class TextureCache:
+    """TextureCache, textures loaded on demand and evicted least recently used first over a VRAM budget
+
+    Textures got since the last end_drawing() and pinned ones are never
+    evicted, the budget is exceeded instead (see over_budget). Evicted
+    textures keep their Texture object with an id of 0, get() reloads into
+    that same object, so get() the textures drawn every frame or pin() them
+    """
+
+    budget: int
+    """VRAM budget in bytes, 0 for no limit"""
+
+    @property
+    def over_budget(self) -> int:
+        """VRAM in bytes above budget, taken by textures pinned or in use this frame"""
+        ...
+
+    @property
+    def used(self) -> int:
+        """VRAM in bytes taken by the resident textures"""
+        ...
+
+    @property
+    def hits(self) -> int:
+        """get() calls that found the texture resident"""
+        ...
+
+    @property
+    def misses(self) -> int:
+        """get() calls that loaded the texture"""
+        ...
+
+    @property
+    def evictions(self) -> int:
+        """Textures unloaded to stay under budget"""
+        ...
+
+    def __init__(self, budget: int = ..., loader: Callable[[Hashable], Texture] | None = ...,
+                 *, mipmaps: bool = ...) -> None: ...
+
+    def get(self, key: Hashable, /) -> Texture:
+        """Return the texture for a key, loading it on a miss and evicting the least recently used ones over budget"""
+        ...
+
+    def pin(self, key: Hashable, /) -> Texture:
+        """Return the texture for a key like get() and keep it from being evicted until unpin()"""
+        ...
+
+    def unpin(self, key: Hashable, /) -> None:
+        """Let a pinned texture be evicted again, once unpinned as many times as it was pinned"""
+        ...
+
+    def __getitem__(self, key: Hashable, /) -> Texture: ...
+
+    def __contains__(self, key: object, /) -> bool:
+        """Whether the texture for a key is resident"""
+        ...
+
+    def __len__(self) -> int:
+        """Number of resident textures"""
+        ...
+
+    def remove(self, key: Hashable, /) -> None:
+        """Unload the texture for a key and forget it"""
+        ...
+
+    def clear(self) -> None:
+        """Unload every texture and forget all keys"""
+        ...
+
+    def reset_stats(self) -> None:
+        """Reset hits, misses and evictions to 0"""
+        ...
+
+
 class RenderTexture:
     """RenderTexture, fbo for texture rendering"""
 
@@ -217,8 +344,566 @@ class GlyphInfo:
     """Character image data"""
 
 
+class Camera2D:
+    """Camera2D, defines position/orientation in 2d space"""
+
+    offset: Vector2
+    """Camera offset (displacement from target)"""
+
+    target: Vector2
+    """Camera target (rotation and zoom origin)"""
+
+    rotation: float
+    """Camera rotation in degrees"""
+
+    zoom: float
+    """Camera zoom (scaling), should be 1.0f by default"""
+
+    def __init__(self, offset: Vector2 = ..., target: Vector2 = ..., rotation: float = ...,
+                 zoom: float = ...) -> None: ...
+
+
+class Camera3D:
+    """Camera3D, defines position/orientation in 3d space"""
+
+    position: Vector3
+    """Camera position"""
+
+    target: Vector3
+    """Camera target it looks-at"""
+
+    up: Vector3
+    """Camera up vector (rotation over its axis)"""
+
+    fovy: float
+    """Camera field-of-view aperture in Y (degrees) in perspective, used as near plane width in orthographic"""
+
+    projection: int
+    """Camera projection: CAMERA_PERSPECTIVE or CAMERA_ORTHOGRAPHIC"""
+
+    def __init__(self, position: Vector3 = ..., target: Vector3 = ..., up: Vector3 = ...,
+                 fovy: float = ..., projection: int = ...) -> None: ...
+
+
+"""Camera, same as Camera3D"""
+Camera = Camera3D
+
+
+class Mesh:
+    """Mesh, vertex data and vao/vbo
+
+    The vertex arrays are writable memoryviews over the mesh's own memory,
+    e.g. `numpy.asarray(mesh.vertices)` is a (vertex_count, 3) float32 array,
+    changes are sent to the GPU with upload_mesh() or update_mesh_buffer()
+    """
+
+    @property
+    def vertex_count(self) -> int:
+        """Number of vertices stored in arrays"""
+        ...
+
+    @property
+    def triangle_count(self) -> int:
+        """Number of triangles stored (indexed or not)"""
+        ...
+
+    @property
+    def vao_id(self) -> int:
+        """OpenGL Vertex Array Object id, 0 until uploaded"""
+        ...
+
+    @property
+    def vertices(self) -> memoryview:
+        """Vertex position (XYZ - 3 components per vertex), float32 memoryview of shape (vertex_count, 3)"""
+        ...
+
+    @property
+    def texcoords(self) -> memoryview | None:
+        """Vertex texture coordinates (UV - 2 components per vertex), None if the mesh has none"""
+        ...
+
+    @property
+    def normals(self) -> memoryview | None:
+        """Vertex normals (XYZ - 3 components per vertex), None if the mesh has none"""
+        ...
+
+    @property
+    def colors(self) -> memoryview | None:
+        """Vertex colors (RGBA - 4 uint8 components per vertex), None if the mesh has none"""
+        ...
+
+    @property
+    def tangents(self) -> memoryview | None:
+        """Vertex tangents (XYZW - 4 components per vertex), None if the mesh has none"""
+        ...
+
+    @property
+    def texcoords2(self) -> memoryview | None:
+        """Vertex texture second coordinates (UV - 2 components per vertex), None if the mesh has none"""
+        ...
+
+    @property
+    def indices(self) -> memoryview | None:
+        """Vertex indices, uint16 memoryview of shape (triangle_count, 3), None if not indexed"""
+        ...
+
+    def __init__(self, vertex_count: int, triangle_count: int = ..., *, texcoords: bool = ...,
+                 normals: bool = ..., colors: bool = ..., tangents: bool = ...,
+                 texcoords2: bool = ...) -> None:
+        """Allocate zeroed arrays, indexed by triangle_count triangles when it's not 0"""
+        ...
+
+
+class Model:
+    """Model, meshes, materials and animation data"""
+
+    @property
+    def mesh_count(self) -> int:
+        """Number of meshes"""
+        ...
+
+    @property
+    def material_count(self) -> int:
+        """Number of materials"""
+        ...
+
+
+class Material:
+    """Material, includes shader and maps"""
+
+    @property
+    def shader_id(self) -> int:
+        """OpenGL id of the material shader"""
+        ...
+
+
+class Tilemap:
+    """Tilemap(width, height, tileset, tile_width, tile_height, chunk_size=32), grid of tiles drawn from cached chunk
+    meshes"""
+
+    def __init__(self, width: int, height: int, tileset: Texture, tile_width: int, tile_height: int,
+                 chunk_size: int = ...) -> None: ...
+    @property
+    def tiles(self) -> memoryview:
+        """Tile ids, uint16 memoryview of shape (height, width), 0 for no tile and n for the n-th tile of the tileset"""
+        ...
+
+    tileset: Texture
+    """Texture of the tiles, left to right and top to bottom"""
+
+    @property
+    def width(self) -> int:
+        """Map width in tiles"""
+        ...
+
+    @property
+    def height(self) -> int:
+        """Map height in tiles"""
+        ...
+
+    @property
+    def tile_width(self) -> int:
+        """Tile width in pixels"""
+        ...
+
+    @property
+    def tile_height(self) -> int:
+        """Tile height in pixels"""
+        ...
+
+    @property
+    def chunk_size(self) -> int:
+        """Chunk width and height in tiles"""
+        ...
+
+
+class ParticleSystem:
+    """ParticleSystem(capacity, seed=0), particles in float arrays updated natively, a seed of 0 seeds from the clock"""
+
+    def __init__(self, capacity: int, seed: int = ...) -> None: ...
+    @property
+    def capacity(self) -> int:
+        """Particles the system can hold"""
+        ...
+
+    @property
+    def count(self) -> int:
+        """Particles alive"""
+        ...
+
+    drag: float
+    """Fraction of the velocity lost per second"""
+
+    rate: float
+    """Particles emitted per second by update()"""
+
+    size_start: float
+    """Particle size at birth"""
+
+    size_end: float
+    """Particle size at death"""
+
+    gravity: Vector2
+    """Acceleration of every particle"""
+
+    @property
+    def x(self) -> memoryview:
+        """Positions x of the particles alive, float32 memoryview"""
+        ...
+
+    @property
+    def y(self) -> memoryview:
+        """Positions y of the particles alive, float32 memoryview"""
+        ...
+
+    @property
+    def vx(self) -> memoryview:
+        """Velocities x of the particles alive, float32 memoryview"""
+        ...
+
+    @property
+    def vy(self) -> memoryview:
+        """Velocities y of the particles alive, float32 memoryview"""
+        ...
+
+    @property
+    def age(self) -> memoryview:
+        """Seconds since each particle was emitted, float32 memoryview"""
+        ...
+
+    @property
+    def lifetime(self) -> memoryview:
+        """Seconds each particle lives, float32 memoryview"""
+        ...
+
+    def set_emitter(self, position: Vector2, rate: float = ..., *, speed: tuple[float, float] = ...,
+                    angle: tuple[float, float] = ..., life: tuple[float, float] = ..., spread: float = ...) -> None:
+        """Set where and how particles are emitted: position, rate per second and (min, max) ranges of speed, angle
+        in degrees and life in seconds, spread is the radius around the position they start in"""
+        ...
+
+    def emit(self, count: int, position: Vector2 = ..., /) -> int:
+        """Emit particles now, at the emitter or at a position, returns how many fit"""
+        ...
+
+    def update(self, dt: float, /) -> None:
+        """Move the particles dt seconds, remove those past their life and emit at the emitter rate"""
+        ...
+
+    def set_color_curve(self, stops: Sequence[tuple[float, Color]], /) -> None:
+        """Set the color over life as (time, Color) stops, time from 0.0 (birth) to 1.0 (death)"""
+        ...
+
+    def clear(self) -> None:
+        """Remove every particle"""
+        ...
+
+
+class Wave:
+    """Wave, audio wave data, a buffer of shape (frame_count, channels)"""
+
+    @property
+    def frame_count(self) -> int:
+        """Total number of frames (considering channels)"""
+        ...
+
+    @property
+    def sample_rate(self) -> int:
+        """Frequency (samples per second)"""
+        ...
+
+    @property
+    def sample_size(self) -> int:
+        """Bit depth (bits per sample): 8, 16, 32 (24 not supported)"""
+        ...
+
+    @property
+    def channels(self) -> int:
+        """Number of channels (1-mono, 2-stereo, ...)"""
+        ...
+
+
+class Sound:
+    """Sound, decoded audio played from memory, made by load_sound()"""
+
+    @property
+    def frame_count(self) -> int:
+        """Total number of frames (considering channels)"""
+        ...
+
+    @property
+    def sample_rate(self) -> int:
+        """Frequency (samples per second)"""
+        ...
+
+    @property
+    def sample_size(self) -> int:
+        """Bit depth (bits per sample): 8, 16, 32 (24 not supported)"""
+        ...
+
+    @property
+    def channels(self) -> int:
+        """Number of channels (1-mono, 2-stereo, ...)"""
+        ...
+
+
+class Music:
+    """Music, audio stream decoded from its file while playing, made by load_music_stream()"""
+
+    @property
+    def frame_count(self) -> int:
+        """Total number of frames (considering channels)"""
+        ...
+
+    @property
+    def sample_rate(self) -> int:
+        """Frequency (samples per second)"""
+        ...
+
+    @property
+    def sample_size(self) -> int:
+        """Bit depth (bits per sample): 8, 16, 32 (24 not supported)"""
+        ...
+
+    @property
+    def channels(self) -> int:
+        """Number of channels (1-mono, 2-stereo, ...)"""
+        ...
+
+    @property
+    def ctx_type(self) -> int:
+        """Type of music context (audio filetype)"""
+        ...
+
+    looping: bool
+    """Music looping enable"""
+
+
+class AudioStream:
+    """AudioStream, custom audio stream fed with PCM buffers, made by load_audio_stream()"""
+
+    @property
+    def sample_rate(self) -> int:
+        """Frequency (samples per second)"""
+        ...
+
+    @property
+    def sample_size(self) -> int:
+        """Bit depth (bits per sample): 8, 16, 32 (24 not supported)"""
+        ...
+
+    @property
+    def channels(self) -> int:
+        """Number of channels (1-mono, 2-stereo, ...)"""
+        ...
+
+    @property
+    def queued_frames(self) -> int:
+        """Frames queued with queue_audio_stream() not played yet"""
+        ...
+
+    @property
+    def silent_frames(self) -> int:
+        """Frames played as silence because the queue ran out"""
+        ...
+
+
+class Shader:
+    """Shader, program with cached uniform locations
+
+    Uniform locations are looked up once per name. For uniforms set every
+    frame describe them once with set_layout() and upload them together from
+    a packed buffer with set_values()
+    """
+
+    @property
+    def id(self) -> int:
+        """Shader program id, 0 once unloaded"""
+        ...
+
+    def get_location(self, name: str, /) -> int:
+        """Get shader uniform location, cached after the first lookup"""
+        ...
+
+    def get_location_attrib(self, name: str, /) -> int:
+        """Get shader attribute location"""
+        ...
+
+    def get_loc(self, index: int, /) -> int:
+        """Get the location raylib uses for a SHADER_LOC_* index"""
+        ...
+
+    def set_loc(self, index: int, location: int, /) -> None:
+        """Set the location raylib uses for a SHADER_LOC_* index, e.g. SHADER_LOC_MATRIX_MODEL for instancing"""
+        ...
+
+    def set_value(self, name: str, value: float | Sequence[float] | Vector2 | Vector3 | Vector4 | Color | Texture | ReadableBuffer,
+                  uniform_type: int = ..., /) -> None:
+        """Set shader uniform value, float or vecN unless uniform_type says otherwise, buffers set uniform arrays"""
+        ...
+
+    def set_layout(self, fields: Sequence[tuple[str, int] | tuple[str, int, int]], /) -> None:
+        """Describe the packed buffers set_values() gets, as (name, uniform_type[, count]) fields"""
+        ...
+
+    def set_values(self, values: dict[str, object] | ReadableBuffer, /) -> None:
+        """Set many uniforms at once, from a dict of name: value or a buffer packed as set_layout() describes"""
+        ...
+
+
+class InstanceBuffer:
+    """InstanceBuffer, per instance transforms kept in GPU memory (VRAM)"""
+
+    @property
+    def id(self) -> int:
+        """OpenGL vertex buffer id, 0 once unloaded"""
+        ...
+
+    @property
+    def capacity(self) -> int:
+        """Number of transforms the buffer holds"""
+        ...
+
+    count: int
+    """Number of instances drawn, grows with update_instance_buffer()"""
+
+
+class SpatialIndex:
+    """SpatialIndex(cell_size), rectangles and points with ids in a uniform grid for overlap, radius, raycast and
+    broad-phase collision queries"""
+
+    def __init__(self, cell_size: float) -> None: ...
+    @property
+    def cell_size(self) -> float:
+        """Grid cell size"""
+        ...
+
+    def insert(self, id: int, bounds: Rectangle | Vector2, /) -> None:
+        """Insert a Rectangle or a Vector2 point with an id, moving it if the id is already in"""
+        ...
+
+    def insert_many(self, ids: ReadableBuffer, bounds: ReadableBuffer, /) -> None:
+        """Insert or move many boxes from an integer ids buffer and a float32 buffer of (x, y, width, height) or
+        (x, y) per id"""
+        ...
+
+    def update_many(self, ids: ReadableBuffer, bounds: ReadableBuffer, /) -> None:
+        """Move many boxes like insert_many(), raising KeyError if an id isn't in the index"""
+        ...
+
+    def remove(self, id: int, /) -> None:
+        """Remove the box of an id"""
+        ...
+
+    def clear(self) -> None:
+        """Remove every box"""
+        ...
+
+    def query_rect(self, rec: Rectangle | Vector2, /) -> memoryview:
+        """Ids of the boxes overlapping a Rectangle (or containing a Vector2), int64 memoryview"""
+        ...
+
+    def query_radius(self, center: Vector2, radius: float, /) -> memoryview:
+        """Ids of the boxes overlapping a circle, int64 memoryview"""
+        ...
+
+    def raycast(self, start: Vector2, end: Vector2, /) -> memoryview:
+        """Ids of the boxes the segment from start to end crosses, nearest first, int64 memoryview"""
+        ...
+
+    def query_pairs(self) -> memoryview:
+        """Every pair of overlapping boxes once, int64 memoryview of shape (n, 2)"""
+        ...
+
+    def __len__(self) -> int: ...
+    def __contains__(self, id: object) -> bool: ...
+
+
+class FramePacer:
+    """FramePacer, hybrid sleep/spin frame limiter with a fixed timestep accumulator"""
+
+    target_fps: float
+    """Frames per second to pace at, 0 for no limit"""
+
+    fixed_dt: float
+    """Fixed update timestep in seconds, 0 disables the accumulator"""
+
+    max_frame_time: float
+    """Longest frame time fed to the accumulator, 0 for no limit"""
+
+    spin_threshold_ns: int
+    """Busy-wait this many nanoseconds before a deadline instead of sleeping"""
+
+    @property
+    def frame_time(self) -> float:
+        """Time in seconds for last frame (delta time)"""
+        ...
+
+    @property
+    def accumulator(self) -> float:
+        """Time in seconds not yet consumed by step()"""
+        ...
+
+    @property
+    def frame_count(self) -> int:
+        """Frames waited for since creation or reset()"""
+        ...
+
+    @property
+    def alpha(self) -> float:
+        """Interpolation factor between the last two fixed steps [0.0..1.0]"""
+        ...
+
+    def __init__(self, target_fps: float = ..., fixed_dt: float = ...,
+                 spin_threshold_ns: int = ..., max_frame_time: float = ...) -> None: ...
+
+    def wait(self) -> float:
+        """Wait until the next frame is due and return the last frame time in seconds"""
+        ...
+
+    def step(self) -> bool:
+        """Consume one fixed_dt from the accumulator, False when there's not enough time left"""
+        ...
+
+    def reset(self) -> None:
+        """Forget the previous frame time and empty the accumulator"""
+        ...
+
+
+class CommandList:
+    """CommandList(), draw and upload commands recorded on any thread for the render thread, use one per thread"""
+
+    def __init__(self) -> None: ...
+    def __len__(self) -> int: ...
+
+    def clear_background(self, color: Color, /) -> None:
+        """Record clear_background(color)"""
+        ...
+
+    def draw_text(self, text: str, pos_x: int, pos_y: int, font_size: int, color: Color) -> None:
+        """Record draw_text(text, pos_x, pos_y, font_size, color)"""
+        ...
+
+    def draw_texture(self, texture: Texture, pos_x: int, pos_y: int, tint: Color, /) -> None:
+        """Record draw_texture(texture, pos_x, pos_y, tint)"""
+        ...
+
+    def draw_fps(self, pos_x: int, pos_y: int, /) -> None:
+        """Record draw_fps(pos_x, pos_y)"""
+        ...
+
+    def call(self, func: Callable[..., object], /, *args: object) -> None:
+        """Record call(func, *args), func(*args) called on the render thread, for any other draw or upload function"""
+        ...
+
+    def clear(self) -> None:
+        """Drop the commands recorded"""
+        ...
+
+
 def swap_screen_buffer() -> None: ...
 def poll_input_events() -> None: ...
+def has_input_events() -> bool: ...
 def wait_time(ms: float, /) -> None: ...
 def show_cursor() -> None: ...
 def hide_cursor() -> None: ...
@@ -227,12 +912,25 @@ def enable_cursor() -> None: ...
 def disable_cursor() -> None: ...
 def is_cursor_on_screen() -> bool: ...
 def clear_background(color: Color, /) -> None: ...
-def begin_drawing() -> None: ...
+def begin_drawing() -> bool: ...
 def end_drawing() -> None: ...
 def set_target_fps(fps: int, /) -> None: ...
+def get_target_fps() -> int: ...
+def enable_frame_export(name: str, slots: int = ..., texture: Texture | None = ...) -> None: ...
+def disable_frame_export() -> None: ...
+def is_frame_export_enabled() -> bool: ...
+def enable_render_on_demand() -> None: ...
+def disable_render_on_demand() -> None: ...
+def is_render_on_demand() -> bool: ...
+def request_redraw(rec: Rectangle | None = ..., /) -> None: ...
+def is_redraw_requested() -> bool: ...
+def get_dirty_rect() -> Rectangle | None: ...
 def get_fps() -> int: ...
 def get_frame_time() -> float: ...
 def get_time() -> float: ...
+def get_time_ns() -> int: ...
+def get_frame_timings() -> dict[str, float]: ...
+def next_frame(fps: float | None = ..., idle: bool | None = ...) -> Awaitable[float]: ...
 def get_random_value(min: int, max: int, /) -> int: ...
 def set_random_seed(seed: int, /) -> None: ...
 def take_screenshot(file_name: str, /) -> None: ...
@@ -249,6 +947,150 @@ def get_key_pressed() -> int: ...
 def get_char_pressed() -> int: ...
 def draw_fps(pos_x: int, pos_y: int, /) -> None: ...
 def draw_text(text: str, pos_x: int, pos_y: int, font_size: int, color: Color) -> None: ...
+def submit_commands(commands: CommandList, /) -> None: ...
+def replay_commands() -> int: ...
+def is_render_thread() -> bool: ...
+def load_image(file_name: str, /) -> Image: ...
+def load_image_from_memory(file_type: str, data: ReadableBuffer, /) -> Image: ...
+def unload_image(image: Image, /) -> None: ...
+def gen_image_color(width: int, height: int, color: Color, /) -> Image: ...
+def image_copy(image: Image, /) -> Image: ...
+def image_resize(image: Image, new_width: int, new_height: int, /) -> None: ...
+def image_resize_bilinear(image: Image, new_width: int, new_height: int, /) -> None: ...
+def image_resize_nn(image: Image, new_width: int, new_height: int, /) -> None: ...
+def image_crop(image: Image, crop: Rectangle, /) -> None: ...
+def image_flip_vertical(image: Image, /) -> None: ...
+def image_flip_horizontal(image: Image, /) -> None: ...
+def image_rotate(image: Image, degrees: float, /) -> None: ...
+def image_rotate_cw(image: Image, /) -> None: ...
+def image_rotate_ccw(image: Image, /) -> None: ...
+def image_color_tint(image: Image, color: Color, /) -> None: ...
+def image_alpha_premultiply(image: Image, /) -> None: ...
+def image_format(image: Image, new_format: int, /) -> None: ...
+def image_blur_gaussian(image: Image, blur_size: int, /) -> None: ...
+def image_mipmaps(image: Image, /) -> None: ...
+def set_worker_threads(count: int, /) -> None: ...
+def get_worker_threads() -> int: ...
+def load_image_compressed(file_name: str, /) -> Image: ...
+def load_texture_compressed(file_name: str, /) -> Texture: ...
+def is_texture_format_supported(format: int, /) -> bool: ...
+def image_compress(image: Image, format: int, mipmaps: bool = ..., /) -> None: ...
+def export_image_compressed(image: Image, file_name: str, /) -> bool: ...
+def load_texture(file_name: str, mipmaps: bool = ..., /) -> Texture: ...
+def load_texture_from_image(image: Image, /) -> Texture: ...
+def gen_texture_mipmaps(texture: Texture, /) -> None: ...
+def set_texture_filter(texture: Texture, filter: int, /) -> None: ...
+def set_texture_wrap(texture: Texture, wrap: int, /) -> None: ...
+def begin_mode_2d(camera: Camera2D, /) -> None: ...
+def end_mode_2d() -> None: ...
+def get_screen_to_world_2d(position: Vector2, camera: Camera2D, /) -> Vector2: ...
+def get_world_to_screen_2d(position: Vector2, camera: Camera2D, /) -> Vector2: ...
+def set_cull_rect(rec: Rectangle | None, /) -> None: ...
+def get_cull_stats() -> tuple[int, int, int, int]: ...
+def draw_texture_batch(texture: Texture, dests: ReadableBuffer, sources: ReadableBuffer | None = ...,
+                       tint: Color = ..., colors: ReadableBuffer | None = ..., *, cull: bool = ...) -> int: ...
+def check_collision_recs(rec1: Rectangle, rec2: Rectangle, /) -> bool: ...
+def check_collision_circles(center1: Vector2, radius1: float, center2: Vector2, radius2: float, /) -> bool: ...
+def check_collision_circle_rec(center: Vector2, radius: float, rec: Rectangle, /) -> bool: ...
+def check_collision_point_rec(point: Vector2, rec: Rectangle, /) -> bool: ...
+def check_collision_point_circle(point: Vector2, center: Vector2, radius: float, /) -> bool: ...
+def get_collision_rec(rec1: Rectangle, rec2: Rectangle, /) -> Rectangle: ...
+def begin_mode_3d(camera: Camera3D, /) -> None: ...
+def end_mode_3d() -> None: ...
+def update_camera(camera: Camera3D, mode: int, /) -> None: ...
+def draw_grid(slices: int, spacing: float, /) -> None: ...
+def upload_mesh(mesh: Mesh, dynamic: bool = ..., /) -> None: ...
+def update_mesh_buffer(mesh: Mesh, index: int, first: int = ..., count: int = ..., /) -> None: ...
+def unload_mesh(mesh: Mesh, /) -> None: ...
+def gen_mesh_plane(width: float, length: float, res_x: int, res_z: int, /) -> Mesh: ...
+def gen_mesh_cube(width: float, height: float, length: float, /) -> Mesh: ...
+def load_model(file_name: str, /) -> Model: ...
+def load_model_from_mesh(mesh: Mesh, /) -> Model: ...
+def unload_model(model: Model, /) -> None: ...
+def draw_model(model: Model, position: Vector3, scale: float, tint: Color, /) -> None: ...
+def draw_model_wires(model: Model, position: Vector3, scale: float, tint: Color, /) -> None: ...
+def set_model_texture(model: Model, texture: Texture, material: int = ..., /) -> None: ...
+def load_material_default() -> Material: ...
+def get_model_material(model: Model, index: int = ..., /) -> Material: ...
+def set_material_texture(material: Material, map_type: int, texture: Texture, /) -> None: ...
+def load_instance_buffer(capacity: int, transforms: ReadableBuffer | None = ..., /) -> InstanceBuffer: ...
+def update_instance_buffer(buffer: InstanceBuffer, transforms: ReadableBuffer, first: int = ..., /) -> None: ...
+def unload_instance_buffer(buffer: InstanceBuffer, /) -> None: ...
+def draw_mesh_instanced(mesh: Mesh, material: Material, transforms: ReadableBuffer | InstanceBuffer,
+                        instances: int = ..., /) -> None: ...
+def draw_tilemap(tilemap: Tilemap, position: Vector2 = ..., tint: Color = ..., /) -> int: ...
+def unload_tilemap(tilemap: Tilemap, /) -> None: ...
+def draw_particles(system: ParticleSystem, texture: Texture = ..., /) -> int: ...
+def load_shader(vs_file_name: str | None, fs_file_name: str | None, /) -> Shader: ...
+def load_shader_from_memory(vs_code: str | None, fs_code: str | None, /) -> Shader: ...
+def unload_shader(shader: Shader, /) -> None: ...
+def begin_shader_mode(shader: Shader, /) -> None: ...
+def end_shader_mode() -> None: ...
+def set_material_shader(material: Material, shader: Shader, /) -> None: ...
+def init_audio_device() -> None: ...
+def close_audio_device() -> None: ...
+def is_audio_device_ready() -> bool: ...
+def set_master_volume(volume: float, /) -> None: ...
+def load_sound(file_name: str, /) -> Sound: ...
+def unload_sound(sound: Sound, /) -> None: ...
+def play_sound(sound: Sound, /) -> None: ...
+def stop_sound(sound: Sound, /) -> None: ...
+def pause_sound(sound: Sound, /) -> None: ...
+def resume_sound(sound: Sound, /) -> None: ...
+def is_sound_playing(sound: Sound, /) -> bool: ...
+def set_sound_volume(sound: Sound, volume: float, /) -> None: ...
+def set_sound_pitch(sound: Sound, pitch: float, /) -> None: ...
+def set_sound_pan(sound: Sound, pan: float, /) -> None: ...
+def load_music_stream(file_name: str, /) -> Music: ...
+def unload_music_stream(music: Music, /) -> None: ...
+def play_music_stream(music: Music, /) -> None: ...
+def is_music_stream_playing(music: Music, /) -> bool: ...
+def update_music_stream(music: Music, /) -> None: ...
+def stop_music_stream(music: Music, /) -> None: ...
+def pause_music_stream(music: Music, /) -> None: ...
+def resume_music_stream(music: Music, /) -> None: ...
+def seek_music_stream(music: Music, position: float, /) -> None: ...
+def set_music_volume(music: Music, volume: float, /) -> None: ...
+def set_music_pitch(music: Music, pitch: float, /) -> None: ...
+def set_music_pan(music: Music, pan: float, /) -> None: ...
+def get_music_time_length(music: Music, /) -> float: ...
+def get_music_time_played(music: Music, /) -> float: ...
+def load_audio_stream(sample_rate: int, sample_size: int, channels: int, /) -> AudioStream: ...
+def unload_audio_stream(stream: AudioStream, /) -> None: ...
+def update_audio_stream(stream: AudioStream, data: ReadableBuffer, /) -> None: ...
+def queue_audio_stream(stream: AudioStream, data: ReadableBuffer, /) -> None: ...
+def is_audio_stream_processed(stream: AudioStream, /) -> bool: ...
+def play_audio_stream(stream: AudioStream, /) -> None: ...
+def pause_audio_stream(stream: AudioStream, /) -> None: ...
+def resume_audio_stream(stream: AudioStream, /) -> None: ...
+def is_audio_stream_playing(stream: AudioStream, /) -> bool: ...
+def stop_audio_stream(stream: AudioStream, /) -> None: ...
+def set_audio_stream_volume(stream: AudioStream, volume: float, /) -> None: ...
+def set_audio_stream_pitch(stream: AudioStream, pitch: float, /) -> None: ...
+def set_audio_stream_pan(stream: AudioStream, pan: float, /) -> None: ...
+def set_audio_stream_buffer_size_default(size: int, /) -> None: ...
+def load_wave(file_name: str, /) -> Wave: ...
+def load_wave_from_memory(file_type: str, data: ReadableBuffer, /) -> Wave: ...
+def unload_wave(wave: Wave, /) -> None: ...
+def wave_copy(wave: Wave, /) -> Wave: ...
+def wave_format(wave: Wave, sample_rate: int, sample_size: int, channels: int, /) -> None: ...
+def export_wave(wave: Wave, file_name: str, /) -> bool: ...
+def load_sound_from_wave(wave: Wave, /) -> Sound: ...
+def _audio_mix(dst: ReadableBuffer, src: ReadableBuffer, gain: float = ..., pan: float = ..., /) -> int: ...
+def _audio_resample(src: ReadableBuffer, from_rate: int, to_rate: int, /) -> memoryview: ...
+def _audio_convert(src: ReadableBuffer, sample_size: int, /) -> memoryview: ...
+def vfs_mount(source: str, mount_point: str = ..., /) -> None: ...
+def vfs_unmount(source: str, /) -> bool: ...
+def vfs_read_file(file_name: str, /) -> bytes: ...
+
+
+def run(update: Callable[[float], object] | None = ..., draw: Callable[[float], object] | None = ...,
+        fixed_dt: float | None = ..., *, clear_color: Color | None = ...,
+        pacer: FramePacer | None = ...) -> None:
+    """Run the game loop until the window should close: update(dt) is called once per
+    frame, or once per fixed_dt step, then draw(alpha) between BeginDrawing() and
+    EndDrawing() after clearing the background with clear_color"""
+    ...
 
 
 def init_window(width: int, height: int, title: str, /) -> None:
@@ -491,6 +1333,11 @@ def disable_event_waiting() -> None:
     ...						
 
 
+def is_event_waiting() -> bool:
+    """Check if waiting for events on end_drawing() is enabled"""
+    ...
+
+
 # System/Window config flags
 # NOTE: Every bit registers one state (use it with bit masks)
 # By default all flags are set to 0
@@ -1442,6 +2289,29 @@ CAMERA_PERSPECTIVE: int
 """Orthographic projection"""
 CAMERA_ORTHOGRAPHIC: int
 
+# Mesh vertex buffers, for update_mesh_buffer()
+
+"""Vertex positions, rows are vertices"""
+MESH_BUFFER_VERTICES: int
+
+"""Vertex texture coordinates"""
+MESH_BUFFER_TEXCOORDS: int
+
+"""Vertex normals"""
+MESH_BUFFER_NORMALS: int
+
+"""Vertex colors"""
+MESH_BUFFER_COLORS: int
+
+"""Vertex tangents"""
+MESH_BUFFER_TANGENTS: int
+
+"""Vertex texture second coordinates"""
+MESH_BUFFER_TEXCOORDS2: int
+
+"""Vertex indices, rows are triangles"""
+MESH_BUFFER_INDICES: int
+
 # N-patch layout
 
 """Npatch layout: 3x3 tiles"""
@@ -0,0 +1,218 @@
+"""asyncio integration for ray.py
+
+Frames are paced by the event loop instead of inside `end_drawing()`, so other
+tasks (networking, timers...) keep running between frames:
+
+    async def main():
+        raypy.init_window(800, 450, "raypy.aio")
+        while not raypy.window_should_close():
+            raypy.begin_drawing()
+            ...
+            raypy.end_drawing()
+            await raypy.next_frame()
+
+Or let `run()` drive `update(dt)` and `draw(alpha)` callbacks, sync or async.
+
+With `enable_event_waiting()` (or `idle=True`) the loop goes idle: frames are
+only rendered when there's input, the window changed, `request_frame()` or
+`request_redraw()` was called, in between it just polls input events once per
+frame period, which keeps an idle window close to zero CPU usage.
+
+NOTE: set_target_fps(), FLAG_VSYNC_HINT and raylib's own event waiting block
+inside end_drawing(), i.e. they block the whole event loop, so the first call
+to `next_frame()` or `run()` turns off the first and the last. `run()` turns
+them back on when it returns, after `next_frame()` loops they stay off.
+"""
+
+import asyncio
+import inspect
+from typing import Any, Awaitable, Callable, Optional, Union
+
+import raypy
+
+__all__ = ["next_frame", "request_frame", "run"]
+
+Callback = Callable[[float], Union[Awaitable[Any], Any]]
+
+
+class _FrameClock:
+    """Frame deadlines on the running loop's clock, shared by next_frame() and run()"""
+
+    def __init__(self) -> None:
+        self.fps = 60.0
+        self.idle = False
+        self.deadline = 0.0
+        self.last = 0.0
+        self.requested = False
+        self.restore_event_waiting = False
+        self.restore_target_fps = 0
+        self.loop = None  # type: Optional[asyncio.AbstractEventLoop]
+        self.waiter = None  # type: Optional[asyncio.Future]
+
+    def bind(self, loop: asyncio.AbstractEventLoop) -> None:
+        if self.loop is loop:
+            return
+        self.loop = loop
+        self.deadline = self.last = 0.0
+        self.requested = True  # the first frame is always drawn
+        fps = raypy.get_target_fps()
+        if fps:
+            self.restore_target_fps = fps
+            raypy.set_target_fps(0)
+        if raypy.is_event_waiting():
+            # keep the flag, idle mode is handled here without blocking the loop
+            raypy.disable_event_waiting()
+            self.idle = True
+            self.restore_event_waiting = True
+
+    def unbind(self) -> None:
+        self.loop = None
+        if self.restore_target_fps:
+            raypy.set_target_fps(self.restore_target_fps)
+            self.restore_target_fps = 0
+        if self.restore_event_waiting:
+            self.restore_event_waiting = False
+            self.idle = False
+            raypy.enable_event_waiting()
+
+    def wake(self) -> None:
+        waiter = self.waiter
+        if waiter is not None and not waiter.done():
+            waiter.set_result(None)
+
+    async def sleep_until(self, deadline: float, interruptible: bool) -> None:
+        loop = self.loop
+        assert loop is not None
+        if deadline <= loop.time():
+            return
+        waiter = loop.create_future()
+        handle = loop.call_at(deadline, _resolve, waiter)
+        if interruptible:
+            self.waiter = waiter
+        try:
+            await waiter
+        finally:
+            handle.cancel()
+            if self.waiter is waiter:
+                self.waiter = None
+
+    def pending(self) -> bool:
+        return (self.requested or raypy.is_redraw_requested() or raypy.window_should_close()
+                or raypy.has_input_events())
+
+
+def _resolve(fut: asyncio.Future) -> None:
+    if not fut.done():
+        fut.set_result(None)
+
+
+_clock = _FrameClock()
+
+
+def request_frame() -> None:
+    """Ask an idle loop to render a frame, safe to call from any thread"""
+    _clock.requested = True
+    loop = _clock.loop
+    if loop is None or loop.is_closed():
+        return
+    try:
+        running = asyncio.get_running_loop()
+    except RuntimeError:
+        running = None
+    if running is loop:
+        _clock.wake()
+    else:
+        # wakes the selector through the loop's self-pipe
+        loop.call_soon_threadsafe(_clock.wake)
+
+
+async def next_frame(fps: Optional[float] = None, idle: Optional[bool] = None) -> float:
+    """Yield to the event loop until the next frame is due, returns the frame time in seconds
+
+    fps: frames per second to pace at (default: the previous value, initially 60)
+    idle: only return when there's input or request_frame() was called
+          (default: follow enable_event_waiting())
+    """
+    clock = _clock
+    loop = asyncio.get_running_loop()
+    clock.bind(loop)
+    if fps is not None:
+        if fps < 0:
+            raise ValueError("fps must be >= 0")
+        clock.fps = fps
+    if idle is not None:
+        clock.idle = idle
+
+    period = 1.0 / clock.fps if clock.fps > 0 else 0.0
+    now = loop.time()
+    if clock.last == 0.0:
+        clock.last = now
+    # missed a whole frame, don't try to catch up with a burst of short frames
+    if clock.deadline == 0.0 or now - clock.deadline > period:
+        clock.deadline = now
+    clock.deadline += period
+
+    if period:
+        await clock.sleep_until(clock.deadline, interruptible=False)
+    else:
+        await asyncio.sleep(0)
+
+    if clock.idle:
+        poll_period = period or 1.0 / 60.0
+        # the first check sees the events polled by the last end_drawing()
+        while not clock.pending():
+            clock.deadline = max(clock.deadline + poll_period, loop.time())
+            await clock.sleep_until(clock.deadline, interruptible=True)
+            raypy.poll_input_events()
+
+    clock.requested = False
+    now = loop.time()
+    dt, clock.last = now - clock.last, now
+    return dt
+
+
+async def _call(callback: Callback, arg: float) -> None:
+    res = callback(arg)
+    if inspect.isawaitable(res):
+        await res
+
+
+async def run(update: Optional[Callback] = None, draw: Optional[Callback] = None,
+              fixed_dt: Optional[float] = None, *, fps: float = 60.0,
+              clear_color: Optional[raypy.Color] = None, idle: Optional[bool] = None) -> None:
+    """Event-loop-friendly version of raypy.run()
+
+    update(dt) is called once per frame, or once per fixed_dt step, then draw(alpha)
+    between begin_drawing() and end_drawing(), either may be a coroutine function.
+    """
+    if fixed_dt is not None and fixed_dt <= 0:
+        raise ValueError("fixed_dt must be > 0 or None")
+
+    accumulator = 0.0
+    try:
+        dt = await next_frame(fps, idle)
+        while not raypy.window_should_close():
+            alpha = 1.0
+            if update is not None:
+                if fixed_dt:
+                    accumulator += min(dt, 0.25)
+                    while accumulator >= fixed_dt:
+                        await _call(update, fixed_dt)
+                        accumulator -= fixed_dt
+                    alpha = accumulator / fixed_dt
+                else:
+                    await _call(update, dt)
+
+            try:
+                # False when enable_render_on_demand() has nothing to redraw
+                if raypy.begin_drawing():
+                    if clear_color is not None:
+                        raypy.clear_background(clear_color)
+                    if draw is not None:
+                        await _call(draw, alpha)
+            finally:
+                raypy.end_drawing()
+
+            dt = await next_frame()
+    finally:
+        _clock.unbind()
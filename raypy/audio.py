@@ -0,0 +1,47 @@
+"""PCM mixing and resampling for ray.py
+
+Kernels over interleaved int16 or float32 samples in any C-contiguous
+buffer (numpy arrays, array.array, memoryviews), 1-D for mono or shaped
+(frames, channels). They run natively, 4 samples at a time where the CPU
+allows, and release the GIL, so sources can be mixed from several threads:
+
+    block = numpy.zeros((frames, 2), numpy.float32)
+    for voice in voices:
+        raypy.audio.mix(block, voice.render(frames), voice.gain, voice.pan)
+    raypy.queue_audio_stream(stream, block)
+
+int16 samples are scaled to [-1.0, 1.0) when mixed with float32 ones and
+results written as int16 saturate instead of wrapping around.
+"""
+
+from typing import TYPE_CHECKING, Literal
+
+from raypy import _audio_convert, _audio_mix, _audio_resample
+
+if TYPE_CHECKING:
+    from _typeshed import ReadableBuffer, WriteableBuffer
+
+
+def mix(dst: "WriteableBuffer", src: "ReadableBuffer", gain: float = 1.0, pan: float = 0.5) -> int:
+    """Add `src` times `gain` to `dst` in place, returns the frames mixed
+
+    Both are mono or stereo, mono sources are panned into stereo
+    destinations: 0.0 left only, 0.5 both at full level, 1.0 right only.
+    Stereo into mono is averaged. Mixes as many frames as the shorter of
+    the two holds, slice `dst` to mix at an offset.
+    """
+    return _audio_mix(dst, src, gain, pan)
+
+
+def resample(src: "ReadableBuffer", from_rate: int, to_rate: int) -> memoryview:
+    """Resample `src` from `from_rate` to `to_rate` with linear interpolation
+
+    Returns a new memoryview with the same sample type and shape layout,
+    len(src) * to_rate // from_rate frames long.
+    """
+    return _audio_resample(src, from_rate, to_rate)
+
+
+def convert(src: "ReadableBuffer", sample_size: Literal[16, 32]) -> memoryview:
+    """Convert `src` to int16 (16) or float32 (32) samples, returns a new memoryview shaped like `src`"""
+    return _audio_convert(src, sample_size)
@@ -0,0 +1,131 @@
+"""Shared memory frame reader for ray.py
+
+Reads the frames a ray.py process publishes with `enable_frame_export()`,
+from any other local process, without files or sockets in between:
+
+    # renderer
+    raypy.enable_frame_export("game-frames")
+
+    # analytics process
+    with FrameReader("game-frames") as reader:
+        last = 0
+        while True:
+            frame = reader.wait(after=last)
+            last = frame.number
+            pixels = numpy.frombuffer(frame.data, numpy.uint8).reshape(frame.height, frame.width, 4)
+
+The reader maps the memory read-only and never blocks the renderer, a frame
+that gets overwritten while being copied is read again, up to `RETRIES` times
+so a renderer that died mid-write can't keep it spinning.
+"""
+
+import mmap
+import os
+import struct
+import sys
+import time
+from typing import NamedTuple, Optional
+
+MAGIC = 0x46595052  # "RPYF"
+VERSION = 1
+
+# see the "Frame export" section of src/raypy.c
+HEADER = struct.Struct("=IIIIQQQQ")  # magic, version, slots, header size, slot size, capacity, latest, dropped
+SLOT = struct.Struct("=QQqIIII")  # sequence, frame, time_ns, width, height, format, stride
+SEQUENCE = struct.Struct("=Q")
+LATEST_OFFSET = 32
+SLOT_HEADER_SIZE = 64
+RETRIES = 100  # torn reads before read() gives up until the next call
+
+
+class Frame(NamedTuple):
+    number: int
+    """Frames published before this one plus one"""
+    time_ns: int
+    """When the frame was published, time.monotonic_ns() clock"""
+    width: int
+    height: int
+    format: int
+    """Pixel format, always PIXELFORMAT_UNCOMPRESSED_R8G8B8A8"""
+    stride: int
+    """Bytes per row"""
+    data: bytes
+    """Pixels, rows top to bottom for the screen"""
+
+
+class FrameReader:
+    """Read-only view of the frames published under `name`"""
+
+    def __init__(self, name: str) -> None:
+        self.name = name
+        self._map = self._open(name)
+        magic, version, self.slots, self._header_size, self._slot_size, self.capacity, _, _ = \
+            HEADER.unpack_from(self._map, 0)
+        if magic != MAGIC or version != VERSION:
+            self._map.close()
+            raise ValueError("%r is not a ray.py frame export (version %d)" % (name, VERSION))
+
+    @staticmethod
+    def _open(name: str) -> mmap.mmap:
+        name = name.lstrip("/")
+        if sys.platform == "win32":
+            header = mmap.mmap(-1, HEADER.size, tagname=name, access=mmap.ACCESS_READ)
+            try:
+                _, _, slots, header_size, slot_size, _, _, _ = HEADER.unpack_from(header, 0)
+            finally:
+                header.close()
+            return mmap.mmap(-1, header_size + slots * slot_size, tagname=name, access=mmap.ACCESS_READ)
+
+        import _posixshmem
+
+        fd = _posixshmem.shm_open("/" + name, os.O_RDONLY, mode=0)
+        try:
+            return mmap.mmap(fd, os.fstat(fd).st_size, mmap.MAP_SHARED, mmap.PROT_READ)
+        finally:
+            os.close(fd)
+
+    @property
+    def latest(self) -> int:
+        """Number of the last published frame, 0 if none yet"""
+        return SEQUENCE.unpack_from(self._map, LATEST_OFFSET)[0]
+
+    @property
+    def dropped(self) -> int:
+        """Frames not published for being larger than the window was when export started"""
+        return HEADER.unpack_from(self._map, 0)[7]
+
+    def read(self, after: int = 0) -> Optional[Frame]:
+        """Copy the last published frame, None if there's none newer than `after` or it kept changing"""
+        for _ in range(RETRIES):
+            number = self.latest
+            if number <= after:
+                return None
+            offset = self._header_size + (number % self.slots) * self._slot_size
+            sequence, frame, time_ns, width, height, format, stride = SLOT.unpack_from(self._map, offset)
+            if sequence & 1 or frame != number:
+                continue  # being written, or already reused for a newer frame
+            start = offset + SLOT_HEADER_SIZE
+            data = self._map[start:start + stride * height]
+            if SEQUENCE.unpack_from(self._map, offset)[0] == sequence:
+                return Frame(number, time_ns, width, height, format, stride, data)
+        return None
+
+    def wait(self, after: int = 0, timeout: Optional[float] = None, interval: float = 0.001) -> Optional[Frame]:
+        """Wait for a frame newer than `after`, None on timeout"""
+        deadline = None if timeout is None else time.monotonic() + timeout
+        while True:
+            frame = self.read(after)
+            if frame is not None:
+                return frame
+            if deadline is not None and time.monotonic() >= deadline:
+                return None
+            time.sleep(interval)
+
+    def close(self) -> None:
+        self._map.close()
+
+    def __enter__(self) -> "FrameReader":
+        return self
+
+    def __exit__(self, *exc_info: object) -> None:
+        self.close()
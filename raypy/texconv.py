@@ -0,0 +1,92 @@
+"""Offline texture converter for ray.py
+
+Compresses images to DXT and writes them as DDS or KTX files that
+`load_texture_compressed()` uploads as they are, 4-8x smaller in VRAM than
+R8G8B8A8 and without any decoding at load time:
+
+    python -m raypy.texconv -f dxt5 --mipmaps sprites/*.png -d build/textures
+
+DDS, KTX and KTX2 inputs are converted between containers without
+recompressing, e.g. ETC2 or ASTC files made by other encoders to KTX.
+"""
+
+import argparse
+import os
+import sys
+import time
+from typing import List, Optional
+
+import raypy
+
+FORMATS = {
+    "dxt1": raypy.PIXELFORMAT_COMPRESSED_DXT1_RGB,
+    "dxt1a": raypy.PIXELFORMAT_COMPRESSED_DXT1_RGBA,
+    "dxt3": raypy.PIXELFORMAT_COMPRESSED_DXT3_RGBA,
+    "dxt5": raypy.PIXELFORMAT_COMPRESSED_DXT5_RGBA,
+}
+
+COMPRESSED_EXTENSIONS = (".dds", ".ktx", ".ktx2")
+
+
+def parse_args(argv: Optional[List[str]] = None) -> argparse.Namespace:
+    parser = argparse.ArgumentParser(prog="python -m raypy.texconv",
+                                     description="Compress images to DDS/KTX textures")
+    parser.add_argument("inputs", nargs="+", help="images to convert (png, jpg, ..., dds, ktx, ktx2)")
+    parser.add_argument("-f", "--format", choices=sorted(FORMATS), default="dxt5",
+                        help="DXT format: dxt1 (no alpha), dxt1a (1-bit alpha), dxt3 or dxt5 (default: dxt5)")
+    parser.add_argument("-m", "--mipmaps", action="store_true", help="generate mipmaps")
+    parser.add_argument("-t", "--type", choices=("dds", "ktx"), default="dds",
+                        help="output container (default: dds)")
+    parser.add_argument("-o", "--output", help="output file, only with a single input")
+    parser.add_argument("-d", "--out-dir", help="output directory (default: next to the inputs)")
+    parser.add_argument("-j", "--threads", type=int, default=0,
+                        help="encoding threads (default: one per CPU)")
+    args = parser.parse_args(argv)
+    if args.output and len(args.inputs) > 1:
+        parser.error("--output needs a single input, use --out-dir instead")
+    return args
+
+
+def output_path(path: str, args: argparse.Namespace) -> str:
+    if args.output:
+        return args.output
+    base = os.path.splitext(os.path.basename(path))[0] + "." + args.type
+    return os.path.join(args.out_dir or os.path.dirname(path), base)
+
+
+def convert(path: str, out: str, args: argparse.Namespace) -> raypy.Image:
+    if path.lower().endswith(COMPRESSED_EXTENSIONS):
+        image = raypy.load_image_compressed(path)
+    else:
+        image = raypy.load_image(path)
+        raypy.image_compress(image, FORMATS[args.format], args.mipmaps)
+    if not raypy.export_image_compressed(image, out):
+        raise OSError("failed to write %r" % out)
+    return image
+
+
+def main(argv: Optional[List[str]] = None) -> int:
+    args = parse_args(argv)
+    if args.threads:
+        raypy.set_worker_threads(args.threads)
+    if args.out_dir:
+        os.makedirs(args.out_dir, exist_ok=True)
+
+    failed = 0
+    for path in args.inputs:
+        out = output_path(path, args)
+        start = time.perf_counter()
+        try:
+            image = convert(path, out, args)
+        except (OSError, ValueError) as exc:
+            sys.stderr.write("%s: %s\n" % (path, exc))
+            failed += 1
+            continue
+        print("%s -> %s (%dx%d, %d mipmaps, %d bytes, %.0f ms)"
+              % (path, out, image.width, image.height, image.mipmaps, os.path.getsize(out),
+                 (time.perf_counter() - start) * 1000.0))
+    return 1 if failed else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
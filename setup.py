@@ -293,6 +293,8 @@ if __name__ == "__main__":
         libraries.extend(["raylib", "user32", "gdi32", "winmm", "shell32"])
     else:
         extra_objects.append(os.path.join(RAYLIB_DIR, "lib", "libraylib.a"))
+        if sys.platform.startswith("linux"):
+            libraries.append("rt")  # shm_open() before glibc 2.34
 
     try:
         setup(
@@ -3,12 +3,110 @@
 #include <descrobject.h> // Py_T_FLOAT
 #include <stddef.h> // offsetof
 #include <raylib.h>
+#include <rlgl.h> // rlDrawRenderBatchActive, rlReadScreenPixels
+#include <raymath.h> // MatrixMultiply
 #include <stdio.h>
+#include <string.h> // memset
+#include <stdint.h> // int64_t
+#include <errno.h>
+#include <time.h>
+#include <math.h>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#include <immintrin.h> // _mm_pause
+#define RAYPY_CPU_RELAX() _mm_pause()
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define RAYPY_SSE2 1
+#endif
+#elif defined(__aarch64__) || defined(__arm__)
+#define RAYPY_CPU_RELAX() __asm__ __volatile__("yield")
+#else
+#define RAYPY_CPU_RELAX() ((void)0)
+#endif
+
+/* Atomics, for the few flags threads share without a lock. The _LONG ones
+   take int, long or unsigned long, all 32 bits on Windows. */
+#if defined(_MSC_VER)
+#include <intrin.h> // _InterlockedCompareExchange, _ReadWriteBarrier, __dmb
+#if defined(_M_ARM64)
+#define RAYPY_FENCE_RELEASE() __dmb(0xB) // ISH
+#else
+#define RAYPY_FENCE_RELEASE() _ReadWriteBarrier() // stores aren't reordered on x86
+#endif
+#define RAYPY_STORE_RELEASE(p, v) (RAYPY_FENCE_RELEASE(), *(volatile unsigned long long *)(p) = (v))
+#define RAYPY_LOAD_LONG(p) _InterlockedOr((volatile long *)(p), 0)
+#define RAYPY_STORE_LONG(p, v) ((void)_InterlockedExchange((volatile long *)(p), (long)(v)))
+#define RAYPY_CAS_LONG(p, expected, desired) \
+    (_InterlockedCompareExchange((volatile long *)(p), (long)(desired), (long)(expected)) == (long)(expected))
+#define RAYPY_ADD_LONG(p, v) (_InterlockedExchangeAdd((volatile long *)(p), (long)(v)) + (long)(v))
+#define RAYPY_THREAD_LOCAL __declspec(thread)
+#else
+#define RAYPY_FENCE_RELEASE() __atomic_thread_fence(__ATOMIC_RELEASE)
+#define RAYPY_STORE_RELEASE(p, v) __atomic_store_n((p), (v), __ATOMIC_RELEASE)
+#define RAYPY_LOAD_LONG(p) __atomic_load_n((p), __ATOMIC_ACQUIRE)
+#define RAYPY_STORE_LONG(p, v) __atomic_store_n((p), (v), __ATOMIC_RELEASE)
+#define RAYPY_CAS_LONG(p, expected, desired) __sync_bool_compare_and_swap((p), (expected), (desired))
+#define RAYPY_ADD_LONG(p, v) __atomic_add_fetch((p), (v), __ATOMIC_ACQ_REL)
+#define RAYPY_THREAD_LOCAL _Thread_local
+#endif
+
+/* Python 3.13 locks objects in these on the free-threaded build, the GIL does it otherwise */
+#ifndef Py_BEGIN_CRITICAL_SECTION
+#define Py_BEGIN_CRITICAL_SECTION(op) {
+#define Py_END_CRITICAL_SECTION() }
+#endif
+
+/* Defines func##_Locked, func called with self locked, for methods of mutable containers */
+#define RAYPY_LOCKED_METHOD(type, func)                                  \
+    static PyObject *func##_Locked(type *self, PyObject *arg)            \
+    {                                                                    \
+        PyObject *ret;                                                   \
+        Py_BEGIN_CRITICAL_SECTION(self);                                 \
+        ret = func(self, arg);                                           \
+        Py_END_CRITICAL_SECTION();                                       \
+        return ret;                                                      \
+    }
+
+#define RAYPY_LOCKED_METHOD_KW(type, func)                                           \
+    static PyObject *func##_Locked(type *self, PyObject *args, PyObject *keywds)     \
+    {                                                                                \
+        PyObject *ret;                                                               \
+        Py_BEGIN_CRITICAL_SECTION(self);                                             \
+        ret = func(self, args, keywds);                                              \
+        Py_END_CRITICAL_SECTION();                                                   \
+        return ret;                                                                  \
+    }
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+#if defined(_WIN32)
+/* <windows.h> clashes with raylib.h (CloseWindow, DrawText, Rectangle...) */
+__declspec(dllimport) int __stdcall QueryPerformanceCounter(long long *count);
+__declspec(dllimport) int __stdcall QueryPerformanceFrequency(long long *frequency);
+__declspec(dllimport) void __stdcall Sleep(unsigned long milliseconds);
+__declspec(dllimport) void *__stdcall CreateFileA(const char *name, unsigned long access, unsigned long share,
+                                                  void *security, unsigned long disposition,
+                                                  unsigned long flags, void *template_file);
+__declspec(dllimport) int __stdcall GetFileSizeEx(void *file, long long *size);
+__declspec(dllimport) void *__stdcall CreateFileMappingA(void *file, void *security, unsigned long protect,
+                                                         unsigned long size_high, unsigned long size_low,
+                                                         const char *name);
+__declspec(dllimport) void *__stdcall MapViewOfFile(void *mapping, unsigned long access, unsigned long offset_high,
+                                                    unsigned long offset_low, size_t size);
+__declspec(dllimport) int __stdcall UnmapViewOfFile(const void *view);
+__declspec(dllimport) int __stdcall CloseHandle(void *handle);
+__declspec(dllimport) unsigned long __stdcall GetLastError(void);
+#define RAYPY_DEFAULT_SPIN_NS 2000000LL // Sleep() has ~1ms granularity at best
+#else
+#define RAYPY_DEFAULT_SPIN_NS 1000000LL
+#include <fcntl.h>    // open
+#include <sys/mman.h> // mmap
+#include <sys/stat.h> // fstat
+#include <unistd.h>   // close
+#endif
+
 #define METH_O_TYPE_ERROR(obj, type)                                                          \
     if (PyErr_Occurred()) {                                                                   \
         if (PyErr_ExceptionMatches(PyExc_TypeError)) {                                        \
@@ -19,12 +117,157 @@ extern "C" {
         return NULL;                                                                          \
     }
 
+/* Thread that called init_window(), raylib's GL calls all have to come from it */
+static unsigned long RayPy_render_thread = 0;
+/* and its interpreter, subinterpreters can run on the same thread, -1 with no window */
+static long RayPy_render_interp = -1;
+/* drawing between begin_drawing() and end_drawing() */
+static int RayPy_frame_open = 0;
+/* end_drawing() calls so far, render thread only */
+static unsigned long long RayPy_frame_count = 0;
+/* bumped by every init_window(), tells the GL objects of one window from the next's */
+static long RayPy_window_generation = 0;
+
+static long
+RayPy_InterpreterId(void)
+{
+    return (long)PyInterpreterState_GetID(PyInterpreterState_Get());
+}
+
+/* 1 when a window is open and this isn't its thread and interpreter */
+static int
+RayPy_OffRenderThread(void)
+{
+    unsigned long render_thread = RAYPY_LOAD_LONG(&RayPy_render_thread);
+    if (render_thread == 0)
+        return 0;
+    /* the interpreter is stored after the thread is claimed, -1 until then fails the check */
+    return PyThread_get_thread_ident() != render_thread
+           || RAYPY_LOAD_LONG(&RayPy_render_interp) != RayPy_InterpreterId();
+}
+
+#define IS_RENDER_THREAD()                                                                    \
+    if (RayPy_OffRenderThread()) {                                                            \
+        PyErr_SetString(PyExc_RuntimeError,                                                   \
+                        "must be called from the thread and interpreter that called "         \
+                        "init_window(), record it in a CommandList and submit_commands() "   \
+                        "it from other threads");                                             \
+        return NULL;                                                                          \
+    }
+
 #define WINDOW_IS_READY()                                                                     \
+    IS_RENDER_THREAD()                                                                        \
     if (!IsWindowReady()) {                                                                   \
         PyErr_SetString(PyExc_RuntimeError, "window not initialized");                        \
         return NULL;                                                                          \
     }
 
+/* Module state
+
+   Types are heap types, created by the first import in each interpreter and
+   shared by later ones there. Code that isn't handed the module gets them
+   from RayPy_GetState(), the state of the current interpreter's module,
+   which each thread caches. */
+
+#define RAYPY_TYPES(X) \
+    X(Vector2) \
+    X(Vector3) \
+    X(Vector4) \
+    X(Color) \
+    X(Rectangle) \
+    X(Image) \
+    X(ImagePipeline) \
+    X(Texture) \
+    X(TextureCacheEntry) \
+    X(TextureCache) \
+    X(IdBuffer) \
+    X(SpatialIndex) \
+    X(Camera2D) \
+    X(Camera3D) \
+    X(MeshBuffer) \
+    X(Mesh) \
+    X(Model) \
+    X(Material) \
+    X(InstanceBuffer) \
+    X(Shader) \
+    X(Tilemap) \
+    X(ParticleArray) \
+    X(ParticleSystem) \
+    X(Sound) \
+    X(Music) \
+    X(AudioStream) \
+    X(PcmBuffer) \
+    X(Wave) \
+    X(FramePacer) \
+    X(CommandList)
+
+typedef struct {
+#define RAYPY_STATE_TYPE(name) PyTypeObject *name##_Type;
+    RAYPY_TYPES(RAYPY_STATE_TYPE)
+#undef RAYPY_STATE_TYPE
+} RayPy_State;
+
+/* key of the first imported module in the interpreter's dict */
+#define RAYPY_STATE_KEY "raypy"
+
+static RAYPY_THREAD_LOCAL struct {
+    int64_t interp; // ID, addresses get reused
+    RayPy_State *state;
+} RayPy_state_cache;
+
+static RayPy_State *
+RayPy_FindState(void)
+{
+    PyInterpreterState *interp = PyInterpreterState_Get();
+    PyObject *dict = PyInterpreterState_GetDict(interp);
+    PyObject *module = dict != NULL ? PyDict_GetItemString(dict, RAYPY_STATE_KEY) : NULL;
+    if (module == NULL)
+        Py_FatalError("raypy: no module state in this interpreter");
+    RayPy_state_cache.interp = PyInterpreterState_GetID(interp);
+    RayPy_state_cache.state = PyModule_GetState(module);
+    return RayPy_state_cache.state;
+}
+
+static inline RayPy_State *
+RayPy_GetState(void)
+{
+    if (RayPy_state_cache.state != NULL
+        && RayPy_state_cache.interp == PyInterpreterState_GetID(PyInterpreterState_Get()))
+        return RayPy_state_cache.state;
+    return RayPy_FindState();
+}
+
+#define RayPy_Vector2_Type (*RayPy_GetState()->Vector2_Type)
+#define RayPy_Vector3_Type (*RayPy_GetState()->Vector3_Type)
+#define RayPy_Vector4_Type (*RayPy_GetState()->Vector4_Type)
+#define RayPy_Color_Type (*RayPy_GetState()->Color_Type)
+#define RayPy_Rectangle_Type (*RayPy_GetState()->Rectangle_Type)
+#define RayPy_Image_Type (*RayPy_GetState()->Image_Type)
+#define RayPy_ImagePipeline_Type (*RayPy_GetState()->ImagePipeline_Type)
+#define RayPy_Texture_Type (*RayPy_GetState()->Texture_Type)
+#define RayPy_TextureCacheEntry_Type (*RayPy_GetState()->TextureCacheEntry_Type)
+#define RayPy_TextureCache_Type (*RayPy_GetState()->TextureCache_Type)
+#define RayPy_IdBuffer_Type (*RayPy_GetState()->IdBuffer_Type)
+#define RayPy_SpatialIndex_Type (*RayPy_GetState()->SpatialIndex_Type)
+#define RayPy_Camera2D_Type (*RayPy_GetState()->Camera2D_Type)
+#define RayPy_Camera3D_Type (*RayPy_GetState()->Camera3D_Type)
+#define RayPy_MeshBuffer_Type (*RayPy_GetState()->MeshBuffer_Type)
+#define RayPy_Mesh_Type (*RayPy_GetState()->Mesh_Type)
+#define RayPy_Model_Type (*RayPy_GetState()->Model_Type)
+#define RayPy_Material_Type (*RayPy_GetState()->Material_Type)
+#define RayPy_InstanceBuffer_Type (*RayPy_GetState()->InstanceBuffer_Type)
+#define RayPy_Shader_Type (*RayPy_GetState()->Shader_Type)
+#define RayPy_Tilemap_Type (*RayPy_GetState()->Tilemap_Type)
+#define RayPy_ParticleArray_Type (*RayPy_GetState()->ParticleArray_Type)
+#define RayPy_ParticleSystem_Type (*RayPy_GetState()->ParticleSystem_Type)
+#define RayPy_Sound_Type (*RayPy_GetState()->Sound_Type)
+#define RayPy_Music_Type (*RayPy_GetState()->Music_Type)
+#define RayPy_AudioStream_Type (*RayPy_GetState()->AudioStream_Type)
+#define RayPy_PcmBuffer_Type (*RayPy_GetState()->PcmBuffer_Type)
+#define RayPy_Wave_Type (*RayPy_GetState()->Wave_Type)
+#define RayPy_FramePacer_Type (*RayPy_GetState()->FramePacer_Type)
+#define RayPy_CommandList_Type (*RayPy_GetState()->CommandList_Type)
+
 /* Utility Functions */
 
 PyObject *
@@ -43,6 +286,347 @@ RayPyErr_ArgTypeError(Py_ssize_t i, PyTypeObject *type, PyObject *const *args)
         i+1, type->tp_name, Py_TYPE(args[i])->tp_name);
 }
 
+/* Monotonic clock in nanoseconds, unrelated to the wall clock */
+static int64_t
+RayPy_MonotonicNs(void)
+{
+#if defined(_WIN32)
+    static long long frequency = 0;
+    long long counter;
+    if (frequency == 0)
+        QueryPerformanceFrequency(&frequency);
+    QueryPerformanceCounter(&counter);
+    return (int64_t)((counter / frequency) * 1000000000LL
+                     + (counter % frequency) * 1000000000LL / frequency);
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+#endif
+}
+
+/* get_time_ns() origin, set by RayPy_exec() and reset by RayPy_InitWindow() */
+static int64_t RayPy_time_base_ns = 0;
+
+/* Render on demand, see enable_render_on_demand() */
+
+typedef struct {
+    int enabled;
+    int full;            // the whole screen is damaged
+    int has_dirty;       // `dirty` holds the union of the damaged regions
+    Rectangle dirty;
+    int drawing;         // 0: frame skipped, 1: full redraw, 2: scissored redraw
+    RenderTexture2D canvas; // keeps the last frame, partial redraws go on top of it
+    int skipped;         // the last frame was skipped, raylib didn't time it
+    float frame_time;    // seconds since the frame before the skipped one
+} RayPy_RedrawState;
+
+#define RAYPY_IDLE_FPS 60 // skipped frames pace at this rate without a target or monitor rate
+
+static RayPy_RedrawState RayPy_redraw = {0};
+static int RayPy_target_fps = 0;
+static int64_t RayPy_last_frame_ns = 0;
+
+/* drops render on demand state, must run before the GL context goes away */
+static void
+RayPy_Redraw_Reset(void)
+{
+    if (RayPy_redraw.canvas.id != 0)
+        UnloadRenderTexture(RayPy_redraw.canvas);
+    RayPy_redraw = (RayPy_RedrawState){0};
+}
+
+/* GL objects released off the render thread
+
+   Objects owning GPU memory can be dropped by any thread but only the render
+   thread can free it, the others queue the ids for the next begin_drawing().
+   Ids queued for a window closed since went with its context. */
+
+enum {
+    RAYPY_GL_TEXTURE,
+    RAYPY_GL_VERTEX_ARRAY,
+    RAYPY_GL_VERTEX_BUFFER,
+};
+
+typedef struct RayPy_GLRelease {
+    struct RayPy_GLRelease *next;
+    int kind;
+    unsigned int id;
+    long window; // RayPy_window_generation when queued
+} RayPy_GLRelease;
+
+static RayPy_GLRelease *RayPy_gl_releases = NULL;
+
+static void
+RayPy_GL_Unload(int kind, unsigned int id)
+{
+    switch (kind) {
+    case RAYPY_GL_TEXTURE:
+        rlUnloadTexture(id);
+        break;
+    case RAYPY_GL_VERTEX_ARRAY:
+        rlUnloadVertexArray(id);
+        break;
+    case RAYPY_GL_VERTEX_BUFFER:
+        rlUnloadVertexBuffer(id);
+        break;
+    }
+}
+
+/* Frees a GL object now on the render thread, at the next begin_drawing()
+   from any other, nothing to do without a window */
+static void
+RayPy_GL_Release(int kind, unsigned int id)
+{
+    long window = RAYPY_LOAD_LONG(&RayPy_window_generation);
+    if (id == 0 || !IsWindowReady())
+        return;
+    if (!RayPy_OffRenderThread()) {
+        RayPy_GL_Unload(kind, id);
+        return;
+    }
+    RayPy_GLRelease *release = PyMem_RawMalloc(sizeof(RayPy_GLRelease));
+    if (release == NULL)
+        return; // leaked, nothing better to do in a dealloc
+    release->kind = kind;
+    release->id = id;
+    release->window = window;
+#if defined(_MSC_VER)
+    void *head;
+    do {
+        head = *(void *volatile *)&RayPy_gl_releases;
+        release->next = head;
+    } while (_InterlockedCompareExchangePointer((void *volatile *)&RayPy_gl_releases, release, head) != head);
+#else
+    RayPy_GLRelease *head = __atomic_load_n(&RayPy_gl_releases, __ATOMIC_RELAXED);
+    do
+        release->next = head;
+    while (!__atomic_compare_exchange_n(&RayPy_gl_releases, &head, release, 1, __ATOMIC_RELEASE,
+                                        __ATOMIC_RELAXED));
+#endif
+}
+
+/* Frees what other threads released, on the render thread. unload is 0 to
+   only drop the queue, when the context is already gone. */
+static void
+RayPy_GL_ReleaseQueued(int unload)
+{
+#if defined(_MSC_VER)
+    RayPy_GLRelease *release = _InterlockedExchangePointer((void *volatile *)&RayPy_gl_releases, NULL);
+#else
+    RayPy_GLRelease *release = __atomic_exchange_n(&RayPy_gl_releases, NULL, __ATOMIC_ACQUIRE);
+#endif
+    long window = RAYPY_LOAD_LONG(&RayPy_window_generation);
+    if (release != NULL && unload)
+        rlDrawRenderBatchActive();
+    while (release != NULL) {
+        RayPy_GLRelease *next = release->next;
+        if (unload && release->window == window)
+            RayPy_GL_Unload(release->kind, release->id);
+        PyMem_RawFree(release);
+        release = next;
+    }
+}
+
+static void
+RayPy_SleepNs(int64_t ns)
+{
+    if (ns <= 0)
+        return;
+#if defined(_WIN32)
+    Sleep((unsigned long)(ns / 1000000));
+#else
+    struct timespec ts = {(time_t)(ns / 1000000000LL), (long)(ns % 1000000000LL)};
+    while (nanosleep(&ts, &ts) == -1 && errno == EINTR)
+        ;
+#endif
+}
+
+/* Sleep until `spin_ns` before `deadline`, then busy-wait the rest so the OS
+   scheduler's wake-up latency doesn't end up in the frame time.
+   Doesn't touch Python objects, call it with the GIL released. */
+static void
+RayPy_WaitUntilNs(int64_t deadline, int64_t spin_ns)
+{
+    int64_t remaining = deadline - RayPy_MonotonicNs();
+    if (remaining > spin_ns)
+        RayPy_SleepNs(remaining - spin_ns);
+    while (RayPy_MonotonicNs() < deadline)
+        RAYPY_CPU_RELAX();
+}
+
+/* Worker threads
+
+   A small pool shared by the CPU-heavy parts of the module (image processing),
+   threads are started on first use and never touch Python objects. */
+
+#define RAYPY_MAX_WORKERS 64
+
+typedef void (*RayPy_TaskFunc)(void *arg, int begin, int end);
+
+static struct {
+    int threads;              // threads per job including the caller, 0: one per CPU
+    int started;              // worker threads running
+    int quit;                 // asks the woken workers to exit instead of working
+    long starting;            // spinlock for RayPy_Pool_Start(), 1 while held
+    PyThread_type_lock busy;  // held by the thread dispatching a job
+    PyThread_type_lock mutex; // guards next and active
+    PyThread_type_lock done;  // released by the last thread to finish a job
+    PyThread_type_lock wake[RAYPY_MAX_WORKERS];
+    RayPy_TaskFunc func;
+    void *arg;
+    int count, grain, next, active;
+} RayPy_pool = {0};
+
+static void
+RayPy_Pool_Work(void)
+{
+    for (;;) {
+        PyThread_acquire_lock(RayPy_pool.mutex, WAIT_LOCK);
+        int begin = RayPy_pool.next;
+        RayPy_pool.next += RayPy_pool.grain;
+        PyThread_release_lock(RayPy_pool.mutex);
+        if (begin >= RayPy_pool.count)
+            break;
+        int end = begin + RayPy_pool.grain;
+        RayPy_pool.func(RayPy_pool.arg, begin, end < RayPy_pool.count ? end : RayPy_pool.count);
+    }
+    PyThread_acquire_lock(RayPy_pool.mutex, WAIT_LOCK);
+    int last = --RayPy_pool.active == 0;
+    PyThread_release_lock(RayPy_pool.mutex);
+    if (last)
+        PyThread_release_lock(RayPy_pool.done);
+}
+
+static void
+RayPy_Pool_Worker(void *arg)
+{
+    PyThread_type_lock wake = RayPy_pool.wake[(intptr_t)arg];
+    for (;;) {
+        PyThread_acquire_lock(wake, WAIT_LOCK);
+        if (RayPy_pool.quit)
+            break;
+        RayPy_Pool_Work();
+    }
+    PyThread_acquire_lock(RayPy_pool.mutex, WAIT_LOCK);
+    int last = --RayPy_pool.active == 0;
+    PyThread_release_lock(RayPy_pool.mutex);
+    if (last)
+        PyThread_release_lock(RayPy_pool.done);
+}
+
+static int
+RayPy_Pool_Threads(void)
+{
+    if (RayPy_pool.threads > 0)
+        return RayPy_pool.threads;
+    int cpus = 1;
+    PyObject *os = PyImport_ImportModule("os");
+    if (os != NULL) {
+        PyObject *count = PyObject_CallMethod(os, "cpu_count", NULL);
+        if (count != NULL && count != Py_None)
+            cpus = PyLong_AsLong(count);
+        Py_XDECREF(count);
+        Py_DECREF(os);
+    }
+    PyErr_Clear();
+    if (cpus < 1)
+        cpus = 1;
+    RayPy_pool.threads = cpus < RAYPY_MAX_WORKERS + 1 ? cpus : RAYPY_MAX_WORKERS + 1;
+    return RayPy_pool.threads;
+}
+
+/* Starts the worker threads, called with the GIL held before RayPy_ParallelFor() */
+static int
+RayPy_Pool_Start(void)
+{
+    int workers = RayPy_Pool_Threads() - 1, ret = 0;
+    /* without the GIL two threads can get here at once, neither calls into Python while spinning */
+    while (!RAYPY_CAS_LONG(&RayPy_pool.starting, 0, 1))
+        RAYPY_CPU_RELAX();
+    if (RayPy_pool.busy == NULL) {
+        RayPy_pool.busy = PyThread_allocate_lock();
+        RayPy_pool.mutex = PyThread_allocate_lock();
+        RayPy_pool.done = PyThread_allocate_lock();
+        if (RayPy_pool.busy == NULL || RayPy_pool.mutex == NULL || RayPy_pool.done == NULL) {
+            PyErr_NoMemory();
+            ret = -1;
+            goto done;
+        }
+        PyThread_acquire_lock(RayPy_pool.done, WAIT_LOCK);
+    }
+    while (RayPy_pool.started < workers) {
+        int i = RayPy_pool.started;
+        if (RayPy_pool.wake[i] == NULL) {
+            RayPy_pool.wake[i] = PyThread_allocate_lock();
+            if (RayPy_pool.wake[i] == NULL) {
+                PyErr_NoMemory();
+                ret = -1;
+                goto done;
+            }
+            PyThread_acquire_lock(RayPy_pool.wake[i], WAIT_LOCK);
+        }
+        if (PyThread_start_new_thread(RayPy_Pool_Worker, (void *)(intptr_t)i)
+            == PYTHREAD_INVALID_THREAD_ID)
+            break; // run with fewer threads
+        RayPy_pool.started++;
+    }
+done:
+    RAYPY_STORE_LONG(&RayPy_pool.starting, 0);
+    return ret;
+}
+
+/* Stops the worker threads and waits for them to exit, called with the GIL
+   held once no module instance is left to dispatch jobs */
+static void
+RayPy_Pool_Stop(void)
+{
+    if (RayPy_pool.started == 0)
+        return;
+    Py_BEGIN_ALLOW_THREADS
+    PyThread_acquire_lock(RayPy_pool.busy, WAIT_LOCK);
+    RayPy_pool.quit = 1;
+    RayPy_pool.active = RayPy_pool.started;
+    for (int i = 0; i < RayPy_pool.started; i++)
+        PyThread_release_lock(RayPy_pool.wake[i]);
+    PyThread_acquire_lock(RayPy_pool.done, WAIT_LOCK);
+    RayPy_pool.quit = 0;
+    RayPy_pool.started = 0;
+    PyThread_release_lock(RayPy_pool.busy);
+    Py_END_ALLOW_THREADS
+}
+
+/* Calls func(arg, begin, end) over [0, count) in chunks of `grain` items spread
+   across the worker threads and the calling one, returns once all are done.
+   Call it with the GIL released, a job already running from another thread
+   makes this one run serially. */
+static void
+RayPy_ParallelFor(RayPy_TaskFunc func, void *arg, int count, int grain)
+{
+    if (count <= 0)
+        return;
+    int helpers = (count + grain - 1) / grain - 1;
+    if (helpers > RayPy_pool.threads - 1)
+        helpers = RayPy_pool.threads - 1;
+    if (helpers > RayPy_pool.started)
+        helpers = RayPy_pool.started;
+    if (helpers <= 0 || !PyThread_acquire_lock(RayPy_pool.busy, NOWAIT_LOCK)) {
+        func(arg, 0, count);
+        return;
+    }
+    RayPy_pool.func = func;
+    RayPy_pool.arg = arg;
+    RayPy_pool.count = count;
+    RayPy_pool.grain = grain;
+    RayPy_pool.next = 0;
+    RayPy_pool.active = helpers + 1;
+    for (int i = 0; i < helpers; i++)
+        PyThread_release_lock(RayPy_pool.wake[i]);
+    RayPy_Pool_Work();
+    PyThread_acquire_lock(RayPy_pool.done, WAIT_LOCK);
+    PyThread_release_lock(RayPy_pool.busy);
+}
+
 
 /* Vector2 */
 
@@ -54,7 +638,9 @@ typedef struct {
 static void
 RayPy_Vector2_dealloc(RayPy_Vector2Object *self)
 {
-    Py_TYPE(self)->tp_free((PyObject *)self);
+    PyTypeObject *tp = Py_TYPE(self);
+    tp->tp_free((PyObject *)self);
+    Py_DECREF(tp);
 }
 
 static RayPy_Vector2Object *
@@ -108,19 +694,23 @@ RayPy_Vector2_richcompare(RayPy_Vector2Object *self, RayPy_Vector2Object *other,
     }
 }
 
-static PyTypeObject RayPy_Vector2_Type = {
-    .ob_base = PyVarObject_HEAD_INIT(NULL, 0)
-    .tp_name = "raypy.Vector2",
-    .tp_doc = PyDoc_STR("Vector2, 2 components"),
-    .tp_basicsize = sizeof(RayPy_Vector2Object),
-    .tp_itemsize = 0,
-    .tp_flags = Py_TPFLAGS_DEFAULT | Py_TPFLAGS_BASETYPE,
-    .tp_new = (newfunc)RayPy_Vector2_new,
-    .tp_init = (initproc)RayPy_Vector2_init,
-    .tp_repr = (reprfunc)RayPy_Vector2_repr,
-    .tp_dealloc = (destructor)RayPy_Vector2_dealloc,
-    .tp_members = RayPy_Vector2_members,
-    .tp_richcompare = (richcmpfunc)RayPy_Vector2_richcompare,
+static PyType_Slot RayPy_Vector2_slots[] = {
+    {Py_tp_doc, PyDoc_STR("Vector2, 2 components")},
+    {Py_tp_new, RayPy_Vector2_new},
+    {Py_tp_init, RayPy_Vector2_init},
+    {Py_tp_repr, RayPy_Vector2_repr},
+    {Py_tp_dealloc, RayPy_Vector2_dealloc},
+    {Py_tp_members, RayPy_Vector2_members},
+    {Py_tp_richcompare, RayPy_Vector2_richcompare},
+    {0, NULL},
+};
+
+static PyType_Spec RayPy_Vector2_spec = {
+    .name = "raypy.Vector2",
+    .basicsize = sizeof(RayPy_Vector2Object),
+    .itemsize = 0,
+    .flags = Py_TPFLAGS_DEFAULT | Py_TPFLAGS_BASETYPE | Py_TPFLAGS_IMMUTABLETYPE,
+    .slots = RayPy_Vector2_slots,
 };
 
 /* Vector3 */
@@ -134,7 +724,9 @@ typedef struct {
 static void
 RayPy_Vector3_dealloc(RayPy_Vector3Object *self)
 {
-    Py_TYPE(self)->tp_free((PyObject *)self);
+    PyTypeObject *tp = Py_TYPE(self);
+    tp->tp_free((PyObject *)self);
+    Py_DECREF(tp);
 }
 
 static RayPy_Vector3Object *
@@ -193,19 +785,23 @@ RayPy_Vector3_richcompare(RayPy_Vector3Object *self, RayPy_Vector3Object *other,
     }
 }
 
-static PyTypeObject RayPy_Vector3_Type = {
-    .ob_base = PyVarObject_HEAD_INIT(NULL, 0)
-    .tp_name = "raypy.Vector3",
-    .tp_doc = PyDoc_STR("Vector3, 3 components"),
-    .tp_basicsize = sizeof(RayPy_Vector3Object),
-    .tp_itemsize = 0,
-    .tp_flags = Py_TPFLAGS_DEFAULT | Py_TPFLAGS_BASETYPE,
-    .tp_new = (newfunc)RayPy_Vector3_new,
-    .tp_init = (initproc)RayPy_Vector3_init,
-    .tp_repr = (reprfunc)RayPy_Vector3_repr,
-    .tp_dealloc = (destructor)RayPy_Vector3_dealloc,
-    .tp_members = RayPy_Vector3_members,
-    .tp_richcompare = (richcmpfunc)RayPy_Vector3_richcompare,
+static PyType_Slot RayPy_Vector3_slots[] = {
+    {Py_tp_doc, PyDoc_STR("Vector3, 3 components")},
+    {Py_tp_new, RayPy_Vector3_new},
+    {Py_tp_init, RayPy_Vector3_init},
+    {Py_tp_repr, RayPy_Vector3_repr},
+    {Py_tp_dealloc, RayPy_Vector3_dealloc},
+    {Py_tp_members, RayPy_Vector3_members},
+    {Py_tp_richcompare, RayPy_Vector3_richcompare},
+    {0, NULL},
+};
+
+static PyType_Spec RayPy_Vector3_spec = {
+    .name = "raypy.Vector3",
+    .basicsize = sizeof(RayPy_Vector3Object),
+    .itemsize = 0,
+    .flags = Py_TPFLAGS_DEFAULT | Py_TPFLAGS_BASETYPE | Py_TPFLAGS_IMMUTABLETYPE,
+    .slots = RayPy_Vector3_slots,
 };
 
 /* Vector4 */
@@ -220,7 +816,9 @@ typedef struct {
 static void
 RayPy_Vector4_dealloc(RayPy_Vector4Object *self)
 {
-    Py_TYPE(self)->tp_free((PyObject *)self);
+    PyTypeObject *tp = Py_TYPE(self);
+    tp->tp_free((PyObject *)self);
+    Py_DECREF(tp);
 }
 
 static RayPy_Vector4Object *
@@ -284,19 +882,23 @@ RayPy_Vector4_richcompare(RayPy_Vector4Object *self, RayPy_Vector4Object *other,
     }
 }
 
-static PyTypeObject RayPy_Vector4_Type = {
-    .ob_base = PyVarObject_HEAD_INIT(NULL, 0)
-    .tp_name = "raypy.Vector4",
-    .tp_doc = PyDoc_STR("Vector4, 4 components"),
-    .tp_basicsize = sizeof(RayPy_Vector4Object),
-    .tp_itemsize = 0,
-    .tp_flags = Py_TPFLAGS_DEFAULT | Py_TPFLAGS_BASETYPE,
-    .tp_new = (newfunc)RayPy_Vector4_new,
-    .tp_init = (initproc)RayPy_Vector4_init,
-    .tp_repr = (reprfunc)RayPy_Vector4_repr,
-    .tp_dealloc = (destructor)RayPy_Vector4_dealloc,
-    .tp_members = RayPy_Vector4_members,
-    .tp_richcompare = (richcmpfunc)RayPy_Vector4_richcompare,
+static PyType_Slot RayPy_Vector4_slots[] = {
+    {Py_tp_doc, PyDoc_STR("Vector4, 4 components")},
+    {Py_tp_new, RayPy_Vector4_new},
+    {Py_tp_init, RayPy_Vector4_init},
+    {Py_tp_repr, RayPy_Vector4_repr},
+    {Py_tp_dealloc, RayPy_Vector4_dealloc},
+    {Py_tp_members, RayPy_Vector4_members},
+    {Py_tp_richcompare, RayPy_Vector4_richcompare},
+    {0, NULL},
+};
+
+static PyType_Spec RayPy_Vector4_spec = {
+    .name = "raypy.Vector4",
+    .basicsize = sizeof(RayPy_Vector4Object),
+    .itemsize = 0,
+    .flags = Py_TPFLAGS_DEFAULT | Py_TPFLAGS_BASETYPE | Py_TPFLAGS_IMMUTABLETYPE,
+    .slots = RayPy_Vector4_slots,
 };
 
 /* Color */
@@ -311,7 +913,9 @@ typedef struct {
 static void
 RayPy_Color_dealloc(RayPy_ColorObject *self)
 {
-    Py_TYPE(self)->tp_free((PyObject *)self);
+    PyTypeObject *tp = Py_TYPE(self);
+    tp->tp_free((PyObject *)self);
+    Py_DECREF(tp);
 }
 
 static RayPy_ColorObject *
@@ -375,19 +979,23 @@ RayPy_Color_richcompare(RayPy_ColorObject *self, RayPy_ColorObject *other, int o
     }
 }
 
-static PyTypeObject RayPy_Color_Type = {
-    .ob_base = PyVarObject_HEAD_INIT(NULL, 0)
-    .tp_name = "raypy.Color",
-    .tp_doc = PyDoc_STR("Color, 4 components, R8G8B8A8 (32bit)"),
-    .tp_basicsize = sizeof(RayPy_ColorObject),
-    .tp_itemsize = 0,
-    .tp_flags = Py_TPFLAGS_DEFAULT | Py_TPFLAGS_BASETYPE,
-    .tp_new = (newfunc)RayPy_Color_new,
-    .tp_init = (initproc)RayPy_Color_init,
-    .tp_repr = (reprfunc)RayPy_Color_repr,
-    .tp_dealloc = (destructor)RayPy_Color_dealloc,
-    .tp_members = RayPy_Color_members,
-    .tp_richcompare = (richcmpfunc)RayPy_Color_richcompare,
+static PyType_Slot RayPy_Color_slots[] = {
+    {Py_tp_doc, PyDoc_STR("Color, 4 components, R8G8B8A8 (32bit)")},
+    {Py_tp_new, RayPy_Color_new},
+    {Py_tp_init, RayPy_Color_init},
+    {Py_tp_repr, RayPy_Color_repr},
+    {Py_tp_dealloc, RayPy_Color_dealloc},
+    {Py_tp_members, RayPy_Color_members},
+    {Py_tp_richcompare, RayPy_Color_richcompare},
+    {0, NULL},
+};
+
+static PyType_Spec RayPy_Color_spec = {
+    .name = "raypy.Color",
+    .basicsize = sizeof(RayPy_ColorObject),
+    .itemsize = 0,
+    .flags = Py_TPFLAGS_DEFAULT | Py_TPFLAGS_BASETYPE | Py_TPFLAGS_IMMUTABLETYPE,
+    .slots = RayPy_Color_slots,
 };
 
 Color
@@ -420,7 +1028,9 @@ typedef struct {
 static void
 RayPy_Rectangle_dealloc(RayPy_RectangleObject *self)
 {
-    Py_TYPE(self)->tp_free((PyObject *)self);
+    PyTypeObject *tp = Py_TYPE(self);
+    tp->tp_free((PyObject *)self);
+    Py_DECREF(tp);
 }
 
 static RayPy_RectangleObject *
@@ -484,31 +1094,40 @@ RayPy_Rectangle_richcompare(RayPy_RectangleObject *self, RayPy_RectangleObject *
     }
 }
 
-static PyTypeObject RayPy_Rectangle_Type = {
-    .ob_base = PyVarObject_HEAD_INIT(NULL, 0)
-    .tp_name = "raypy.Rectangle",
-    .tp_doc = PyDoc_STR("Rectangle, 4 components"),
-    .tp_basicsize = sizeof(RayPy_RectangleObject),
-    .tp_itemsize = 0,
-    .tp_flags = Py_TPFLAGS_DEFAULT | Py_TPFLAGS_BASETYPE,
-    .tp_new = (newfunc)RayPy_Rectangle_new,
-    .tp_init = (initproc)RayPy_Rectangle_init,
-    .tp_repr = (reprfunc)RayPy_Rectangle_repr,
-    .tp_dealloc = (destructor)RayPy_Rectangle_dealloc,
-    .tp_members = RayPy_Rectangle_members,
-    .tp_richcompare = (richcmpfunc)RayPy_Rectangle_richcompare,
+static PyType_Slot RayPy_Rectangle_slots[] = {
+    {Py_tp_doc, PyDoc_STR("Rectangle, 4 components")},
+    {Py_tp_new, RayPy_Rectangle_new},
+    {Py_tp_init, RayPy_Rectangle_init},
+    {Py_tp_repr, RayPy_Rectangle_repr},
+    {Py_tp_dealloc, RayPy_Rectangle_dealloc},
+    {Py_tp_members, RayPy_Rectangle_members},
+    {Py_tp_richcompare, RayPy_Rectangle_richcompare},
+    {0, NULL},
+};
+
+static PyType_Spec RayPy_Rectangle_spec = {
+    .name = "raypy.Rectangle",
+    .basicsize = sizeof(RayPy_RectangleObject),
+    .itemsize = 0,
+    .flags = Py_TPFLAGS_DEFAULT | Py_TPFLAGS_BASETYPE | Py_TPFLAGS_IMMUTABLETYPE,
+    .slots = RayPy_Rectangle_slots,
 };
 
 /* Image */
 
 typedef struct {
     PyObject_HEAD Image i;
+    int busy; // claimed by the image function working on it, see RayPy_Image_Claim()
 } RayPy_ImageObject;
 
 static void
 RayPy_Image_dealloc(RayPy_ImageObject *self)
 {
-    Py_TYPE(self)->tp_free((PyObject *)self);
+    if (self->i.data != NULL)
+        UnloadImage(self->i);
+    PyTypeObject *tp = Py_TYPE(self);
+    tp->tp_free((PyObject *)self);
+    Py_DECREF(tp);
 }
 
 static RayPy_ImageObject *
@@ -530,698 +1149,12100 @@ RayPy_Image_init(RayPy_ImageObject *self, PyObject *args, PyObject *Py_UNUSED(kw
 }
 
 static PyMemberDef RayPy_Image_members[] = {
-    {"width", Py_T_INT, offsetof(RayPy_ImageObject, i.width), 0, "Image base width"},
-    {"height", Py_T_INT, offsetof(RayPy_ImageObject, i.height), 0, "Image base height"},
-    {"mipmaps", Py_T_INT, offsetof(RayPy_ImageObject, i.mipmaps), 0, "Mipmap levels, 1 by default"},
-    {"format", Py_T_INT, offsetof(RayPy_ImageObject, i.format), 0, "Data format (PixelFormat type)"},
+    {"width", Py_T_INT, offsetof(RayPy_ImageObject, i.width), Py_READONLY, "Image base width"},
+    {"height", Py_T_INT, offsetof(RayPy_ImageObject, i.height), Py_READONLY, "Image base height"},
+    {"mipmaps", Py_T_INT, offsetof(RayPy_ImageObject, i.mipmaps), Py_READONLY, "Mipmap levels, 1 by default"},
+    {"format", Py_T_INT, offsetof(RayPy_ImageObject, i.format), Py_READONLY, "Data format (PixelFormat type)"},
     {NULL}
 };
 
-static PyTypeObject RayPy_Image_Type = {
-    .ob_base = PyVarObject_HEAD_INIT(NULL, 0)
-    .tp_name = "raypy.Image",
-    .tp_doc = "Image, pixel data stored in CPU memory (RAM)",
-    .tp_basicsize = sizeof(RayPy_ImageObject),
-    .tp_itemsize = 0,
-    .tp_flags = Py_TPFLAGS_DEFAULT | Py_TPFLAGS_BASETYPE,
-    .tp_new = (newfunc)RayPy_Image_new,
-    .tp_init = (initproc)RayPy_Image_init,
-    .tp_dealloc = (destructor)RayPy_Image_dealloc,
-    .tp_members = RayPy_Image_members,
+static PyObject *RayPy_Image_Lazy(RayPy_ImageObject *self, PyObject *Py_UNUSED(args));
+
+static PyMethodDef RayPy_Image_methods[] = {
+    {"lazy", (PyCFunction)RayPy_Image_Lazy, METH_NOARGS,
+     "Start recording operations that apply() runs fused, in a single pass"},
+    {NULL}
 };
 
-/* Texture */
+static PyType_Slot RayPy_Image_slots[] = {
+    {Py_tp_doc, "Image, pixel data stored in CPU memory (RAM)"},
+    {Py_tp_new, RayPy_Image_new},
+    {Py_tp_init, RayPy_Image_init},
+    {Py_tp_dealloc, RayPy_Image_dealloc},
+    {Py_tp_members, RayPy_Image_members},
+    {Py_tp_methods, RayPy_Image_methods},
+    {0, NULL},
+};
 
-typedef struct {
-    PyObject_HEAD Texture t;
-} RayPy_TextureObject;
+static PyType_Spec RayPy_Image_spec = {
+    .name = "raypy.Image",
+    .basicsize = sizeof(RayPy_ImageObject),
+    .itemsize = 0,
+    .flags = Py_TPFLAGS_DEFAULT | Py_TPFLAGS_BASETYPE | Py_TPFLAGS_IMMUTABLETYPE,
+    .slots = RayPy_Image_slots,
+};
 
-static void
-RayPy_Texture_dealloc(RayPy_TextureObject *self)
+/* Image processing
+
+   Resampling, rotation, tint, premultiply and blur kernels work on
+   R8G8B8A8 pixels, other uncompressed formats are converted to it and back.
+   Rows are split across the worker threads and the GIL is released while
+   they run. */
+
+#define RAYPY_IMAGE_GRAIN 8 // rows per task
+
+#ifdef RAYPY_SSE2
+typedef __m128 RayPy_Vec4;
+
+static inline RayPy_Vec4 RayPy_Vec4_Set1(float f) { return _mm_set1_ps(f); }
+static inline RayPy_Vec4 RayPy_Vec4_Add(RayPy_Vec4 a, RayPy_Vec4 b) { return _mm_add_ps(a, b); }
+static inline RayPy_Vec4 RayPy_Vec4_Sub(RayPy_Vec4 a, RayPy_Vec4 b) { return _mm_sub_ps(a, b); }
+static inline RayPy_Vec4 RayPy_Vec4_Mul(RayPy_Vec4 a, RayPy_Vec4 b) { return _mm_mul_ps(a, b); }
+static inline RayPy_Vec4 RayPy_Vec4_LoadF(const float *p) { return _mm_loadu_ps(p); }
+static inline void RayPy_Vec4_StoreF(float *p, RayPy_Vec4 v) { _mm_storeu_ps(p, v); }
+
+static inline RayPy_Vec4
+RayPy_Vec4_LoadPixel(const unsigned char *p)
 {
-    Py_TYPE(self)->tp_free((PyObject *)self);
+    int v;
+    memcpy(&v, p, 4);
+    __m128i zero = _mm_setzero_si128();
+    __m128i x = _mm_unpacklo_epi8(_mm_cvtsi32_si128(v), zero);
+    return _mm_cvtepi32_ps(_mm_unpacklo_epi16(x, zero));
 }
 
-static RayPy_TextureObject *
-RayPy_Texture_new(PyTypeObject *type, PyObject *Py_UNUSED(args), PyObject *Py_UNUSED(kwds)) {
-    RayPy_TextureObject *self = (RayPy_TextureObject *)type->tp_alloc(type, 0);
-    if (self == NULL)
-        return NULL;
-    return self;
+static inline void
+RayPy_Vec4_StorePixel(unsigned char *p, RayPy_Vec4 v)
+{
+    __m128i x = _mm_cvtps_epi32(v);
+    x = _mm_packs_epi32(x, x);
+    x = _mm_packus_epi16(x, x); // saturates to [0, 255]
+    int r = _mm_cvtsi128_si32(x);
+    memcpy(p, &r, 4);
 }
+#else
+typedef struct {
+    float v[4];
+} RayPy_Vec4;
 
-static int
-RayPy_Texture_init(RayPy_TextureObject *self, PyObject *args, PyObject *Py_UNUSED(kwds))
+static inline RayPy_Vec4
+RayPy_Vec4_Set1(float f)
 {
-    PyErr_SetString(PyExc_TypeError,
-                        "raypy.Texture cannot be instantiated directly from"
-                        " Python. Use the provided module-level functions"
-                        " instead.");
-    return -1;
+    RayPy_Vec4 r = {{f, f, f, f}};
+    return r;
 }
 
-static PyMemberDef RayPy_Texture_members[] = {
-    {"id", Py_T_UINT, offsetof(RayPy_TextureObject, t.id), 0, "OpenGL texture id"},
-    {"width", Py_T_INT, offsetof(RayPy_TextureObject, t.width), 0, "Texture base width"},
-    {"height", Py_T_INT, offsetof(RayPy_TextureObject, t.height), 0, "Texture base height"},
-    {"mipmaps", Py_T_INT, offsetof(RayPy_TextureObject, t.mipmaps), 0, "Mipmap levels, 1 by default"},
-    {"format", Py_T_INT, offsetof(RayPy_TextureObject, t.format), 0, "Data format (PixelFormat type)"},
-    {NULL}
-};
-
-static PyTypeObject RayPy_Texture_Type = {
-    .ob_base = PyVarObject_HEAD_INIT(NULL, 0)
-    .tp_name = "raypy.Texture",
-    .tp_doc = "Texture, tex data stored in GPU memory (VRAM)",
-    .tp_basicsize = sizeof(RayPy_TextureObject),
-    .tp_itemsize = 0,
-    .tp_flags = Py_TPFLAGS_DEFAULT | Py_TPFLAGS_BASETYPE,
-    .tp_new = (newfunc)RayPy_Texture_new,
-    .tp_init = (initproc)RayPy_Texture_init,
-    .tp_dealloc = (destructor)RayPy_Texture_dealloc,
-    .tp_members = RayPy_Texture_members,
-};
+static inline RayPy_Vec4
+RayPy_Vec4_Add(RayPy_Vec4 a, RayPy_Vec4 b)
+{
+    for (int i = 0; i < 4; i++)
+        a.v[i] += b.v[i];
+    return a;
+}
 
-static PyObject *
-RayPy_LoadTexture(PyObject *Py_UNUSED(self), PyObject *args, PyObject *keywds)
+static inline RayPy_Vec4
+RayPy_Vec4_Sub(RayPy_Vec4 a, RayPy_Vec4 b)
 {
-    const char *fileName;
-    RayPy_TextureObject *ret;
-    if (!PyArg_ParseTuple(args, "s", &fileName))
-        return NULL;
-    Texture texture = LoadTexture(fileName);
-    ret = PyObject_New(RayPy_TextureObject, &RayPy_Texture_Type);
-    ret->t = texture;
-    return (PyObject *)ret;
+    for (int i = 0; i < 4; i++)
+        a.v[i] -= b.v[i];
+    return a;
 }
 
-static PyObject *
-RayPy_DrawTexture(PyObject *self, PyObject *const *args, Py_ssize_t nargs)
+static inline RayPy_Vec4
+RayPy_Vec4_Mul(RayPy_Vec4 a, RayPy_Vec4 b)
 {
-    RayPy_TextureObject *texture;
-    int posX, posY;
-    RayPy_ColorObject *tint;
-    if (nargs != 4) {
-        RayPyErr_ArgsNumberError(4, nargs);
-        return NULL;
-    }
-    if (!PyType_IsSubtype(Py_TYPE(args[0]), &RayPy_Texture_Type)) {
-        RayPyErr_ArgTypeError(0, &RayPy_Texture_Type, args);
-        return NULL;
-    }
-    texture = (RayPy_TextureObject *)args[0];
-    posX = PyLong_AsLong(args[1]);
-    if (PyErr_Occurred()) {
-        PyErr_Clear();
-        RayPyErr_ArgTypeError(1, &RayPy_Texture_Type, args);
-        return NULL;
-    }
-    posY = PyLong_AsLong(args[2]);
-    if (PyErr_Occurred()) {
-        PyErr_Clear();
-        RayPyErr_ArgTypeError(2, &RayPy_Texture_Type, args);
-        return NULL;
-    }
-    if (!PyType_IsSubtype(Py_TYPE(args[3]), &RayPy_Color_Type)) {
-        RayPyErr_ArgTypeError(3, &RayPy_Texture_Type, args);
-        return NULL;
-    }
-    tint = (RayPy_ColorObject *)args[3];
-    DrawTexture(texture->t, posX, posY, RayPy_Color_AsColor(tint));
-    Py_RETURN_NONE;
+    for (int i = 0; i < 4; i++)
+        a.v[i] *= b.v[i];
+    return a;
 }
 
-static PyObject *
-RayPy_UnloadTexture(PyObject *Py_UNUSED(self), PyObject *args, PyObject *keywds)
+static inline RayPy_Vec4
+RayPy_Vec4_LoadF(const float *p)
 {
-    RayPy_TextureObject *texture;
-    if (!PyArg_ParseTuple(args, "O!", &RayPy_Texture_Type, &texture))
-        return NULL;
-    UnloadTexture(texture->t);
-    Py_RETURN_NONE;
+    RayPy_Vec4 r;
+    memcpy(r.v, p, sizeof(r.v));
+    return r;
 }
 
-static PyObject *
-RayPy_InitWindow(PyObject *Py_UNUSED(self), PyObject *args, PyObject *keywds)
+static inline void
+RayPy_Vec4_StoreF(float *p, RayPy_Vec4 v)
 {
-    int width, height;
-    const char *title;
-    if (!PyArg_ParseTuple(args, "iis", &width, &height, &title))
-        return NULL;
-    InitWindow(width, height, title);
-    Py_RETURN_NONE;
+    memcpy(p, v.v, sizeof(v.v));
 }
 
-PyDoc_STRVAR(init_window_doc, "Initialize window and OpenGL context");
+static inline RayPy_Vec4
+RayPy_Vec4_LoadPixel(const unsigned char *p)
+{
+    RayPy_Vec4 r = {{p[0], p[1], p[2], p[3]}};
+    return r;
+}
 
-static PyObject *
-RayPy_WindowShouldClose(PyObject *Py_UNUSED(self), PyObject *Py_UNUSED(args))
+static inline void
+RayPy_Vec4_StorePixel(unsigned char *p, RayPy_Vec4 v)
 {
-    return PyBool_FromLong(WindowShouldClose());
+    for (int i = 0; i < 4; i++) {
+        float f = v.v[i] + 0.5f;
+        p[i] = f <= 0.0f ? 0 : f >= 255.0f ? 255 : (unsigned char)f;
+    }
 }
+#endif
 
-PyDoc_STRVAR(window_should_close_doc, "Check if KEY_ESCAPE pressed or Close icon pressed");
+static inline RayPy_Vec4
+RayPy_Vec4_Clamp255(RayPy_Vec4 v)
+{
+#ifdef RAYPY_SSE2
+    return _mm_min_ps(_mm_max_ps(v, _mm_setzero_ps()), _mm_set1_ps(255.0f));
+#else
+    for (int i = 0; i < 4; i++)
+        v.v[i] = v.v[i] < 0.0f ? 0.0f : v.v[i] > 255.0f ? 255.0f : v.v[i];
+    return v;
+#endif
+}
 
-static PyObject *
-RayPy_CloseWindow(PyObject *Py_UNUSED(self), PyObject *Py_UNUSED(args))
+static inline RayPy_Vec4
+RayPy_Vec4_Scale(RayPy_Vec4 v, float f)
 {
-    if (!IsWindowReady())
-        return (PyErr_SetString(PyExc_TypeError, ""), NULL);
-    CloseWindow();
-    Py_RETURN_NONE;
+    return RayPy_Vec4_Mul(v, RayPy_Vec4_Set1(f));
 }
 
-PyDoc_STRVAR(close_window_doc, "Close window and unload OpenGL context");
+static inline int
+RayPy_DivideBy255(int x)
+{
+    x += 128;
+    return (x + (x >> 8)) >> 8;
+}
 
-static PyObject *
-RayPy_IsWindowReady(PyObject *Py_UNUSED(self), PyObject *Py_UNUSED(args))
+#ifdef RAYPY_SSE2
+static inline __m128i
+RayPy_DivideBy255_epu16(__m128i x)
 {
-    return PyBool_FromLong(IsWindowReady());
+    x = _mm_add_epi16(x, _mm_set1_epi16(128));
+    return _mm_srli_epi16(_mm_add_epi16(x, _mm_srli_epi16(x, 8)), 8);
 }
+#endif
 
-PyDoc_STRVAR(is_window_ready_doc, "Check if window has been initialized successfully");
+/* same weights as raylib */
+static inline unsigned char
+RayPy_Luma(const unsigned char *rgb)
+{
+    return (unsigned char)((rgb[0] * 299 + rgb[1] * 587 + rgb[2] * 114 + 500) / 1000);
+}
 
-static PyObject *
-RayPy_IsWindowFullscreen(PyObject *Py_UNUSED(self), PyObject *Py_UNUSED(args))
+static int
+RayPy_IsFastFormat(int format)
 {
-    return PyBool_FromLong(IsWindowFullscreen());
+    return format == PIXELFORMAT_UNCOMPRESSED_R8G8B8A8 || format == PIXELFORMAT_UNCOMPRESSED_R8G8B8
+           || format == PIXELFORMAT_UNCOMPRESSED_GRAY_ALPHA
+           || format == PIXELFORMAT_UNCOMPRESSED_GRAYSCALE;
+}
+
+/* Format conversion, fast paths for the common 8-bit formats and raylib's
+   ImageFormat() for everything else. Returns -1 when out of memory. */
+static int
+RayPy_Pixels_Format(Image *image, int format)
+{
+    int from = image->format;
+    if (from == format)
+        return 0;
+    if (image->mipmaps > 1 || !RayPy_IsFastFormat(from) || !RayPy_IsFastFormat(format)) {
+        ImageFormat(image, format);
+        return 0;
+    }
+    /* between two 8-bit formats: go through R8G8B8A8 */
+    if (format != PIXELFORMAT_UNCOMPRESSED_R8G8B8A8 && from != PIXELFORMAT_UNCOMPRESSED_R8G8B8A8) {
+        if (RayPy_Pixels_Format(image, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8))
+            return -1;
+        from = PIXELFORMAT_UNCOMPRESSED_R8G8B8A8;
+    }
+
+    size_t n = (size_t)image->width * image->height;
+    const unsigned char *src = image->data;
+    unsigned char *dst = RL_MALLOC((size_t)GetPixelDataSize(image->width, image->height, format));
+    if (dst == NULL)
+        return -1;
+    size_t i;
+    switch (from == PIXELFORMAT_UNCOMPRESSED_R8G8B8A8 ? format : from) {
+    case PIXELFORMAT_UNCOMPRESSED_GRAYSCALE:
+        if (from == PIXELFORMAT_UNCOMPRESSED_R8G8B8A8) {
+            for (i = 0; i < n; i++, src += 4)
+                dst[i] = RayPy_Luma(src);
+        }
+        else {
+            for (i = 0; i < n; i++, dst += 4)
+                dst[0] = dst[1] = dst[2] = src[i], dst[3] = 255;
+            dst -= n * 4;
+        }
+        break;
+    case PIXELFORMAT_UNCOMPRESSED_GRAY_ALPHA:
+        if (from == PIXELFORMAT_UNCOMPRESSED_R8G8B8A8) {
+            for (i = 0; i < n; i++, src += 4, dst += 2) {
+                dst[0] = RayPy_Luma(src);
+                dst[1] = src[3];
+            }
+            dst -= n * 2;
+        }
+        else {
+            for (i = 0; i < n; i++, src += 2, dst += 4)
+                dst[0] = dst[1] = dst[2] = src[0], dst[3] = src[1];
+            dst -= n * 4;
+        }
+        break;
+    case PIXELFORMAT_UNCOMPRESSED_R8G8B8:
+        if (from == PIXELFORMAT_UNCOMPRESSED_R8G8B8A8) {
+            for (i = 0; i < n; i++, src += 4, dst += 3)
+                dst[0] = src[0], dst[1] = src[1], dst[2] = src[2];
+            dst -= n * 3;
+        }
+        else {
+            for (i = 0; i < n; i++, src += 3, dst += 4)
+                dst[0] = src[0], dst[1] = src[1], dst[2] = src[2], dst[3] = 255;
+            dst -= n * 4;
+        }
+        break;
+    }
+    RL_FREE(image->data);
+    image->data = dst;
+    image->format = format;
+    return 0;
+}
+
+/* Resampling: separable filters, horizontal pass into a temporary image then
+   the vertical one. Kernels are stretched when downscaling so every source
+   pixel contributes (no aliasing). */
+
+typedef struct {
+    int taps;
+    int *first;  // first source pixel per destination pixel
+    int *count;  // taps actually used per destination pixel
+    float *weights;
+} RayPy_ResampleFilter;
+
+static double
+RayPy_TriangleKernel(double x)
+{
+    x = fabs(x);
+    return x < 1.0 ? 1.0 - x : 0.0;
+}
+
+static double
+RayPy_CatmullRomKernel(double x)
+{
+    x = fabs(x);
+    if (x < 1.0)
+        return (1.5 * x - 2.5) * x * x + 1.0;
+    if (x < 2.0)
+        return ((-0.5 * x + 2.5) * x - 4.0) * x + 2.0;
+    return 0.0;
+}
+
+static void
+RayPy_ResampleFilter_Free(RayPy_ResampleFilter *f)
+{
+    free(f->first);
+    free(f->count);
+    free(f->weights);
+    f->first = f->count = NULL;
+    f->weights = NULL;
+}
+
+static int
+RayPy_ResampleFilter_Init(RayPy_ResampleFilter *f, int src_size, int dst_size, double support,
+                          double (*kernel)(double))
+{
+    double scale = (double)src_size / dst_size;
+    double filter_scale = scale > 1.0 ? scale : 1.0;
+    double radius = support * filter_scale;
+    f->taps = (int)ceil(radius) * 2 + 1;
+    f->first = malloc(sizeof(int) * dst_size);
+    f->count = malloc(sizeof(int) * dst_size);
+    f->weights = malloc(sizeof(float) * dst_size * f->taps);
+    if (f->first == NULL || f->count == NULL || f->weights == NULL) {
+        RayPy_ResampleFilter_Free(f);
+        return -1;
+    }
+    for (int i = 0; i < dst_size; i++) {
+        double center = (i + 0.5) * scale;
+        int lo = (int)floor(center - radius + 0.5), hi = (int)floor(center + radius + 0.5);
+        if (lo < 0)
+            lo = 0;
+        if (hi > src_size)
+            hi = src_size;
+        if (hi - lo > f->taps)
+            hi = lo + f->taps;
+        float *w = f->weights + (size_t)i * f->taps;
+        double sum = 0.0;
+        for (int k = 0; k < hi - lo; k++)
+            sum += w[k] = (float)kernel((lo + k + 0.5 - center) / filter_scale);
+        for (int k = 0; k < hi - lo && sum != 0.0; k++)
+            w[k] = (float)(w[k] / sum);
+        f->first[i] = lo;
+        f->count[i] = hi - lo;
+    }
+    return 0;
+}
+
+typedef struct {
+    const unsigned char *src;
+    unsigned char *dst;
+    int src_width, dst_width;
+    const RayPy_ResampleFilter *filter;
+} RayPy_ResampleArgs;
+
+static void
+RayPy_ResampleRows(void *arg, int begin, int end)
+{
+    const RayPy_ResampleArgs *a = arg;
+    const RayPy_ResampleFilter *f = a->filter;
+    for (int y = begin; y < end; y++) {
+        const unsigned char *src = a->src + (size_t)y * a->src_width * 4;
+        unsigned char *dst = a->dst + (size_t)y * a->dst_width * 4;
+        for (int x = 0; x < a->dst_width; x++) {
+            const float *w = f->weights + (size_t)x * f->taps;
+            const unsigned char *p = src + (size_t)f->first[x] * 4;
+            RayPy_Vec4 acc = RayPy_Vec4_Set1(0.0f);
+            for (int k = 0; k < f->count[x]; k++)
+                acc = RayPy_Vec4_Add(acc, RayPy_Vec4_Scale(RayPy_Vec4_LoadPixel(p + k * 4), w[k]));
+            RayPy_Vec4_StorePixel(dst + x * 4, acc);
+        }
+    }
+}
+
+static void
+RayPy_ResampleColumns(void *arg, int begin, int end)
+{
+    const RayPy_ResampleArgs *a = arg;
+    const RayPy_ResampleFilter *f = a->filter;
+    size_t stride = (size_t)a->dst_width * 4;
+    for (int y = begin; y < end; y++) {
+        const float *w = f->weights + (size_t)y * f->taps;
+        const unsigned char *src = a->src + f->first[y] * stride;
+        unsigned char *dst = a->dst + y * stride;
+        for (int x = 0; x < a->dst_width; x++) {
+            RayPy_Vec4 acc = RayPy_Vec4_Set1(0.0f);
+            for (int k = 0; k < f->count[y]; k++)
+                acc = RayPy_Vec4_Add(acc, RayPy_Vec4_Scale(RayPy_Vec4_LoadPixel(src + k * stride + x * 4), w[k]));
+            RayPy_Vec4_StorePixel(dst + x * 4, acc);
+        }
+    }
+}
+
+/* image must be R8G8B8A8 */
+static int
+RayPy_Pixels_Resample(Image *image, int width, int height, double support, double (*kernel)(double))
+{
+    RayPy_ResampleFilter fx = {0}, fy = {0};
+    unsigned char *src = image->data, *tmp = src, *dst = NULL;
+    int ret = -1;
+
+    if (width != image->width) {
+        if (RayPy_ResampleFilter_Init(&fx, image->width, width, support, kernel))
+            goto done;
+        tmp = RL_MALLOC((size_t)width * image->height * 4);
+        if (tmp == NULL)
+            goto done;
+        RayPy_ResampleArgs args = {src, tmp, image->width, width, &fx};
+        RayPy_ParallelFor(RayPy_ResampleRows, &args, image->height, RAYPY_IMAGE_GRAIN);
+    }
+    dst = tmp;
+    if (height != image->height) {
+        if (RayPy_ResampleFilter_Init(&fy, image->height, height, support, kernel))
+            goto done;
+        dst = RL_MALLOC((size_t)width * height * 4);
+        if (dst == NULL)
+            goto done;
+        RayPy_ResampleArgs args = {tmp, dst, width, width, &fy};
+        RayPy_ParallelFor(RayPy_ResampleColumns, &args, height, RAYPY_IMAGE_GRAIN);
+    }
+    image->data = dst;
+    image->width = width;
+    image->height = height;
+    image->mipmaps = 1;
+    if (src != dst)
+        RL_FREE(src);
+    ret = 0;
+
+done:
+    /* the horizontal pass output, unless it is the source or became the image */
+    if (tmp != src && tmp != dst)
+        RL_FREE(tmp);
+    RayPy_ResampleFilter_Free(&fx);
+    RayPy_ResampleFilter_Free(&fy);
+    return ret;
+}
+
+typedef struct {
+    const uint32_t *src;
+    uint32_t *dst;
+    int src_width, dst_width;
+    const int *xs;
+    int src_height, dst_height;
+} RayPy_ResizeNNArgs;
+
+static void
+RayPy_ResizeNNRows(void *arg, int begin, int end)
+{
+    const RayPy_ResizeNNArgs *a = arg;
+    for (int y = begin; y < end; y++) {
+        const uint32_t *src = a->src + (size_t)((int64_t)y * a->src_height / a->dst_height) * a->src_width;
+        uint32_t *dst = a->dst + (size_t)y * a->dst_width;
+        for (int x = 0; x < a->dst_width; x++)
+            dst[x] = src[a->xs[x]];
+    }
+}
+
+/* image must be R8G8B8A8 */
+static int
+RayPy_Pixels_ResizeNN(Image *image, int width, int height)
+{
+    int *xs = malloc(sizeof(int) * width);
+    uint32_t *dst = RL_MALLOC((size_t)width * height * 4);
+    if (xs == NULL || dst == NULL) {
+        free(xs);
+        RL_FREE(dst);
+        return -1;
+    }
+    for (int x = 0; x < width; x++)
+        xs[x] = (int)((int64_t)x * image->width / width);
+    RayPy_ResizeNNArgs args = {image->data, dst, image->width, width, xs,
+                               image->height, height};
+    RayPy_ParallelFor(RayPy_ResizeNNRows, &args, height, RAYPY_IMAGE_GRAIN * 4);
+    free(xs);
+    RL_FREE(image->data);
+    image->data = dst;
+    image->width = width;
+    image->height = height;
+    image->mipmaps = 1;
+    return 0;
+}
+
+/* Flips and quarter turns move whole pixels, any uncompressed format works */
+
+typedef struct {
+    unsigned char *src;
+    unsigned char *dst;
+    int width, height, bpp;
+} RayPy_PixelMoveArgs;
+
+static void
+RayPy_FlipHorizontalRows(void *arg, int begin, int end)
+{
+    const RayPy_PixelMoveArgs *a = arg;
+    int bpp = a->bpp;
+    unsigned char tmp[16];
+    for (int y = begin; y < end; y++) {
+        unsigned char *row = a->src + (size_t)y * a->width * bpp;
+        if (bpp == 4) {
+            uint32_t *p = (uint32_t *)row, *q = p + a->width - 1;
+            for (; p < q; p++, q--) {
+                uint32_t t = *p;
+                *p = *q;
+                *q = t;
+            }
+            continue;
+        }
+        for (int x = 0; x < a->width / 2; x++) {
+            unsigned char *p = row + x * bpp, *q = row + (a->width - 1 - x) * bpp;
+            memcpy(tmp, p, bpp);
+            memcpy(p, q, bpp);
+            memcpy(q, tmp, bpp);
+        }
+    }
+}
+
+static void
+RayPy_FlipVerticalRows(void *arg, int begin, int end)
+{
+    const RayPy_PixelMoveArgs *a = arg;
+    size_t stride = (size_t)a->width * a->bpp;
+    unsigned char tmp[1024];
+    for (int y = begin; y < end; y++) {
+        unsigned char *p = a->src + y * stride, *q = a->src + (a->height - 1 - y) * stride;
+        for (size_t off = 0; off < stride; off += sizeof(tmp)) {
+            size_t n = stride - off < sizeof(tmp) ? stride - off : sizeof(tmp);
+            memcpy(tmp, p + off, n);
+            memcpy(p + off, q + off, n);
+            memcpy(q + off, tmp, n);
+        }
+    }
+}
+
+/* dst rows [begin, end) of a quarter turn, 16 columns at a time so the source
+   rows being read stay in cache */
+static void
+RayPy_RotateRows(const RayPy_PixelMoveArgs *a, int begin, int end, int clockwise)
+{
+    int sw = a->width, sh = a->height, dw = sh, bpp = a->bpp;
+    for (int x0 = 0; x0 < dw; x0 += 16) {
+        int x1 = x0 + 16 < dw ? x0 + 16 : dw;
+        for (int y = begin; y < end; y++) {
+            unsigned char *dst = a->dst + ((size_t)y * dw + x0) * bpp;
+            for (int x = x0; x < x1; x++, dst += bpp) {
+                /* clockwise: dst(x, y) = src(y, sh - 1 - x), ccw: src(sw - 1 - y, x) */
+                size_t i = clockwise ? (size_t)(sh - 1 - x) * sw + y : (size_t)x * sw + (sw - 1 - y);
+                if (bpp == 4)
+                    *(uint32_t *)dst = ((const uint32_t *)a->src)[i];
+                else
+                    memcpy(dst, a->src + i * bpp, bpp);
+            }
+        }
+    }
+}
+
+static void
+RayPy_RotateCWRows(void *arg, int begin, int end)
+{
+    RayPy_RotateRows(arg, begin, end, 1);
+}
+
+static void
+RayPy_RotateCCWRows(void *arg, int begin, int end)
+{
+    RayPy_RotateRows(arg, begin, end, 0);
+}
+
+static int
+RayPy_Pixels_RotateQuarter(Image *image, int clockwise)
+{
+    int bpp = GetPixelDataSize(1, 1, image->format);
+    unsigned char *dst = RL_MALLOC((size_t)image->width * image->height * bpp);
+    if (dst == NULL)
+        return -1;
+    RayPy_PixelMoveArgs args = {image->data, dst, image->width, image->height, bpp};
+    RayPy_ParallelFor(clockwise ? RayPy_RotateCWRows : RayPy_RotateCCWRows, &args, image->width,
+                      RAYPY_IMAGE_GRAIN * 2);
+    RL_FREE(image->data);
+    image->data = dst;
+    image->width = args.height;
+    image->height = args.width;
+    image->mipmaps = 1;
+    return 0;
+}
+
+/* Arbitrary rotation, bilinear sampling, the image grows to fit and the new
+   corners are transparent */
+
+typedef struct {
+    const unsigned char *src;
+    unsigned char *dst;
+    int src_width, src_height, dst_width;
+    float cos_a, sin_a, cx, cy, dcx, dcy;
+} RayPy_RotateArgs;
+
+static inline RayPy_Vec4
+RayPy_FetchPixel(const RayPy_RotateArgs *a, int x, int y)
+{
+    if (x < 0 || y < 0 || x >= a->src_width || y >= a->src_height)
+        return RayPy_Vec4_Set1(0.0f);
+    return RayPy_Vec4_LoadPixel(a->src + ((size_t)y * a->src_width + x) * 4);
+}
+
+static void
+RayPy_RotateBilinearRows(void *arg, int begin, int end)
+{
+    const RayPy_RotateArgs *a = arg;
+    for (int y = begin; y < end; y++) {
+        unsigned char *dst = a->dst + (size_t)y * a->dst_width * 4;
+        float dy = y + 0.5f - a->dcy;
+        for (int x = 0; x < a->dst_width; x++) {
+            float dx = x + 0.5f - a->dcx;
+            float sx = a->cos_a * dx + a->sin_a * dy + a->cx - 0.5f;
+            float sy = -a->sin_a * dx + a->cos_a * dy + a->cy - 0.5f;
+            float fx0 = floorf(sx), fy0 = floorf(sy);
+            int x0 = (int)fx0, y0 = (int)fy0;
+            float fx = sx - fx0, fy = sy - fy0;
+            RayPy_Vec4 top = RayPy_Vec4_Add(RayPy_Vec4_Scale(RayPy_FetchPixel(a, x0, y0), 1.0f - fx),
+                                            RayPy_Vec4_Scale(RayPy_FetchPixel(a, x0 + 1, y0), fx));
+            RayPy_Vec4 bottom = RayPy_Vec4_Add(RayPy_Vec4_Scale(RayPy_FetchPixel(a, x0, y0 + 1), 1.0f - fx),
+                                               RayPy_Vec4_Scale(RayPy_FetchPixel(a, x0 + 1, y0 + 1), fx));
+            RayPy_Vec4_StorePixel(dst + x * 4, RayPy_Vec4_Add(RayPy_Vec4_Scale(top, 1.0f - fy),
+                                                              RayPy_Vec4_Scale(bottom, fy)));
+        }
+    }
+}
+
+/* image must be R8G8B8A8 */
+static int
+RayPy_Pixels_Rotate(Image *image, float degrees)
+{
+    float rad = degrees * DEG2RAD;
+    float c = cosf(rad), s = sinf(rad);
+    int width = (int)ceilf(fabsf(image->width * c) + fabsf(image->height * s) - 1e-3f);
+    int height = (int)ceilf(fabsf(image->width * s) + fabsf(image->height * c) - 1e-3f);
+    if (width < 1)
+        width = 1;
+    if (height < 1)
+        height = 1;
+    unsigned char *dst = RL_MALLOC((size_t)width * height * 4);
+    if (dst == NULL)
+        return -1;
+    RayPy_RotateArgs args = {image->data, dst, image->width, image->height, width, c, s,
+                             image->width * 0.5f, image->height * 0.5f, width * 0.5f, height * 0.5f};
+    RayPy_ParallelFor(RayPy_RotateBilinearRows, &args, height, RAYPY_IMAGE_GRAIN);
+    RL_FREE(image->data);
+    image->data = dst;
+    image->width = width;
+    image->height = height;
+    image->mipmaps = 1;
+    return 0;
+}
+
+/* Per-pixel ops, in place on R8G8B8A8 */
+
+typedef struct {
+    unsigned char *pixels;
+    int width;
+    Color tint;
+} RayPy_PixelOpArgs;
+
+static void
+RayPy_ColorTintRows(void *arg, int begin, int end)
+{
+    const RayPy_PixelOpArgs *a = arg;
+    unsigned char *p = a->pixels + (size_t)begin * a->width * 4;
+    size_t n = (size_t)(end - begin) * a->width, i = 0;
+    const unsigned char t[4] = {a->tint.r, a->tint.g, a->tint.b, a->tint.a};
+#ifdef RAYPY_SSE2
+    __m128i zero = _mm_setzero_si128();
+    __m128i tint = _mm_setr_epi16(t[0], t[1], t[2], t[3], t[0], t[1], t[2], t[3]);
+    for (; i + 4 <= n; i += 4, p += 16) {
+        __m128i v = _mm_loadu_si128((const __m128i *)p);
+        __m128i lo = RayPy_DivideBy255_epu16(_mm_mullo_epi16(_mm_unpacklo_epi8(v, zero), tint));
+        __m128i hi = RayPy_DivideBy255_epu16(_mm_mullo_epi16(_mm_unpackhi_epi8(v, zero), tint));
+        _mm_storeu_si128((__m128i *)p, _mm_packus_epi16(lo, hi));
+    }
+#endif
+    for (; i < n; i++, p += 4) {
+        for (int c = 0; c < 4; c++)
+            p[c] = (unsigned char)RayPy_DivideBy255(p[c] * t[c]);
+    }
+}
+
+static void
+RayPy_AlphaPremultiplyRows(void *arg, int begin, int end)
+{
+    const RayPy_PixelOpArgs *a = arg;
+    unsigned char *p = a->pixels + (size_t)begin * a->width * 4;
+    size_t n = (size_t)(end - begin) * a->width, i = 0;
+#ifdef RAYPY_SSE2
+    __m128i zero = _mm_setzero_si128();
+    /* the alpha lanes are multiplied by 255, i.e. kept as they are */
+    __m128i alpha_lanes = _mm_setr_epi16(0, 0, 0, -1, 0, 0, 0, -1);
+    __m128i alpha_255 = _mm_setr_epi16(0, 0, 0, 255, 0, 0, 0, 255);
+    for (; i + 4 <= n; i += 4, p += 16) {
+        __m128i v = _mm_loadu_si128((const __m128i *)p);
+        __m128i lo = _mm_unpacklo_epi8(v, zero), hi = _mm_unpackhi_epi8(v, zero);
+        __m128i alo = _mm_shufflehi_epi16(_mm_shufflelo_epi16(lo, 0xFF), 0xFF);
+        __m128i ahi = _mm_shufflehi_epi16(_mm_shufflelo_epi16(hi, 0xFF), 0xFF);
+        alo = _mm_or_si128(_mm_andnot_si128(alpha_lanes, alo), alpha_255);
+        ahi = _mm_or_si128(_mm_andnot_si128(alpha_lanes, ahi), alpha_255);
+        lo = RayPy_DivideBy255_epu16(_mm_mullo_epi16(lo, alo));
+        hi = RayPy_DivideBy255_epu16(_mm_mullo_epi16(hi, ahi));
+        _mm_storeu_si128((__m128i *)p, _mm_packus_epi16(lo, hi));
+    }
+#endif
+    for (; i < n; i++, p += 4) {
+        for (int c = 0; c < 3; c++)
+            p[c] = (unsigned char)RayPy_DivideBy255(p[c] * p[3]);
+    }
+}
+
+/* Blur: three box blur passes (a close Gaussian approximation, same as raylib's
+   ImageBlurGaussian()) on premultiplied float pixels, each one O(1) per pixel
+   whatever the radius is */
+
+typedef struct {
+    float *src;
+    float *dst;
+    int width, height, radius;
+} RayPy_BlurArgs;
+
+static void
+RayPy_BoxBlurRows(void *arg, int begin, int end)
+{
+    const RayPy_BlurArgs *a = arg;
+    int w = a->width, r = a->radius;
+    RayPy_Vec4 inv = RayPy_Vec4_Set1(1.0f / (2 * r + 1));
+    for (int y = begin; y < end; y++) {
+        const float *src = a->src + (size_t)y * w * 4;
+        float *dst = a->dst + (size_t)y * w * 4;
+        RayPy_Vec4 sum = RayPy_Vec4_Scale(RayPy_Vec4_LoadF(src), (float)(r + 1));
+        for (int x = 1; x <= r; x++)
+            sum = RayPy_Vec4_Add(sum, RayPy_Vec4_LoadF(src + (x < w ? x : w - 1) * 4));
+        for (int x = 0; x < w; x++) {
+            RayPy_Vec4_StoreF(dst + x * 4, RayPy_Vec4_Mul(sum, inv));
+            int in = x + r + 1 < w ? x + r + 1 : w - 1, out = x - r > 0 ? x - r : 0;
+            sum = RayPy_Vec4_Add(sum, RayPy_Vec4_Sub(RayPy_Vec4_LoadF(src + in * 4),
+                                                     RayPy_Vec4_LoadF(src + out * 4)));
+        }
+    }
+}
+
+#define RAYPY_BLUR_STRIP 64 // columns per vertical task
+
+/* [begin, end) are strips of RAYPY_BLUR_STRIP columns, running sums are kept
+   per column so memory is still read row by row */
+static void
+RayPy_BoxBlurColumns(void *arg, int begin, int end)
+{
+    const RayPy_BlurArgs *a = arg;
+    int w = a->width, h = a->height, r = a->radius;
+    size_t stride = (size_t)w * 4;
+    RayPy_Vec4 inv = RayPy_Vec4_Set1(1.0f / (2 * r + 1));
+    RayPy_Vec4 sums[RAYPY_BLUR_STRIP];
+    for (int strip = begin; strip < end; strip++) {
+        int x0 = strip * RAYPY_BLUR_STRIP;
+        int n = w - x0 < RAYPY_BLUR_STRIP ? w - x0 : RAYPY_BLUR_STRIP;
+        const float *src = a->src + x0 * 4;
+        float *dst = a->dst + x0 * 4;
+        for (int i = 0; i < n; i++)
+            sums[i] = RayPy_Vec4_Scale(RayPy_Vec4_LoadF(src + i * 4), (float)(r + 1));
+        for (int y = 1; y <= r; y++) {
+            const float *row = src + (y < h ? y : h - 1) * stride;
+            for (int i = 0; i < n; i++)
+                sums[i] = RayPy_Vec4_Add(sums[i], RayPy_Vec4_LoadF(row + i * 4));
+        }
+        for (int y = 0; y < h; y++) {
+            const float *in = src + (y + r + 1 < h ? y + r + 1 : h - 1) * stride;
+            const float *out = src + (y - r > 0 ? y - r : 0) * stride;
+            float *row = dst + y * stride;
+            for (int i = 0; i < n; i++) {
+                RayPy_Vec4_StoreF(row + i * 4, RayPy_Vec4_Mul(sums[i], inv));
+                sums[i] = RayPy_Vec4_Add(sums[i], RayPy_Vec4_Sub(RayPy_Vec4_LoadF(in + i * 4),
+                                                                 RayPy_Vec4_LoadF(out + i * 4)));
+            }
+        }
+    }
+}
+
+typedef struct {
+    unsigned char *pixels;
+    float *floats;
+    int width;
+} RayPy_BlurConvertArgs;
+
+static void
+RayPy_BlurLoadRows(void *arg, int begin, int end)
+{
+    const RayPy_BlurConvertArgs *a = arg;
+    size_t n = (size_t)(end - begin) * a->width, offset = (size_t)begin * a->width * 4;
+    const unsigned char *p = a->pixels + offset;
+    float *f = a->floats + offset;
+    for (size_t i = 0; i < n; i++, p += 4, f += 4) {
+        RayPy_Vec4 v = RayPy_Vec4_Scale(RayPy_Vec4_LoadPixel(p), p[3] / 255.0f);
+        RayPy_Vec4_StoreF(f, v);
+        f[3] = p[3];
+    }
+}
+
+static void
+RayPy_BlurStoreRows(void *arg, int begin, int end)
+{
+    const RayPy_BlurConvertArgs *a = arg;
+    size_t n = (size_t)(end - begin) * a->width, offset = (size_t)begin * a->width * 4;
+    unsigned char *p = a->pixels + offset;
+    const float *f = a->floats + offset;
+    for (size_t i = 0; i < n; i++, p += 4, f += 4) {
+        float alpha = f[3];
+        RayPy_Vec4 v = RayPy_Vec4_LoadF(f);
+        if (alpha > 0.0f)
+            v = RayPy_Vec4_Scale(v, 255.0f / alpha);
+        RayPy_Vec4_StorePixel(p, v);
+        float rounded = alpha + 0.5f;
+        p[3] = rounded >= 255.0f ? 255 : (unsigned char)rounded;
+    }
+}
+
+/* image must be R8G8B8A8 */
+static int
+RayPy_Pixels_Blur(Image *image, int radius)
+{
+    int w = image->width, h = image->height;
+    float *a = malloc((size_t)w * h * 4 * sizeof(float));
+    float *b = malloc((size_t)w * h * 4 * sizeof(float));
+    if (a == NULL || b == NULL) {
+        free(a);
+        free(b);
+        return -1;
+    }
+    RayPy_BlurConvertArgs convert = {image->data, a, w};
+    RayPy_ParallelFor(RayPy_BlurLoadRows, &convert, h, RAYPY_IMAGE_GRAIN * 4);
+    for (int pass = 0; pass < 3; pass++) {
+        RayPy_BlurArgs rows = {a, b, w, h, radius};
+        RayPy_ParallelFor(RayPy_BoxBlurRows, &rows, h, RAYPY_IMAGE_GRAIN);
+        RayPy_BlurArgs columns = {b, a, w, h, radius};
+        RayPy_ParallelFor(RayPy_BoxBlurColumns, &columns,
+                          (w + RAYPY_BLUR_STRIP - 1) / RAYPY_BLUR_STRIP, 1);
+    }
+    RayPy_ParallelFor(RayPy_BlurStoreRows, &convert, h, RAYPY_IMAGE_GRAIN * 4);
+    free(a);
+    free(b);
+    return 0;
+}
+
+/* Mipmaps: each level is the previous one halved with a 2x2 box filter,
+   stored after it like raylib's ImageMipmaps() does, down to 1x1 */
+
+static void
+RayPy_HalveRows(void *arg, int begin, int end)
+{
+    const RayPy_PixelMoveArgs *a = arg; // width, height and bpp of src
+    int w = a->width > 1 ? a->width / 2 : 1, bpp = a->bpp;
+    size_t stride = (size_t)a->width * bpp;
+    for (int y = begin; y < end; y++) {
+        const unsigned char *r0 = a->src + (size_t)(y * 2) * stride;
+        const unsigned char *r1 = y * 2 + 1 < a->height ? r0 + stride : r0;
+        unsigned char *dst = a->dst + (size_t)y * w * bpp;
+        if (a->width == 1) {
+            for (int c = 0; c < bpp; c++)
+                dst[c] = (unsigned char)((r0[c] + r1[c] + 1) / 2);
+            continue;
+        }
+        for (int x = 0; x < w * bpp; x++) {
+            int i = x / bpp * 2 * bpp + x % bpp;
+            dst[x] = (unsigned char)((r0[i] + r0[i + bpp] + r1[i] + r1[i + bpp] + 2) / 4);
+        }
+    }
+}
+
+/* Halves the 8-bit pixels of src into dst */
+static void
+RayPy_Pixels_Halve(const unsigned char *src, int width, int height, int bpp, unsigned char *dst)
+{
+    RayPy_PixelMoveArgs args = {(unsigned char *)src, dst, width, height, bpp};
+    RayPy_ParallelFor(RayPy_HalveRows, &args, height > 1 ? height / 2 : 1, RAYPY_IMAGE_GRAIN);
+}
+
+static int
+RayPy_Pixels_Mipmaps(Image *image)
+{
+    if (!RayPy_IsFastFormat(image->format)) {
+        ImageMipmaps(image);
+        return 0;
+    }
+    int bpp = GetPixelDataSize(1, 1, image->format), levels = 1;
+    size_t total = (size_t)image->width * image->height * bpp;
+    for (int w = image->width, h = image->height; w > 1 || h > 1; levels++) {
+        w = w > 1 ? w / 2 : 1;
+        h = h > 1 ? h / 2 : 1;
+        total += (size_t)w * h * bpp;
+    }
+    unsigned char *data = RL_MALLOC(total), *level = data;
+    if (data == NULL)
+        return -1;
+    memcpy(data, image->data, (size_t)image->width * image->height * bpp);
+    for (int i = 1, w = image->width, h = image->height; i < levels; i++) {
+        unsigned char *next = level + (size_t)w * h * bpp;
+        RayPy_Pixels_Halve(level, w, h, bpp, next);
+        level = next;
+        w = w > 1 ? w / 2 : 1;
+        h = h > 1 ? h / 2 : 1;
+    }
+    RL_FREE(image->data);
+    image->data = data;
+    image->mipmaps = levels;
+    return 0;
+}
+
+enum {
+    RAYPY_IMAGE_RESIZE,
+    RAYPY_IMAGE_RESIZE_BILINEAR,
+    RAYPY_IMAGE_RESIZE_NN,
+    RAYPY_IMAGE_CROP,
+    RAYPY_IMAGE_FLIP_VERTICAL,
+    RAYPY_IMAGE_FLIP_HORIZONTAL,
+    RAYPY_IMAGE_ROTATE,
+    RAYPY_IMAGE_ROTATE_CW,
+    RAYPY_IMAGE_ROTATE_CCW,
+    RAYPY_IMAGE_COLOR_TINT,
+    RAYPY_IMAGE_ALPHA_PREMULTIPLY,
+    RAYPY_IMAGE_FORMAT,
+    RAYPY_IMAGE_BLUR,
+    RAYPY_IMAGE_MIPMAPS,
+};
+
+typedef struct {
+    int kind;
+    int width, height; // resize and crop size, blur radius in width
+    int x, y;          // crop offset
+    float degrees;
+    Color color;
+    int format;
+} RayPy_ImageOp;
+
+/* Runs an image operation without touching Python objects, returns -1 when
+   out of memory */
+static int
+RayPy_Pixels_Apply(Image *image, const RayPy_ImageOp *op)
+{
+    int format = image->format, ret = 0;
+    int bpp = GetPixelDataSize(1, 1, format);
+
+    switch (op->kind) {
+    case RAYPY_IMAGE_CROP: {
+        unsigned char *dst = RL_MALLOC((size_t)op->width * op->height * bpp);
+        if (dst == NULL)
+            return -1;
+        for (int y = 0; y < op->height; y++)
+            memcpy(dst + (size_t)y * op->width * bpp,
+                   (unsigned char *)image->data + ((size_t)(op->y + y) * image->width + op->x) * bpp,
+                   (size_t)op->width * bpp);
+        RL_FREE(image->data);
+        image->data = dst;
+        image->width = op->width;
+        image->height = op->height;
+        image->mipmaps = 1;
+        return 0;
+    }
+    case RAYPY_IMAGE_FLIP_VERTICAL:
+    case RAYPY_IMAGE_FLIP_HORIZONTAL: {
+        RayPy_PixelMoveArgs args = {image->data, NULL, image->width, image->height, bpp};
+        if (op->kind == RAYPY_IMAGE_FLIP_VERTICAL)
+            RayPy_ParallelFor(RayPy_FlipVerticalRows, &args, image->height / 2, RAYPY_IMAGE_GRAIN);
+        else
+            RayPy_ParallelFor(RayPy_FlipHorizontalRows, &args, image->height, RAYPY_IMAGE_GRAIN);
+        image->mipmaps = 1;
+        return 0;
+    }
+    case RAYPY_IMAGE_ROTATE_CW:
+    case RAYPY_IMAGE_ROTATE_CCW:
+        return RayPy_Pixels_RotateQuarter(image, op->kind == RAYPY_IMAGE_ROTATE_CW);
+    case RAYPY_IMAGE_ROTATE: {
+        /* quarter turns are exact and work on any format */
+        double turns = op->degrees / 90.0;
+        if (turns == floor(turns)) {
+            int quarter = ((int)fmod(turns, 4.0) + 4) % 4;
+            RayPy_ImageOp flip = {RAYPY_IMAGE_FLIP_VERTICAL};
+            switch (quarter) {
+            case 1:
+                return RayPy_Pixels_RotateQuarter(image, 1);
+            case 2:
+                if (RayPy_Pixels_Apply(image, &flip))
+                    return -1;
+                flip.kind = RAYPY_IMAGE_FLIP_HORIZONTAL;
+                return RayPy_Pixels_Apply(image, &flip);
+            case 3:
+                return RayPy_Pixels_RotateQuarter(image, 0);
+            default:
+                return 0;
+            }
+        }
+        break;
+    }
+    case RAYPY_IMAGE_FORMAT:
+        return RayPy_Pixels_Format(image, op->format);
+    case RAYPY_IMAGE_MIPMAPS:
+        return RayPy_Pixels_Mipmaps(image);
+    }
+
+    if (RayPy_Pixels_Format(image, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8))
+        return -1;
+    RayPy_PixelOpArgs pixels = {image->data, image->width, op->color};
+    switch (op->kind) {
+    case RAYPY_IMAGE_RESIZE:
+        ret = RayPy_Pixels_Resample(image, op->width, op->height, 2.0, RayPy_CatmullRomKernel);
+        break;
+    case RAYPY_IMAGE_RESIZE_BILINEAR:
+        ret = RayPy_Pixels_Resample(image, op->width, op->height, 1.0, RayPy_TriangleKernel);
+        break;
+    case RAYPY_IMAGE_RESIZE_NN:
+        ret = RayPy_Pixels_ResizeNN(image, op->width, op->height);
+        break;
+    case RAYPY_IMAGE_ROTATE:
+        ret = RayPy_Pixels_Rotate(image, op->degrees);
+        break;
+    case RAYPY_IMAGE_COLOR_TINT:
+        RayPy_ParallelFor(RayPy_ColorTintRows, &pixels, image->height, RAYPY_IMAGE_GRAIN * 4);
+        break;
+    case RAYPY_IMAGE_ALPHA_PREMULTIPLY:
+        RayPy_ParallelFor(RayPy_AlphaPremultiplyRows, &pixels, image->height, RAYPY_IMAGE_GRAIN * 4);
+        break;
+    case RAYPY_IMAGE_BLUR:
+        ret = RayPy_Pixels_Blur(image, op->width);
+        break;
+    }
+    if (RayPy_Pixels_Format(image, format))
+        ret = -1;
+    return ret;
+}
+
+static PyObject *
+RayPy_Image_FromImage(Image image)
+{
+    RayPy_ImageObject *ret = PyObject_New(RayPy_ImageObject, &RayPy_Image_Type);
+    if (ret == NULL) {
+        UnloadImage(image);
+        return NULL;
+    }
+    ret->i = image;
+    ret->busy = 0;
+    return (PyObject *)ret;
+}
+
+/* Marks the image busy for the caller, which calls RayPy_Image_Release() when
+   done. Atomic, threads run at once without the GIL on free-threaded builds. */
+static int
+RayPy_Image_Claim(RayPy_ImageObject *image)
+{
+    if (!RAYPY_CAS_LONG(&image->busy, 0, 1)) {
+        PyErr_SetString(PyExc_RuntimeError, "image is being processed by another thread");
+        return -1;
+    }
+    if (image->i.data == NULL) {
+        RAYPY_STORE_LONG(&image->busy, 0);
+        PyErr_SetString(PyExc_ValueError, "image is not loaded");
+        return -1;
+    }
+    return 0;
+}
+
+static void
+RayPy_Image_Release(RayPy_ImageObject *image)
+{
+    RAYPY_STORE_LONG(&image->busy, 0);
+}
+
+/* Applies `op` to `image` in place with the GIL released */
+static PyObject *
+RayPy_Image_Run(RayPy_ImageObject *image, const RayPy_ImageOp *op)
+{
+    int err;
+    if (RayPy_Image_Claim(image))
+        return NULL;
+    if (image->i.format >= PIXELFORMAT_COMPRESSED_DXT1_RGB) {
+        PyErr_SetString(PyExc_ValueError, "compressed images are not supported");
+        RayPy_Image_Release(image);
+        return NULL;
+    }
+    /* the crop was clamped before the claim, another thread may have resized it since */
+    if (op->kind == RAYPY_IMAGE_CROP
+        && (op->x + op->width > image->i.width || op->y + op->height > image->i.height)) {
+        PyErr_SetString(PyExc_ValueError, "crop rectangle is outside of the image");
+        RayPy_Image_Release(image);
+        return NULL;
+    }
+    if (RayPy_Pool_Start()) {
+        RayPy_Image_Release(image);
+        return NULL;
+    }
+    Py_BEGIN_ALLOW_THREADS
+    err = RayPy_Pixels_Apply(&image->i, op);
+    Py_END_ALLOW_THREADS
+    RayPy_Image_Release(image);
+    if (err)
+        return PyErr_NoMemory();
+    Py_RETURN_NONE;
+}
+
+static int
+RayPy_CheckImageSize(int width, int height)
+{
+    if (width <= 0 || height <= 0) {
+        PyErr_SetString(PyExc_ValueError, "width and height must be > 0");
+        return -1;
+    }
+    if ((long long)width * height > INT_MAX / 16) {
+        PyErr_SetString(PyExc_ValueError, "image is too large");
+        return -1;
+    }
+    return 0;
+}
+
+static PyObject *
+RayPy_LoadImage(PyObject *Py_UNUSED(self), PyObject *args)
+{
+    const char *fileName;
+    if (!PyArg_ParseTuple(args, "s", &fileName))
+        return NULL;
+    Image image;
+    Py_BEGIN_ALLOW_THREADS
+    image = LoadImage(fileName);
+    Py_END_ALLOW_THREADS
+    if (image.data == NULL)
+        return PyErr_Format(PyExc_OSError, "failed to load image %R", PyTuple_GET_ITEM(args, 0));
+    return RayPy_Image_FromImage(image);
+}
+
+PyDoc_STRVAR(load_image_doc, "Load image from file into CPU memory (RAM)");
+
+static PyObject *
+RayPy_LoadImageFromMemory(PyObject *Py_UNUSED(self), PyObject *args)
+{
+    const char *fileType;
+    char extension[16];
+    Py_buffer buffer;
+    Image image;
+    if (!PyArg_ParseTuple(args, "sy*", &fileType, &buffer))
+        return NULL;
+    /* raylib wants ".png", take "png" too */
+    if (snprintf(extension, sizeof(extension), "%s%s", fileType[0] == '.' ? "" : ".", fileType)
+        >= (int)sizeof(extension)) {
+        PyBuffer_Release(&buffer);
+        return PyErr_Format(PyExc_ValueError, "unknown file type '%s'", fileType);
+    }
+    if (buffer.len > INT_MAX) {
+        PyBuffer_Release(&buffer);
+        PyErr_SetString(PyExc_OverflowError, "buffer is larger than 2 GiB");
+        return NULL;
+    }
+    /* the exporter can't resize or free the buffer until it's released */
+    Py_BEGIN_ALLOW_THREADS
+    image = LoadImageFromMemory(extension, buffer.buf, (int)buffer.len);
+    Py_END_ALLOW_THREADS
+    PyBuffer_Release(&buffer);
+    if (image.data == NULL)
+        return PyErr_Format(PyExc_OSError, "failed to load %s image from memory", extension);
+    return RayPy_Image_FromImage(image);
+}
+
+PyDoc_STRVAR(load_image_from_memory_doc,
+             "Load image from a bytes-like object (bytes, memoryview, mmap, ...) without copying it, file_type is the extension like '.png'");
+
+static PyObject *
+RayPy_UnloadImage(PyObject *Py_UNUSED(self), PyObject *args)
+{
+    RayPy_ImageObject *image;
+    if (!PyArg_ParseTuple(args, "O!", &RayPy_Image_Type, &image))
+        return NULL;
+    if (!RAYPY_CAS_LONG(&image->busy, 0, 1)) {
+        PyErr_SetString(PyExc_RuntimeError, "image is being processed by another thread");
+        return NULL;
+    }
+    UnloadImage(image->i);
+    image->i.data = NULL;
+    RayPy_Image_Release(image);
+    Py_RETURN_NONE;
+}
+
+PyDoc_STRVAR(unload_image_doc, "Unload image from CPU memory (RAM)");
+
+static PyObject *
+RayPy_GenImageColor(PyObject *Py_UNUSED(self), PyObject *args)
+{
+    int width, height;
+    RayPy_ColorObject *color;
+    if (!PyArg_ParseTuple(args, "iiO!", &width, &height, &RayPy_Color_Type, &color))
+        return NULL;
+    if (RayPy_CheckImageSize(width, height))
+        return NULL;
+    return RayPy_Image_FromImage(GenImageColor(width, height, RayPy_Color_AsColor(color)));
+}
+
+PyDoc_STRVAR(gen_image_color_doc, "Generate image: plain color");
+
+static PyObject *
+RayPy_ImageCopy(PyObject *Py_UNUSED(self), PyObject *args)
+{
+    RayPy_ImageObject *image;
+    Image copy;
+    if (!PyArg_ParseTuple(args, "O!", &RayPy_Image_Type, &image))
+        return NULL;
+    if (RayPy_Image_Claim(image))
+        return NULL;
+    Py_BEGIN_ALLOW_THREADS
+    copy = ImageCopy(image->i);
+    Py_END_ALLOW_THREADS
+    RayPy_Image_Release(image);
+    if (copy.data == NULL)
+        return PyErr_NoMemory();
+    return RayPy_Image_FromImage(copy);
+}
+
+PyDoc_STRVAR(image_copy_doc, "Create an image duplicate (useful for transformations)");
+
+static PyObject *
+RayPy_ImageResizeWith(PyObject *args, int kind)
+{
+    RayPy_ImageObject *image;
+    RayPy_ImageOp op = {kind};
+    if (!PyArg_ParseTuple(args, "O!ii", &RayPy_Image_Type, &image, &op.width, &op.height))
+        return NULL;
+    if (RayPy_CheckImageSize(op.width, op.height))
+        return NULL;
+    return RayPy_Image_Run(image, &op);
+}
+
+static PyObject *
+RayPy_ImageResize(PyObject *Py_UNUSED(self), PyObject *args)
+{
+    return RayPy_ImageResizeWith(args, RAYPY_IMAGE_RESIZE);
+}
+
+PyDoc_STRVAR(image_resize_doc, "Resize image (Bicubic scaling algorithm)");
+
+static PyObject *
+RayPy_ImageResizeBilinear(PyObject *Py_UNUSED(self), PyObject *args)
+{
+    return RayPy_ImageResizeWith(args, RAYPY_IMAGE_RESIZE_BILINEAR);
+}
+
+PyDoc_STRVAR(image_resize_bilinear_doc, "Resize image (Bilinear scaling algorithm)");
+
+static PyObject *
+RayPy_ImageResizeNN(PyObject *Py_UNUSED(self), PyObject *args)
+{
+    return RayPy_ImageResizeWith(args, RAYPY_IMAGE_RESIZE_NN);
+}
+
+PyDoc_STRVAR(image_resize_nn_doc, "Resize image (Nearest-Neighbor scaling algorithm)");
+
+static PyObject *
+RayPy_ImageCrop(PyObject *Py_UNUSED(self), PyObject *args)
+{
+    RayPy_ImageObject *image;
+    RayPy_RectangleObject *crop;
+    RayPy_ImageOp op = {RAYPY_IMAGE_CROP};
+    if (!PyArg_ParseTuple(args, "O!O!", &RayPy_Image_Type, &image, &RayPy_Rectangle_Type, &crop))
+        return NULL;
+    /* clamped to the image like raylib does */
+    float x0 = crop->x > 0 ? crop->x : 0, y0 = crop->y > 0 ? crop->y : 0;
+    float x1 = crop->x + crop->width, y1 = crop->y + crop->height;
+    if (x1 > image->i.width)
+        x1 = (float)image->i.width;
+    if (y1 > image->i.height)
+        y1 = (float)image->i.height;
+    op.x = (int)x0;
+    op.y = (int)y0;
+    op.width = (int)x1 - op.x;
+    op.height = (int)y1 - op.y;
+    if (op.width <= 0 || op.height <= 0) {
+        PyErr_SetString(PyExc_ValueError, "crop rectangle is outside of the image");
+        return NULL;
+    }
+    return RayPy_Image_Run(image, &op);
+}
+
+PyDoc_STRVAR(image_crop_doc, "Crop an image to a defined rectangle");
+
+static PyObject *
+RayPy_ImageSimpleOp(PyObject *args, int kind)
+{
+    RayPy_ImageObject *image;
+    RayPy_ImageOp op = {kind};
+    if (!PyArg_ParseTuple(args, "O!", &RayPy_Image_Type, &image))
+        return NULL;
+    return RayPy_Image_Run(image, &op);
+}
+
+static PyObject *
+RayPy_ImageFlipVertical(PyObject *Py_UNUSED(self), PyObject *args)
+{
+    return RayPy_ImageSimpleOp(args, RAYPY_IMAGE_FLIP_VERTICAL);
+}
+
+PyDoc_STRVAR(image_flip_vertical_doc, "Flip image vertically");
+
+static PyObject *
+RayPy_ImageFlipHorizontal(PyObject *Py_UNUSED(self), PyObject *args)
+{
+    return RayPy_ImageSimpleOp(args, RAYPY_IMAGE_FLIP_HORIZONTAL);
+}
+
+PyDoc_STRVAR(image_flip_horizontal_doc, "Flip image horizontally");
+
+static PyObject *
+RayPy_ImageRotate(PyObject *Py_UNUSED(self), PyObject *args)
+{
+    RayPy_ImageObject *image;
+    RayPy_ImageOp op = {RAYPY_IMAGE_ROTATE};
+    if (!PyArg_ParseTuple(args, "O!f", &RayPy_Image_Type, &image, &op.degrees))
+        return NULL;
+    return RayPy_Image_Run(image, &op);
+}
+
+PyDoc_STRVAR(image_rotate_doc,
+             "Rotate image by input angle in degrees, clockwise (the image grows to fit)");
+
+static PyObject *
+RayPy_ImageRotateCW(PyObject *Py_UNUSED(self), PyObject *args)
+{
+    return RayPy_ImageSimpleOp(args, RAYPY_IMAGE_ROTATE_CW);
+}
+
+PyDoc_STRVAR(image_rotate_cw_doc, "Rotate image clockwise 90deg");
+
+static PyObject *
+RayPy_ImageRotateCCW(PyObject *Py_UNUSED(self), PyObject *args)
+{
+    return RayPy_ImageSimpleOp(args, RAYPY_IMAGE_ROTATE_CCW);
+}
+
+PyDoc_STRVAR(image_rotate_ccw_doc, "Rotate image counter-clockwise 90deg");
+
+static PyObject *
+RayPy_ImageColorTint(PyObject *Py_UNUSED(self), PyObject *args)
+{
+    RayPy_ImageObject *image;
+    RayPy_ColorObject *color;
+    RayPy_ImageOp op = {RAYPY_IMAGE_COLOR_TINT};
+    if (!PyArg_ParseTuple(args, "O!O!", &RayPy_Image_Type, &image, &RayPy_Color_Type, &color))
+        return NULL;
+    op.color = RayPy_Color_AsColor(color);
+    return RayPy_Image_Run(image, &op);
+}
+
+PyDoc_STRVAR(image_color_tint_doc, "Modify image color: tint");
+
+static PyObject *
+RayPy_ImageAlphaPremultiply(PyObject *Py_UNUSED(self), PyObject *args)
+{
+    return RayPy_ImageSimpleOp(args, RAYPY_IMAGE_ALPHA_PREMULTIPLY);
+}
+
+PyDoc_STRVAR(image_alpha_premultiply_doc, "Premultiply alpha channel");
+
+static PyObject *
+RayPy_ImageFormat(PyObject *Py_UNUSED(self), PyObject *args)
+{
+    RayPy_ImageObject *image;
+    RayPy_ImageOp op = {RAYPY_IMAGE_FORMAT};
+    if (!PyArg_ParseTuple(args, "O!i", &RayPy_Image_Type, &image, &op.format))
+        return NULL;
+    if (op.format < PIXELFORMAT_UNCOMPRESSED_GRAYSCALE
+        || op.format > PIXELFORMAT_UNCOMPRESSED_R16G16B16A16) {
+        PyErr_Format(PyExc_ValueError, "invalid uncompressed pixel format: %d", op.format);
+        return NULL;
+    }
+    return RayPy_Image_Run(image, &op);
+}
+
+PyDoc_STRVAR(image_format_doc, "Convert image data to desired format");
+
+static PyObject *
+RayPy_ImageBlurGaussian(PyObject *Py_UNUSED(self), PyObject *args)
+{
+    RayPy_ImageObject *image;
+    RayPy_ImageOp op = {RAYPY_IMAGE_BLUR};
+    if (!PyArg_ParseTuple(args, "O!i", &RayPy_Image_Type, &image, &op.width))
+        return NULL;
+    if (op.width < 0) {
+        PyErr_SetString(PyExc_ValueError, "blur_size must be >= 0");
+        return NULL;
+    }
+    if (op.width == 0)
+        Py_RETURN_NONE;
+    return RayPy_Image_Run(image, &op);
+}
+
+PyDoc_STRVAR(image_blur_gaussian_doc, "Apply Gaussian blur using a box blur approximation");
+
+static PyObject *
+RayPy_ImageMipmaps(PyObject *Py_UNUSED(self), PyObject *args)
+{
+    RayPy_ImageObject *image;
+    RayPy_ImageOp op = {RAYPY_IMAGE_MIPMAPS};
+    if (!PyArg_ParseTuple(args, "O!", &RayPy_Image_Type, &image))
+        return NULL;
+    return RayPy_Image_Run(image, &op);
+}
+
+PyDoc_STRVAR(image_mipmaps_doc,
+             "Compute all mipmap levels for a provided image, doesn't hold the GIL so it can run on a worker thread before upload");
+
+static PyObject *
+RayPy_SetWorkerThreads(PyObject *Py_UNUSED(self), PyObject *obj)
+{
+    int count = PyLong_AsLong(obj);
+    METH_O_TYPE_ERROR(obj, "int");
+    if (count < 0) {
+        PyErr_SetString(PyExc_ValueError, "count must be >= 0");
+        return NULL;
+    }
+    RayPy_pool.threads = count < RAYPY_MAX_WORKERS + 1 ? count : RAYPY_MAX_WORKERS + 1;
+    Py_RETURN_NONE;
+}
+
+PyDoc_STRVAR(set_worker_threads_doc,
+             "Set the number of threads image functions run on, 0 means one per CPU (default)");
+
+static PyObject *
+RayPy_GetWorkerThreads(PyObject *Py_UNUSED(self), PyObject *Py_UNUSED(args))
+{
+    return PyLong_FromLong(RayPy_Pool_Threads());
+}
+
+PyDoc_STRVAR(get_worker_threads_doc, "Get the number of threads image functions run on");
+
+/* Lazy image pipelines
+
+   image.lazy() records operations, apply() plans them into segments: each
+   one samples a window of its source (crop), resamples it at most once,
+   crops the result again and applies per-pixel operations before and after
+   the resampling. Flips are folded into the reads of the source or the
+   writes of the result. Segments run tile by tile, a few output rows at a time,
+   so the only full-size buffers are the result and the output of a segment
+   followed by another resample. */
+
+typedef struct {
+    int sx, sy, sw, sh; // source window
+    int resample;       // RAYPY_IMAGE_RESIZE* or -1
+    int rw, rh;         // size after resampling
+    int ox, oy, ow, oh; // output window inside the resampled image
+    int sflip_x, sflip_y; // flips before resampling, applied when reading the source
+    int flip_x, flip_y;   // flips after, applied when storing
+    RayPy_ImageOp *point; // per-pixel ops, the first npre run before resampling
+    int npre, npost;
+} RayPy_Segment;
+
+static void
+RayPy_Segment_Init(RayPy_Segment *seg, int width, int height)
+{
+    RayPy_ImageOp *point = seg->point;
+    memset(seg, 0, sizeof(*seg));
+    seg->point = point;
+    seg->sw = seg->rw = seg->ow = width;
+    seg->sh = seg->rh = seg->oh = height;
+    seg->resample = -1;
+}
+
+/* no resampling, flips or crop of an image `width` x `height` */
+static int
+RayPy_Segment_IsWhole(const RayPy_Segment *seg, int width, int height)
+{
+    return seg->resample < 0 && !seg->flip_x && !seg->flip_y && !seg->sflip_x && !seg->sflip_y
+           && seg->sx == 0 && seg->sy == 0 && seg->sw == width && seg->sh == height
+           && seg->ow == width && seg->oh == height;
+}
+
+static int
+RayPy_ResampleFilter_InitNN(RayPy_ResampleFilter *f, int src_size, int dst_size)
+{
+    f->taps = 1;
+    f->first = malloc(sizeof(int) * dst_size);
+    f->count = malloc(sizeof(int) * dst_size);
+    f->weights = malloc(sizeof(float) * dst_size);
+    if (f->first == NULL || f->count == NULL || f->weights == NULL) {
+        RayPy_ResampleFilter_Free(f);
+        return -1;
+    }
+    for (int i = 0; i < dst_size; i++) {
+        f->first[i] = (int)((int64_t)i * src_size / dst_size);
+        f->count[i] = 1;
+        f->weights[i] = 1.0f;
+    }
+    return 0;
+}
+
+/* the per-pixel ops of a segment, with their constants worked out up front */
+
+enum {
+    RAYPY_POINT_MUL,         // tint, k = color / 255
+    RAYPY_POINT_PREMULTIPLY, // k = 1 / 255
+    RAYPY_POINT_GRAY,        // luma, k = alpha mask
+    RAYPY_POINT_OPAQUE,      // alpha = 255
+};
+
+typedef struct {
+    int kind;
+    float k[4];
+} RayPy_PointOp;
+
+static void
+RayPy_PointOp_Init(RayPy_PointOp *point, const RayPy_ImageOp *op)
+{
+    float one[4] = {1.0f, 1.0f, 1.0f, 1.0f};
+    memcpy(point->k, one, sizeof(one));
+    switch (op->kind) {
+    case RAYPY_IMAGE_COLOR_TINT:
+        point->kind = RAYPY_POINT_MUL;
+        point->k[0] = op->color.r / 255.0f;
+        point->k[1] = op->color.g / 255.0f;
+        point->k[2] = op->color.b / 255.0f;
+        point->k[3] = op->color.a / 255.0f;
+        break;
+    case RAYPY_IMAGE_ALPHA_PREMULTIPLY:
+        point->kind = RAYPY_POINT_PREMULTIPLY;
+        point->k[0] = point->k[1] = point->k[2] = point->k[3] = 1.0f / 255.0f;
+        break;
+    default:
+        /* RAYPY_IMAGE_FORMAT: the channels the target format keeps,
+           quantization happens on store */
+        switch (op->format) {
+        case PIXELFORMAT_UNCOMPRESSED_GRAYSCALE:
+        case PIXELFORMAT_UNCOMPRESSED_R32:
+        case PIXELFORMAT_UNCOMPRESSED_R16:
+            point->kind = RAYPY_POINT_GRAY;
+            point->k[3] = 0.0f;
+            break;
+        case PIXELFORMAT_UNCOMPRESSED_GRAY_ALPHA:
+            point->kind = RAYPY_POINT_GRAY;
+            break;
+        case PIXELFORMAT_UNCOMPRESSED_R8G8B8:
+        case PIXELFORMAT_UNCOMPRESSED_R5G6B5:
+        case PIXELFORMAT_UNCOMPRESSED_R32G32B32:
+        case PIXELFORMAT_UNCOMPRESSED_R16G16B16:
+            point->kind = RAYPY_POINT_OPAQUE;
+            break;
+        default:
+            point->kind = RAYPY_POINT_MUL; // keeps everything
+            break;
+        }
+        break;
+    }
+}
+
+static inline RayPy_Vec4
+RayPy_PointOps(RayPy_Vec4 v, const RayPy_PointOp *ops, int count)
+{
+    for (int i = 0; i < count; i++) {
+        const RayPy_PointOp *op = &ops[i];
+#ifdef RAYPY_SSE2
+        /* lane masks instead of a round trip through memory, which stalls */
+        __m128 rgb = _mm_castsi128_ps(_mm_setr_epi32(-1, -1, -1, 0));
+        __m128 alpha;
+        switch (op->kind) {
+        case RAYPY_POINT_MUL:
+            v = _mm_mul_ps(v, _mm_loadu_ps(op->k));
+            break;
+        case RAYPY_POINT_PREMULTIPLY:
+            /* (a, a, a, 255) * k */
+            alpha = _mm_shuffle_ps(v, v, _MM_SHUFFLE(3, 3, 3, 3));
+            alpha = _mm_or_ps(_mm_and_ps(rgb, alpha), _mm_andnot_ps(rgb, _mm_set1_ps(255.0f)));
+            v = _mm_mul_ps(v, _mm_mul_ps(alpha, _mm_loadu_ps(op->k)));
+            break;
+        case RAYPY_POINT_GRAY: {
+            __m128 y = _mm_mul_ps(v, _mm_setr_ps(0.299f, 0.587f, 0.114f, 0.0f));
+            y = _mm_add_ps(y, _mm_shuffle_ps(y, y, _MM_SHUFFLE(2, 3, 0, 1)));
+            y = _mm_add_ps(y, _mm_shuffle_ps(y, y, _MM_SHUFFLE(1, 0, 3, 2)));
+            /* k[3] is 0 when the alpha goes too, 255 + 0 * a */
+            alpha = _mm_add_ps(_mm_mul_ps(v, _mm_loadu_ps(op->k)),
+                               _mm_set1_ps(op->k[3] != 0.0f ? 0.0f : 255.0f));
+            v = _mm_or_ps(_mm_and_ps(rgb, y), _mm_andnot_ps(rgb, alpha));
+            break;
+        }
+        default:
+            v = _mm_or_ps(_mm_and_ps(rgb, v), _mm_andnot_ps(rgb, _mm_set1_ps(255.0f)));
+            break;
+        }
+#else
+        switch (op->kind) {
+        case RAYPY_POINT_MUL:
+            for (int c = 0; c < 4; c++)
+                v.v[c] *= op->k[c];
+            break;
+        case RAYPY_POINT_PREMULTIPLY:
+            for (int c = 0; c < 3; c++)
+                v.v[c] *= v.v[3] * op->k[c];
+            break;
+        case RAYPY_POINT_GRAY:
+            v.v[0] = v.v[1] = v.v[2] = v.v[0] * 0.299f + v.v[1] * 0.587f + v.v[2] * 0.114f;
+            v.v[3] = op->k[3] != 0.0f ? v.v[3] : 255.0f;
+            break;
+        default:
+            v.v[3] = 255.0f;
+            break;
+        }
+#endif
+    }
+    return v;
+}
+
+/* stores a pixel as R8G8B8A8, R8G8B8, GRAY_ALPHA or GRAYSCALE */
+static inline void
+RayPy_StoreFormat(unsigned char *p, RayPy_Vec4 v, int format)
+{
+    unsigned char rgba[4];
+    if (format == PIXELFORMAT_UNCOMPRESSED_R8G8B8A8) {
+        RayPy_Vec4_StorePixel(p, v);
+        return;
+    }
+    RayPy_Vec4_StorePixel(rgba, v);
+    switch (format) {
+    case PIXELFORMAT_UNCOMPRESSED_R8G8B8:
+        p[0] = rgba[0], p[1] = rgba[1], p[2] = rgba[2];
+        break;
+    case PIXELFORMAT_UNCOMPRESSED_GRAY_ALPHA:
+        p[0] = RayPy_Luma(rgba), p[1] = rgba[3];
+        break;
+    default:
+        p[0] = RayPy_Luma(rgba);
+        break;
+    }
+}
+
+/* post ops and store of a row of clamped float pixels */
+static void
+RayPy_StoreRow(unsigned char *dst, const float *row, int width, const RayPy_PointOp *ops, int count,
+               int flip, int format)
+{
+    int bpp = GetPixelDataSize(1, 1, format);
+    if (count == 0 && !flip && format == PIXELFORMAT_UNCOMPRESSED_R8G8B8A8) {
+        for (int x = 0; x < width; x++)
+            RayPy_Vec4_StorePixel(dst + x * 4, RayPy_Vec4_LoadF(row + x * 4));
+        return;
+    }
+    for (int x = 0; x < width; x++) {
+        RayPy_Vec4 v = RayPy_PointOps(RayPy_Vec4_LoadF(row + x * 4), ops, count);
+        RayPy_StoreFormat(dst + (size_t)(flip ? width - 1 - x : x) * bpp, v, format);
+    }
+}
+
+typedef struct {
+    const RayPy_Segment *seg;
+    const unsigned char *src; // R8G8B8A8
+    int src_width;
+    unsigned char *dst;
+    int format; // of dst: R8G8B8A8, R8G8B8, GRAY_ALPHA or GRAYSCALE
+    int bpp;
+    RayPy_ResampleFilter fx, fy;
+    RayPy_PointOp *point; // seg->point, prepared
+    int post_in_place;    // the post ops run on the stored R8G8B8A8 rows
+    int tile_rows;
+    int failed;
+} RayPy_SegmentArgs;
+
+static int
+RayPy_PointOps_AreInPlace(const RayPy_ImageOp *ops, int count)
+{
+    for (int i = 0; i < count; i++) {
+        if (ops[i].kind != RAYPY_IMAGE_COLOR_TINT && ops[i].kind != RAYPY_IMAGE_ALPHA_PREMULTIPLY)
+            return 0;
+    }
+    return 1;
+}
+
+/* runs tints and alpha premultiplies on R8G8B8A8 rows with the 8-bit kernels */
+static void
+RayPy_PointOps_InPlace(unsigned char *pixels, int width, int begin, int end, const RayPy_ImageOp *ops,
+                       int count)
+{
+    for (int i = 0; i < count; i++) {
+        RayPy_PixelOpArgs op = {pixels, width, ops[i].color};
+        if (ops[i].kind == RAYPY_IMAGE_COLOR_TINT)
+            RayPy_ColorTintRows(&op, begin, end);
+        else
+            RayPy_AlphaPremultiplyRows(&op, begin, end);
+    }
+}
+
+/* segments of tints and alpha premultiplies only: the 8-bit in place kernels,
+   all of them on a few rows at a time while they're still in cache */
+static int
+RayPy_Segment_IsInPlace(const RayPy_Segment *seg, const Image *image, int format)
+{
+    return format == PIXELFORMAT_UNCOMPRESSED_R8G8B8A8
+           && RayPy_Segment_IsWhole(seg, image->width, image->height)
+           && RayPy_PointOps_AreInPlace(seg->point, seg->npre + seg->npost);
+}
+
+typedef struct {
+    const RayPy_Segment *seg;
+    unsigned char *pixels;
+    int width;
+} RayPy_InPlaceArgs;
+
+static void
+RayPy_InPlaceRows(void *arg, int begin, int end)
+{
+    const RayPy_InPlaceArgs *a = arg;
+    const RayPy_Segment *seg = a->seg;
+    for (int y = begin; y < end; y += 16) {
+        int y1 = y + 16 < end ? y + 16 : end;
+        RayPy_PointOps_InPlace(a->pixels, a->width, y, y1, seg->point, seg->npre + seg->npost);
+    }
+}
+
+static void
+RayPy_SegmentTiles(void *arg, int begin, int end)
+{
+    RayPy_SegmentArgs *a = arg;
+    const RayPy_Segment *seg = a->seg;
+    const RayPy_ResampleFilter *fx = &a->fx, *fy = &a->fy;
+    const RayPy_PointOp *pre = a->point, *post = a->point + seg->npre;
+    int ow = seg->ow;
+    /* source columns read by the output window */
+    int c0 = fx->first[seg->ox], c1 = 0;
+    for (int x = seg->ox; x < seg->ox + ow; x++) {
+        if (fx->first[x] + fx->count[x] > c1)
+            c1 = fx->first[x] + fx->count[x];
+    }
+
+    if (fx->taps == 1 && fy->taps == 1) {
+        /* nearest neighbor or no resampling: one read per output pixel */
+        int y0 = begin * a->tile_rows;
+        int y1 = end * a->tile_rows < seg->oh ? end * a->tile_rows : seg->oh;
+        for (int y = y0; y < y1; y++) {
+            int r = fy->first[seg->oy + y];
+            int sr = seg->sflip_y ? seg->sh - 1 - r : r;
+            const unsigned char *src = a->src + ((size_t)(seg->sy + sr) * a->src_width + seg->sx) * 4;
+            int dy = seg->flip_y ? seg->oh - 1 - y : y;
+            unsigned char *dst = a->dst + (size_t)dy * ow * a->bpp;
+            for (int x = 0; x < ow; x++) {
+                int c = fx->first[seg->ox + x];
+                int sc = seg->sflip_x ? seg->sw - 1 - c : c;
+                RayPy_Vec4 v = RayPy_PointOps(RayPy_Vec4_LoadPixel(src + sc * 4), pre, seg->npre);
+                v = RayPy_PointOps(RayPy_Vec4_Clamp255(v), post, a->post_in_place ? 0 : seg->npost);
+                RayPy_StoreFormat(dst + (size_t)(seg->flip_x ? ow - 1 - x : x) * a->bpp, v, a->format);
+            }
+            if (a->post_in_place)
+                RayPy_PointOps_InPlace(dst, ow, 0, 1, seg->point + seg->npre, seg->npost);
+        }
+        return;
+    }
+
+    for (int tile = begin; tile < end; tile++) {
+        int ty0 = tile * a->tile_rows;
+        int ty1 = ty0 + a->tile_rows < seg->oh ? ty0 + a->tile_rows : seg->oh;
+        int r0 = fy->first[seg->oy + ty0], r1 = 0;
+        for (int y = seg->oy + ty0; y < seg->oy + ty1; y++) {
+            if (fy->first[y] + fy->count[y] > r1)
+                r1 = fy->first[y] + fy->count[y];
+        }
+
+        /* a source row for the horizontal pass, an output row for the vertical one */
+        float *row = malloc(sizeof(float) * 4 * (c1 - c0 > ow ? c1 - c0 : ow));
+        float *hbuf = malloc(sizeof(float) * 4 * ow * (r1 - r0));
+        if (row == NULL || hbuf == NULL) {
+            free(row);
+            free(hbuf);
+            a->failed = 1;
+            return;
+        }
+
+        /* horizontal pass over the source rows this tile needs */
+        for (int r = r0; r < r1; r++) {
+            int sr = seg->sflip_y ? seg->sh - 1 - r : r;
+            const unsigned char *src = a->src + ((size_t)(seg->sy + sr) * a->src_width + seg->sx) * 4;
+            for (int c = c0; c < c1; c++) {
+                int sc = seg->sflip_x ? seg->sw - 1 - c : c;
+                RayPy_Vec4_StoreF(row + (c - c0) * 4,
+                                  RayPy_PointOps(RayPy_Vec4_LoadPixel(src + sc * 4), pre, seg->npre));
+            }
+            float *out = hbuf + (size_t)(r - r0) * ow * 4;
+            for (int x = 0; x < ow; x++) {
+                int rx = seg->ox + x;
+                const float *w = fx->weights + (size_t)rx * fx->taps;
+                const float *p = row + (fx->first[rx] - c0) * 4;
+                RayPy_Vec4 acc = RayPy_Vec4_Set1(0.0f);
+                for (int k = 0; k < fx->count[rx]; k++)
+                    acc = RayPy_Vec4_Add(acc, RayPy_Vec4_Scale(RayPy_Vec4_LoadF(p + k * 4), w[k]));
+                /* bicubic overshoots, clamp like the 8-bit intermediate of image_resize() */
+                RayPy_Vec4_StoreF(out + x * 4, RayPy_Vec4_Clamp255(acc));
+            }
+        }
+
+        /* vertical pass, post ops and store */
+        for (int y = ty0; y < ty1; y++) {
+            int ry = seg->oy + y;
+            const float *w = fy->weights + (size_t)ry * fy->taps;
+            const float *col = hbuf + (size_t)(fy->first[ry] - r0) * ow * 4;
+            int dy = seg->flip_y ? seg->oh - 1 - y : y;
+            unsigned char *dst = a->dst + (size_t)dy * ow * a->bpp;
+            for (int x = 0; x < ow; x++) {
+                RayPy_Vec4 acc = RayPy_Vec4_Set1(0.0f);
+                for (int k = 0; k < fy->count[ry]; k++)
+                    acc = RayPy_Vec4_Add(acc, RayPy_Vec4_Scale(RayPy_Vec4_LoadF(col + ((size_t)k * ow + x) * 4), w[k]));
+                RayPy_Vec4_StoreF(row + x * 4, RayPy_Vec4_Clamp255(acc));
+            }
+            if (a->post_in_place) {
+                RayPy_StoreRow(dst, row, ow, NULL, 0, seg->flip_x, a->format);
+                RayPy_PointOps_InPlace(dst, ow, 0, 1, seg->point + seg->npre, seg->npost);
+            }
+            else {
+                RayPy_StoreRow(dst, row, ow, post, seg->npost, seg->flip_x, a->format);
+            }
+        }
+        free(row);
+        free(hbuf);
+    }
+}
+
+/* Runs `seg` over image (R8G8B8A8) and replaces its pixels with the result in
+   `format` when that's one of the 8-bit ones, R8G8B8A8 otherwise */
+static int
+RayPy_Segment_Run(const RayPy_Segment *seg, Image *image, int format)
+{
+    RayPy_SegmentArgs a = {seg, image->data, image->width};
+    int ret = -1;
+    if (format != PIXELFORMAT_UNCOMPRESSED_R8G8B8 && format != PIXELFORMAT_UNCOMPRESSED_GRAY_ALPHA
+        && format != PIXELFORMAT_UNCOMPRESSED_GRAYSCALE)
+        format = PIXELFORMAT_UNCOMPRESSED_R8G8B8A8;
+    a.format = format;
+    a.bpp = GetPixelDataSize(1, 1, format);
+
+    if (RayPy_Segment_IsInPlace(seg, image, format)) {
+        RayPy_InPlaceArgs in_place = {seg, image->data, image->width};
+        RayPy_ParallelFor(RayPy_InPlaceRows, &in_place, seg->oh, 64);
+        return 0;
+    }
+
+    a.point = malloc(sizeof(RayPy_PointOp) * (seg->npre + seg->npost + 1));
+    if (a.point == NULL)
+        return -1;
+    for (int i = 0; i < seg->npre + seg->npost; i++)
+        RayPy_PointOp_Init(&a.point[i], &seg->point[i]);
+    a.post_in_place = format == PIXELFORMAT_UNCOMPRESSED_R8G8B8A8
+                      && RayPy_PointOps_AreInPlace(seg->point + seg->npre, seg->npost);
+
+    switch (seg->resample) {
+    case RAYPY_IMAGE_RESIZE:
+        if (RayPy_ResampleFilter_Init(&a.fx, seg->sw, seg->rw, 2.0, RayPy_CatmullRomKernel)
+            || RayPy_ResampleFilter_Init(&a.fy, seg->sh, seg->rh, 2.0, RayPy_CatmullRomKernel))
+            goto done;
+        break;
+    case RAYPY_IMAGE_RESIZE_BILINEAR:
+        if (RayPy_ResampleFilter_Init(&a.fx, seg->sw, seg->rw, 1.0, RayPy_TriangleKernel)
+            || RayPy_ResampleFilter_Init(&a.fy, seg->sh, seg->rh, 1.0, RayPy_TriangleKernel))
+            goto done;
+        break;
+    default: // nearest neighbor, or the identity without resampling
+        if (RayPy_ResampleFilter_InitNN(&a.fx, seg->sw, seg->rw)
+            || RayPy_ResampleFilter_InitNN(&a.fy, seg->sh, seg->rh))
+            goto done;
+        break;
+    }
+    a.dst = RL_MALLOC((size_t)seg->ow * seg->oh * a.bpp);
+    if (a.dst == NULL)
+        goto done;
+
+    /* enough output rows per tile that the source rows shared by neighbour
+       tiles (filter taps) are a small part of the work */
+    double scale = (double)seg->sh / seg->rh;
+    a.tile_rows = (int)ceil(4.0 * a.fy.taps / scale);
+    a.tile_rows = a.tile_rows < 8 ? 8 : a.tile_rows > 256 ? 256 : a.tile_rows;
+    RayPy_ParallelFor(RayPy_SegmentTiles, &a, (seg->oh + a.tile_rows - 1) / a.tile_rows, 1);
+    if (a.failed) {
+        RL_FREE(a.dst);
+        goto done;
+    }
+    RL_FREE(image->data);
+    image->data = a.dst;
+    image->width = seg->ow;
+    image->height = seg->oh;
+    image->format = format;
+    image->mipmaps = 1;
+    ret = 0;
+
+done:
+    RayPy_ResampleFilter_Free(&a.fx);
+    RayPy_ResampleFilter_Free(&a.fy);
+    free(a.point);
+    return ret;
+}
+
+/* Plans and runs a recorded pipeline, returns -1 when out of memory */
+static int
+RayPy_Pixels_ApplyPipeline(Image *image, const RayPy_ImageOp *ops, Py_ssize_t count)
+{
+    int format = image->format, ret = -1;
+    RayPy_Segment seg = {0};
+    seg.point = malloc(sizeof(RayPy_ImageOp) * (count * 2 + 1));
+    if (seg.point == NULL)
+        return -1;
+    if (RayPy_Pixels_Format(image, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8))
+        goto done;
+    RayPy_Segment_Init(&seg, image->width, image->height);
+
+    for (Py_ssize_t i = 0; i < count; i++) {
+        const RayPy_ImageOp *op = &ops[i];
+        switch (op->kind) {
+        case RAYPY_IMAGE_CROP: {
+            /* x/y are in flipped output space */
+            int x = seg.flip_x ? seg.ow - op->x - op->width : op->x;
+            int y = seg.flip_y ? seg.oh - op->y - op->height : op->y;
+            if (seg.resample < 0) {
+                seg.sx += x;
+                seg.sy += y;
+                seg.sw = seg.rw = seg.ow = op->width;
+                seg.sh = seg.rh = seg.oh = op->height;
+            }
+            else {
+                seg.ox += x;
+                seg.oy += y;
+                seg.ow = op->width;
+                seg.oh = op->height;
+            }
+            break;
+        }
+        case RAYPY_IMAGE_FLIP_VERTICAL:
+            seg.flip_y = !seg.flip_y;
+            break;
+        case RAYPY_IMAGE_FLIP_HORIZONTAL:
+            seg.flip_x = !seg.flip_x;
+            break;
+        case RAYPY_IMAGE_RESIZE:
+        case RAYPY_IMAGE_RESIZE_BILINEAR:
+        case RAYPY_IMAGE_RESIZE_NN:
+            if (seg.resample >= 0) {
+                if (RayPy_Segment_Run(&seg, image, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8))
+                    goto done;
+                RayPy_Segment_Init(&seg, image->width, image->height);
+            }
+            seg.resample = op->kind;
+            seg.sflip_x = seg.flip_x;
+            seg.sflip_y = seg.flip_y;
+            seg.flip_x = seg.flip_y = 0;
+            seg.rw = seg.ow = op->width;
+            seg.rh = seg.oh = op->height;
+            break;
+        default:
+            if (op->kind == RAYPY_IMAGE_FORMAT)
+                format = op->format;
+            seg.point[seg.npre + seg.npost] = *op;
+            /* the eager functions convert back to the image format after each
+               operation, keep dropping the channels it doesn't have */
+            if (op->kind != RAYPY_IMAGE_FORMAT && format != PIXELFORMAT_UNCOMPRESSED_R8G8B8A8) {
+                RayPy_ImageOp *back = &seg.point[seg.npre + seg.npost + 1];
+                *back = (RayPy_ImageOp){RAYPY_IMAGE_FORMAT};
+                back->format = format;
+                if (seg.resample < 0)
+                    seg.npre++;
+                else
+                    seg.npost++;
+            }
+            if (seg.resample < 0)
+                seg.npre++;
+            else
+                seg.npost++;
+            break;
+        }
+    }
+
+    if ((!RayPy_Segment_IsWhole(&seg, image->width, image->height) || seg.npre + seg.npost > 0)
+        && RayPy_Segment_Run(&seg, image, format))
+        goto done;
+    ret = RayPy_Pixels_Format(image, format);
+
+done:
+    free(seg.point);
+    return ret;
+}
+
+typedef struct {
+    PyObject_HEAD RayPy_ImageObject *image;
+    RayPy_ImageOp *ops;
+    Py_ssize_t count, capacity;
+    int src_width, src_height; // image size when lazy() was called
+    int width, height;         // result size so far
+} RayPy_ImagePipelineObject;
+
+static void
+RayPy_ImagePipeline_dealloc(RayPy_ImagePipelineObject *self)
+{
+    Py_XDECREF(self->image);
+    PyMem_Free(self->ops);
+    PyTypeObject *tp = Py_TYPE(self);
+    tp->tp_free((PyObject *)self);
+    Py_DECREF(tp);
+}
+
+static PyObject *
+RayPy_Image_Lazy(RayPy_ImageObject *self, PyObject *Py_UNUSED(args))
+{
+    if (RayPy_Image_Claim(self))
+        return NULL;
+    RayPy_Image_Release(self);
+    RayPy_ImagePipelineObject *ret = PyObject_New(RayPy_ImagePipelineObject, &RayPy_ImagePipeline_Type);
+    if (ret == NULL)
+        return NULL;
+    Py_INCREF(self);
+    ret->image = self;
+    ret->ops = NULL;
+    ret->count = ret->capacity = 0;
+    ret->src_width = ret->width = self->i.width;
+    ret->src_height = ret->height = self->i.height;
+    return (PyObject *)ret;
+}
+
+/* Records `op` and returns self for chaining */
+static PyObject *
+RayPy_ImagePipeline_Push(RayPy_ImagePipelineObject *self, const RayPy_ImageOp *op)
+{
+    int err = 0;
+    Py_BEGIN_CRITICAL_SECTION(self);
+    if (self->count == self->capacity) {
+        Py_ssize_t capacity = self->capacity ? self->capacity * 2 : 8;
+        RayPy_ImageOp *ops = PyMem_Realloc(self->ops, sizeof(RayPy_ImageOp) * capacity);
+        if (ops != NULL) {
+            self->ops = ops;
+            self->capacity = capacity;
+        }
+        err = ops == NULL;
+    }
+    if (!err)
+        self->ops[self->count++] = *op;
+    Py_END_CRITICAL_SECTION();
+    if (err)
+        return PyErr_NoMemory();
+    Py_INCREF(self);
+    return (PyObject *)self;
+}
+
+static PyObject *
+RayPy_ImagePipeline_ResizeWith(RayPy_ImagePipelineObject *self, PyObject *args, int kind)
+{
+    RayPy_ImageOp op = {kind};
+    if (!PyArg_ParseTuple(args, "ii", &op.width, &op.height))
+        return NULL;
+    if (RayPy_CheckImageSize(op.width, op.height))
+        return NULL;
+    self->width = op.width;
+    self->height = op.height;
+    return RayPy_ImagePipeline_Push(self, &op);
+}
+
+static PyObject *
+RayPy_ImagePipeline_resize(RayPy_ImagePipelineObject *self, PyObject *args)
+{
+    return RayPy_ImagePipeline_ResizeWith(self, args, RAYPY_IMAGE_RESIZE);
+}
+
+static PyObject *
+RayPy_ImagePipeline_resize_bilinear(RayPy_ImagePipelineObject *self, PyObject *args)
+{
+    return RayPy_ImagePipeline_ResizeWith(self, args, RAYPY_IMAGE_RESIZE_BILINEAR);
+}
+
+static PyObject *
+RayPy_ImagePipeline_resize_nn(RayPy_ImagePipelineObject *self, PyObject *args)
+{
+    return RayPy_ImagePipeline_ResizeWith(self, args, RAYPY_IMAGE_RESIZE_NN);
+}
+
+static PyObject *
+RayPy_ImagePipeline_crop(RayPy_ImagePipelineObject *self, PyObject *arg)
+{
+    RayPy_ImageOp op = {RAYPY_IMAGE_CROP};
+    if (!PyObject_TypeCheck(arg, &RayPy_Rectangle_Type)) {
+        PyErr_Format(PyExc_TypeError, "argument must be raypy.Rectangle, not %s",
+                     Py_TYPE(arg)->tp_name);
+        return NULL;
+    }
+    RayPy_RectangleObject *crop = (RayPy_RectangleObject *)arg;
+    float x0 = crop->x > 0 ? crop->x : 0, y0 = crop->y > 0 ? crop->y : 0;
+    float x1 = crop->x + crop->width, y1 = crop->y + crop->height;
+    if (x1 > self->width)
+        x1 = (float)self->width;
+    if (y1 > self->height)
+        y1 = (float)self->height;
+    op.x = (int)x0;
+    op.y = (int)y0;
+    op.width = (int)x1 - op.x;
+    op.height = (int)y1 - op.y;
+    if (op.width <= 0 || op.height <= 0) {
+        PyErr_SetString(PyExc_ValueError, "crop rectangle is outside of the image");
+        return NULL;
+    }
+    self->width = op.width;
+    self->height = op.height;
+    return RayPy_ImagePipeline_Push(self, &op);
+}
+
+static PyObject *
+RayPy_ImagePipeline_flip_vertical(RayPy_ImagePipelineObject *self, PyObject *Py_UNUSED(args))
+{
+    RayPy_ImageOp op = {RAYPY_IMAGE_FLIP_VERTICAL};
+    return RayPy_ImagePipeline_Push(self, &op);
+}
+
+static PyObject *
+RayPy_ImagePipeline_flip_horizontal(RayPy_ImagePipelineObject *self, PyObject *Py_UNUSED(args))
+{
+    RayPy_ImageOp op = {RAYPY_IMAGE_FLIP_HORIZONTAL};
+    return RayPy_ImagePipeline_Push(self, &op);
+}
+
+static PyObject *
+RayPy_ImagePipeline_tint(RayPy_ImagePipelineObject *self, PyObject *arg)
+{
+    RayPy_ImageOp op = {RAYPY_IMAGE_COLOR_TINT};
+    if (!PyObject_TypeCheck(arg, &RayPy_Color_Type)) {
+        PyErr_Format(PyExc_TypeError, "argument must be raypy.Color, not %s",
+                     Py_TYPE(arg)->tp_name);
+        return NULL;
+    }
+    op.color = RayPy_Color_AsColor((RayPy_ColorObject *)arg);
+    return RayPy_ImagePipeline_Push(self, &op);
+}
+
+static PyObject *
+RayPy_ImagePipeline_premultiply(RayPy_ImagePipelineObject *self, PyObject *Py_UNUSED(args))
+{
+    RayPy_ImageOp op = {RAYPY_IMAGE_ALPHA_PREMULTIPLY};
+    return RayPy_ImagePipeline_Push(self, &op);
+}
+
+static PyObject *
+RayPy_ImagePipeline_to_format(RayPy_ImagePipelineObject *self, PyObject *arg)
+{
+    RayPy_ImageOp op = {RAYPY_IMAGE_FORMAT};
+    op.format = PyLong_AsLong(arg);
+    METH_O_TYPE_ERROR(arg, "int");
+    if (op.format < PIXELFORMAT_UNCOMPRESSED_GRAYSCALE
+        || op.format > PIXELFORMAT_UNCOMPRESSED_R16G16B16A16) {
+        PyErr_Format(PyExc_ValueError, "invalid uncompressed pixel format: %d", op.format);
+        return NULL;
+    }
+    return RayPy_ImagePipeline_Push(self, &op);
+}
+
+static PyObject *
+RayPy_ImagePipeline_apply(RayPy_ImagePipelineObject *self, PyObject *Py_UNUSED(args))
+{
+    RayPy_ImageObject *image = self->image;
+    RayPy_ImageOp *ops;
+    Py_ssize_t count;
+    int err;
+    if (RayPy_Image_Claim(image))
+        return NULL;
+    if (image->i.width != self->src_width || image->i.height != self->src_height) {
+        PyErr_SetString(PyExc_ValueError, "image size changed since lazy() was called");
+        goto error;
+    }
+    if (image->i.format >= PIXELFORMAT_COMPRESSED_DXT1_RGB) {
+        PyErr_SetString(PyExc_ValueError, "compressed images are not supported");
+        goto error;
+    }
+    if (RayPy_Pool_Start())
+        goto error;
+    /* taken out, ops recorded from other threads meanwhile are for the next apply() */
+    Py_BEGIN_CRITICAL_SECTION(self);
+    ops = self->ops;
+    count = self->count;
+    self->ops = NULL;
+    self->count = self->capacity = 0;
+    Py_END_CRITICAL_SECTION();
+    Py_BEGIN_ALLOW_THREADS
+    err = RayPy_Pixels_ApplyPipeline(&image->i, ops, count);
+    Py_END_ALLOW_THREADS
+    PyMem_Free(ops);
+    /* start over from the result */
+    self->src_width = self->width = image->i.width;
+    self->src_height = self->height = image->i.height;
+    RayPy_Image_Release(image);
+    if (err)
+        return PyErr_NoMemory();
+    Py_RETURN_NONE;
+
+error:
+    RayPy_Image_Release(image);
+    return NULL;
+}
+
+static PyObject *
+RayPy_ImagePipeline_get_width(RayPy_ImagePipelineObject *self, void *Py_UNUSED(closure))
+{
+    return PyLong_FromLong(self->width);
+}
+
+static PyObject *
+RayPy_ImagePipeline_get_height(RayPy_ImagePipelineObject *self, void *Py_UNUSED(closure))
+{
+    return PyLong_FromLong(self->height);
+}
+
+static PyMethodDef RayPy_ImagePipeline_methods[] = {
+    {"resize", (PyCFunction)RayPy_ImagePipeline_resize, METH_VARARGS, "Resize (Bicubic scaling algorithm)"},
+    {"resize_bilinear", (PyCFunction)RayPy_ImagePipeline_resize_bilinear, METH_VARARGS, "Resize (Bilinear scaling algorithm)"},
+    {"resize_nn", (PyCFunction)RayPy_ImagePipeline_resize_nn, METH_VARARGS, "Resize (Nearest-Neighbor scaling algorithm)"},
+    {"crop", (PyCFunction)RayPy_ImagePipeline_crop, METH_O, "Crop to a defined rectangle"},
+    {"flip_vertical", (PyCFunction)RayPy_ImagePipeline_flip_vertical, METH_NOARGS, "Flip vertically"},
+    {"flip_horizontal", (PyCFunction)RayPy_ImagePipeline_flip_horizontal, METH_NOARGS, "Flip horizontally"},
+    {"tint", (PyCFunction)RayPy_ImagePipeline_tint, METH_O, "Modify color: tint"},
+    {"premultiply", (PyCFunction)RayPy_ImagePipeline_premultiply, METH_NOARGS, "Premultiply alpha channel"},
+    {"to_format", (PyCFunction)RayPy_ImagePipeline_to_format, METH_O, "Convert to the given PixelFormat"},
+    {"apply", (PyCFunction)RayPy_ImagePipeline_apply, METH_NOARGS, "Run the recorded operations on the image in a single pass and clear them"},
+    {NULL}
+};
+
+static PyGetSetDef RayPy_ImagePipeline_getset[] = {
+    {"width", (getter)RayPy_ImagePipeline_get_width, NULL, "Width of the result", NULL},
+    {"height", (getter)RayPy_ImagePipeline_get_height, NULL, "Height of the result", NULL},
+    {NULL}
+};
+
+static PyType_Slot RayPy_ImagePipeline_slots[] = {
+    {Py_tp_doc, PyDoc_STR("ImagePipeline, image operations recorded by Image.lazy() and fused by apply()")},
+    {Py_tp_dealloc, RayPy_ImagePipeline_dealloc},
+    {Py_tp_methods, RayPy_ImagePipeline_methods},
+    {Py_tp_getset, RayPy_ImagePipeline_getset},
+    {0, NULL},
+};
+
+static PyType_Spec RayPy_ImagePipeline_spec = {
+    .name = "raypy.ImagePipeline",
+    .basicsize = sizeof(RayPy_ImagePipelineObject),
+    .itemsize = 0,
+    .flags = Py_TPFLAGS_DEFAULT | Py_TPFLAGS_IMMUTABLETYPE | Py_TPFLAGS_DISALLOW_INSTANTIATION,
+    .slots = RayPy_ImagePipeline_slots,
+};
+
+/* Texture */
+
+typedef struct {
+    PyObject_HEAD Texture t;
+} RayPy_TextureObject;
+
+static void
+RayPy_Texture_dealloc(RayPy_TextureObject *self)
+{
+    PyTypeObject *tp = Py_TYPE(self);
+    tp->tp_free((PyObject *)self);
+    Py_DECREF(tp);
+}
+
+static RayPy_TextureObject *
+RayPy_Texture_new(PyTypeObject *type, PyObject *Py_UNUSED(args), PyObject *Py_UNUSED(kwds)) {
+    RayPy_TextureObject *self = (RayPy_TextureObject *)type->tp_alloc(type, 0);
+    if (self == NULL)
+        return NULL;
+    return self;
+}
+
+static int
+RayPy_Texture_init(RayPy_TextureObject *self, PyObject *args, PyObject *Py_UNUSED(kwds))
+{
+    PyErr_SetString(PyExc_TypeError,
+                        "raypy.Texture cannot be instantiated directly from"
+                        " Python. Use the provided module-level functions"
+                        " instead.");
+    return -1;
+}
+
+static PyMemberDef RayPy_Texture_members[] = {
+    {"id", Py_T_UINT, offsetof(RayPy_TextureObject, t.id), 0, "OpenGL texture id"},
+    {"width", Py_T_INT, offsetof(RayPy_TextureObject, t.width), Py_READONLY, "Texture base width"},
+    {"height", Py_T_INT, offsetof(RayPy_TextureObject, t.height), Py_READONLY, "Texture base height"},
+    {"mipmaps", Py_T_INT, offsetof(RayPy_TextureObject, t.mipmaps), Py_READONLY, "Mipmap levels, 1 by default"},
+    {"format", Py_T_INT, offsetof(RayPy_TextureObject, t.format), Py_READONLY, "Data format (PixelFormat type)"},
+    {NULL}
+};
+
+static PyType_Slot RayPy_Texture_slots[] = {
+    {Py_tp_doc, "Texture, tex data stored in GPU memory (VRAM)"},
+    {Py_tp_new, RayPy_Texture_new},
+    {Py_tp_init, RayPy_Texture_init},
+    {Py_tp_dealloc, RayPy_Texture_dealloc},
+    {Py_tp_members, RayPy_Texture_members},
+    {0, NULL},
+};
+
+static PyType_Spec RayPy_Texture_spec = {
+    .name = "raypy.Texture",
+    .basicsize = sizeof(RayPy_TextureObject),
+    .itemsize = 0,
+    .flags = Py_TPFLAGS_DEFAULT | Py_TPFLAGS_BASETYPE | Py_TPFLAGS_IMMUTABLETYPE,
+    .slots = RayPy_Texture_slots,
+};
+
+/* LoadTexture() with the file decoded without the GIL, mipmaps builds the
+   chain on the worker threads first. Returns -1 with an exception set when
+   out of memory, a texture that failed to load has an id of 0 */
+static int
+RayPy_Texture_Load(const char *fileName, int mipmaps, Texture *texture)
+{
+    Image image;
+    int err = 0;
+    if (mipmaps && RayPy_Pool_Start())
+        return -1;
+    Py_BEGIN_ALLOW_THREADS
+    image = LoadImage(fileName);
+    if (mipmaps && image.data != NULL && image.format < PIXELFORMAT_COMPRESSED_DXT1_RGB && image.mipmaps == 1)
+        err = RayPy_Pixels_Mipmaps(&image);
+    Py_END_ALLOW_THREADS
+    if (err) {
+        UnloadImage(image);
+        PyErr_NoMemory();
+        return -1;
+    }
+    /* only the upload needs the GL thread */
+    *texture = image.data != NULL ? LoadTextureFromImage(image) : (Texture){0};
+    UnloadImage(image);
+    return 0;
+}
+
+static PyObject *
+RayPy_LoadTexture(PyObject *Py_UNUSED(self), PyObject *args, PyObject *keywds)
+{
+    const char *fileName;
+    RayPy_TextureObject *ret;
+    int mipmaps = 0;
+    Texture texture;
+    if (!PyArg_ParseTuple(args, "s|p", &fileName, &mipmaps))
+        return NULL;
+    IS_RENDER_THREAD();
+    if (RayPy_Texture_Load(fileName, mipmaps, &texture))
+        return NULL;
+    ret = PyObject_New(RayPy_TextureObject, &RayPy_Texture_Type);
+    ret->t = texture;
+    return (PyObject *)ret;
+}
+
+static PyObject *
+RayPy_LoadTextureFromImage(PyObject *Py_UNUSED(self), PyObject *args)
+{
+    RayPy_ImageObject *image;
+    RayPy_TextureObject *ret;
+    if (!PyArg_ParseTuple(args, "O!", &RayPy_Image_Type, &image))
+        return NULL;
+    WINDOW_IS_READY();
+    if (RayPy_Image_Claim(image))
+        return NULL;
+    ret = PyObject_New(RayPy_TextureObject, &RayPy_Texture_Type);
+    if (ret != NULL)
+        ret->t = LoadTextureFromImage(image->i);
+    RayPy_Image_Release(image);
+    return (PyObject *)ret;
+}
+
+PyDoc_STRVAR(load_texture_from_image_doc, "Load texture from image data, with all its mipmaps");
+
+static PyObject *
+RayPy_DrawTexture(PyObject *self, PyObject *const *args, Py_ssize_t nargs)
+{
+    RayPy_TextureObject *texture;
+    int posX, posY;
+    RayPy_ColorObject *tint;
+    IS_RENDER_THREAD();
+    if (nargs != 4) {
+        RayPyErr_ArgsNumberError(4, nargs);
+        return NULL;
+    }
+    if (!PyType_IsSubtype(Py_TYPE(args[0]), &RayPy_Texture_Type)) {
+        RayPyErr_ArgTypeError(0, &RayPy_Texture_Type, args);
+        return NULL;
+    }
+    texture = (RayPy_TextureObject *)args[0];
+    posX = PyLong_AsLong(args[1]);
+    if (PyErr_Occurred()) {
+        PyErr_Clear();
+        RayPyErr_ArgTypeError(1, &RayPy_Texture_Type, args);
+        return NULL;
+    }
+    posY = PyLong_AsLong(args[2]);
+    if (PyErr_Occurred()) {
+        PyErr_Clear();
+        RayPyErr_ArgTypeError(2, &RayPy_Texture_Type, args);
+        return NULL;
+    }
+    if (!PyType_IsSubtype(Py_TYPE(args[3]), &RayPy_Color_Type)) {
+        RayPyErr_ArgTypeError(3, &RayPy_Texture_Type, args);
+        return NULL;
+    }
+    tint = (RayPy_ColorObject *)args[3];
+    DrawTexture(texture->t, posX, posY, RayPy_Color_AsColor(tint));
+    Py_RETURN_NONE;
+}
+
+static PyObject *
+RayPy_UnloadTexture(PyObject *Py_UNUSED(self), PyObject *args, PyObject *keywds)
+{
+    RayPy_TextureObject *texture;
+    if (!PyArg_ParseTuple(args, "O!", &RayPy_Texture_Type, &texture))
+        return NULL;
+    IS_RENDER_THREAD();
+    UnloadTexture(texture->t);
+    Py_RETURN_NONE;
+}
+
+static PyObject *
+RayPy_GenTextureMipmaps(PyObject *Py_UNUSED(self), PyObject *args)
+{
+    RayPy_TextureObject *texture;
+    if (!PyArg_ParseTuple(args, "O!", &RayPy_Texture_Type, &texture))
+        return NULL;
+    WINDOW_IS_READY();
+    GenTextureMipmaps(&texture->t);
+    Py_RETURN_NONE;
+}
+
+PyDoc_STRVAR(gen_texture_mipmaps_doc, "Generate GPU mipmaps for a texture");
+
+static PyObject *
+RayPy_SetTextureFilter(PyObject *Py_UNUSED(self), PyObject *args)
+{
+    RayPy_TextureObject *texture;
+    int filter;
+    if (!PyArg_ParseTuple(args, "O!i", &RayPy_Texture_Type, &texture, &filter))
+        return NULL;
+    WINDOW_IS_READY();
+    if (filter < TEXTURE_FILTER_POINT || filter > TEXTURE_FILTER_ANISOTROPIC_16X)
+        return PyErr_Format(PyExc_ValueError, "invalid texture filter: %d", filter);
+    SetTextureFilter(texture->t, filter);
+    Py_RETURN_NONE;
+}
+
+PyDoc_STRVAR(set_texture_filter_doc, "Set texture scaling filter mode");
+
+static PyObject *
+RayPy_SetTextureWrap(PyObject *Py_UNUSED(self), PyObject *args)
+{
+    RayPy_TextureObject *texture;
+    int wrap;
+    if (!PyArg_ParseTuple(args, "O!i", &RayPy_Texture_Type, &texture, &wrap))
+        return NULL;
+    WINDOW_IS_READY();
+    if (wrap < TEXTURE_WRAP_REPEAT || wrap > TEXTURE_WRAP_MIRROR_CLAMP)
+        return PyErr_Format(PyExc_ValueError, "invalid texture wrap mode: %d", wrap);
+    SetTextureWrap(texture->t, wrap);
+    Py_RETURN_NONE;
+}
+
+PyDoc_STRVAR(set_texture_wrap_doc, "Set texture wrapping mode");
+
+/* Texture cache
+
+   Textures keyed by path (or any hashable asset id with a loader), kept
+   under a VRAM budget by unloading the least recently used ones. Textures
+   got since the last end_drawing() and pinned ones are never evicted, the
+   budget is exceeded instead (over_budget). Evicted entries keep their
+   Texture object with an id of 0 and get() reloads into that same object. */
+
+/* VRAM taken by a texture and its mipmaps */
+static size_t
+RayPy_Texture_Size(Texture t)
+{
+    size_t size = 0;
+    int w = t.width, h = t.height;
+    for (int level = 0; level < t.mipmaps; level++) {
+        size += (size_t)GetPixelDataSize(w, h, t.format);
+        w = w > 1 ? w / 2 : 1;
+        h = h > 1 ? h / 2 : 1;
+    }
+    return size;
+}
+
+typedef struct RayPy_TextureCacheEntryObject {
+    PyObject_HEAD RayPy_TextureObject *texture;
+    size_t size;
+    int resident;
+    Py_ssize_t pins;          // pin() calls not undone by unpin()
+    unsigned long long frame; // RayPy_frame_count when last got
+    /* resident entries, most recently used first */
+    struct RayPy_TextureCacheEntryObject *prev, *next;
+} RayPy_TextureCacheEntryObject;
+
+static void
+RayPy_TextureCacheEntry_dealloc(RayPy_TextureCacheEntryObject *self)
+{
+    Py_XDECREF(self->texture);
+    PyTypeObject *tp = Py_TYPE(self);
+    tp->tp_free((PyObject *)self);
+    Py_DECREF(tp);
+}
+
+static PyType_Slot RayPy_TextureCacheEntry_slots[] = {
+    {Py_tp_dealloc, RayPy_TextureCacheEntry_dealloc},
+    {0, NULL},
+};
+
+static PyType_Spec RayPy_TextureCacheEntry_spec = {
+    .name = "raypy._TextureCacheEntry",
+    .basicsize = sizeof(RayPy_TextureCacheEntryObject),
+    .itemsize = 0,
+    .flags = Py_TPFLAGS_DEFAULT | Py_TPFLAGS_IMMUTABLETYPE | Py_TPFLAGS_DISALLOW_INSTANTIATION,
+    .slots = RayPy_TextureCacheEntry_slots,
+};
+
+typedef struct {
+    PyObject_HEAD PyObject *entries; // key -> entry, resident or not
+    PyObject *loader;                // NULL: load_texture(key)
+    int mipmaps;
+    RayPy_TextureCacheEntryObject *head, *tail;
+    unsigned long long budget, used;
+    Py_ssize_t resident;
+    unsigned long long hits, misses, evictions;
+} RayPy_TextureCacheObject;
+
+static void
+RayPy_TextureCache_Unlink(RayPy_TextureCacheObject *self, RayPy_TextureCacheEntryObject *entry)
+{
+    if (entry->prev != NULL)
+        entry->prev->next = entry->next;
+    else
+        self->head = entry->next;
+    if (entry->next != NULL)
+        entry->next->prev = entry->prev;
+    else
+        self->tail = entry->prev;
+    entry->prev = entry->next = NULL;
+}
+
+static void
+RayPy_TextureCache_PushFront(RayPy_TextureCacheObject *self, RayPy_TextureCacheEntryObject *entry)
+{
+    entry->prev = NULL;
+    entry->next = self->head;
+    if (self->head != NULL)
+        self->head->prev = entry;
+    else
+        self->tail = entry;
+    self->head = entry;
+}
+
+/* unloads the texture of a resident entry, the GL context must be alive */
+static void
+RayPy_TextureCache_Unload(RayPy_TextureCacheObject *self, RayPy_TextureCacheEntryObject *entry)
+{
+    RayPy_TextureCache_Unlink(self, entry);
+    UnloadTexture(entry->texture->t);
+    entry->texture->t.id = 0;
+    entry->resident = 0;
+    self->used -= entry->size;
+    self->resident--;
+}
+
+/* evicts least recently used textures until under budget, keeping `keep`,
+   the pinned ones and the ones in use this frame */
+static void
+RayPy_TextureCache_Trim(RayPy_TextureCacheObject *self, RayPy_TextureCacheEntryObject *keep)
+{
+    if (self->budget == 0 || self->used <= self->budget)
+        return;
+    /* draws of this frame may still be batched with the textures about to go */
+    rlDrawRenderBatchActive();
+    RayPy_TextureCacheEntryObject *entry = self->tail;
+    while (self->used > self->budget && entry != NULL) {
+        RayPy_TextureCacheEntryObject *prev = entry->prev;
+        if (entry != keep && entry->pins == 0 && entry->frame != RayPy_frame_count) {
+            RayPy_TextureCache_Unload(self, entry);
+            self->evictions++;
+        }
+        entry = prev;
+    }
+}
+
+/* unloads every resident texture, entries are dropped too when forget is set.
+   Off the render thread the textures are unloaded at the next begin_drawing(). */
+static void
+RayPy_TextureCache_Clear(RayPy_TextureCacheObject *self, int forget)
+{
+    int unload = IsWindowReady() && !RayPy_OffRenderThread();
+    if (unload && self->head != NULL)
+        rlDrawRenderBatchActive();
+    while (self->head != NULL) {
+        RayPy_TextureCacheEntryObject *entry = self->head;
+        if (unload) {
+            RayPy_TextureCache_Unload(self, entry);
+        }
+        else {
+            RayPy_TextureCache_Unlink(self, entry);
+            RayPy_GL_Release(RAYPY_GL_TEXTURE, entry->texture->t.id);
+            entry->texture->t.id = 0;
+            entry->resident = 0;
+        }
+    }
+    self->used = 0;
+    self->resident = 0;
+    if (forget && self->entries != NULL)
+        PyDict_Clear(self->entries);
+}
+
+static int
+RayPy_TextureCache_traverse(RayPy_TextureCacheObject *self, visitproc visit, void *arg)
+{
+    Py_VISIT(Py_TYPE(self));
+    Py_VISIT(self->entries);
+    Py_VISIT(self->loader);
+    return 0;
+}
+
+static int
+RayPy_TextureCache_clear(RayPy_TextureCacheObject *self)
+{
+    Py_CLEAR(self->loader);
+    return 0;
+}
+
+static void
+RayPy_TextureCache_dealloc(RayPy_TextureCacheObject *self)
+{
+    PyObject_GC_UnTrack(self);
+    RayPy_TextureCache_Clear(self, 0);
+    Py_XDECREF(self->entries);
+    Py_XDECREF(self->loader);
+    PyTypeObject *tp = Py_TYPE(self);
+    tp->tp_free((PyObject *)self);
+    Py_DECREF(tp);
+}
+
+static RayPy_TextureCacheObject *
+RayPy_TextureCache_new(PyTypeObject *type, PyObject *Py_UNUSED(args), PyObject *Py_UNUSED(kwds))
+{
+    RayPy_TextureCacheObject *self = (RayPy_TextureCacheObject *)type->tp_alloc(type, 0);
+    if (self == NULL)
+        return NULL;
+    self->entries = PyDict_New();
+    if (self->entries == NULL) {
+        Py_DECREF(self);
+        return NULL;
+    }
+    return self;
+}
+
+static int
+RayPy_TextureCache_init(RayPy_TextureCacheObject *self, PyObject *args, PyObject *kwds)
+{
+    long long budget = 0;
+    PyObject *loader = Py_None;
+    int mipmaps = 0;
+    static char *kwlist[] = {"budget", "loader", "mipmaps", NULL};
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "|LO$p", kwlist, &budget, &loader, &mipmaps))
+        return -1;
+    if (budget < 0) {
+        PyErr_SetString(PyExc_ValueError, "budget must be >= 0");
+        return -1;
+    }
+    if (loader != Py_None && !PyCallable_Check(loader)) {
+        PyErr_SetString(PyExc_TypeError, "loader must be callable or None");
+        return -1;
+    }
+    Py_XSETREF(self->loader, loader != Py_None ? Py_NewRef(loader) : NULL);
+    self->budget = (unsigned long long)budget;
+    self->mipmaps = mipmaps;
+    return 0;
+}
+
+static PyObject *
+RayPy_TextureCache_get(RayPy_TextureCacheObject *self, PyObject *key)
+{
+    RayPy_TextureCacheEntryObject *entry;
+    RayPy_TextureObject *loaded = NULL;
+    Texture texture;
+
+    /* the LRU list is only ever touched from the render thread, no locking needed */
+    IS_RENDER_THREAD();
+    entry = (RayPy_TextureCacheEntryObject *)PyDict_GetItemWithError(self->entries, key);
+    if (entry == NULL && PyErr_Occurred())
+        return NULL;
+    if (entry != NULL && entry->resident) {
+        self->hits++;
+        entry->frame = RayPy_frame_count;
+        if (entry != self->head) {
+            RayPy_TextureCache_Unlink(self, entry);
+            RayPy_TextureCache_PushFront(self, entry);
+        }
+        return Py_NewRef(entry->texture);
+    }
+
+    WINDOW_IS_READY();
+    if (self->loader != NULL) {
+        loaded = (RayPy_TextureObject *)PyObject_CallOneArg(self->loader, key);
+        if (loaded == NULL)
+            return NULL;
+        if (!PyObject_TypeCheck(loaded, &RayPy_Texture_Type)) {
+            PyErr_Format(PyExc_TypeError, "loader must return a Texture, not %.200s",
+                         Py_TYPE(loaded)->tp_name);
+            Py_DECREF(loaded);
+            return NULL;
+        }
+        texture = loaded->t;
+    }
+    else {
+        const char *fileName = PyUnicode_Check(key) ? PyUnicode_AsUTF8(key) : NULL;
+        if (fileName == NULL) {
+            if (!PyErr_Occurred())
+                PyErr_Format(PyExc_TypeError, "key must be a file name without a loader, not %.200s",
+                             Py_TYPE(key)->tp_name);
+            return NULL;
+        }
+        if (RayPy_Texture_Load(fileName, self->mipmaps, &texture))
+            return NULL;
+    }
+    if (texture.id == 0) {
+        Py_XDECREF(loaded);
+        return PyErr_Format(PyExc_OSError, "failed to load texture %R", key);
+    }
+    self->misses++;
+
+    /* the loader may have used the cache, look the key up again */
+    entry = (RayPy_TextureCacheEntryObject *)PyDict_GetItemWithError(self->entries, key);
+    if (entry == NULL) {
+        if (PyErr_Occurred())
+            goto error;
+        entry = PyObject_New(RayPy_TextureCacheEntryObject, &RayPy_TextureCacheEntry_Type);
+        if (entry == NULL)
+            goto error;
+        entry->texture = loaded != NULL ? (RayPy_TextureObject *)Py_NewRef(loaded)
+                                        : PyObject_New(RayPy_TextureObject, &RayPy_Texture_Type);
+        entry->resident = 0;
+        entry->pins = 0;
+        entry->prev = entry->next = NULL;
+        if (entry->texture == NULL || PyDict_SetItem(self->entries, key, (PyObject *)entry)) {
+            Py_DECREF(entry);
+            goto error;
+        }
+        Py_DECREF(entry); // the dict holds it
+    }
+    else if (entry->resident) {
+        /* loaded twice, keep the first */
+        if (entry->texture->t.id != texture.id)
+            UnloadTexture(texture);
+        entry->frame = RayPy_frame_count;
+        Py_XDECREF(loaded);
+        return Py_NewRef(entry->texture);
+    }
+    Py_XDECREF(loaded);
+
+    entry->texture->t = texture;
+    entry->size = RayPy_Texture_Size(texture);
+    entry->resident = 1;
+    entry->frame = RayPy_frame_count;
+    RayPy_TextureCache_PushFront(self, entry);
+    self->used += entry->size;
+    self->resident++;
+    RayPy_TextureCache_Trim(self, entry);
+    return Py_NewRef(entry->texture);
+
+error:
+    if (loaded == NULL || loaded->t.id == texture.id)
+        UnloadTexture(texture);
+    Py_XDECREF(loaded);
+    return NULL;
+}
+
+static PyObject *
+RayPy_TextureCache_pin(RayPy_TextureCacheObject *self, PyObject *key)
+{
+    PyObject *texture = RayPy_TextureCache_get(self, key);
+    if (texture == NULL)
+        return NULL;
+    /* get() left the entry resident, and in the dict unless the loader removed it */
+    RayPy_TextureCacheEntryObject *entry =
+        (RayPy_TextureCacheEntryObject *)PyDict_GetItemWithError(self->entries, key);
+    if (entry == NULL) {
+        if (!PyErr_Occurred())
+            PyErr_SetObject(PyExc_KeyError, key);
+        Py_DECREF(texture);
+        return NULL;
+    }
+    entry->pins++;
+    return texture;
+}
+
+static PyObject *
+RayPy_TextureCache_unpin(RayPy_TextureCacheObject *self, PyObject *key)
+{
+    RayPy_TextureCacheEntryObject *entry;
+    IS_RENDER_THREAD();
+    entry = (RayPy_TextureCacheEntryObject *)PyDict_GetItemWithError(self->entries, key);
+    if (entry == NULL) {
+        if (!PyErr_Occurred())
+            PyErr_SetObject(PyExc_KeyError, key);
+        return NULL;
+    }
+    if (entry->pins == 0)
+        return PyErr_Format(PyExc_ValueError, "texture %R is not pinned", key);
+    entry->pins--;
+    Py_RETURN_NONE;
+}
+
+static PyObject *
+RayPy_TextureCache_remove(RayPy_TextureCacheObject *self, PyObject *key)
+{
+    RayPy_TextureCacheEntryObject *entry;
+    IS_RENDER_THREAD();
+    entry = (RayPy_TextureCacheEntryObject *)PyDict_GetItemWithError(self->entries, key);
+    if (entry == NULL) {
+        if (!PyErr_Occurred())
+            PyErr_SetObject(PyExc_KeyError, key);
+        return NULL;
+    }
+    if (entry->resident) {
+        WINDOW_IS_READY();
+        rlDrawRenderBatchActive();
+        RayPy_TextureCache_Unload(self, entry);
+    }
+    if (PyDict_DelItem(self->entries, key))
+        return NULL;
+    Py_RETURN_NONE;
+}
+
+static PyObject *
+RayPy_TextureCache_clear_method(RayPy_TextureCacheObject *self, PyObject *Py_UNUSED(args))
+{
+    IS_RENDER_THREAD();
+    RayPy_TextureCache_Clear(self, 1);
+    Py_RETURN_NONE;
+}
+
+static PyObject *
+RayPy_TextureCache_reset_stats(RayPy_TextureCacheObject *self, PyObject *Py_UNUSED(args))
+{
+    self->hits = self->misses = self->evictions = 0;
+    Py_RETURN_NONE;
+}
+
+static Py_ssize_t
+RayPy_TextureCache_length(RayPy_TextureCacheObject *self)
+{
+    return self->resident;
+}
+
+static int
+RayPy_TextureCache_contains(RayPy_TextureCacheObject *self, PyObject *key)
+{
+    RayPy_TextureCacheEntryObject *entry;
+    entry = (RayPy_TextureCacheEntryObject *)PyDict_GetItemWithError(self->entries, key);
+    if (entry == NULL)
+        return PyErr_Occurred() ? -1 : 0;
+    return entry->resident;
+}
+
+static PyObject *
+RayPy_TextureCache_get_over_budget(RayPy_TextureCacheObject *self, void *Py_UNUSED(closure))
+{
+    return PyLong_FromUnsignedLongLong(self->budget != 0 && self->used > self->budget ? self->used - self->budget : 0);
+}
+
+static PyObject *
+RayPy_TextureCache_get_budget(RayPy_TextureCacheObject *self, void *Py_UNUSED(closure))
+{
+    return PyLong_FromUnsignedLongLong(self->budget);
+}
+
+static int
+RayPy_TextureCache_set_budget(RayPy_TextureCacheObject *self, PyObject *value, void *Py_UNUSED(closure))
+{
+    if (value == NULL) {
+        PyErr_SetString(PyExc_TypeError, "cannot delete budget");
+        return -1;
+    }
+    if (RayPy_OffRenderThread()) {
+        PyErr_SetString(PyExc_RuntimeError, "must be called from the thread that called init_window()");
+        return -1;
+    }
+    long long budget = PyLong_AsLongLong(value);
+    if (budget == -1 && PyErr_Occurred())
+        return -1;
+    if (budget < 0) {
+        PyErr_SetString(PyExc_ValueError, "budget must be >= 0");
+        return -1;
+    }
+    self->budget = (unsigned long long)budget;
+    if (self->budget != 0 && self->used > self->budget) {
+        if (!IsWindowReady()) {
+            PyErr_SetString(PyExc_RuntimeError, "window not initialized");
+            return -1;
+        }
+        RayPy_TextureCache_Trim(self, NULL);
+    }
+    return 0;
+}
+
+static PyMethodDef RayPy_TextureCache_methods[] = {
+    {"get", (PyCFunction)RayPy_TextureCache_get, METH_O,
+     "Return the texture for a key, loading it on a miss and evicting the least recently used ones over budget"},
+    {"pin", (PyCFunction)RayPy_TextureCache_pin, METH_O,
+     "Return the texture for a key like get() and keep it from being evicted until unpin()"},
+    {"unpin", (PyCFunction)RayPy_TextureCache_unpin, METH_O,
+     "Let a pinned texture be evicted again, once unpinned as many times as it was pinned"},
+    {"remove", (PyCFunction)RayPy_TextureCache_remove, METH_O,
+     "Unload the texture for a key and forget it"},
+    {"clear", (PyCFunction)RayPy_TextureCache_clear_method, METH_NOARGS,
+     "Unload every texture and forget all keys"},
+    {"reset_stats", (PyCFunction)RayPy_TextureCache_reset_stats, METH_NOARGS,
+     "Reset hits, misses and evictions to 0"},
+    {NULL}
+};
+
+static PyMemberDef RayPy_TextureCache_members[] = {
+    {"used", Py_T_ULONGLONG, offsetof(RayPy_TextureCacheObject, used), Py_READONLY, "VRAM in bytes taken by the resident textures"},
+    {"hits", Py_T_ULONGLONG, offsetof(RayPy_TextureCacheObject, hits), Py_READONLY, "get() calls that found the texture resident"},
+    {"misses", Py_T_ULONGLONG, offsetof(RayPy_TextureCacheObject, misses), Py_READONLY, "get() calls that loaded the texture"},
+    {"evictions", Py_T_ULONGLONG, offsetof(RayPy_TextureCacheObject, evictions), Py_READONLY, "Textures unloaded to stay under budget"},
+    {NULL}
+};
+
+static PyGetSetDef RayPy_TextureCache_getset[] = {
+    {"budget", (getter)RayPy_TextureCache_get_budget, (setter)RayPy_TextureCache_set_budget, "VRAM budget in bytes, 0 for no limit", NULL},
+    {"over_budget", (getter)RayPy_TextureCache_get_over_budget, NULL,
+     "VRAM in bytes above budget, taken by textures pinned or in use this frame", NULL},
+    {NULL}
+};
+
+static PyType_Slot RayPy_TextureCache_slots[] = {
+    {Py_tp_doc, PyDoc_STR("TextureCache, textures loaded on demand and evicted least recently used first over a VRAM budget")},
+    {Py_tp_new, RayPy_TextureCache_new},
+    {Py_tp_init, RayPy_TextureCache_init},
+    {Py_tp_dealloc, RayPy_TextureCache_dealloc},
+    {Py_tp_traverse, RayPy_TextureCache_traverse},
+    {Py_tp_clear, RayPy_TextureCache_clear},
+    {Py_tp_methods, RayPy_TextureCache_methods},
+    {Py_tp_members, RayPy_TextureCache_members},
+    {Py_tp_getset, RayPy_TextureCache_getset},
+    {Py_sq_length, RayPy_TextureCache_length},
+    {Py_sq_contains, RayPy_TextureCache_contains},
+    {Py_mp_length, RayPy_TextureCache_length},
+    {Py_mp_subscript, RayPy_TextureCache_get},
+    {0, NULL},
+};
+
+static PyType_Spec RayPy_TextureCache_spec = {
+    .name = "raypy.TextureCache",
+    .basicsize = sizeof(RayPy_TextureCacheObject),
+    .itemsize = 0,
+    .flags = Py_TPFLAGS_DEFAULT | Py_TPFLAGS_BASETYPE | Py_TPFLAGS_HAVE_GC | Py_TPFLAGS_IMMUTABLETYPE,
+    .slots = RayPy_TextureCache_slots,
+};
+
+/* Compressed textures
+
+   DDS, KTX and KTX2 files are loaded as they are, in their GPU compressed
+   format with their mipmaps, and laid out like raylib uploads them from:
+   the levels back to back, GetPixelDataSize() bytes each. */
+
+#define RAYPY_MAX_LEVELS 32
+
+typedef struct {
+    int format;
+    const char *fourcc; // DDS
+    unsigned int dxgi;  // DDS with a DX10 header, dxgi + 1 is the _SRGB variant
+    unsigned int gl;    // KTX glInternalFormat
+    unsigned int vk;    // KTX2 vkFormat, vk + 1 is the _SRGB variant
+} RayPy_TextureFormatInfo;
+
+static const RayPy_TextureFormatInfo RayPy_texture_formats[] = {
+    {PIXELFORMAT_UNCOMPRESSED_R8G8B8A8, NULL, 28, 0x8058, 37},
+    {PIXELFORMAT_COMPRESSED_DXT1_RGB, "DXT1", 0, 0x83F0, 131},
+    {PIXELFORMAT_COMPRESSED_DXT1_RGBA, "DXT1", 71, 0x83F1, 133},
+    {PIXELFORMAT_COMPRESSED_DXT3_RGBA, "DXT3", 74, 0x83F2, 135},
+    {PIXELFORMAT_COMPRESSED_DXT5_RGBA, "DXT5", 77, 0x83F3, 137},
+    {PIXELFORMAT_COMPRESSED_ETC2_RGB, NULL, 0, 0x9274, 147},
+    {PIXELFORMAT_COMPRESSED_ETC1_RGB, NULL, 0, 0x8D64, 147}, // a subset of ETC2, found second
+    {PIXELFORMAT_COMPRESSED_ETC2_EAC_RGBA, NULL, 0, 0x9278, 151},
+    {PIXELFORMAT_COMPRESSED_PVRT_RGB, NULL, 0, 0x8C00, 0},
+    {PIXELFORMAT_COMPRESSED_PVRT_RGBA, NULL, 0, 0x8C02, 0},
+    {PIXELFORMAT_COMPRESSED_ASTC_4x4_RGBA, NULL, 0, 0x93B0, 157},
+    {PIXELFORMAT_COMPRESSED_ASTC_8x8_RGBA, NULL, 0, 0x93B7, 171},
+};
+
+#define RAYPY_TEXTURE_FORMATS (int)(sizeof(RayPy_texture_formats) / sizeof(RayPy_texture_formats[0]))
+
+static const RayPy_TextureFormatInfo *
+RayPy_TextureFormat_Info(int format)
+{
+    for (int i = 0; i < RAYPY_TEXTURE_FORMATS; i++) {
+        if (RayPy_texture_formats[i].format == format)
+            return &RayPy_texture_formats[i];
+    }
+    return NULL;
+}
+
+/* Size of a mipmap level in the file, whole blocks */
+static size_t
+RayPy_TextureFormat_LevelSize(int format, int width, int height)
+{
+    size_t bw = (size_t)(width + 3) / 4, bh = (size_t)(height + 3) / 4;
+    switch (format) {
+    case PIXELFORMAT_COMPRESSED_DXT1_RGB:
+    case PIXELFORMAT_COMPRESSED_DXT1_RGBA:
+    case PIXELFORMAT_COMPRESSED_ETC1_RGB:
+    case PIXELFORMAT_COMPRESSED_ETC2_RGB:
+        return bw * bh * 8;
+    case PIXELFORMAT_COMPRESSED_DXT3_RGBA:
+    case PIXELFORMAT_COMPRESSED_DXT5_RGBA:
+    case PIXELFORMAT_COMPRESSED_ETC2_EAC_RGBA:
+    case PIXELFORMAT_COMPRESSED_ASTC_4x4_RGBA:
+        return bw * bh * 16;
+    case PIXELFORMAT_COMPRESSED_ASTC_8x8_RGBA:
+        return (size_t)((width + 7) / 8) * ((height + 7) / 8) * 16;
+    case PIXELFORMAT_COMPRESSED_PVRT_RGB:
+    case PIXELFORMAT_COMPRESSED_PVRT_RGBA:
+        return (size_t)(width > 8 ? width : 8) * (height > 8 ? height : 8) / 2;
+    default:
+        return (size_t)GetPixelDataSize(width, height, format);
+    }
+}
+
+/* Number of leading levels raylib can upload, it sizes levels with
+   GetPixelDataSize() which only agrees with whole blocks on some sizes */
+static int
+RayPy_TextureFormat_UsableLevels(int format, int width, int height, int levels)
+{
+    for (int i = 0; i < levels; i++) {
+        if (RayPy_TextureFormat_LevelSize(format, width, height)
+            != (size_t)GetPixelDataSize(width, height, format))
+            return i;
+        width = width > 1 ? width / 2 : 1;
+        height = height > 1 ? height / 2 : 1;
+    }
+    return levels;
+}
+
+typedef struct {
+    int format, width, height, levels;
+    int bgra; // DDS A8R8G8B8, swapped to R8G8B8A8 on load
+    const unsigned char *level[RAYPY_MAX_LEVELS];
+    size_t size[RAYPY_MAX_LEVELS];
+} RayPy_TextureFile;
+
+static unsigned int
+RayPy_ReadU32(const unsigned char *p, int swap)
+{
+    if (swap)
+        return (unsigned int)p[3] | (unsigned int)p[2] << 8 | (unsigned int)p[1] << 16 | (unsigned int)p[0] << 24;
+    return (unsigned int)p[0] | (unsigned int)p[1] << 8 | (unsigned int)p[2] << 16 | (unsigned int)p[3] << 24;
+}
+
+static unsigned long long
+RayPy_ReadU64(const unsigned char *p)
+{
+    return RayPy_ReadU32(p, 0) | (unsigned long long)RayPy_ReadU32(p + 4, 0) << 32;
+}
+
+/* Levels stored back to back from `offset`, the DDS layout */
+static const char *
+RayPy_TextureFile_Sequential(RayPy_TextureFile *tex, const unsigned char *data, size_t size, size_t offset)
+{
+    int w = tex->width, h = tex->height;
+    for (int i = 0; i < tex->levels; i++) {
+        size_t n = RayPy_TextureFormat_LevelSize(tex->format, w, h);
+        if (offset > size || size - offset < n)
+            return "file is truncated";
+        tex->level[i] = data + offset;
+        tex->size[i] = n;
+        offset += n;
+        w = w > 1 ? w / 2 : 1;
+        h = h > 1 ? h / 2 : 1;
+    }
+    return NULL;
+}
+
+static const char *
+RayPy_TextureFile_ParseDDS(RayPy_TextureFile *tex, const unsigned char *data, size_t size)
+{
+    if (size < 128)
+        return "file is truncated";
+    const unsigned char *header = data + 4, *pf = data + 76;
+    unsigned int flags = RayPy_ReadU32(header + 4, 0), pf_flags = RayPy_ReadU32(pf + 4, 0);
+    size_t offset = 128;
+    tex->height = (int)RayPy_ReadU32(header + 8, 0);
+    tex->width = (int)RayPy_ReadU32(header + 12, 0);
+    tex->levels = flags & 0x20000 ? (int)RayPy_ReadU32(header + 24, 0) : 1; // DDSD_MIPMAPCOUNT
+    tex->format = -1;
+    if (RayPy_ReadU32(header + 108, 0) & 0x200) // DDSCAPS2_CUBEMAP
+        return "cubemaps are not supported";
+
+    if (pf_flags & 0x4) { // DDPF_FOURCC
+        if (memcmp(pf + 8, "DX10", 4) == 0) {
+            if (size < 148)
+                return "file is truncated";
+            unsigned int dxgi = RayPy_ReadU32(data + 128, 0);
+            if (RayPy_ReadU32(data + 132, 0) != 3 || (RayPy_ReadU32(data + 136, 0) & 0x4)
+                || RayPy_ReadU32(data + 140, 0) > 1) // TEXTURE2D, not a cube, no array
+                return "only 2D textures are supported";
+            offset = 148;
+            for (int i = 0; i < RAYPY_TEXTURE_FORMATS && tex->format < 0; i++) {
+                unsigned int d = RayPy_texture_formats[i].dxgi;
+                if (d && (dxgi == d || dxgi == d + 1))
+                    tex->format = RayPy_texture_formats[i].format;
+            }
+        }
+        else if (memcmp(pf + 8, "DXT1", 4) == 0) {
+            tex->format = pf_flags & 0x1 ? PIXELFORMAT_COMPRESSED_DXT1_RGBA // DDPF_ALPHAPIXELS
+                                         : PIXELFORMAT_COMPRESSED_DXT1_RGB;
+        }
+        else if (memcmp(pf + 8, "DXT2", 4) == 0 || memcmp(pf + 8, "DXT3", 4) == 0) {
+            tex->format = PIXELFORMAT_COMPRESSED_DXT3_RGBA;
+        }
+        else if (memcmp(pf + 8, "DXT4", 4) == 0 || memcmp(pf + 8, "DXT5", 4) == 0) {
+            tex->format = PIXELFORMAT_COMPRESSED_DXT5_RGBA;
+        }
+    }
+    else if ((pf_flags & 0x40) && RayPy_ReadU32(pf + 12, 0) == 32) { // DDPF_RGB
+        unsigned int r = RayPy_ReadU32(pf + 16, 0), b = RayPy_ReadU32(pf + 24, 0);
+        if (r == 0xFF && b == 0xFF0000) {
+            tex->format = PIXELFORMAT_UNCOMPRESSED_R8G8B8A8;
+        }
+        else if (r == 0xFF0000 && b == 0xFF) {
+            tex->format = PIXELFORMAT_UNCOMPRESSED_R8G8B8A8;
+            tex->bgra = 1;
+        }
+    }
+    if (tex->format < 0)
+        return "unsupported DDS pixel format";
+    if (tex->levels == 0)
+        tex->levels = 1;
+    if (tex->levels > RAYPY_MAX_LEVELS)
+        return "too many mipmap levels";
+    return RayPy_TextureFile_Sequential(tex, data, size, offset);
+}
+
+static const char *
+RayPy_TextureFile_ParseKTX(RayPy_TextureFile *tex, const unsigned char *data, size_t size)
+{
+    if (size < 64)
+        return "file is truncated";
+    int swap = RayPy_ReadU32(data + 12, 0) == 0x01020304;
+    unsigned int gl = RayPy_ReadU32(data + 28, swap);
+    tex->width = (int)RayPy_ReadU32(data + 36, swap);
+    tex->height = (int)RayPy_ReadU32(data + 40, swap);
+    tex->levels = (int)RayPy_ReadU32(data + 56, swap);
+    tex->format = -1;
+    if (RayPy_ReadU32(data + 44, swap) > 1 || RayPy_ReadU32(data + 48, swap) > 0
+        || RayPy_ReadU32(data + 52, swap) > 1)
+        return "only 2D textures are supported";
+    for (int i = 0; i < RAYPY_TEXTURE_FORMATS && tex->format < 0; i++) {
+        if (RayPy_texture_formats[i].gl == gl)
+            tex->format = RayPy_texture_formats[i].format;
+    }
+    if (tex->format < 0)
+        return "unsupported KTX internal format";
+    if (tex->levels == 0) // generate mipmaps on load, i.e. none stored
+        tex->levels = 1;
+    if (tex->levels > RAYPY_MAX_LEVELS)
+        return "too many mipmap levels";
+
+    size_t offset = 64 + (size_t)RayPy_ReadU32(data + 60, swap);
+    for (int i = 0; i < tex->levels; i++) {
+        if (offset > size || size - offset < 4)
+            return "file is truncated";
+        size_t n = RayPy_ReadU32(data + offset, swap);
+        offset += 4;
+        if (size - offset < n)
+            return "file is truncated";
+        tex->level[i] = data + offset;
+        tex->size[i] = n;
+        offset += (n + 3) & ~(size_t)3;
+    }
+    return NULL;
+}
+
+static const char *
+RayPy_TextureFile_ParseKTX2(RayPy_TextureFile *tex, const unsigned char *data, size_t size)
+{
+    if (size < 80)
+        return "file is truncated";
+    unsigned int vk = RayPy_ReadU32(data + 12, 0);
+    tex->width = (int)RayPy_ReadU32(data + 20, 0);
+    tex->height = (int)RayPy_ReadU32(data + 24, 0);
+    tex->levels = (int)RayPy_ReadU32(data + 40, 0);
+    tex->format = -1;
+    if (RayPy_ReadU32(data + 28, 0) > 1 || RayPy_ReadU32(data + 32, 0) > 1 || RayPy_ReadU32(data + 36, 0) > 1)
+        return "only 2D textures are supported";
+    if (RayPy_ReadU32(data + 44, 0) != 0)
+        return "supercompressed KTX2 files (BasisLZ, Zstandard) are not supported";
+    for (int i = 0; i < RAYPY_TEXTURE_FORMATS && tex->format < 0; i++) {
+        unsigned int v = RayPy_texture_formats[i].vk;
+        if (v && (vk == v || (vk == v + 1 && v != 37)))
+            tex->format = RayPy_texture_formats[i].format;
+    }
+    if (vk == 43) // R8G8B8A8_SRGB
+        tex->format = PIXELFORMAT_UNCOMPRESSED_R8G8B8A8;
+    if (tex->format < 0)
+        return "unsupported KTX2 vkFormat";
+    if (tex->levels == 0)
+        tex->levels = 1;
+    if (tex->levels > RAYPY_MAX_LEVELS)
+        return "too many mipmap levels";
+    if (size - 80 < (size_t)tex->levels * 24)
+        return "file is truncated";
+
+    for (int i = 0; i < tex->levels; i++) {
+        unsigned long long offset = RayPy_ReadU64(data + 80 + i * 24);
+        unsigned long long n = RayPy_ReadU64(data + 80 + i * 24 + 8);
+        if (offset > size || size - offset < n)
+            return "file is truncated";
+        tex->level[i] = data + offset;
+        tex->size[i] = (size_t)n;
+    }
+    return NULL;
+}
+
+/* Loads a DDS, KTX or KTX2 file into `image`, returns an error message or
+   NULL. Doesn't need the GIL. */
+static const char *
+RayPy_TextureFile_Load(const char *fileName, Image *image)
+{
+    static const unsigned char ktx1[12] = {0xAB, 'K', 'T', 'X', ' ', '1', '1', 0xBB, '\r', '\n', 0x1A, '\n'};
+    static const unsigned char ktx2[12] = {0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n'};
+    RayPy_TextureFile tex = {0};
+    const char *err;
+    int size = 0;
+    unsigned char *data = LoadFileData(fileName, &size);
+    if (data == NULL)
+        return "failed to read file";
+
+    if (size >= 4 && memcmp(data, "DDS ", 4) == 0)
+        err = RayPy_TextureFile_ParseDDS(&tex, data, (size_t)size);
+    else if (size >= 12 && memcmp(data, ktx1, 12) == 0)
+        err = RayPy_TextureFile_ParseKTX(&tex, data, (size_t)size);
+    else if (size >= 12 && memcmp(data, ktx2, 12) == 0)
+        err = RayPy_TextureFile_ParseKTX2(&tex, data, (size_t)size);
+    else
+        err = "not a DDS, KTX or KTX2 file";
+    if (err != NULL)
+        goto done;
+
+    if (tex.width <= 0 || tex.height <= 0 || tex.width > 16384 || tex.height > 16384) {
+        err = "invalid texture size";
+        goto done;
+    }
+    if (tex.levels < 1 || tex.levels > RAYPY_MAX_LEVELS) {
+        err = "invalid number of mipmap levels";
+        goto done;
+    }
+    int levels = RayPy_TextureFormat_UsableLevels(tex.format, tex.width, tex.height, tex.levels);
+    if (levels == 0) {
+        err = "texture width and height must be multiples of the format block size";
+        goto done;
+    }
+
+    size_t total = 0;
+    int w = tex.width, h = tex.height;
+    for (int i = 0; i < levels; i++) {
+        size_t n = RayPy_TextureFormat_LevelSize(tex.format, w, h);
+        if (tex.size[i] < n) {
+            err = "mipmap level is truncated";
+            goto done;
+        }
+        total += n;
+        w = w > 1 ? w / 2 : 1;
+        h = h > 1 ? h / 2 : 1;
+    }
+    unsigned char *pixels = RL_MALLOC(total);
+    if (pixels == NULL) {
+        err = "out of memory";
+        goto done;
+    }
+    total = 0;
+    w = tex.width, h = tex.height;
+    for (int i = 0; i < levels; i++) {
+        size_t n = RayPy_TextureFormat_LevelSize(tex.format, w, h);
+        memcpy(pixels + total, tex.level[i], n);
+        if (tex.bgra) {
+            for (size_t k = total; k < total + n; k += 4) {
+                unsigned char t = pixels[k];
+                pixels[k] = pixels[k + 2];
+                pixels[k + 2] = t;
+            }
+        }
+        total += n;
+        w = w > 1 ? w / 2 : 1;
+        h = h > 1 ? h / 2 : 1;
+    }
+    *image = (Image){pixels, tex.width, tex.height, levels, tex.format};
+
+done:
+    UnloadFileData(data);
+    return err;
+}
+
+/* load_image_compressed() and load_texture_compressed() with errors as exceptions */
+static int
+RayPy_LoadImageCompressedArgs(PyObject *args, Image *image)
+{
+    const char *fileName, *err;
+    if (!PyArg_ParseTuple(args, "s", &fileName))
+        return -1;
+    Py_BEGIN_ALLOW_THREADS
+    err = RayPy_TextureFile_Load(fileName, image);
+    Py_END_ALLOW_THREADS
+    if (err == NULL)
+        return 0;
+    if (strcmp(err, "out of memory") == 0)
+        PyErr_NoMemory();
+    else if (strcmp(err, "failed to read file") == 0)
+        PyErr_Format(PyExc_OSError, "failed to load image %R", PyTuple_GET_ITEM(args, 0));
+    else
+        PyErr_Format(PyExc_ValueError, "%R: %s", PyTuple_GET_ITEM(args, 0), err);
+    return -1;
+}
+
+static PyObject *
+RayPy_LoadImageCompressed(PyObject *Py_UNUSED(self), PyObject *args)
+{
+    Image image;
+    if (RayPy_LoadImageCompressedArgs(args, &image))
+        return NULL;
+    return RayPy_Image_FromImage(image);
+}
+
+PyDoc_STRVAR(load_image_compressed_doc,
+             "Load a DDS, KTX or KTX2 file into CPU memory (RAM) keeping its GPU compressed format and mipmaps");
+
+static PyObject *
+RayPy_LoadTextureCompressed(PyObject *Py_UNUSED(self), PyObject *args)
+{
+    Image image;
+    WINDOW_IS_READY();
+    if (RayPy_LoadImageCompressedArgs(args, &image))
+        return NULL;
+    Texture texture = LoadTextureFromImage(image);
+    UnloadImage(image);
+    if (texture.id == 0)
+        return PyErr_Format(PyExc_RuntimeError, "%R: texture format not supported by the GPU",
+                            PyTuple_GET_ITEM(args, 0));
+    RayPy_TextureObject *ret = PyObject_New(RayPy_TextureObject, &RayPy_Texture_Type);
+    if (ret == NULL) {
+        UnloadTexture(texture);
+        return NULL;
+    }
+    ret->t = texture;
+    return (PyObject *)ret;
+}
+
+PyDoc_STRVAR(load_texture_compressed_doc,
+             "Load a DDS, KTX or KTX2 file into GPU memory (VRAM) without decompressing it");
+
+/* 0 unknown, 1 supported, -1 not, per GL context */
+static signed char RayPy_format_support[PIXELFORMAT_COMPRESSED_ASTC_8x8_RGBA + 1];
+
+static PyObject *
+RayPy_IsTextureFormatSupported(PyObject *Py_UNUSED(self), PyObject *arg)
+{
+    int format = PyLong_AsLong(arg);
+    METH_O_TYPE_ERROR(arg, "int");
+    WINDOW_IS_READY();
+    if (format < PIXELFORMAT_UNCOMPRESSED_GRAYSCALE || format > PIXELFORMAT_COMPRESSED_ASTC_8x8_RGBA)
+        return PyErr_Format(PyExc_ValueError, "invalid pixel format: %d", format);
+    if (RayPy_format_support[format] == 0) {
+        /* rlgl refuses to create textures in formats the GPU can't sample,
+           upload a zeroed 8x8 one (the smallest PVRTC texture) and see */
+        unsigned char block[8 * 8 * 16] = {0};
+        Image probe = {block, 8, 8, 1, format};
+        Texture texture = LoadTextureFromImage(probe);
+        RayPy_format_support[format] = texture.id != 0 ? 1 : -1;
+        if (texture.id != 0)
+            UnloadTexture(texture);
+    }
+    return PyBool_FromLong(RayPy_format_support[format] > 0);
+}
+
+PyDoc_STRVAR(is_texture_format_supported_doc,
+             "Check if the GPU can load textures in the given PixelFormat (compressed formats depend on the platform)");
+
+/* DXT encoding: bounding box endpoints inset by 1/16th of the range
+   ("Real-Time DXT Compression", J.M.P. van Waveren) and the closest palette
+   entry per pixel. Fast, good enough for color textures. */
+
+static unsigned short
+RayPy_To565(const int rgb[3])
+{
+    return (unsigned short)(((rgb[0] * 31 + 127) / 255) << 11 | ((rgb[1] * 63 + 127) / 255) << 5
+                            | (rgb[2] * 31 + 127) / 255);
+}
+
+static void
+RayPy_From565(unsigned short c, int rgb[3])
+{
+    int r = c >> 11 & 31, g = c >> 5 & 63, b = c & 31;
+    rgb[0] = r << 3 | r >> 2;
+    rgb[1] = g << 2 | g >> 4;
+    rgb[2] = b << 3 | b >> 2;
+}
+
+static void
+RayPy_WriteU16(unsigned char *p, unsigned int v)
+{
+    p[0] = (unsigned char)v;
+    p[1] = (unsigned char)(v >> 8);
+}
+
+/* BC1 block of 16 R8G8B8A8 pixels, pixels with alpha < 128 are transparent
+   when `punch_through`, which takes the 3 color mode */
+static void
+RayPy_EncodeColorBlock(unsigned char *out, const unsigned char *px, int punch_through)
+{
+    int lo[3] = {255, 255, 255}, hi[3] = {0, 0, 0}, opaque = 0, transparent = 0;
+    for (int i = 0; i < 16; i++) {
+        if (punch_through && px[i * 4 + 3] < 128) {
+            transparent = 1;
+            continue;
+        }
+        opaque = 1;
+        for (int c = 0; c < 3; c++) {
+            lo[c] = px[i * 4 + c] < lo[c] ? px[i * 4 + c] : lo[c];
+            hi[c] = px[i * 4 + c] > hi[c] ? px[i * 4 + c] : hi[c];
+        }
+    }
+    if (!opaque) {
+        memset(out, 0, 4);
+        memset(out + 4, 0xFF, 4);
+        return;
+    }
+    for (int c = 0; c < 3; c++) {
+        int inset = (hi[c] - lo[c]) >> 4;
+        lo[c] += inset;
+        hi[c] -= inset;
+    }
+    unsigned short c0 = RayPy_To565(hi), c1 = RayPy_To565(lo);
+    /* c0 > c1 selects 4 colors, c0 <= c1 3 colors and transparent black */
+    if (transparent ? c0 > c1 : c0 < c1) {
+        unsigned short t = c0;
+        c0 = c1;
+        c1 = t;
+    }
+
+    int palette[4][3], entries = transparent ? 3 : 4;
+    RayPy_From565(c0, palette[0]);
+    RayPy_From565(c1, palette[1]);
+    for (int c = 0; c < 3; c++) {
+        if (transparent) {
+            palette[2][c] = (palette[0][c] + palette[1][c]) / 2;
+        }
+        else {
+            palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+            palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+        }
+    }
+    unsigned int indices = 0;
+    for (int i = 0; i < 16; i++) {
+        int best = 3;
+        if (!(punch_through && px[i * 4 + 3] < 128)) {
+            int best_dist = INT_MAX;
+            for (int k = 0; k < entries; k++) {
+                int dr = px[i * 4] - palette[k][0], dg = px[i * 4 + 1] - palette[k][1],
+                    db = px[i * 4 + 2] - palette[k][2];
+                int dist = dr * dr + dg * dg + db * db;
+                if (dist < best_dist)
+                    best = k, best_dist = dist;
+            }
+        }
+        indices |= (unsigned int)best << (i * 2);
+    }
+    RayPy_WriteU16(out, c0);
+    RayPy_WriteU16(out + 2, c1);
+    RayPy_WriteU16(out + 4, indices & 0xFFFF);
+    RayPy_WriteU16(out + 6, indices >> 16);
+}
+
+/* BC3 alpha block: 8 interpolated values between the extremes */
+static void
+RayPy_EncodeAlphaBlock(unsigned char *out, const unsigned char *px)
+{
+    int lo = 255, hi = 0;
+    for (int i = 0; i < 16; i++) {
+        lo = px[i * 4 + 3] < lo ? px[i * 4 + 3] : lo;
+        hi = px[i * 4 + 3] > hi ? px[i * 4 + 3] : hi;
+    }
+    int palette[8] = {hi, lo};
+    for (int k = 1; k < 7; k++)
+        palette[k + 1] = ((7 - k) * hi + k * lo) / 7;
+    unsigned long long indices = 0;
+    for (int i = 0; i < 16 && hi != lo; i++) {
+        int best = 0, best_dist = 256;
+        for (int k = 0; k < 8; k++) {
+            int dist = abs(px[i * 4 + 3] - palette[k]);
+            if (dist < best_dist)
+                best = k, best_dist = dist;
+        }
+        indices |= (unsigned long long)best << (i * 3);
+    }
+    out[0] = (unsigned char)hi;
+    out[1] = (unsigned char)lo;
+    for (int i = 0; i < 6; i++)
+        out[2 + i] = (unsigned char)(indices >> (i * 8));
+}
+
+typedef struct {
+    const unsigned char *pixels; // R8G8B8A8
+    unsigned char *out;
+    int width, height, format;
+} RayPy_DXTArgs;
+
+static void
+RayPy_DXTRows(void *arg, int begin, int end)
+{
+    const RayPy_DXTArgs *a = arg;
+    int bw = (a->width + 3) / 4, bytes = a->format == PIXELFORMAT_COMPRESSED_DXT3_RGBA
+                                                 || a->format == PIXELFORMAT_COMPRESSED_DXT5_RGBA ? 16 : 8;
+    unsigned char px[64];
+    for (int by = begin; by < end; by++) {
+        unsigned char *out = a->out + (size_t)by * bw * bytes;
+        for (int bx = 0; bx < bw; bx++, out += bytes) {
+            /* edge blocks repeat the last row and column */
+            for (int i = 0; i < 16; i++) {
+                int x = bx * 4 + i % 4, y = by * 4 + i / 4;
+                x = x < a->width ? x : a->width - 1;
+                y = y < a->height ? y : a->height - 1;
+                memcpy(px + i * 4, a->pixels + ((size_t)y * a->width + x) * 4, 4);
+            }
+            switch (a->format) {
+            case PIXELFORMAT_COMPRESSED_DXT1_RGB:
+                RayPy_EncodeColorBlock(out, px, 0);
+                break;
+            case PIXELFORMAT_COMPRESSED_DXT1_RGBA:
+                RayPy_EncodeColorBlock(out, px, 1);
+                break;
+            case PIXELFORMAT_COMPRESSED_DXT3_RGBA:
+                for (int i = 0; i < 8; i++) {
+                    out[i] = (unsigned char)((px[i * 8 + 3] * 15 + 127) / 255
+                                             | (px[i * 8 + 7] * 15 + 127) / 255 << 4);
+                }
+                RayPy_EncodeColorBlock(out + 8, px, 0);
+                break;
+            default:
+                RayPy_EncodeAlphaBlock(out, px);
+                RayPy_EncodeColorBlock(out + 8, px, 0);
+                break;
+            }
+        }
+    }
+}
+
+/* Compresses an R8G8B8A8 image to a DXT format with `levels` mipmaps,
+   returns -1 when out of memory */
+static int
+RayPy_Pixels_CompressDXT(Image *image, int format, int levels)
+{
+    size_t total = 0;
+    int w = image->width, h = image->height;
+    for (int i = 0; i < levels; i++) {
+        total += (size_t)GetPixelDataSize(w, h, format);
+        w = w > 1 ? w / 2 : 1;
+        h = h > 1 ? h / 2 : 1;
+    }
+    unsigned char *out = RL_MALLOC(total), *level = image->data, *next = NULL;
+    if (out == NULL)
+        return -1;
+    if (levels > 1) {
+        next = malloc((size_t)(image->width / 2 + 1) * (image->height / 2 + 1) * 4);
+        if (next == NULL) {
+            RL_FREE(out);
+            return -1;
+        }
+    }
+
+    /* levels alternate between the source pixels, which are freed after, and `next` */
+    unsigned char *buffers[2] = {level, next};
+    RayPy_DXTArgs a = {level, out, image->width, image->height, format};
+    for (int i = 0, cur = 0; i < levels; i++) {
+        RayPy_ParallelFor(RayPy_DXTRows, &a, (a.height + 3) / 4, 4);
+        if (i + 1 == levels)
+            break;
+        RayPy_Pixels_Halve(buffers[cur], a.width, a.height, 4, buffers[cur ^ 1]);
+        cur ^= 1;
+        a.out += GetPixelDataSize(a.width, a.height, format);
+        a.pixels = buffers[cur];
+        a.width = a.width > 1 ? a.width / 2 : 1;
+        a.height = a.height > 1 ? a.height / 2 : 1;
+    }
+    free(next);
+    RL_FREE(image->data);
+    image->data = out;
+    image->format = format;
+    image->mipmaps = levels;
+    return 0;
+}
+
+static PyObject *
+RayPy_ImageCompress(PyObject *Py_UNUSED(self), PyObject *args)
+{
+    RayPy_ImageObject *image;
+    int format, mipmaps = 0, levels = 1, err;
+    if (!PyArg_ParseTuple(args, "O!i|p", &RayPy_Image_Type, &image, &format, &mipmaps))
+        return NULL;
+    if (RayPy_Image_Claim(image))
+        return NULL;
+    if (format < PIXELFORMAT_COMPRESSED_DXT1_RGB || format > PIXELFORMAT_COMPRESSED_DXT5_RGBA) {
+        PyErr_SetString(PyExc_ValueError, "only the DXT1, DXT3 and DXT5 formats can be encoded");
+        goto error;
+    }
+    if (image->i.format >= PIXELFORMAT_COMPRESSED_DXT1_RGB) {
+        PyErr_SetString(PyExc_ValueError, "image is already compressed");
+        goto error;
+    }
+    if (RayPy_TextureFormat_UsableLevels(format, image->i.width, image->i.height, 1) == 0) {
+        PyErr_SetString(PyExc_ValueError, "image width and height must be multiples of 4");
+        goto error;
+    }
+    if (mipmaps) {
+        for (int w = image->i.width, h = image->i.height; w > 1 || h > 1; levels++) {
+            w = w > 1 ? w / 2 : 1;
+            h = h > 1 ? h / 2 : 1;
+        }
+        levels = RayPy_TextureFormat_UsableLevels(format, image->i.width, image->i.height, levels);
+    }
+    if (RayPy_Pool_Start())
+        goto error;
+    Py_BEGIN_ALLOW_THREADS
+    /* the base level only, the mipmaps are made again */
+    image->i.mipmaps = 1;
+    err = RayPy_Pixels_Format(&image->i, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8)
+          || RayPy_Pixels_CompressDXT(&image->i, format, levels);
+    Py_END_ALLOW_THREADS
+    RayPy_Image_Release(image);
+    if (err)
+        return PyErr_NoMemory();
+    Py_RETURN_NONE;
+
+error:
+    RayPy_Image_Release(image);
+    return NULL;
+}
+
+PyDoc_STRVAR(image_compress_doc,
+             "Compress image to a DXT PixelFormat, with mipmaps down to the smallest level raylib can upload if mipmaps is True");
+
+static void
+RayPy_WriteU32(unsigned char *p, unsigned int v)
+{
+    RayPy_WriteU16(p, v & 0xFFFF);
+    RayPy_WriteU16(p + 2, v >> 16);
+}
+
+/* Writes `image` to a DDS (`ktx` = 0) or KTX file, the format has been checked */
+static int
+RayPy_TextureFile_Save(const Image *image, const char *fileName, int ktx)
+{
+    const RayPy_TextureFormatInfo *info = RayPy_TextureFormat_Info(image->format);
+    size_t size = 0, header = ktx ? 64 : 128;
+    int w = image->width, h = image->height;
+    for (int i = 0; i < image->mipmaps; i++) {
+        size += (size_t)GetPixelDataSize(w, h, image->format) + (ktx ? 4 : 0);
+        w = w > 1 ? w / 2 : 1;
+        h = h > 1 ? h / 2 : 1;
+    }
+    if (header + size > INT_MAX)
+        return 0;
+    unsigned char *data = calloc(1, header + size), *p = data + header;
+    if (data == NULL)
+        return 0;
+
+    int rgba = image->format == PIXELFORMAT_UNCOMPRESSED_R8G8B8A8;
+    if (ktx) {
+        static const unsigned char id[12] = {0xAB, 'K', 'T', 'X', ' ', '1', '1', 0xBB, '\r', '\n', 0x1A, '\n'};
+        memcpy(data, id, 12);
+        RayPy_WriteU32(data + 12, 0x04030201);
+        RayPy_WriteU32(data + 16, rgba ? 0x1401 : 0); // glType: GL_UNSIGNED_BYTE
+        RayPy_WriteU32(data + 20, 1);
+        RayPy_WriteU32(data + 24, rgba ? 0x1908 : 0); // glFormat: GL_RGBA
+        RayPy_WriteU32(data + 28, info->gl);
+        /* glBaseInternalFormat: GL_RGB or GL_RGBA */
+        RayPy_WriteU32(data + 32, image->format == PIXELFORMAT_COMPRESSED_DXT1_RGB
+                                          || image->format == PIXELFORMAT_COMPRESSED_ETC1_RGB
+                                          || image->format == PIXELFORMAT_COMPRESSED_ETC2_RGB
+                                          || image->format == PIXELFORMAT_COMPRESSED_PVRT_RGB
+                                      ? 0x1907 : 0x1908);
+        RayPy_WriteU32(data + 36, image->width);
+        RayPy_WriteU32(data + 40, image->height);
+        RayPy_WriteU32(data + 52, 1); // numberOfFaces
+        RayPy_WriteU32(data + 56, image->mipmaps);
+    }
+    else {
+        memcpy(data, "DDS ", 4);
+        RayPy_WriteU32(data + 4, 124);
+        /* CAPS | HEIGHT | WIDTH | PIXELFORMAT, PITCH or LINEARSIZE, MIPMAPCOUNT */
+        RayPy_WriteU32(data + 8, 0x1007 | (rgba ? 0x8 : 0x80000) | (image->mipmaps > 1 ? 0x20000 : 0));
+        RayPy_WriteU32(data + 12, image->height);
+        RayPy_WriteU32(data + 16, image->width);
+        RayPy_WriteU32(data + 20, rgba ? image->width * 4 : GetPixelDataSize(image->width, image->height, image->format));
+        RayPy_WriteU32(data + 28, image->mipmaps);
+        RayPy_WriteU32(data + 76, 32);
+        if (rgba) {
+            RayPy_WriteU32(data + 80, 0x41); // DDPF_RGB | DDPF_ALPHAPIXELS
+            RayPy_WriteU32(data + 88, 32);
+            RayPy_WriteU32(data + 92, 0xFF);
+            RayPy_WriteU32(data + 96, 0xFF00);
+            RayPy_WriteU32(data + 100, 0xFF0000);
+            RayPy_WriteU32(data + 104, 0xFF000000);
+        }
+        else {
+            /* DDPF_FOURCC, DDPF_ALPHAPIXELS tells DXT1 with alpha apart */
+            RayPy_WriteU32(data + 80, image->format == PIXELFORMAT_COMPRESSED_DXT1_RGBA ? 0x5 : 0x4);
+            memcpy(data + 84, info->fourcc, 4);
+        }
+        /* DDSCAPS_TEXTURE, DDSCAPS_COMPLEX | DDSCAPS_MIPMAP */
+        RayPy_WriteU32(data + 108, 0x1000 | (image->mipmaps > 1 ? 0x400008 : 0));
+    }
+
+    const unsigned char *src = image->data;
+    w = image->width, h = image->height;
+    for (int i = 0; i < image->mipmaps; i++) {
+        size_t n = (size_t)GetPixelDataSize(w, h, image->format);
+        if (ktx) {
+            RayPy_WriteU32(p, (unsigned int)n); // whole blocks, already a multiple of 4
+            p += 4;
+        }
+        memcpy(p, src, n);
+        p += n;
+        src += n;
+        w = w > 1 ? w / 2 : 1;
+        h = h > 1 ? h / 2 : 1;
+    }
+    int ok = SaveFileData(fileName, data, (int)(header + size));
+    free(data);
+    return ok;
+}
+
+static PyObject *
+RayPy_ExportImageCompressed(PyObject *Py_UNUSED(self), PyObject *args)
+{
+    RayPy_ImageObject *image;
+    const char *fileName;
+    int ktx, ok;
+    if (!PyArg_ParseTuple(args, "O!s", &RayPy_Image_Type, &image, &fileName))
+        return NULL;
+    if (RayPy_Image_Claim(image))
+        return NULL;
+    if (IsFileExtension(fileName, ".ktx")) {
+        ktx = 1;
+    }
+    else if (IsFileExtension(fileName, ".dds")) {
+        ktx = 0;
+    }
+    else {
+        PyErr_SetString(PyExc_ValueError, "file extension must be .dds or .ktx");
+        goto error;
+    }
+    const RayPy_TextureFormatInfo *info = RayPy_TextureFormat_Info(image->i.format);
+    if (info == NULL || (!ktx && info->fourcc == NULL && info->format != PIXELFORMAT_UNCOMPRESSED_R8G8B8A8)) {
+        PyErr_Format(PyExc_ValueError, "pixel format %d can't be saved as %s", image->i.format,
+                     ktx ? "KTX" : "DDS");
+        goto error;
+    }
+    if (RayPy_TextureFormat_UsableLevels(image->i.format, image->i.width, image->i.height, image->i.mipmaps)
+        != image->i.mipmaps) {
+        PyErr_SetString(PyExc_ValueError, "image size is not a multiple of the format block size");
+        goto error;
+    }
+    Py_BEGIN_ALLOW_THREADS
+    ok = RayPy_TextureFile_Save(&image->i, fileName, ktx);
+    Py_END_ALLOW_THREADS
+    RayPy_Image_Release(image);
+    return PyBool_FromLong(ok);
+
+error:
+    RayPy_Image_Release(image);
+    return NULL;
+}
+
+PyDoc_STRVAR(export_image_compressed_doc,
+             "Export image data to a DDS or KTX file as it is, compressed or R8G8B8A8, with its mipmaps, returns true on success");
+
+/* Collision */
+
+static Rectangle
+RayPy_Rectangle_AsRectangle(RayPy_RectangleObject *obj)
+{
+    return (Rectangle){obj->x, obj->y, obj->width, obj->height};
+}
+
+static PyObject *
+RayPy_CheckCollisionRecs(PyObject *Py_UNUSED(self), PyObject *args)
+{
+    RayPy_RectangleObject *rec1, *rec2;
+    if (!PyArg_ParseTuple(args, "O!O!", &RayPy_Rectangle_Type, &rec1, &RayPy_Rectangle_Type, &rec2))
+        return NULL;
+    return PyBool_FromLong(CheckCollisionRecs(RayPy_Rectangle_AsRectangle(rec1), RayPy_Rectangle_AsRectangle(rec2)));
+}
+
+PyDoc_STRVAR(check_collision_recs_doc, "Check collision between two rectangles");
+
+static PyObject *
+RayPy_CheckCollisionCircles(PyObject *Py_UNUSED(self), PyObject *args)
+{
+    RayPy_Vector2Object *center1, *center2;
+    float radius1, radius2;
+    if (!PyArg_ParseTuple(args, "O!fO!f", &RayPy_Vector2_Type, &center1, &radius1, &RayPy_Vector2_Type, &center2,
+                          &radius2))
+        return NULL;
+    return PyBool_FromLong(CheckCollisionCircles((Vector2){center1->x, center1->y}, radius1,
+                                                 (Vector2){center2->x, center2->y}, radius2));
+}
+
+PyDoc_STRVAR(check_collision_circles_doc, "Check collision between two circles");
+
+static PyObject *
+RayPy_CheckCollisionCircleRec(PyObject *Py_UNUSED(self), PyObject *args)
+{
+    RayPy_Vector2Object *center;
+    RayPy_RectangleObject *rec;
+    float radius;
+    if (!PyArg_ParseTuple(args, "O!fO!", &RayPy_Vector2_Type, &center, &radius, &RayPy_Rectangle_Type, &rec))
+        return NULL;
+    return PyBool_FromLong(
+        CheckCollisionCircleRec((Vector2){center->x, center->y}, radius, RayPy_Rectangle_AsRectangle(rec)));
+}
+
+PyDoc_STRVAR(check_collision_circle_rec_doc, "Check collision between circle and rectangle");
+
+static PyObject *
+RayPy_CheckCollisionPointRec(PyObject *Py_UNUSED(self), PyObject *args)
+{
+    RayPy_Vector2Object *point;
+    RayPy_RectangleObject *rec;
+    if (!PyArg_ParseTuple(args, "O!O!", &RayPy_Vector2_Type, &point, &RayPy_Rectangle_Type, &rec))
+        return NULL;
+    return PyBool_FromLong(CheckCollisionPointRec((Vector2){point->x, point->y}, RayPy_Rectangle_AsRectangle(rec)));
+}
+
+PyDoc_STRVAR(check_collision_point_rec_doc, "Check if point is inside rectangle");
+
+static PyObject *
+RayPy_CheckCollisionPointCircle(PyObject *Py_UNUSED(self), PyObject *args)
+{
+    RayPy_Vector2Object *point, *center;
+    float radius;
+    if (!PyArg_ParseTuple(args, "O!O!f", &RayPy_Vector2_Type, &point, &RayPy_Vector2_Type, &center, &radius))
+        return NULL;
+    return PyBool_FromLong(
+        CheckCollisionPointCircle((Vector2){point->x, point->y}, (Vector2){center->x, center->y}, radius));
+}
+
+PyDoc_STRVAR(check_collision_point_circle_doc, "Check if point is inside circle");
+
+static PyObject *
+RayPy_GetCollisionRec(PyObject *Py_UNUSED(self), PyObject *args)
+{
+    RayPy_RectangleObject *rec1, *rec2;
+    if (!PyArg_ParseTuple(args, "O!O!", &RayPy_Rectangle_Type, &rec1, &RayPy_Rectangle_Type, &rec2))
+        return NULL;
+    Rectangle r = GetCollisionRec(RayPy_Rectangle_AsRectangle(rec1), RayPy_Rectangle_AsRectangle(rec2));
+    RayPy_RectangleObject *ret = PyObject_New(RayPy_RectangleObject, &RayPy_Rectangle_Type);
+    if (ret == NULL)
+        return NULL;
+    ret->x = r.x;
+    ret->y = r.y;
+    ret->width = r.width;
+    ret->height = r.height;
+    return (PyObject *)ret;
+}
+
+PyDoc_STRVAR(get_collision_rec_doc, "Get collision rectangle for two rectangles collision");
+
+/* Spatial index
+
+   Axis aligned boxes (points are empty boxes) with int64 ids in a uniform
+   grid hashed by cell, so only occupied cells cost memory. Boxes are kept
+   in flat arrays and the grid is rebuilt with a counting sort on the first
+   query after a change, which for simulations moving everything every
+   frame is cheaper than updating cells as boxes move. Boxes covering too
+   many cells are kept out of the grid and tested against every query. */
+
+#define RAYPY_GRID_MAX_CELLS 16 // cells a box may cover before it's oversized
+#define RAYPY_GRID_LIMIT 1073741824.0f // cell coordinates are clamped to +-2^30
+
+typedef struct {
+    float x0, y0, x1, y1;
+} RayPy_Aabb;
+
+typedef struct {
+    int32_t slot;
+    int32_t cx, cy;
+} RayPy_GridEntry;
+
+/* Query results, exported as int64 memoryviews of shape (n,) or (n, 2) */
+typedef struct {
+    PyObject_HEAD int64_t *data;
+    Py_ssize_t shape[2];
+    int ndim;
+} RayPy_IdBufferObject;
+
+static void
+RayPy_IdBuffer_dealloc(RayPy_IdBufferObject *self)
+{
+    PyMem_Free(self->data);
+    PyTypeObject *tp = Py_TYPE(self);
+    tp->tp_free((PyObject *)self);
+    Py_DECREF(tp);
+}
+
+static int
+RayPy_IdBuffer_getbuffer(RayPy_IdBufferObject *self, Py_buffer *view, int flags)
+{
+    static Py_ssize_t strides[2] = {2 * sizeof(int64_t), sizeof(int64_t)};
+    if (PyBuffer_FillInfo(view, (PyObject *)self, self->data, self->shape[0] * (self->ndim == 2 ? 2 : 1)
+                          * (Py_ssize_t)sizeof(int64_t), 1, flags))
+        return -1;
+    view->itemsize = sizeof(int64_t);
+    if (flags & PyBUF_FORMAT)
+        view->format = "q";
+    if (flags & PyBUF_ND) {
+        view->ndim = self->ndim;
+        view->shape = self->shape;
+        if ((flags & PyBUF_STRIDES) == PyBUF_STRIDES)
+            view->strides = self->ndim == 2 ? strides : strides + 1;
+    }
+    return 0;
+}
+
+static PyType_Slot RayPy_IdBuffer_slots[] = {
+    {Py_tp_dealloc, RayPy_IdBuffer_dealloc},
+    {Py_bf_getbuffer, RayPy_IdBuffer_getbuffer},
+    {0, NULL},
+};
+
+static PyType_Spec RayPy_IdBuffer_spec = {
+    .name = "raypy._IdBuffer",
+    .basicsize = sizeof(RayPy_IdBufferObject),
+    .itemsize = 0,
+    .flags = Py_TPFLAGS_DEFAULT | Py_TPFLAGS_IMMUTABLETYPE | Py_TPFLAGS_DISALLOW_INSTANTIATION,
+    .slots = RayPy_IdBuffer_slots,
+};
+
+/* growable int64 list the results are collected in */
+typedef struct {
+    int64_t *data;
+    Py_ssize_t count, capacity;
+} RayPy_IdList;
+
+static int
+RayPy_IdList_Append(RayPy_IdList *list, int64_t id)
+{
+    if (list->count == list->capacity) {
+        Py_ssize_t capacity = list->capacity ? list->capacity * 2 : 64;
+        int64_t *data = PyMem_Realloc(list->data, capacity * sizeof(int64_t));
+        if (data == NULL) {
+            PyErr_NoMemory();
+            return -1;
+        }
+        list->data = data;
+        list->capacity = capacity;
+    }
+    list->data[list->count++] = id;
+    return 0;
+}
+
+/* Steals the list's memory */
+static PyObject *
+RayPy_IdList_ToMemoryview(RayPy_IdList *list, int ndim)
+{
+    RayPy_IdBufferObject *buffer = PyObject_New(RayPy_IdBufferObject, &RayPy_IdBuffer_Type);
+    if (buffer == NULL) {
+        PyMem_Free(list->data);
+        return NULL;
+    }
+    buffer->data = list->data;
+    buffer->ndim = ndim;
+    buffer->shape[0] = ndim == 2 ? list->count / 2 : list->count;
+    buffer->shape[1] = 2;
+    PyObject *ret = PyMemoryView_FromObject((PyObject *)buffer);
+    Py_DECREF(buffer);
+    return ret;
+}
+
+typedef struct {
+    PyObject_HEAD float cell_size;
+    float inv_cell;
+    Py_ssize_t count, capacity;
+    int64_t *ids;
+    RayPy_Aabb *boxes;
+    uint32_t *stamps; // last query that saw each box, to report boxes in many cells once
+    uint32_t stamp;
+    int32_t *table; // id -> slot + 1, open addressing
+    size_t table_mask;
+    /* grid, rebuilt by queries when dirty */
+    int dirty;
+    RayPy_GridEntry *entries;
+    Py_ssize_t entries_capacity;
+    uint32_t *buckets; // entries of bucket i are [buckets[i], buckets[i + 1])
+    size_t bucket_mask;
+    int32_t *oversized;
+    Py_ssize_t oversized_count;
+    unsigned char *is_oversized;
+} RayPy_SpatialIndexObject;
+
+static inline uint64_t
+RayPy_Hash64(uint64_t x)
+{
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9ULL;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111ebULL;
+    x ^= x >> 31;
+    return x;
+}
+
+static inline size_t
+RayPy_Grid_Bucket(RayPy_SpatialIndexObject *self, int32_t cx, int32_t cy)
+{
+    return RayPy_Hash64(((uint64_t)(uint32_t)cx << 32) | (uint32_t)cy) & self->bucket_mask;
+}
+
+static inline int32_t
+RayPy_Grid_Cell(RayPy_SpatialIndexObject *self, float x)
+{
+    float c = floorf(x * self->inv_cell);
+    return (int32_t)(c < -RAYPY_GRID_LIMIT ? -RAYPY_GRID_LIMIT : c > RAYPY_GRID_LIMIT ? RAYPY_GRID_LIMIT : c);
+}
+
+static inline int
+RayPy_Aabb_Overlap(const RayPy_Aabb *a, const RayPy_Aabb *b)
+{
+    return a->x0 <= b->x1 && b->x0 <= a->x1 && a->y0 <= b->y1 && b->y0 <= a->y1;
+}
+
+/* position of an id in the table, or of the empty slot where it would go */
+static size_t
+RayPy_SpatialIndex_Find(RayPy_SpatialIndexObject *self, int64_t id)
+{
+    size_t i = RayPy_Hash64((uint64_t)id) & self->table_mask;
+    while (self->table[i] != 0 && self->ids[self->table[i] - 1] != id)
+        i = (i + 1) & self->table_mask;
+    return i;
+}
+
+static int
+RayPy_SpatialIndex_Reserve(RayPy_SpatialIndexObject *self, Py_ssize_t count)
+{
+    if (count > INT32_MAX - 1) {
+        PyErr_SetString(PyExc_OverflowError, "too many boxes in the spatial index");
+        return -1;
+    }
+    if (count > self->capacity) {
+        Py_ssize_t capacity = Py_MAX(count, self->capacity * 2);
+        int64_t *ids = PyMem_Realloc(self->ids, capacity * sizeof(int64_t));
+        if (ids != NULL)
+            self->ids = ids;
+        RayPy_Aabb *boxes = PyMem_Realloc(self->boxes, capacity * sizeof(RayPy_Aabb));
+        if (boxes != NULL)
+            self->boxes = boxes;
+        uint32_t *stamps = PyMem_Realloc(self->stamps, capacity * sizeof(uint32_t));
+        if (stamps != NULL)
+            self->stamps = stamps;
+        unsigned char *is_oversized = PyMem_Realloc(self->is_oversized, capacity);
+        if (is_oversized != NULL)
+            self->is_oversized = is_oversized;
+        if (ids == NULL || boxes == NULL || stamps == NULL || is_oversized == NULL) {
+            PyErr_NoMemory();
+            return -1;
+        }
+        self->capacity = capacity;
+    }
+    /* keep the table at most half full */
+    if ((size_t)count * 2 > self->table_mask + 1 || self->table == NULL) {
+        size_t size = 64;
+        while (size < (size_t)count * 2)
+            size *= 2;
+        int32_t *table = PyMem_Calloc(size, sizeof(int32_t));
+        if (table == NULL) {
+            PyErr_NoMemory();
+            return -1;
+        }
+        PyMem_Free(self->table);
+        self->table = table;
+        self->table_mask = size - 1;
+        for (Py_ssize_t slot = 0; slot < self->count; slot++)
+            self->table[RayPy_SpatialIndex_Find(self, self->ids[slot])] = (int32_t)slot + 1;
+    }
+    return 0;
+}
+
+/* Insert or move a box, space must be reserved */
+static void
+RayPy_SpatialIndex_Set(RayPy_SpatialIndexObject *self, int64_t id, RayPy_Aabb box)
+{
+    size_t i = RayPy_SpatialIndex_Find(self, id);
+    if (self->table[i] == 0) {
+        self->ids[self->count] = id;
+        self->stamps[self->count] = 0;
+        self->table[i] = (int32_t)++self->count;
+    }
+    self->boxes[self->table[i] - 1] = box;
+    self->dirty = 1;
+}
+
+static void
+RayPy_SpatialIndex_Delete(RayPy_SpatialIndexObject *self, size_t i)
+{
+    Py_ssize_t slot = self->table[i] - 1, last = self->count - 1;
+    /* backward shift deletion, no tombstones */
+    size_t j = i;
+    for (;;) {
+        j = (j + 1) & self->table_mask;
+        if (self->table[j] == 0)
+            break;
+        size_t k = RayPy_Hash64((uint64_t)self->ids[self->table[j] - 1]) & self->table_mask;
+        if ((j > i && (k <= i || k > j)) || (j < i && (k <= i && k > j))) {
+            self->table[i] = self->table[j];
+            i = j;
+        }
+    }
+    self->table[i] = 0;
+    /* move the last box into the hole */
+    if (slot != last) {
+        self->ids[slot] = self->ids[last];
+        self->boxes[slot] = self->boxes[last];
+        self->stamps[slot] = self->stamps[last];
+        self->table[RayPy_SpatialIndex_Find(self, self->ids[slot])] = (int32_t)slot + 1;
+    }
+    self->count--;
+    self->dirty = 1;
+}
+
+static int
+RayPy_SpatialIndex_Rebuild(RayPy_SpatialIndexObject *self)
+{
+    Py_ssize_t total = 0;
+    if (!self->dirty)
+        return 0;
+    self->oversized_count = 0;
+    PyMem_Free(self->oversized);
+    self->oversized = NULL;
+    for (Py_ssize_t slot = 0; slot < self->count; slot++) {
+        RayPy_Aabb *b = &self->boxes[slot];
+        int64_t cells = ((int64_t)RayPy_Grid_Cell(self, b->x1) - RayPy_Grid_Cell(self, b->x0) + 1)
+                        * ((int64_t)RayPy_Grid_Cell(self, b->y1) - RayPy_Grid_Cell(self, b->y0) + 1);
+        self->is_oversized[slot] = cells > RAYPY_GRID_MAX_CELLS;
+        if (self->is_oversized[slot])
+            self->oversized_count++;
+        else
+            total += (Py_ssize_t)cells;
+    }
+    if (total > (Py_ssize_t)UINT32_MAX - 1) {
+        PyErr_NoMemory();
+        return -1;
+    }
+    size_t buckets = 16;
+    while (buckets < (size_t)total)
+        buckets *= 2;
+    if (total > self->entries_capacity) {
+        RayPy_GridEntry *entries = PyMem_Realloc(self->entries, total * sizeof(RayPy_GridEntry));
+        if (entries == NULL) {
+            PyErr_NoMemory();
+            return -1;
+        }
+        self->entries = entries;
+        self->entries_capacity = total;
+    }
+    if (buckets - 1 != self->bucket_mask || self->buckets == NULL) {
+        uint32_t *starts = PyMem_Realloc(self->buckets, (buckets + 1) * sizeof(uint32_t));
+        if (starts == NULL) {
+            PyErr_NoMemory();
+            return -1;
+        }
+        self->buckets = starts;
+        self->bucket_mask = buckets - 1;
+    }
+    if (self->oversized_count > 0) {
+        self->oversized = PyMem_Malloc(self->oversized_count * sizeof(int32_t));
+        if (self->oversized == NULL) {
+            PyErr_NoMemory();
+            return -1;
+        }
+    }
+
+    /* counting sort of the (box, cell) entries by bucket */
+    uint32_t *starts = self->buckets;
+    memset(starts, 0, (buckets + 1) * sizeof(uint32_t));
+    for (Py_ssize_t slot = 0; slot < self->count; slot++) {
+        if (self->is_oversized[slot])
+            continue;
+        RayPy_Aabb *b = &self->boxes[slot];
+        int32_t cx0 = RayPy_Grid_Cell(self, b->x0), cx1 = RayPy_Grid_Cell(self, b->x1);
+        int32_t cy0 = RayPy_Grid_Cell(self, b->y0), cy1 = RayPy_Grid_Cell(self, b->y1);
+        for (int32_t cy = cy0; cy <= cy1; cy++)
+            for (int32_t cx = cx0; cx <= cx1; cx++)
+                starts[RayPy_Grid_Bucket(self, cx, cy) + 1]++;
+    }
+    for (size_t i = 0; i < buckets; i++)
+        starts[i + 1] += starts[i];
+    Py_ssize_t n = 0;
+    for (Py_ssize_t slot = 0; slot < self->count; slot++) {
+        if (self->is_oversized[slot]) {
+            self->oversized[n++] = (int32_t)slot;
+            continue;
+        }
+        RayPy_Aabb *b = &self->boxes[slot];
+        int32_t cx0 = RayPy_Grid_Cell(self, b->x0), cx1 = RayPy_Grid_Cell(self, b->x1);
+        int32_t cy0 = RayPy_Grid_Cell(self, b->y0), cy1 = RayPy_Grid_Cell(self, b->y1);
+        for (int32_t cy = cy0; cy <= cy1; cy++)
+            for (int32_t cx = cx0; cx <= cx1; cx++)
+                self->entries[starts[RayPy_Grid_Bucket(self, cx, cy)]++] = (RayPy_GridEntry){(int32_t)slot, cx, cy};
+    }
+    /* the fill moved every start to the next bucket's */
+    memmove(starts + 1, starts, buckets * sizeof(uint32_t));
+    starts[0] = 0;
+    self->dirty = 0;
+    return 0;
+}
+
+/* New query stamp, boxes seen in this query get it */
+static uint32_t
+RayPy_SpatialIndex_Stamp(RayPy_SpatialIndexObject *self)
+{
+    if (++self->stamp == 0) {
+        memset(self->stamps, 0, self->count * sizeof(uint32_t));
+        self->stamp = 1;
+    }
+    return self->stamp;
+}
+
+/* Box of a Rectangle, or an empty box at a Vector2 */
+static int
+RayPy_Aabb_FromObject(PyObject *obj, RayPy_Aabb *box)
+{
+    if (PyObject_TypeCheck(obj, &RayPy_Rectangle_Type)) {
+        RayPy_RectangleObject *r = (RayPy_RectangleObject *)obj;
+        *box = (RayPy_Aabb){r->x, r->y, r->x + r->width, r->y + r->height};
+    }
+    else if (PyObject_TypeCheck(obj, &RayPy_Vector2_Type)) {
+        RayPy_Vector2Object *v = (RayPy_Vector2Object *)obj;
+        *box = (RayPy_Aabb){v->x, v->y, v->x, v->y};
+    }
+    else {
+        PyErr_Format(PyExc_TypeError, "must be raypy.Rectangle or raypy.Vector2, not %s", Py_TYPE(obj)->tp_name);
+        return -1;
+    }
+    if (!(box->x0 <= box->x1 && box->y0 <= box->y1) || !isfinite(box->x1 - box->x0) || !isfinite(box->y1 - box->y0)) {
+        PyErr_SetString(PyExc_ValueError, "bounds must be finite with a size >= 0");
+        return -1;
+    }
+    return 0;
+}
+
+static void
+RayPy_SpatialIndex_dealloc(RayPy_SpatialIndexObject *self)
+{
+    PyMem_Free(self->ids);
+    PyMem_Free(self->boxes);
+    PyMem_Free(self->stamps);
+    PyMem_Free(self->table);
+    PyMem_Free(self->entries);
+    PyMem_Free(self->buckets);
+    PyMem_Free(self->oversized);
+    PyMem_Free(self->is_oversized);
+    PyTypeObject *tp = Py_TYPE(self);
+    tp->tp_free((PyObject *)self);
+    Py_DECREF(tp);
+}
+
+/* __new__() alone, or a subclass skipping __init__(), leaves no table */
+static int
+RayPy_SpatialIndex_CheckInit(RayPy_SpatialIndexObject *self)
+{
+    if (self->table == NULL) {
+        PyErr_SetString(PyExc_ValueError, "spatial index is not initialized");
+        return -1;
+    }
+    return 0;
+}
+
+static int
+RayPy_SpatialIndex_init(RayPy_SpatialIndexObject *self, PyObject *args, PyObject *kwds)
+{
+    float cell_size;
+    static char *kwlist[] = {"cell_size", NULL};
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "f", kwlist, &cell_size))
+        return -1;
+    if (!(cell_size > 0.0f) || !isfinite(cell_size)) {
+        PyErr_SetString(PyExc_ValueError, "cell_size must be > 0");
+        return -1;
+    }
+    if (self->table != NULL) {
+        PyErr_SetString(PyExc_RuntimeError, "spatial index is already initialized");
+        return -1;
+    }
+    self->cell_size = cell_size;
+    self->inv_cell = 1.0f / cell_size;
+    self->dirty = 1;
+    return RayPy_SpatialIndex_Reserve(self, 0);
+}
+
+static PyObject *
+RayPy_SpatialIndex_insert(RayPy_SpatialIndexObject *self, PyObject *args)
+{
+    long long id;
+    PyObject *bounds;
+    RayPy_Aabb box;
+    if (!PyArg_ParseTuple(args, "LO", &id, &bounds))
+        return NULL;
+    if (RayPy_SpatialIndex_CheckInit(self) || RayPy_Aabb_FromObject(bounds, &box) || RayPy_SpatialIndex_Reserve(self, self->count + 1))
+        return NULL;
+    RayPy_SpatialIndex_Set(self, id, box);
+    Py_RETURN_NONE;
+}
+
+static PyObject *
+RayPy_SpatialIndex_remove(RayPy_SpatialIndexObject *self, PyObject *arg)
+{
+    if (RayPy_SpatialIndex_CheckInit(self))
+        return NULL;
+    long long id = PyLong_AsLongLong(arg);
+    if (id == -1 && PyErr_Occurred())
+        return NULL;
+    size_t i = RayPy_SpatialIndex_Find(self, id);
+    if (self->table[i] == 0) {
+        PyErr_SetObject(PyExc_KeyError, arg);
+        return NULL;
+    }
+    RayPy_SpatialIndex_Delete(self, i);
+    Py_RETURN_NONE;
+}
+
+static PyObject *
+RayPy_SpatialIndex_clear(RayPy_SpatialIndexObject *self, PyObject *Py_UNUSED(args))
+{
+    if (RayPy_SpatialIndex_CheckInit(self))
+        return NULL;
+    memset(self->table, 0, (self->table_mask + 1) * sizeof(int32_t));
+    self->count = 0;
+    self->dirty = 1;
+    Py_RETURN_NONE;
+}
+
+/* ids from any integer buffer */
+static int64_t
+RayPy_Ids_Get(Py_buffer *view, Py_ssize_t i)
+{
+    const char *p = (const char *)view->buf + i * view->itemsize;
+    char format = view->format[strspn(view->format, "@=<")];
+    int is_signed = format == 'b' || format == 'h' || format == 'i' || format == 'l' || format == 'q' || format == 'n';
+    switch (view->itemsize) {
+    case 1: return is_signed ? *(const int8_t *)p : *(const uint8_t *)p;
+    case 2: return is_signed ? *(const int16_t *)p : *(const uint16_t *)p;
+    case 4: return is_signed ? *(const int32_t *)p : *(const uint32_t *)p;
+    }
+    return *(const int64_t *)p;
+}
+
+/* Get the ids and float32 bounds (x, y, width, height or points x, y) buffers of a bulk update */
+static Py_ssize_t
+RayPy_SpatialIndex_GetBuffers(PyObject *args, Py_buffer *ids, Py_buffer *bounds, int *components)
+{
+    PyObject *ids_obj, *bounds_obj;
+    if (!PyArg_ParseTuple(args, "OO", &ids_obj, &bounds_obj))
+        return -1;
+    if (PyObject_GetBuffer(ids_obj, ids, PyBUF_C_CONTIGUOUS | PyBUF_FORMAT))
+        return -1;
+    const char *format = ids->format + strspn(ids->format, "@=<");
+    if (strlen(format) != 1 || strchr("bBhHiIlLqQnN", format[0]) == NULL || ids->itemsize > 8) {
+        PyErr_Format(PyExc_TypeError, "ids must be an integer buffer, not format '%s'", ids->format);
+        goto error;
+    }
+    if (PyObject_GetBuffer(bounds_obj, bounds, PyBUF_C_CONTIGUOUS | PyBUF_FORMAT))
+        goto error;
+    format = bounds->format + strspn(bounds->format, "@=<");
+    if (bounds->itemsize != sizeof(float) || strcmp(format, "f") != 0) {
+        PyErr_Format(PyExc_TypeError, "bounds must be a float32 buffer, not format '%s'", bounds->format);
+        goto error_bounds;
+    }
+    Py_ssize_t count = ids->len / ids->itemsize, floats = bounds->len / (Py_ssize_t)sizeof(float);
+    if (floats == count * 4)
+        *components = 4;
+    else if (floats == count * 2)
+        *components = 2;
+    else {
+        PyErr_Format(PyExc_ValueError, "bounds must have 4 (x, y, width, height) or 2 (x, y) floats per id, "
+                     "got %zd floats for %zd ids", floats, count);
+        goto error_bounds;
+    }
+    return count;
+error_bounds:
+    PyBuffer_Release(bounds);
+error:
+    PyBuffer_Release(ids);
+    return -1;
+}
+
+static PyObject *
+RayPy_SpatialIndex_Bulk(RayPy_SpatialIndexObject *self, PyObject *args, int update)
+{
+    Py_buffer ids, bounds;
+    int components;
+    if (RayPy_SpatialIndex_CheckInit(self))
+        return NULL;
+    Py_ssize_t count = RayPy_SpatialIndex_GetBuffers(args, &ids, &bounds, &components);
+    if (count < 0)
+        return NULL;
+    const float *f = bounds.buf;
+    /* validate everything first so a bad entry leaves the index unchanged */
+    for (Py_ssize_t i = 0; i < count; i++, f += components) {
+        float w = components == 4 ? f[2] : 0.0f, h = components == 4 ? f[3] : 0.0f;
+        if (!(w >= 0.0f && h >= 0.0f) || !isfinite(f[0] + w) || !isfinite(f[1] + h)) {
+            PyErr_Format(PyExc_ValueError, "bounds %zd must be finite with a size >= 0", i);
+            goto error;
+        }
+        if (update && self->table[RayPy_SpatialIndex_Find(self, RayPy_Ids_Get(&ids, i))] == 0) {
+            PyObject *key = PyLong_FromLongLong(RayPy_Ids_Get(&ids, i));
+            if (key != NULL) {
+                PyErr_SetObject(PyExc_KeyError, key);
+                Py_DECREF(key);
+            }
+            goto error;
+        }
+    }
+    if (!update && RayPy_SpatialIndex_Reserve(self, self->count + count))
+        goto error;
+    f = bounds.buf;
+    for (Py_ssize_t i = 0; i < count; i++, f += components) {
+        RayPy_Aabb box = {f[0], f[1], f[0], f[1]};
+        if (components == 4)
+            box.x1 += f[2], box.y1 += f[3];
+        RayPy_SpatialIndex_Set(self, RayPy_Ids_Get(&ids, i), box);
+    }
+    PyBuffer_Release(&ids);
+    PyBuffer_Release(&bounds);
+    Py_RETURN_NONE;
+error:
+    PyBuffer_Release(&ids);
+    PyBuffer_Release(&bounds);
+    return NULL;
+}
+
+static PyObject *
+RayPy_SpatialIndex_insert_many(RayPy_SpatialIndexObject *self, PyObject *args)
+{
+    return RayPy_SpatialIndex_Bulk(self, args, 0);
+}
+
+static PyObject *
+RayPy_SpatialIndex_update_many(RayPy_SpatialIndexObject *self, PyObject *args)
+{
+    return RayPy_SpatialIndex_Bulk(self, args, 1);
+}
+
+/* Visit the boxes overlapping `box` (tested by `test`, exactly), once each */
+typedef int (*RayPy_AabbTest)(const RayPy_Aabb *box, const void *arg);
+
+static PyObject *
+RayPy_SpatialIndex_Query(RayPy_SpatialIndexObject *self, RayPy_Aabb range, RayPy_AabbTest test, const void *arg)
+{
+    RayPy_IdList result = {0};
+    if (RayPy_SpatialIndex_CheckInit(self) || RayPy_SpatialIndex_Rebuild(self))
+        return NULL;
+    uint32_t stamp = RayPy_SpatialIndex_Stamp(self);
+    int32_t cx0 = RayPy_Grid_Cell(self, range.x0), cx1 = RayPy_Grid_Cell(self, range.x1);
+    int32_t cy0 = RayPy_Grid_Cell(self, range.y0), cy1 = RayPy_Grid_Cell(self, range.y1);
+    double cells = ((double)cx1 - cx0 + 1) * ((double)cy1 - cy0 + 1);
+    if (cells > (double)self->count) {
+        /* visiting the cells would cost more than testing every box */
+        for (Py_ssize_t slot = 0; slot < self->count; slot++) {
+            if (RayPy_Aabb_Overlap(&self->boxes[slot], &range) && test(&self->boxes[slot], arg)
+                && RayPy_IdList_Append(&result, self->ids[slot]))
+                goto error;
+        }
+        return RayPy_IdList_ToMemoryview(&result, 1);
+    }
+    for (int32_t cy = cy0; cy <= cy1; cy++) {
+        for (int32_t cx = cx0; cx <= cx1; cx++) {
+            size_t bucket = RayPy_Grid_Bucket(self, cx, cy);
+            for (uint32_t e = self->buckets[bucket]; e < self->buckets[bucket + 1]; e++) {
+                RayPy_GridEntry *entry = &self->entries[e];
+                if (entry->cx != cx || entry->cy != cy || self->stamps[entry->slot] == stamp)
+                    continue;
+                self->stamps[entry->slot] = stamp;
+                if (RayPy_Aabb_Overlap(&self->boxes[entry->slot], &range) && test(&self->boxes[entry->slot], arg)
+                    && RayPy_IdList_Append(&result, self->ids[entry->slot]))
+                    goto error;
+            }
+        }
+    }
+    for (Py_ssize_t i = 0; i < self->oversized_count; i++) {
+        int32_t slot = self->oversized[i];
+        if (RayPy_Aabb_Overlap(&self->boxes[slot], &range) && test(&self->boxes[slot], arg)
+            && RayPy_IdList_Append(&result, self->ids[slot]))
+            goto error;
+    }
+    return RayPy_IdList_ToMemoryview(&result, 1);
+error:
+    PyMem_Free(result.data);
+    return NULL;
+}
+
+static int
+RayPy_Aabb_Any(const RayPy_Aabb *Py_UNUSED(box), const void *Py_UNUSED(arg))
+{
+    return 1;
+}
+
+static PyObject *
+RayPy_SpatialIndex_query_rect(RayPy_SpatialIndexObject *self, PyObject *arg)
+{
+    RayPy_Aabb range;
+    if (RayPy_Aabb_FromObject(arg, &range))
+        return NULL;
+    return RayPy_SpatialIndex_Query(self, range, RayPy_Aabb_Any, NULL);
+}
+
+typedef struct {
+    float x, y, radius;
+} RayPy_Circle;
+
+static int
+RayPy_Aabb_InCircle(const RayPy_Aabb *box, const void *arg)
+{
+    const RayPy_Circle *c = arg;
+    float dx = fmaxf(fmaxf(box->x0 - c->x, 0.0f), c->x - box->x1);
+    float dy = fmaxf(fmaxf(box->y0 - c->y, 0.0f), c->y - box->y1);
+    return dx * dx + dy * dy <= c->radius * c->radius;
+}
+
+static PyObject *
+RayPy_SpatialIndex_query_radius(RayPy_SpatialIndexObject *self, PyObject *args)
+{
+    RayPy_Vector2Object *center;
+    RayPy_Circle circle;
+    if (!PyArg_ParseTuple(args, "O!f", &RayPy_Vector2_Type, &center, &circle.radius))
+        return NULL;
+    if (!(circle.radius >= 0.0f) || !isfinite(circle.radius)) {
+        PyErr_SetString(PyExc_ValueError, "radius must be finite and >= 0");
+        return NULL;
+    }
+    circle.x = center->x;
+    circle.y = center->y;
+    RayPy_Aabb range = {circle.x - circle.radius, circle.y - circle.radius, circle.x + circle.radius,
+                        circle.y + circle.radius};
+    return RayPy_SpatialIndex_Query(self, range, RayPy_Aabb_InCircle, &circle);
+}
+
+/* Slab test of the segment start + t * delta, t in [0, 1] */
+static int
+RayPy_Aabb_Segment(const RayPy_Aabb *box, float sx, float sy, float dx, float dy, float *t)
+{
+    float t0 = 0.0f, t1 = 1.0f;
+    const float s[2] = {sx, sy}, d[2] = {dx, dy}, lo[2] = {box->x0, box->y0}, hi[2] = {box->x1, box->y1};
+    for (int axis = 0; axis < 2; axis++) {
+        if (d[axis] == 0.0f) {
+            if (s[axis] < lo[axis] || s[axis] > hi[axis])
+                return 0;
+            continue;
+        }
+        float ta = (lo[axis] - s[axis]) / d[axis], tb = (hi[axis] - s[axis]) / d[axis];
+        if (ta > tb) {
+            float tmp = ta;
+            ta = tb;
+            tb = tmp;
+        }
+        t0 = fmaxf(t0, ta);
+        t1 = fminf(t1, tb);
+        if (t0 > t1)
+            return 0;
+    }
+    *t = t0;
+    return 1;
+}
+
+typedef struct {
+    float t;
+    int64_t id;
+} RayPy_RayHit;
+
+static int
+RayPy_RayHit_Compare(const void *a, const void *b)
+{
+    float ta = ((const RayPy_RayHit *)a)->t, tb = ((const RayPy_RayHit *)b)->t;
+    return (ta > tb) - (ta < tb);
+}
+
+static PyObject *
+RayPy_SpatialIndex_raycast(RayPy_SpatialIndexObject *self, PyObject *args)
+{
+    RayPy_Vector2Object *start, *end;
+    RayPy_RayHit *hits = NULL;
+    Py_ssize_t count = 0, capacity = 0;
+    RayPy_IdList result = {0};
+    float t;
+    if (!PyArg_ParseTuple(args, "O!O!", &RayPy_Vector2_Type, &start, &RayPy_Vector2_Type, &end))
+        return NULL;
+    float sx = start->x, sy = start->y, dx = end->x - sx, dy = end->y - sy;
+    if (!isfinite(dx) || !isfinite(dy)) {
+        PyErr_SetString(PyExc_ValueError, "ray must be finite");
+        return NULL;
+    }
+    if (RayPy_SpatialIndex_CheckInit(self) || RayPy_SpatialIndex_Rebuild(self))
+        return NULL;
+    uint32_t stamp = RayPy_SpatialIndex_Stamp(self);
+#define RAYPY_RAY_HIT(slot)                                                                                 \
+    if (RayPy_Aabb_Segment(&self->boxes[slot], sx, sy, dx, dy, &t)) {                                     \
+        if (count == capacity) {                                                                          \
+            capacity = capacity ? capacity * 2 : 16;                                                      \
+            RayPy_RayHit *grown = PyMem_Realloc(hits, capacity * sizeof(RayPy_RayHit));                   \
+            if (grown == NULL) {                                                                          \
+                PyErr_NoMemory();                                                                         \
+                goto error;                                                                               \
+            }                                                                                             \
+            hits = grown;                                                                                 \
+        }                                                                                                 \
+        hits[count++] = (RayPy_RayHit){t, self->ids[slot]};                                               \
+    }
+
+    int32_t cx = RayPy_Grid_Cell(self, sx), cy = RayPy_Grid_Cell(self, sy);
+    int32_t ex = RayPy_Grid_Cell(self, end->x), ey = RayPy_Grid_Cell(self, end->y);
+    double steps = fabs((double)ex - cx) + fabs((double)ey - cy) + 1;
+    if (steps > (double)self->count) {
+        for (Py_ssize_t slot = 0; slot < self->count; slot++) {
+            RAYPY_RAY_HIT(slot)
+        }
+    }
+    else {
+        /* walk the cells the segment crosses (Amanatides & Woo) */
+        int stepx = dx > 0 ? 1 : -1, stepy = dy > 0 ? 1 : -1;
+        double tmaxx = dx != 0 ? (((double)cx + (dx > 0)) * self->cell_size - sx) / dx : INFINITY;
+        double tmaxy = dy != 0 ? (((double)cy + (dy > 0)) * self->cell_size - sy) / dy : INFINITY;
+        double tdeltax = dx != 0 ? self->cell_size / fabs(dx) : INFINITY;
+        double tdeltay = dy != 0 ? self->cell_size / fabs(dy) : INFINITY;
+        for (Py_ssize_t step = 0; step < (Py_ssize_t)steps; step++) {
+            size_t bucket = RayPy_Grid_Bucket(self, cx, cy);
+            for (uint32_t e = self->buckets[bucket]; e < self->buckets[bucket + 1]; e++) {
+                RayPy_GridEntry *entry = &self->entries[e];
+                if (entry->cx != cx || entry->cy != cy || self->stamps[entry->slot] == stamp)
+                    continue;
+                self->stamps[entry->slot] = stamp;
+                RAYPY_RAY_HIT(entry->slot)
+            }
+            if (tmaxx < tmaxy) {
+                cx += stepx;
+                tmaxx += tdeltax;
+            }
+            else {
+                cy += stepy;
+                tmaxy += tdeltay;
+            }
+        }
+        for (Py_ssize_t i = 0; i < self->oversized_count; i++) {
+            RAYPY_RAY_HIT(self->oversized[i])
+        }
+    }
+#undef RAYPY_RAY_HIT
+
+    if (count > 1)
+        qsort(hits, count, sizeof(RayPy_RayHit), RayPy_RayHit_Compare);
+    for (Py_ssize_t i = 0; i < count; i++) {
+        if (RayPy_IdList_Append(&result, hits[i].id))
+            goto error;
+    }
+    PyMem_Free(hits);
+    return RayPy_IdList_ToMemoryview(&result, 1);
+error:
+    PyMem_Free(hits);
+    PyMem_Free(result.data);
+    return NULL;
+}
+
+static PyObject *
+RayPy_SpatialIndex_query_pairs(RayPy_SpatialIndexObject *self, PyObject *Py_UNUSED(args))
+{
+    RayPy_IdList result = {0};
+    if (RayPy_SpatialIndex_CheckInit(self) || RayPy_SpatialIndex_Rebuild(self))
+        return NULL;
+    for (size_t bucket = 0; bucket <= self->bucket_mask; bucket++) {
+        uint32_t first = self->buckets[bucket], last = self->buckets[bucket + 1];
+        for (uint32_t i = first; i < last; i++) {
+            RayPy_GridEntry *a = &self->entries[i];
+            RayPy_Aabb *boxa = &self->boxes[a->slot];
+            for (uint32_t j = i + 1; j < last; j++) {
+                RayPy_GridEntry *b = &self->entries[j];
+                RayPy_Aabb *boxb = &self->boxes[b->slot];
+                if (a->cx != b->cx || a->cy != b->cy || !RayPy_Aabb_Overlap(boxa, boxb))
+                    continue;
+                /* boxes sharing several cells: report the pair in the cell of the overlap's corner only */
+                if (RayPy_Grid_Cell(self, fmaxf(boxa->x0, boxb->x0)) != a->cx
+                    || RayPy_Grid_Cell(self, fmaxf(boxa->y0, boxb->y0)) != a->cy)
+                    continue;
+                if (RayPy_IdList_Append(&result, self->ids[a->slot])
+                    || RayPy_IdList_Append(&result, self->ids[b->slot]))
+                    goto error;
+            }
+        }
+    }
+    for (Py_ssize_t i = 0; i < self->oversized_count; i++) {
+        int32_t a = self->oversized[i];
+        for (Py_ssize_t b = 0; b < self->count; b++) {
+            /* oversized pairs once, from the one with the lower slot */
+            if (b == a || (self->is_oversized[b] && b < a) || !RayPy_Aabb_Overlap(&self->boxes[a], &self->boxes[b]))
+                continue;
+            if (RayPy_IdList_Append(&result, self->ids[a]) || RayPy_IdList_Append(&result, self->ids[b]))
+                goto error;
+        }
+    }
+    return RayPy_IdList_ToMemoryview(&result, 2);
+error:
+    PyMem_Free(result.data);
+    return NULL;
+}
+
+static Py_ssize_t
+RayPy_SpatialIndex_length(RayPy_SpatialIndexObject *self)
+{
+    return self->count;
+}
+
+static int
+RayPy_SpatialIndex_contains(RayPy_SpatialIndexObject *self, PyObject *key)
+{
+    long long id = PyLong_AsLongLong(key);
+    if (id == -1 && PyErr_Occurred()) {
+        if (!PyErr_ExceptionMatches(PyExc_TypeError) && !PyErr_ExceptionMatches(PyExc_OverflowError))
+            return -1;
+        PyErr_Clear();
+        return 0;
+    }
+    if (RayPy_SpatialIndex_CheckInit(self))
+        return -1;
+    return self->table[RayPy_SpatialIndex_Find(self, id)] != 0;
+}
+
+RAYPY_LOCKED_METHOD(RayPy_SpatialIndexObject, RayPy_SpatialIndex_insert)
+RAYPY_LOCKED_METHOD(RayPy_SpatialIndexObject, RayPy_SpatialIndex_insert_many)
+RAYPY_LOCKED_METHOD(RayPy_SpatialIndexObject, RayPy_SpatialIndex_update_many)
+RAYPY_LOCKED_METHOD(RayPy_SpatialIndexObject, RayPy_SpatialIndex_remove)
+RAYPY_LOCKED_METHOD(RayPy_SpatialIndexObject, RayPy_SpatialIndex_clear)
+RAYPY_LOCKED_METHOD(RayPy_SpatialIndexObject, RayPy_SpatialIndex_query_rect)
+RAYPY_LOCKED_METHOD(RayPy_SpatialIndexObject, RayPy_SpatialIndex_query_radius)
+RAYPY_LOCKED_METHOD(RayPy_SpatialIndexObject, RayPy_SpatialIndex_raycast)
+RAYPY_LOCKED_METHOD(RayPy_SpatialIndexObject, RayPy_SpatialIndex_query_pairs)
+
+static Py_ssize_t
+RayPy_SpatialIndex_length_Locked(RayPy_SpatialIndexObject *self)
+{
+    Py_ssize_t ret;
+    Py_BEGIN_CRITICAL_SECTION(self);
+    ret = RayPy_SpatialIndex_length(self);
+    Py_END_CRITICAL_SECTION();
+    return ret;
+}
+
+static int
+RayPy_SpatialIndex_contains_Locked(RayPy_SpatialIndexObject *self, PyObject *key)
+{
+    int ret;
+    Py_BEGIN_CRITICAL_SECTION(self);
+    ret = RayPy_SpatialIndex_contains(self, key);
+    Py_END_CRITICAL_SECTION();
+    return ret;
+}
+
+static PyMethodDef RayPy_SpatialIndex_methods[] = {
+    {"insert", (PyCFunction)RayPy_SpatialIndex_insert_Locked, METH_VARARGS,
+     "Insert a Rectangle or a Vector2 point with an id, moving it if the id is already in"},
+    {"insert_many", (PyCFunction)RayPy_SpatialIndex_insert_many_Locked, METH_VARARGS,
+     "Insert or move many boxes from an integer ids buffer and a float32 buffer of (x, y, width, height) or (x, y) per id"},
+    {"update_many", (PyCFunction)RayPy_SpatialIndex_update_many_Locked, METH_VARARGS,
+     "Move many boxes like insert_many(), raising KeyError if an id isn't in the index"},
+    {"remove", (PyCFunction)RayPy_SpatialIndex_remove_Locked, METH_O,
+     "Remove the box of an id"},
+    {"clear", (PyCFunction)RayPy_SpatialIndex_clear_Locked, METH_NOARGS,
+     "Remove every box"},
+    {"query_rect", (PyCFunction)RayPy_SpatialIndex_query_rect_Locked, METH_O,
+     "Ids of the boxes overlapping a Rectangle (or containing a Vector2), int64 memoryview"},
+    {"query_radius", (PyCFunction)RayPy_SpatialIndex_query_radius_Locked, METH_VARARGS,
+     "Ids of the boxes overlapping a circle, int64 memoryview"},
+    {"raycast", (PyCFunction)RayPy_SpatialIndex_raycast_Locked, METH_VARARGS,
+     "Ids of the boxes the segment from start to end crosses, nearest first, int64 memoryview"},
+    {"query_pairs", (PyCFunction)RayPy_SpatialIndex_query_pairs_Locked, METH_NOARGS,
+     "Every pair of overlapping boxes once, int64 memoryview of shape (n, 2)"},
+    {NULL}
+};
+
+static PyMemberDef RayPy_SpatialIndex_members[] = {
+    {"cell_size", Py_T_FLOAT, offsetof(RayPy_SpatialIndexObject, cell_size), Py_READONLY, "Grid cell size"},
+    {NULL}
+};
+
+static PyType_Slot RayPy_SpatialIndex_slots[] = {
+    {Py_tp_doc, PyDoc_STR("SpatialIndex(cell_size), rectangles and points with ids in a uniform grid for "
+                        "overlap, radius, raycast and broad-phase collision queries")},
+    {Py_tp_new, PyType_GenericNew},
+    {Py_tp_init, RayPy_SpatialIndex_init},
+    {Py_tp_dealloc, RayPy_SpatialIndex_dealloc},
+    {Py_sq_length, RayPy_SpatialIndex_length_Locked},
+    {Py_sq_contains, RayPy_SpatialIndex_contains_Locked},
+    {Py_tp_methods, RayPy_SpatialIndex_methods},
+    {Py_tp_members, RayPy_SpatialIndex_members},
+    {0, NULL},
+};
+
+static PyType_Spec RayPy_SpatialIndex_spec = {
+    .name = "raypy.SpatialIndex",
+    .basicsize = sizeof(RayPy_SpatialIndexObject),
+    .itemsize = 0,
+    .flags = Py_TPFLAGS_DEFAULT | Py_TPFLAGS_BASETYPE | Py_TPFLAGS_IMMUTABLETYPE,
+    .slots = RayPy_SpatialIndex_slots,
+};
+
+/* Camera2D */
+
+static PyObject *
+RayPy_Vector2_FromVector2(Vector2 v)
+{
+    RayPy_Vector2Object *ret = PyObject_New(RayPy_Vector2Object, &RayPy_Vector2_Type);
+    if (ret == NULL)
+        return NULL;
+    ret->x = v.x;
+    ret->y = v.y;
+    return (PyObject *)ret;
+}
+
+/* offset and target are Vector2 objects, like the vectors of Camera3D */
+typedef struct {
+    PyObject_HEAD RayPy_Vector2Object *offset;
+    RayPy_Vector2Object *target;
+    float rotation;
+    float zoom;
+} RayPy_Camera2DObject;
+
+static Camera2D
+RayPy_Camera2D_AsCamera2D(RayPy_Camera2DObject *obj)
+{
+    return (Camera2D){{obj->offset->x, obj->offset->y}, {obj->target->x, obj->target->y}, obj->rotation, obj->zoom};
+}
+
+static void
+RayPy_Camera2D_dealloc(RayPy_Camera2DObject *self)
+{
+    Py_XDECREF(self->offset);
+    Py_XDECREF(self->target);
+    PyTypeObject *tp = Py_TYPE(self);
+    tp->tp_free((PyObject *)self);
+    Py_DECREF(tp);
+}
+
+static RayPy_Camera2DObject *
+RayPy_Camera2D_new(PyTypeObject *type, PyObject *Py_UNUSED(args), PyObject *Py_UNUSED(kwds))
+{
+    RayPy_Camera2DObject *self = (RayPy_Camera2DObject *)type->tp_alloc(type, 0);
+    if (self == NULL)
+        return NULL;
+    self->offset = (RayPy_Vector2Object *)RayPy_Vector2_FromVector2((Vector2){0, 0});
+    self->target = (RayPy_Vector2Object *)RayPy_Vector2_FromVector2((Vector2){0, 0});
+    if (self->offset == NULL || self->target == NULL) {
+        Py_DECREF(self);
+        return NULL;
+    }
+    self->zoom = 1.0f;
+    return self;
+}
+
+static int
+RayPy_Camera2D_init(RayPy_Camera2DObject *self, PyObject *args, PyObject *kwds)
+{
+    RayPy_Vector2Object *offset = NULL, *target = NULL;
+    static char *kwlist[] = {"offset", "target", "rotation", "zoom", NULL};
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "|O!O!ff", kwlist, &RayPy_Vector2_Type, &offset,
+                                     &RayPy_Vector2_Type, &target, &self->rotation, &self->zoom))
+        return -1;
+    if (offset != NULL)
+        Py_SETREF(self->offset, (RayPy_Vector2Object *)Py_NewRef(offset));
+    if (target != NULL)
+        Py_SETREF(self->target, (RayPy_Vector2Object *)Py_NewRef(target));
+    return 0;
+}
+
+static PyObject *
+RayPy_Camera2D_get_vector(RayPy_Camera2DObject *self, void *closure)
+{
+    return Py_NewRef(*(PyObject **)((char *)self + (size_t)closure));
+}
+
+static int
+RayPy_Camera2D_set_vector(RayPy_Camera2DObject *self, PyObject *value, void *closure)
+{
+    if (value == NULL || !PyObject_TypeCheck(value, &RayPy_Vector2_Type)) {
+        PyErr_Format(PyExc_TypeError, "must be raypy.Vector2, not %s",
+                     value == NULL ? "deleting" : Py_TYPE(value)->tp_name);
+        return -1;
+    }
+    Py_SETREF(*(PyObject **)((char *)self + (size_t)closure), Py_NewRef(value));
+    return 0;
+}
+
+static PyObject *
+RayPy_Camera2D_repr(RayPy_Camera2DObject *self)
+{
+    PyObject *rotation = PyFloat_FromDouble(self->rotation);
+    PyObject *zoom = PyFloat_FromDouble(self->zoom);
+    PyObject *ret = NULL;
+    if (rotation != NULL && zoom != NULL)
+        ret = PyUnicode_FromFormat("Camera2D(%R, %R, %R, %R)", self->offset, self->target, rotation, zoom);
+    Py_XDECREF(rotation);
+    Py_XDECREF(zoom);
+    return ret;
+}
+
+static PyMemberDef RayPy_Camera2D_members[] = {
+    {"rotation", Py_T_FLOAT, offsetof(RayPy_Camera2DObject, rotation), 0, "Camera rotation in degrees"},
+    {"zoom", Py_T_FLOAT, offsetof(RayPy_Camera2DObject, zoom), 0, "Camera zoom (scaling), should be 1.0f by default"},
+    {NULL}
+};
+
+static PyGetSetDef RayPy_Camera2D_getset[] = {
+    {"offset", (getter)RayPy_Camera2D_get_vector, (setter)RayPy_Camera2D_set_vector, "Camera offset (displacement from target)", (void *)offsetof(RayPy_Camera2DObject, offset)},
+    {"target", (getter)RayPy_Camera2D_get_vector, (setter)RayPy_Camera2D_set_vector, "Camera target (rotation and zoom origin)", (void *)offsetof(RayPy_Camera2DObject, target)},
+    {NULL}
+};
+
+static PyType_Slot RayPy_Camera2D_slots[] = {
+    {Py_tp_doc, PyDoc_STR("Camera2D, defines position/orientation in 2d space")},
+    {Py_tp_new, RayPy_Camera2D_new},
+    {Py_tp_init, RayPy_Camera2D_init},
+    {Py_tp_repr, RayPy_Camera2D_repr},
+    {Py_tp_dealloc, RayPy_Camera2D_dealloc},
+    {Py_tp_members, RayPy_Camera2D_members},
+    {Py_tp_getset, RayPy_Camera2D_getset},
+    {0, NULL},
+};
+
+static PyType_Spec RayPy_Camera2D_spec = {
+    .name = "raypy.Camera2D",
+    .basicsize = sizeof(RayPy_Camera2DObject),
+    .itemsize = 0,
+    .flags = Py_TPFLAGS_DEFAULT | Py_TPFLAGS_BASETYPE | Py_TPFLAGS_IMMUTABLETYPE,
+    .slots = RayPy_Camera2D_slots,
+};
+
+/* Culling
+
+   Batched 2D draws skip what's outside the view before any vertex reaches
+   the rlgl batch. The view is the screen seen through the Camera2D of
+   begin_mode_2d(), or a rectangle set with set_cull_rect(). */
+
+static struct {
+    Camera2D camera;
+    int camera_active;
+    Rectangle rect; // set_cull_rect()
+    int rect_set;
+    int target_width, target_height; // render texture being drawn to, 0 for the screen
+    long long drawn, culled; // rectangles and particles since begin_drawing()
+    long long chunks_drawn, chunks_culled; // tilemap chunks, counted apart being much bigger
+} RayPy_cull;
+
+/* World-space bounds of the view: x0, y0, x1, y1 */
+static void
+RayPy_Cull_GetView(float view[4])
+{
+    if (RayPy_cull.rect_set) {
+        Rectangle r = RayPy_cull.rect;
+        view[0] = r.x, view[1] = r.y, view[2] = r.x + r.width, view[3] = r.y + r.height;
+        return;
+    }
+    float w = (float)GetScreenWidth(), h = (float)GetScreenHeight();
+    if (RayPy_cull.target_width != 0)
+        w = (float)RayPy_cull.target_width, h = (float)RayPy_cull.target_height;
+    if (!RayPy_cull.camera_active) {
+        view[0] = 0.0f, view[1] = 0.0f, view[2] = w, view[3] = h;
+        return;
+    }
+    /* a rotated camera sees a rotated screen, cull against its bounding box */
+    const Vector2 corners[4] = {{0, 0}, {w, 0}, {0, h}, {w, h}};
+    view[0] = view[1] = INFINITY;
+    view[2] = view[3] = -INFINITY;
+    for (int i = 0; i < 4; i++) {
+        Vector2 p = GetScreenToWorld2D(corners[i], RayPy_cull.camera);
+        view[0] = fminf(view[0], p.x), view[1] = fminf(view[1], p.y);
+        view[2] = fmaxf(view[2], p.x), view[3] = fmaxf(view[3], p.y);
+    }
+}
+
+/* Indices of the x, y, width, height rects overlapping the view, returns how many.
+   Negative sizes extend the other way and NaNs are never visible. */
+static int
+RayPy_Cull_Rects(const float *rects, int count, const float view[4], int32_t *visible)
+{
+    int n = 0, i = 0;
+#ifdef RAYPY_SSE2
+    const __m128 vx0 = _mm_set1_ps(view[0]), vy0 = _mm_set1_ps(view[1]);
+    const __m128 vx1 = _mm_set1_ps(view[2]), vy1 = _mm_set1_ps(view[3]);
+    for (; i + 4 <= count; i += 4) {
+        __m128 x = _mm_loadu_ps(rects + 4 * i), y = _mm_loadu_ps(rects + 4 * i + 4);
+        __m128 w = _mm_loadu_ps(rects + 4 * i + 8), h = _mm_loadu_ps(rects + 4 * i + 12);
+        _MM_TRANSPOSE4_PS(x, y, w, h);
+        __m128 x1 = _mm_add_ps(x, w), y1 = _mm_add_ps(y, h);
+        __m128 in = _mm_and_ps(_mm_cmple_ps(_mm_min_ps(x, x1), vx1), _mm_cmpge_ps(_mm_max_ps(x, x1), vx0));
+        in = _mm_and_ps(in, _mm_cmple_ps(_mm_min_ps(y, y1), vy1));
+        in = _mm_and_ps(in, _mm_cmpge_ps(_mm_max_ps(y, y1), vy0));
+        /* min/max return the second operand on NaN, x1 and y1 are NaN too then */
+        int mask = _mm_movemask_ps(_mm_and_ps(in, _mm_cmpord_ps(x1, y1)));
+        for (int lane = 0; mask; lane++, mask >>= 1) {
+            if (mask & 1)
+                visible[n++] = i + lane;
+        }
+    }
+#endif
+    for (; i < count; i++) {
+        const float *r = rects + 4 * i;
+        float x1 = r[0] + r[2], y1 = r[1] + r[3];
+        if (fminf(r[0], x1) <= view[2] && fmaxf(r[0], x1) >= view[0] && fminf(r[1], y1) <= view[3]
+            && fmaxf(r[1], y1) >= view[1] && !isnan(x1) && !isnan(y1))
+            visible[n++] = i;
+    }
+    return n;
+}
+
+static PyObject *
+RayPy_BeginMode2D(PyObject *Py_UNUSED(self), PyObject *args)
+{
+    RayPy_Camera2DObject *camera;
+    if (!PyArg_ParseTuple(args, "O!", &RayPy_Camera2D_Type, &camera))
+        return NULL;
+    IS_RENDER_THREAD();
+    RayPy_cull.camera = RayPy_Camera2D_AsCamera2D(camera);
+    RayPy_cull.camera_active = 1;
+    BeginMode2D(RayPy_cull.camera);
+    Py_RETURN_NONE;
+}
+
+PyDoc_STRVAR(begin_mode_2d_doc, "Begin 2D mode with custom camera (2D)");
+
+static PyObject *
+RayPy_EndMode2D(PyObject *Py_UNUSED(self), PyObject *Py_UNUSED(args))
+{
+    IS_RENDER_THREAD();
+    RayPy_cull.camera_active = 0;
+    EndMode2D();
+    Py_RETURN_NONE;
+}
+
+PyDoc_STRVAR(end_mode_2d_doc, "Ends 2D mode with custom camera");
+
+static PyObject *
+RayPy_GetScreenToWorld2D(PyObject *Py_UNUSED(self), PyObject *args)
+{
+    RayPy_Vector2Object *position;
+    RayPy_Camera2DObject *camera;
+    if (!PyArg_ParseTuple(args, "O!O!", &RayPy_Vector2_Type, &position, &RayPy_Camera2D_Type, &camera))
+        return NULL;
+    return RayPy_Vector2_FromVector2(
+        GetScreenToWorld2D((Vector2){position->x, position->y}, RayPy_Camera2D_AsCamera2D(camera)));
+}
+
+PyDoc_STRVAR(get_screen_to_world_2d_doc, "Get the world space position for a 2d camera screen space position");
+
+static PyObject *
+RayPy_GetWorldToScreen2D(PyObject *Py_UNUSED(self), PyObject *args)
+{
+    RayPy_Vector2Object *position;
+    RayPy_Camera2DObject *camera;
+    if (!PyArg_ParseTuple(args, "O!O!", &RayPy_Vector2_Type, &position, &RayPy_Camera2D_Type, &camera))
+        return NULL;
+    return RayPy_Vector2_FromVector2(
+        GetWorldToScreen2D((Vector2){position->x, position->y}, RayPy_Camera2D_AsCamera2D(camera)));
+}
+
+PyDoc_STRVAR(get_world_to_screen_2d_doc, "Get the screen space position for a 2d camera world space position");
+
+static PyObject *
+RayPy_SetCullRect(PyObject *Py_UNUSED(self), PyObject *arg)
+{
+    if (arg == Py_None) {
+        RayPy_cull.rect_set = 0;
+        Py_RETURN_NONE;
+    }
+    if (!PyObject_TypeCheck(arg, &RayPy_Rectangle_Type)) {
+        PyErr_Format(PyExc_TypeError, "must be raypy.Rectangle or None, not %s", Py_TYPE(arg)->tp_name);
+        return NULL;
+    }
+    RayPy_cull.rect = RayPy_Rectangle_AsRectangle((RayPy_RectangleObject *)arg);
+    RayPy_cull.rect_set = 1;
+    Py_RETURN_NONE;
+}
+
+PyDoc_STRVAR(set_cull_rect_doc,
+             "Set the world space rectangle batched draws are culled against, None for the screen as seen "
+             "through the current Camera2D (default)");
+
+static PyObject *
+RayPy_GetCullStats(PyObject *Py_UNUSED(self), PyObject *Py_UNUSED(args))
+{
+    return Py_BuildValue("LLLL", RayPy_cull.drawn, RayPy_cull.culled, RayPy_cull.chunks_drawn,
+                         RayPy_cull.chunks_culled);
+}
+
+PyDoc_STRVAR(get_cull_stats_doc,
+             "Get (drawn, culled, chunks_drawn, chunks_culled) counts since begin_drawing(), of batched "
+             "rectangles and particles then of tilemap chunks");
+
+/* Get a C-contiguous float32 buffer with 4 floats per item, -1 if it isn't one */
+static Py_ssize_t
+RayPy_Rects_GetBuffer(PyObject *obj, Py_buffer *view, const char *name)
+{
+    if (PyObject_GetBuffer(obj, view, PyBUF_C_CONTIGUOUS | PyBUF_FORMAT))
+        return -1;
+    const char *format = view->format;
+    if (format[0] == '@' || format[0] == '=' || format[0] == '<')
+        format++;
+    if (view->itemsize != sizeof(float) || strcmp(format, "f") != 0) {
+        PyErr_Format(PyExc_TypeError, "%s must be a float32 buffer, not format '%s'", name, view->format);
+        goto error;
+    }
+    if (view->len % (4 * sizeof(float)) != 0) {
+        PyErr_Format(PyExc_ValueError, "%s must have 4 floats (x, y, width, height) per rectangle", name);
+        goto error;
+    }
+    if (view->len / (4 * sizeof(float)) > INT_MAX) {
+        PyErr_Format(PyExc_OverflowError, "too many %s", name);
+        goto error;
+    }
+    return view->len / (4 * sizeof(float));
+error:
+    PyBuffer_Release(view);
+    return -1;
+}
+
+#define RAYPY_CULL_CHUNK 1024 // rects culled at a time, so the indices stay on the stack
+
+/* DrawTexturePro() without rotation for each source and dest, sources has one
+   rect for all or one per dest, colors is NULL (all tint) or 4 bytes per dest */
+static void
+RayPy_DrawTextureQuads(Texture texture, const float *sources, int per_dest_source, const float *dests,
+                       const unsigned char *colors, Color tint, const int32_t *indices, int count)
+{
+    float tw = (float)texture.width, th = (float)texture.height;
+    rlSetTexture(texture.id);
+    for (int k = 0; k < count; k++) {
+        int i = indices[k];
+        const float *s = per_dest_source ? sources + 4 * i : sources, *d = dests + 4 * i;
+        float sx = s[0], sy = s[1], sw = s[2], sh = s[3];
+        /* negative source sizes flip, as in DrawTexturePro() */
+        int flip_x = sw < 0.0f;
+        if (flip_x)
+            sw = -sw;
+        if (sh < 0.0f)
+            sy -= sh;
+        float u0 = sx / tw, u1 = (sx + sw) / tw, v0 = sy / th, v1 = (sy + sh) / th;
+        if (flip_x) {
+            float u = u0;
+            u0 = u1;
+            u1 = u;
+        }
+        float x0 = d[0], y0 = d[1], x1 = d[0] + d[2], y1 = d[1] + d[3];
+        Color c = colors != NULL ? (Color){colors[4 * i], colors[4 * i + 1], colors[4 * i + 2], colors[4 * i + 3]}
+                                 : tint;
+        rlCheckRenderBatchLimit(4);
+        rlBegin(RL_QUADS);
+        rlColor4ub(c.r, c.g, c.b, c.a);
+        rlNormal3f(0.0f, 0.0f, 1.0f);
+        rlTexCoord2f(u0, v0);
+        rlVertex2f(x0, y0);
+        rlTexCoord2f(u0, v1);
+        rlVertex2f(x0, y1);
+        rlTexCoord2f(u1, v1);
+        rlVertex2f(x1, y1);
+        rlTexCoord2f(u1, v0);
+        rlVertex2f(x1, y0);
+        rlEnd();
+    }
+    rlSetTexture(0);
+}
+
+static PyObject *
+RayPy_DrawTextureBatch(PyObject *Py_UNUSED(self), PyObject *args, PyObject *keywds)
+{
+    RayPy_TextureObject *texture;
+    PyObject *dests_obj, *sources_obj = Py_None, *colors_obj = Py_None;
+    RayPy_ColorObject *tint = NULL;
+    int cull = 1;
+    Py_buffer dests, sources = {0}, colors = {0};
+    float full[4], view[4];
+    int32_t visible[RAYPY_CULL_CHUNK];
+    static char *kwlist[] = {"texture", "dests", "sources", "tint", "colors", "cull", NULL};
+    if (!PyArg_ParseTupleAndKeywords(args, keywds, "O!O|OO!O$p", kwlist, &RayPy_Texture_Type, &texture, &dests_obj,
+                                     &sources_obj, &RayPy_Color_Type, &tint, &colors_obj, &cull))
+        return NULL;
+    IS_RENDER_THREAD();
+    Py_ssize_t count = RayPy_Rects_GetBuffer(dests_obj, &dests, "dests");
+    if (count < 0)
+        return NULL;
+    const float *source = full;
+    int per_dest_source = 0;
+    if (sources_obj == Py_None) {
+        full[0] = full[1] = 0.0f;
+        full[2] = (float)texture->t.width;
+        full[3] = (float)texture->t.height;
+    }
+    else {
+        Py_ssize_t n = RayPy_Rects_GetBuffer(sources_obj, &sources, "sources");
+        if (n < 0)
+            goto error;
+        if (n != 1 && n != count) {
+            PyErr_Format(PyExc_ValueError, "sources must have 1 or %zd rectangles, not %zd", count, n);
+            goto error;
+        }
+        source = sources.buf;
+        per_dest_source = n != 1;
+    }
+    if (colors_obj != Py_None) {
+        if (PyObject_GetBuffer(colors_obj, &colors, PyBUF_C_CONTIGUOUS | PyBUF_FORMAT))
+            goto error;
+        const char *format = colors.format;
+        if (format[0] == '@' || format[0] == '=' || format[0] == '<' || format[0] == '>' || format[0] == '!')
+            format++;
+        if (colors.itemsize != 1 || (strcmp(format, "B") != 0 && strcmp(format, "b") != 0)) {
+            PyErr_Format(PyExc_TypeError, "colors must be a uint8 buffer, not format '%s'", colors.format);
+            goto error;
+        }
+        if (colors.len != count * 4) {
+            PyErr_Format(PyExc_ValueError, "colors must have 4 bytes (r, g, b, a) per rectangle, got %zd for %zd",
+                         colors.len, count);
+            goto error;
+        }
+    }
+    Color c = tint != NULL ? RayPy_Color_AsColor(tint) : WHITE;
+    if (cull)
+        RayPy_Cull_GetView(view);
+
+    int drawn = 0;
+    for (Py_ssize_t first = 0; first < count; first += RAYPY_CULL_CHUNK) {
+        int n = (int)Py_MIN(count - first, RAYPY_CULL_CHUNK);
+        const float *d = (const float *)dests.buf + 4 * first;
+        int visible_count;
+        if (cull)
+            visible_count = RayPy_Cull_Rects(d, n, view, visible);
+        else {
+            for (int i = 0; i < n; i++)
+                visible[i] = i;
+            visible_count = n;
+        }
+        RayPy_DrawTextureQuads(texture->t, per_dest_source ? source + 4 * first : source, per_dest_source, d,
+                               colors.buf != NULL ? (const unsigned char *)colors.buf + 4 * first : NULL, c,
+                               visible, visible_count);
+        drawn += visible_count;
+    }
+    RayPy_cull.drawn += drawn;
+    RayPy_cull.culled += count - drawn;
+    PyBuffer_Release(&dests);
+    if (sources.obj != NULL)
+        PyBuffer_Release(&sources);
+    if (colors.obj != NULL)
+        PyBuffer_Release(&colors);
+    return PyLong_FromLong(drawn);
+error:
+    PyBuffer_Release(&dests);
+    if (sources.obj != NULL)
+        PyBuffer_Release(&sources);
+    if (colors.obj != NULL)
+        PyBuffer_Release(&colors);
+    return NULL;
+}
+
+PyDoc_STRVAR(draw_texture_batch_doc,
+             "Draw a part of a texture (sources, the whole texture by default) in each rectangle of a float32 "
+             "(n, 4) x, y, width, height buffer, skipping the ones out of view unless cull is False, returns "
+             "how many were drawn");
+
+/* Camera3D */
+
+static Vector3
+RayPy_Vector3_AsVector3(RayPy_Vector3Object *obj)
+{
+    return (Vector3){obj->x, obj->y, obj->z};
+}
+
+static void
+RayPy_Vector3_SetVector3(RayPy_Vector3Object *obj, Vector3 v)
+{
+    obj->x = v.x;
+    obj->y = v.y;
+    obj->z = v.z;
+}
+
+static PyObject *
+RayPy_Vector3_FromVector3(Vector3 v)
+{
+    RayPy_Vector3Object *ret = PyObject_New(RayPy_Vector3Object, &RayPy_Vector3_Type);
+    if (ret == NULL)
+        return NULL;
+    ret->x = v.x;
+    ret->y = v.y;
+    ret->z = v.z;
+    return (PyObject *)ret;
+}
+
+/* position, target and up are Vector3 objects so `camera.position.x += 1` works */
+typedef struct {
+    PyObject_HEAD RayPy_Vector3Object *position;
+    RayPy_Vector3Object *target;
+    RayPy_Vector3Object *up;
+    float fovy;
+    int projection;
+} RayPy_Camera3DObject;
+
+static Camera3D
+RayPy_Camera3D_AsCamera3D(RayPy_Camera3DObject *obj)
+{
+    return (Camera3D){RayPy_Vector3_AsVector3(obj->position), RayPy_Vector3_AsVector3(obj->target),
+                      RayPy_Vector3_AsVector3(obj->up), obj->fovy, obj->projection};
+}
+
+static void
+RayPy_Camera3D_dealloc(RayPy_Camera3DObject *self)
+{
+    Py_XDECREF(self->position);
+    Py_XDECREF(self->target);
+    Py_XDECREF(self->up);
+    PyTypeObject *tp = Py_TYPE(self);
+    tp->tp_free((PyObject *)self);
+    Py_DECREF(tp);
+}
+
+static RayPy_Camera3DObject *
+RayPy_Camera3D_new(PyTypeObject *type, PyObject *Py_UNUSED(args), PyObject *Py_UNUSED(kwds))
+{
+    RayPy_Camera3DObject *self = (RayPy_Camera3DObject *)type->tp_alloc(type, 0);
+    if (self == NULL)
+        return NULL;
+    self->position = (RayPy_Vector3Object *)RayPy_Vector3_FromVector3((Vector3){0, 0, 0});
+    self->target = (RayPy_Vector3Object *)RayPy_Vector3_FromVector3((Vector3){0, 0, 0});
+    self->up = (RayPy_Vector3Object *)RayPy_Vector3_FromVector3((Vector3){0, 1, 0});
+    if (self->position == NULL || self->target == NULL || self->up == NULL) {
+        Py_DECREF(self);
+        return NULL;
+    }
+    self->fovy = 45.0f;
+    self->projection = CAMERA_PERSPECTIVE;
+    return self;
+}
+
+static int
+RayPy_Camera3D_init(RayPy_Camera3DObject *self, PyObject *args, PyObject *kwds)
+{
+    RayPy_Vector3Object *position = NULL, *target = NULL, *up = NULL;
+    static char *kwlist[] = {"position", "target", "up", "fovy", "projection", NULL};
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "|O!O!O!fi", kwlist, &RayPy_Vector3_Type, &position,
+                                     &RayPy_Vector3_Type, &target, &RayPy_Vector3_Type, &up,
+                                     &self->fovy, &self->projection))
+        return -1;
+    if (position != NULL)
+        Py_SETREF(self->position, (RayPy_Vector3Object *)Py_NewRef(position));
+    if (target != NULL)
+        Py_SETREF(self->target, (RayPy_Vector3Object *)Py_NewRef(target));
+    if (up != NULL)
+        Py_SETREF(self->up, (RayPy_Vector3Object *)Py_NewRef(up));
+    return 0;
+}
+
+static PyObject *
+RayPy_Camera3D_get_vector(RayPy_Camera3DObject *self, void *closure)
+{
+    return Py_NewRef(*(PyObject **)((char *)self + (size_t)closure));
+}
+
+static int
+RayPy_Camera3D_set_vector(RayPy_Camera3DObject *self, PyObject *value, void *closure)
+{
+    if (value == NULL || !PyObject_TypeCheck(value, &RayPy_Vector3_Type)) {
+        PyErr_Format(PyExc_TypeError, "must be raypy.Vector3, not %s",
+                     value == NULL ? "deleting" : Py_TYPE(value)->tp_name);
+        return -1;
+    }
+    Py_SETREF(*(PyObject **)((char *)self + (size_t)closure), Py_NewRef(value));
+    return 0;
+}
+
+static PyObject *
+RayPy_Camera3D_repr(RayPy_Camera3DObject *self)
+{
+    PyObject *fovy = PyFloat_FromDouble(self->fovy);
+    PyObject *ret = PyUnicode_FromFormat("Camera3D(%R, %R, %R, %R, %d)", self->position, self->target,
+                                         self->up, fovy, self->projection);
+    Py_XDECREF(fovy);
+    return ret;
+}
+
+static PyMemberDef RayPy_Camera3D_members[] = {
+    {"fovy", Py_T_FLOAT, offsetof(RayPy_Camera3DObject, fovy), 0, "Camera field-of-view aperture in Y (degrees) in perspective, used as near plane width in orthographic"},
+    {"projection", Py_T_INT, offsetof(RayPy_Camera3DObject, projection), 0, "Camera projection: CAMERA_PERSPECTIVE or CAMERA_ORTHOGRAPHIC"},
+    {NULL}
+};
+
+static PyGetSetDef RayPy_Camera3D_getset[] = {
+    {"position", (getter)RayPy_Camera3D_get_vector, (setter)RayPy_Camera3D_set_vector, "Camera position", (void *)offsetof(RayPy_Camera3DObject, position)},
+    {"target", (getter)RayPy_Camera3D_get_vector, (setter)RayPy_Camera3D_set_vector, "Camera target it looks-at", (void *)offsetof(RayPy_Camera3DObject, target)},
+    {"up", (getter)RayPy_Camera3D_get_vector, (setter)RayPy_Camera3D_set_vector, "Camera up vector (rotation over its axis)", (void *)offsetof(RayPy_Camera3DObject, up)},
+    {NULL}
+};
+
+static PyType_Slot RayPy_Camera3D_slots[] = {
+    {Py_tp_doc, PyDoc_STR("Camera3D, defines position/orientation in 3d space")},
+    {Py_tp_new, RayPy_Camera3D_new},
+    {Py_tp_init, RayPy_Camera3D_init},
+    {Py_tp_repr, RayPy_Camera3D_repr},
+    {Py_tp_dealloc, RayPy_Camera3D_dealloc},
+    {Py_tp_members, RayPy_Camera3D_members},
+    {Py_tp_getset, RayPy_Camera3D_getset},
+    {0, NULL},
+};
+
+static PyType_Spec RayPy_Camera3D_spec = {
+    .name = "raypy.Camera3D",
+    .basicsize = sizeof(RayPy_Camera3DObject),
+    .itemsize = 0,
+    .flags = Py_TPFLAGS_DEFAULT | Py_TPFLAGS_BASETYPE | Py_TPFLAGS_IMMUTABLETYPE,
+    .slots = RayPy_Camera3D_slots,
+};
+
+static PyObject *
+RayPy_BeginMode3D(PyObject *Py_UNUSED(self), PyObject *args)
+{
+    RayPy_Camera3DObject *camera;
+    if (!PyArg_ParseTuple(args, "O!", &RayPy_Camera3D_Type, &camera))
+        return NULL;
+    IS_RENDER_THREAD();
+    BeginMode3D(RayPy_Camera3D_AsCamera3D(camera));
+    Py_RETURN_NONE;
+}
+
+PyDoc_STRVAR(begin_mode_3d_doc, "Begin 3D mode with custom camera (3D)");
+
+static PyObject *
+RayPy_EndMode3D(PyObject *Py_UNUSED(self), PyObject *Py_UNUSED(args))
+{
+    IS_RENDER_THREAD();
+    EndMode3D();
+    Py_RETURN_NONE;
+}
+
+PyDoc_STRVAR(end_mode_3d_doc, "Ends 3D mode and returns to default 2D orthographic mode");
+
+static PyObject *
+RayPy_UpdateCamera(PyObject *Py_UNUSED(self), PyObject *args)
+{
+    RayPy_Camera3DObject *camera;
+    int mode;
+    if (!PyArg_ParseTuple(args, "O!i", &RayPy_Camera3D_Type, &camera, &mode))
+        return NULL;
+    WINDOW_IS_READY();
+    Camera3D c = RayPy_Camera3D_AsCamera3D(camera);
+    UpdateCamera(&c, mode);
+    RayPy_Vector3_SetVector3(camera->position, c.position);
+    RayPy_Vector3_SetVector3(camera->target, c.target);
+    RayPy_Vector3_SetVector3(camera->up, c.up);
+    camera->fovy = c.fovy;
+    camera->projection = c.projection;
+    Py_RETURN_NONE;
+}
+
+PyDoc_STRVAR(update_camera_doc, "Update camera position for selected mode");
+
+static PyObject *
+RayPy_DrawGrid(PyObject *Py_UNUSED(self), PyObject *args)
+{
+    int slices;
+    float spacing;
+    if (!PyArg_ParseTuple(args, "if", &slices, &spacing))
+        return NULL;
+    IS_RENDER_THREAD();
+    DrawGrid(slices, spacing);
+    Py_RETURN_NONE;
+}
+
+PyDoc_STRVAR(draw_grid_doc, "Draw a grid (centered at (0, 0, 0))");
+
+/* Mesh
+
+   Vertex data lives in raylib's arrays and is exposed as buffers, numpy
+   arrays made from them write straight into what upload_mesh() and
+   update_mesh_buffer() send to the GPU. */
+
+
+typedef struct {
+    PyObject_HEAD Mesh m;
+    Py_ssize_t exports; // buffers handed out, the arrays can't be freed meanwhile
+} RayPy_MeshObject;
+
+/* Vertex buffers in raylib's vboId order */
+enum {
+    RAYPY_MESH_BUFFER_VERTICES,
+    RAYPY_MESH_BUFFER_TEXCOORDS,
+    RAYPY_MESH_BUFFER_NORMALS,
+    RAYPY_MESH_BUFFER_COLORS,
+    RAYPY_MESH_BUFFER_TANGENTS,
+    RAYPY_MESH_BUFFER_TEXCOORDS2,
+    RAYPY_MESH_BUFFER_INDICES,
+    RAYPY_MESH_BUFFER_COUNT
+};
+
+static const struct {
+    const char *format;
+    int components;
+    int size; // of a component
+} RayPy_mesh_buffers[RAYPY_MESH_BUFFER_COUNT] = {
+    {"f", 3, sizeof(float)},
+    {"f", 2, sizeof(float)},
+    {"f", 3, sizeof(float)},
+    {"B", 4, sizeof(unsigned char)},
+    {"f", 4, sizeof(float)},
+    {"f", 2, sizeof(float)},
+    {"H", 3, sizeof(unsigned short)},
+};
+
+static void *
+RayPy_Mesh_Array(Mesh *mesh, int index)
+{
+    switch (index) {
+    case RAYPY_MESH_BUFFER_VERTICES: return mesh->vertices;
+    case RAYPY_MESH_BUFFER_TEXCOORDS: return mesh->texcoords;
+    case RAYPY_MESH_BUFFER_NORMALS: return mesh->normals;
+    case RAYPY_MESH_BUFFER_COLORS: return mesh->colors;
+    case RAYPY_MESH_BUFFER_TANGENTS: return mesh->tangents;
+    case RAYPY_MESH_BUFFER_TEXCOORDS2: return mesh->texcoords2;
+    case RAYPY_MESH_BUFFER_INDICES: return mesh->indices;
+    }
+    return NULL;
+}
+
+/* rows in a buffer: vertices, or triangles for indices */
+static int
+RayPy_Mesh_Rows(Mesh *mesh, int index)
+{
+    return index == RAYPY_MESH_BUFFER_INDICES ? mesh->triangleCount : mesh->vertexCount;
+}
+
+static void
+RayPy_Mesh_FreeArrays(Mesh *mesh)
+{
+    RL_FREE(mesh->vertices);
+    RL_FREE(mesh->texcoords);
+    RL_FREE(mesh->texcoords2);
+    RL_FREE(mesh->normals);
+    RL_FREE(mesh->tangents);
+    RL_FREE(mesh->colors);
+    RL_FREE(mesh->indices);
+    RL_FREE(mesh->animVertices);
+    RL_FREE(mesh->animNormals);
+    RL_FREE(mesh->boneIds);
+    RL_FREE(mesh->boneWeights);
+    RL_FREE(mesh->vboId);
+}
+
+static void
+RayPy_Mesh_dealloc(RayPy_MeshObject *self)
+{
+    /* GPU buffers can only go on the render thread while the context is
+       alive, other threads leave them to the next begin_drawing() */
+    if (IsWindowReady() && !RayPy_OffRenderThread())
+        UnloadMesh(self->m);
+    else {
+        RayPy_GL_Release(RAYPY_GL_VERTEX_ARRAY, self->m.vaoId);
+        for (int i = 0; self->m.vboId != NULL && i < RAYPY_MESH_BUFFER_COUNT; i++)
+            RayPy_GL_Release(RAYPY_GL_VERTEX_BUFFER, self->m.vboId[i]);
+        RayPy_Mesh_FreeArrays(&self->m);
+    }
+    PyTypeObject *tp = Py_TYPE(self);
+    tp->tp_free((PyObject *)self);
+    Py_DECREF(tp);
+}
+
+static PyObject *
+RayPy_Mesh_FromMesh(Mesh mesh)
+{
+    RayPy_MeshObject *ret = PyObject_New(RayPy_MeshObject, &RayPy_Mesh_Type);
+    if (ret == NULL) {
+        UnloadMesh(mesh);
+        return NULL;
+    }
+    ret->m = mesh;
+    ret->exports = 0;
+    return (PyObject *)ret;
+}
+
+static RayPy_MeshObject *
+RayPy_Mesh_new(PyTypeObject *type, PyObject *Py_UNUSED(args), PyObject *Py_UNUSED(kwds))
+{
+    return (RayPy_MeshObject *)type->tp_alloc(type, 0);
+}
+
+static int
+RayPy_Mesh_init(RayPy_MeshObject *self, PyObject *args, PyObject *kwds)
+{
+    int vertex_count, triangle_count = 0;
+    int texcoords = 1, normals = 1, colors = 0, tangents = 0, texcoords2 = 0;
+    static char *kwlist[] = {"vertex_count", "triangle_count", "texcoords", "normals", "colors",
+                             "tangents", "texcoords2", NULL};
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "i|i$ppppp", kwlist, &vertex_count, &triangle_count,
+                                     &texcoords, &normals, &colors, &tangents, &texcoords2))
+        return -1;
+    if (self->m.vertices != NULL || self->exports > 0) {
+        PyErr_SetString(PyExc_RuntimeError, "mesh is already initialized");
+        return -1;
+    }
+    if (vertex_count <= 0 || triangle_count < 0) {
+        PyErr_SetString(PyExc_ValueError, "vertex_count must be > 0 and triangle_count >= 0");
+        return -1;
+    }
+    if (triangle_count > 0 && vertex_count > 65536) {
+        PyErr_SetString(PyExc_ValueError, "indexed meshes can have 65536 vertices at most");
+        return -1;
+    }
+    /* RL_CALLOC so UnloadMesh() can free them */
+    Mesh m = {0};
+    m.vertexCount = vertex_count;
+    m.triangleCount = triangle_count > 0 ? triangle_count : vertex_count / 3;
+    m.vertices = RL_CALLOC((size_t)vertex_count * 3, sizeof(float));
+    if (texcoords)
+        m.texcoords = RL_CALLOC((size_t)vertex_count * 2, sizeof(float));
+    if (normals)
+        m.normals = RL_CALLOC((size_t)vertex_count * 3, sizeof(float));
+    if (colors)
+        m.colors = RL_CALLOC((size_t)vertex_count * 4, sizeof(unsigned char));
+    if (tangents)
+        m.tangents = RL_CALLOC((size_t)vertex_count * 4, sizeof(float));
+    if (texcoords2)
+        m.texcoords2 = RL_CALLOC((size_t)vertex_count * 2, sizeof(float));
+    if (triangle_count > 0)
+        m.indices = RL_CALLOC((size_t)triangle_count * 3, sizeof(unsigned short));
+    if (m.vertices == NULL || (texcoords && m.texcoords == NULL) || (normals && m.normals == NULL)
+        || (colors && m.colors == NULL) || (tangents && m.tangents == NULL)
+        || (texcoords2 && m.texcoords2 == NULL) || (triangle_count > 0 && m.indices == NULL)) {
+        RayPy_Mesh_FreeArrays(&m);
+        PyErr_NoMemory();
+        return -1;
+    }
+    self->m = m;
+    return 0;
+}
+
+/* A view of one of the mesh arrays, only lives to hand out buffers */
+typedef struct {
+    PyObject_HEAD RayPy_MeshObject *mesh;
+    int index;
+} RayPy_MeshBufferObject;
+
+static void
+RayPy_MeshBuffer_dealloc(RayPy_MeshBufferObject *self)
+{
+    Py_XDECREF(self->mesh);
+    PyTypeObject *tp = Py_TYPE(self);
+    tp->tp_free((PyObject *)self);
+    Py_DECREF(tp);
+}
+
+static int
+RayPy_MeshBuffer_getbuffer(RayPy_MeshBufferObject *self, Py_buffer *view, int flags)
+{
+    Mesh *m = &self->mesh->m;
+    void *array = RayPy_Mesh_Array(m, self->index);
+    if (array == NULL) {
+        PyErr_SetString(PyExc_BufferError, "mesh array was unloaded");
+        return -1;
+    }
+    int components = RayPy_mesh_buffers[self->index].components;
+    int size = RayPy_mesh_buffers[self->index].size;
+    view->obj = Py_NewRef(self);
+    view->buf = array;
+    view->len = (Py_ssize_t)RayPy_Mesh_Rows(m, self->index) * components * size;
+    view->readonly = 0;
+    view->itemsize = size;
+    view->format = (flags & PyBUF_FORMAT) ? (char *)RayPy_mesh_buffers[self->index].format : NULL;
+    view->ndim = 2;
+    view->shape = NULL;
+    view->strides = NULL;
+    view->suboffsets = NULL;
+    view->internal = NULL;
+    if (flags & PyBUF_ND) {
+        /* shape then strides, freed on release */
+        Py_ssize_t *shape = PyMem_Malloc(4 * sizeof(Py_ssize_t));
+        if (shape == NULL) {
+            Py_CLEAR(view->obj);
+            PyErr_NoMemory();
+            return -1;
+        }
+        shape[0] = RayPy_Mesh_Rows(m, self->index);
+        shape[1] = components;
+        shape[2] = (Py_ssize_t)components * size;
+        shape[3] = size;
+        view->internal = shape;
+        view->shape = shape;
+        if ((flags & PyBUF_STRIDES) == PyBUF_STRIDES)
+            view->strides = shape + 2;
+    }
+    else {
+        view->ndim = 1; // plain bytes
+        view->itemsize = 1;
+        if (view->format != NULL)
+            view->format = "B";
+    }
+    self->mesh->exports++;
+    return 0;
+}
+
+static void
+RayPy_MeshBuffer_releasebuffer(RayPy_MeshBufferObject *self, Py_buffer *view)
+{
+    PyMem_Free(view->internal);
+    self->mesh->exports--;
+}
+
+static PyType_Slot RayPy_MeshBuffer_slots[] = {
+    {Py_tp_dealloc, RayPy_MeshBuffer_dealloc},
+    {Py_bf_getbuffer, RayPy_MeshBuffer_getbuffer},
+    {Py_bf_releasebuffer, RayPy_MeshBuffer_releasebuffer},
+    {0, NULL},
+};
+
+static PyType_Spec RayPy_MeshBuffer_spec = {
+    .name = "raypy._MeshBuffer",
+    .basicsize = sizeof(RayPy_MeshBufferObject),
+    .itemsize = 0,
+    .flags = Py_TPFLAGS_DEFAULT | Py_TPFLAGS_IMMUTABLETYPE | Py_TPFLAGS_DISALLOW_INSTANTIATION,
+    .slots = RayPy_MeshBuffer_slots,
+};
+
+static PyObject *
+RayPy_Mesh_get_array(RayPy_MeshObject *self, void *closure)
+{
+    int index = (int)(intptr_t)closure;
+    if (RayPy_Mesh_Array(&self->m, index) == NULL)
+        Py_RETURN_NONE;
+    RayPy_MeshBufferObject *buffer = PyObject_New(RayPy_MeshBufferObject, &RayPy_MeshBuffer_Type);
+    if (buffer == NULL)
+        return NULL;
+    buffer->mesh = (RayPy_MeshObject *)Py_NewRef(self);
+    buffer->index = index;
+    PyObject *ret = PyMemoryView_FromObject((PyObject *)buffer);
+    Py_DECREF(buffer);
+    return ret;
+}
+
+static PyMemberDef RayPy_Mesh_members[] = {
+    {"vertex_count", Py_T_INT, offsetof(RayPy_MeshObject, m.vertexCount), Py_READONLY, "Number of vertices stored in arrays"},
+    {"triangle_count", Py_T_INT, offsetof(RayPy_MeshObject, m.triangleCount), Py_READONLY, "Number of triangles stored (indexed or not)"},
+    {"vao_id", Py_T_UINT, offsetof(RayPy_MeshObject, m.vaoId), Py_READONLY, "OpenGL Vertex Array Object id, 0 until uploaded"},
+    {NULL}
+};
+
+static PyGetSetDef RayPy_Mesh_getset[] = {
+    {"vertices", (getter)RayPy_Mesh_get_array, NULL, "Vertex position (XYZ - 3 components per vertex), float32 memoryview of shape (vertex_count, 3)", (void *)RAYPY_MESH_BUFFER_VERTICES},
+    {"texcoords", (getter)RayPy_Mesh_get_array, NULL, "Vertex texture coordinates (UV - 2 components per vertex), None if the mesh has none", (void *)RAYPY_MESH_BUFFER_TEXCOORDS},
+    {"normals", (getter)RayPy_Mesh_get_array, NULL, "Vertex normals (XYZ - 3 components per vertex), None if the mesh has none", (void *)RAYPY_MESH_BUFFER_NORMALS},
+    {"colors", (getter)RayPy_Mesh_get_array, NULL, "Vertex colors (RGBA - 4 uint8 components per vertex), None if the mesh has none", (void *)RAYPY_MESH_BUFFER_COLORS},
+    {"tangents", (getter)RayPy_Mesh_get_array, NULL, "Vertex tangents (XYZW - 4 components per vertex), None if the mesh has none", (void *)RAYPY_MESH_BUFFER_TANGENTS},
+    {"texcoords2", (getter)RayPy_Mesh_get_array, NULL, "Vertex texture second coordinates (UV - 2 components per vertex), None if the mesh has none", (void *)RAYPY_MESH_BUFFER_TEXCOORDS2},
+    {"indices", (getter)RayPy_Mesh_get_array, NULL, "Vertex indices, uint16 memoryview of shape (triangle_count, 3), None if not indexed", (void *)RAYPY_MESH_BUFFER_INDICES},
+    {NULL}
+};
+
+static PyType_Slot RayPy_Mesh_slots[] = {
+    {Py_tp_doc, PyDoc_STR("Mesh, vertex data and vao/vbo")},
+    {Py_tp_new, RayPy_Mesh_new},
+    {Py_tp_init, RayPy_Mesh_init},
+    {Py_tp_dealloc, RayPy_Mesh_dealloc},
+    {Py_tp_members, RayPy_Mesh_members},
+    {Py_tp_getset, RayPy_Mesh_getset},
+    {0, NULL},
+};
+
+static PyType_Spec RayPy_Mesh_spec = {
+    .name = "raypy.Mesh",
+    .basicsize = sizeof(RayPy_MeshObject),
+    .itemsize = 0,
+    .flags = Py_TPFLAGS_DEFAULT | Py_TPFLAGS_BASETYPE | Py_TPFLAGS_IMMUTABLETYPE,
+    .slots = RayPy_Mesh_slots,
+};
+
+static PyObject *
+RayPy_UploadMesh(PyObject *Py_UNUSED(self), PyObject *args)
+{
+    RayPy_MeshObject *mesh;
+    int dynamic = 0;
+    if (!PyArg_ParseTuple(args, "O!|p", &RayPy_Mesh_Type, &mesh, &dynamic))
+        return NULL;
+    IS_RENDER_THREAD();
+    if (mesh->m.vertices == NULL) {
+        PyErr_SetString(PyExc_ValueError, "mesh has no vertices");
+        return NULL;
+    }
+    if (mesh->m.vaoId != 0 || mesh->m.vboId != NULL) {
+        PyErr_SetString(PyExc_RuntimeError, "mesh is already uploaded, use update_mesh_buffer()");
+        return NULL;
+    }
+    UploadMesh(&mesh->m, dynamic);
+    Py_RETURN_NONE;
+}
+
+PyDoc_STRVAR(upload_mesh_doc, "Upload mesh vertex data in GPU and provide VAO/VBO ids, dynamic for meshes updated often");
+
+static PyObject *
+RayPy_UpdateMeshBuffer(PyObject *Py_UNUSED(self), PyObject *args)
+{
+    RayPy_MeshObject *mesh;
+    int index, first = 0, count = -1;
+    if (!PyArg_ParseTuple(args, "O!i|ii", &RayPy_Mesh_Type, &mesh, &index, &first, &count))
+        return NULL;
+    IS_RENDER_THREAD();
+    if (index < 0 || index >= RAYPY_MESH_BUFFER_COUNT)
+        return PyErr_Format(PyExc_ValueError, "invalid mesh buffer: %d", index);
+    void *array = RayPy_Mesh_Array(&mesh->m, index);
+    if (array == NULL || mesh->m.vboId == NULL || mesh->m.vboId[index] == 0) {
+        PyErr_SetString(PyExc_ValueError, "mesh buffer is not uploaded");
+        return NULL;
+    }
+    int rows = RayPy_Mesh_Rows(&mesh->m, index);
+    if (count < 0)
+        count = rows - first;
+    if (first < 0 || first > rows || count > rows - first) {
+        PyErr_Format(PyExc_IndexError, "rows [%d, %d) out of range for %d rows", first, first + count, rows);
+        return NULL;
+    }
+    int row = RayPy_mesh_buffers[index].components * RayPy_mesh_buffers[index].size;
+    if (count > 0)
+        UpdateMeshBuffer(mesh->m, index, (unsigned char *)array + (size_t)first * row, count * row, first * row);
+    Py_RETURN_NONE;
+}
+
+PyDoc_STRVAR(update_mesh_buffer_doc,
+             "Upload `count` rows (vertices, or triangles for MESH_BUFFER_INDICES) of a mesh array from `first` to the GPU");
+
+static PyObject *
+RayPy_UnloadMesh(PyObject *Py_UNUSED(self), PyObject *args)
+{
+    RayPy_MeshObject *mesh;
+    if (!PyArg_ParseTuple(args, "O!", &RayPy_Mesh_Type, &mesh))
+        return NULL;
+    WINDOW_IS_READY();
+    if (mesh->exports > 0) {
+        PyErr_SetString(PyExc_BufferError, "mesh arrays are still used by buffers");
+        return NULL;
+    }
+    UnloadMesh(mesh->m);
+    memset(&mesh->m, 0, sizeof(mesh->m));
+    Py_RETURN_NONE;
+}
+
+PyDoc_STRVAR(unload_mesh_doc, "Unload mesh data from CPU and GPU");
+
+static PyObject *
+RayPy_GenMeshPlane(PyObject *Py_UNUSED(self), PyObject *args)
+{
+    float width, length;
+    int resX, resZ;
+    if (!PyArg_ParseTuple(args, "ffii", &width, &length, &resX, &resZ))
+        return NULL;
+    WINDOW_IS_READY();
+    if (resX < 1 || resZ < 1 || (resX + 1) * (resZ + 1) > 65536) {
+        PyErr_SetString(PyExc_ValueError, "resolution must be >= 1 with 65536 vertices at most");
+        return NULL;
+    }
+    return RayPy_Mesh_FromMesh(GenMeshPlane(width, length, resX, resZ));
+}
+
+PyDoc_STRVAR(gen_mesh_plane_doc, "Generate plane mesh (with subdivisions), already uploaded");
+
+static PyObject *
+RayPy_GenMeshCube(PyObject *Py_UNUSED(self), PyObject *args)
+{
+    float width, height, length;
+    if (!PyArg_ParseTuple(args, "fff", &width, &height, &length))
+        return NULL;
+    WINDOW_IS_READY();
+    return RayPy_Mesh_FromMesh(GenMeshCube(width, height, length));
+}
+
+PyDoc_STRVAR(gen_mesh_cube_doc, "Generate cuboid mesh, already uploaded");
+
+/* Model */
+
+typedef struct {
+    PyObject_HEAD Model m;
+    RayPy_MeshObject *mesh; // load_model_from_mesh(): not owned, drawn as it is at draw time
+} RayPy_ModelObject;
+
+static void
+RayPy_Model_dealloc(RayPy_ModelObject *self)
+{
+    Py_XDECREF(self->mesh);
+    PyTypeObject *tp = Py_TYPE(self);
+    tp->tp_free((PyObject *)self);
+    Py_DECREF(tp);
+}
+
+static int
+RayPy_Model_init(RayPy_ModelObject *self, PyObject *args, PyObject *Py_UNUSED(kwds))
+{
+    PyErr_SetString(PyExc_TypeError,
+                    "raypy.Model cannot be instantiated directly from"
+                    " Python. Use the provided module-level functions"
+                    " instead.");
+    return -1;
+}
+
+static PyMemberDef RayPy_Model_members[] = {
+    {"mesh_count", Py_T_INT, offsetof(RayPy_ModelObject, m.meshCount), Py_READONLY, "Number of meshes"},
+    {"material_count", Py_T_INT, offsetof(RayPy_ModelObject, m.materialCount), Py_READONLY, "Number of materials"},
+    {NULL}
+};
+
+static PyType_Slot RayPy_Model_slots[] = {
+    {Py_tp_doc, PyDoc_STR("Model, meshes, materials and animation data")},
+    {Py_tp_new, PyType_GenericNew},
+    {Py_tp_init, RayPy_Model_init},
+    {Py_tp_dealloc, RayPy_Model_dealloc},
+    {Py_tp_members, RayPy_Model_members},
+    {0, NULL},
+};
+
+static PyType_Spec RayPy_Model_spec = {
+    .name = "raypy.Model",
+    .basicsize = sizeof(RayPy_ModelObject),
+    .itemsize = 0,
+    .flags = Py_TPFLAGS_DEFAULT | Py_TPFLAGS_BASETYPE | Py_TPFLAGS_IMMUTABLETYPE,
+    .slots = RayPy_Model_slots,
+};
+
+static PyObject *
+RayPy_Model_FromModel(Model model, RayPy_MeshObject *mesh)
+{
+    RayPy_ModelObject *ret = PyObject_New(RayPy_ModelObject, &RayPy_Model_Type);
+    if (ret == NULL)
+        return NULL;
+    ret->m = model;
+    ret->mesh = (RayPy_MeshObject *)Py_XNewRef(mesh);
+    return (PyObject *)ret;
+}
+
+static PyObject *
+RayPy_LoadModel(PyObject *Py_UNUSED(self), PyObject *args)
+{
+    const char *fileName;
+    Model model;
+    if (!PyArg_ParseTuple(args, "s", &fileName))
+        return NULL;
+    WINDOW_IS_READY();
+    /* the GL context is current on this thread whether the GIL is held or not */
+    Py_BEGIN_ALLOW_THREADS
+    model = LoadModel(fileName);
+    Py_END_ALLOW_THREADS
+    if (model.meshCount == 0)
+        return PyErr_Format(PyExc_OSError, "failed to load model %R", PyTuple_GET_ITEM(args, 0));
+    return RayPy_Model_FromModel(model, NULL);
+}
+
+PyDoc_STRVAR(load_model_doc, "Load model from files (meshes and materials)");
+
+static PyObject *
+RayPy_LoadModelFromMesh(PyObject *Py_UNUSED(self), PyObject *args)
+{
+    RayPy_MeshObject *mesh;
+    if (!PyArg_ParseTuple(args, "O!", &RayPy_Mesh_Type, &mesh))
+        return NULL;
+    WINDOW_IS_READY();
+    if (mesh->m.vertices == NULL) {
+        PyErr_SetString(PyExc_ValueError, "mesh has no vertices");
+        return NULL;
+    }
+    if (mesh->m.vaoId == 0 && mesh->m.vboId == NULL)
+        UploadMesh(&mesh->m, false);
+    return RayPy_Model_FromModel(LoadModelFromMesh(mesh->m), mesh);
+}
+
+PyDoc_STRVAR(load_model_from_mesh_doc,
+             "Load model from a mesh (uploaded first if needed), the mesh stays owned by the Mesh object");
+
+static PyObject *
+RayPy_UnloadModel(PyObject *Py_UNUSED(self), PyObject *args)
+{
+    RayPy_ModelObject *model;
+    if (!PyArg_ParseTuple(args, "O!", &RayPy_Model_Type, &model))
+        return NULL;
+    WINDOW_IS_READY();
+    if (model->mesh != NULL)
+        model->m.meshCount = 0; // UnloadModel() would free the Mesh object's arrays
+    UnloadModel(model->m);
+    memset(&model->m, 0, sizeof(model->m));
+    Py_CLEAR(model->mesh);
+    Py_RETURN_NONE;
+}
+
+PyDoc_STRVAR(unload_model_doc, "Unload model (including meshes) from memory (RAM and/or VRAM)");
+
+static int
+RayPy_Model_Sync(RayPy_ModelObject *model)
+{
+    if (model->m.meshCount == 0) {
+        PyErr_SetString(PyExc_ValueError, "model is unloaded");
+        return -1;
+    }
+    if (model->mesh != NULL) {
+        /* unload_mesh() zeroes the mesh the model was made from */
+        if (model->mesh->m.vertices == NULL || model->mesh->m.vboId == NULL) {
+            PyErr_SetString(PyExc_ValueError, "the model's mesh is unloaded");
+            return -1;
+        }
+        model->m.meshes[0] = model->mesh->m;
+    }
+    return 0;
+}
+
+static PyObject *
+RayPy_DrawModelWith(PyObject *args, void (*draw)(Model, Vector3, float, Color))
+{
+    RayPy_ModelObject *model;
+    RayPy_Vector3Object *position;
+    RayPy_ColorObject *tint;
+    float scale;
+    if (!PyArg_ParseTuple(args, "O!O!fO!", &RayPy_Model_Type, &model, &RayPy_Vector3_Type, &position,
+                          &scale, &RayPy_Color_Type, &tint))
+        return NULL;
+    IS_RENDER_THREAD();
+    if (RayPy_Model_Sync(model))
+        return NULL;
+    draw(model->m, RayPy_Vector3_AsVector3(position), scale, RayPy_Color_AsColor(tint));
+    Py_RETURN_NONE;
+}
+
+static PyObject *
+RayPy_DrawModel(PyObject *Py_UNUSED(self), PyObject *args)
+{
+    return RayPy_DrawModelWith(args, DrawModel);
+}
+
+PyDoc_STRVAR(draw_model_doc, "Draw a model (with texture if set)");
+
+static PyObject *
+RayPy_DrawModelWires(PyObject *Py_UNUSED(self), PyObject *args)
+{
+    return RayPy_DrawModelWith(args, DrawModelWires);
+}
+
+PyDoc_STRVAR(draw_model_wires_doc, "Draw a model wires (with texture if set)");
+
+static PyObject *
+RayPy_SetModelTexture(PyObject *Py_UNUSED(self), PyObject *args)
+{
+    RayPy_ModelObject *model;
+    RayPy_TextureObject *texture;
+    int material = 0;
+    if (!PyArg_ParseTuple(args, "O!O!|i", &RayPy_Model_Type, &model, &RayPy_Texture_Type, &texture, &material))
+        return NULL;
+    if (material < 0 || material >= model->m.materialCount)
+        return PyErr_Format(PyExc_IndexError, "material %d out of range", material);
+    SetMaterialTexture(&model->m.materials[material], MATERIAL_MAP_DIFFUSE, texture->t);
+    Py_RETURN_NONE;
+}
+
+PyDoc_STRVAR(set_model_texture_doc, "Set the diffuse texture of a model material (the first one by default)");
+
+/* Material */
+
+#ifndef MAX_MATERIAL_MAPS
+#define MAX_MATERIAL_MAPS 12 // raylib's config.h default, not exported by raylib.h
+#endif
+
+typedef struct {
+    PyObject_HEAD Material m; // unused for model materials, they're looked up when used
+    RayPy_ModelObject *owner; // Model the material belongs to, NULL for load_material_default()
+    int index;                // in owner's materials
+} RayPy_MaterialObject;
+
+static void
+RayPy_Material_dealloc(RayPy_MaterialObject *self)
+{
+    /* textures and shader stay with their own objects, only the maps are ours */
+    if (self->owner == NULL)
+        RL_FREE(self->m.maps);
+    Py_XDECREF(self->owner);
+    PyTypeObject *tp = Py_TYPE(self);
+    tp->tp_free((PyObject *)self);
+    Py_DECREF(tp);
+}
+
+static int
+RayPy_Material_init(RayPy_MaterialObject *self, PyObject *args, PyObject *Py_UNUSED(kwds))
+{
+    PyErr_SetString(PyExc_TypeError,
+                    "raypy.Material cannot be instantiated directly from"
+                    " Python. Use the provided module-level functions"
+                    " instead.");
+    return -1;
+}
+
+static Material *
+RayPy_Material_Get(RayPy_MaterialObject *self)
+{
+    if (self->owner == NULL)
+        return &self->m;
+    if (self->index >= self->owner->m.materialCount) {
+        PyErr_SetString(PyExc_ValueError, "model of the material is unloaded");
+        return NULL;
+    }
+    return &self->owner->m.materials[self->index];
+}
+
+static PyObject *
+RayPy_Material_get_shader_id(RayPy_MaterialObject *self, void *Py_UNUSED(closure))
+{
+    Material *material = RayPy_Material_Get(self);
+    if (material == NULL)
+        return NULL;
+    return PyLong_FromUnsignedLong(material->shader.id);
+}
+
+static PyGetSetDef RayPy_Material_getset[] = {
+    {"shader_id", (getter)RayPy_Material_get_shader_id, NULL, "OpenGL id of the material shader", NULL},
+    {NULL}
+};
+
+static PyType_Slot RayPy_Material_slots[] = {
+    {Py_tp_doc, PyDoc_STR("Material, includes shader and maps")},
+    {Py_tp_new, PyType_GenericNew},
+    {Py_tp_init, RayPy_Material_init},
+    {Py_tp_dealloc, RayPy_Material_dealloc},
+    {Py_tp_getset, RayPy_Material_getset},
+    {0, NULL},
+};
+
+static PyType_Spec RayPy_Material_spec = {
+    .name = "raypy.Material",
+    .basicsize = sizeof(RayPy_MaterialObject),
+    .itemsize = 0,
+    .flags = Py_TPFLAGS_DEFAULT | Py_TPFLAGS_BASETYPE | Py_TPFLAGS_IMMUTABLETYPE,
+    .slots = RayPy_Material_slots,
+};
+
+static PyObject *
+RayPy_Material_New(Material material, RayPy_ModelObject *owner, int index)
+{
+    RayPy_MaterialObject *ret = PyObject_New(RayPy_MaterialObject, &RayPy_Material_Type);
+    if (ret == NULL) {
+        if (owner == NULL)
+            RL_FREE(material.maps);
+        return NULL;
+    }
+    ret->m = material;
+    ret->owner = (RayPy_ModelObject *)Py_XNewRef(owner);
+    ret->index = index;
+    return (PyObject *)ret;
+}
+
+static PyObject *
+RayPy_LoadMaterialDefault(PyObject *Py_UNUSED(self), PyObject *Py_UNUSED(args))
+{
+    WINDOW_IS_READY();
+    return RayPy_Material_New(LoadMaterialDefault(), NULL, 0);
+}
+
+PyDoc_STRVAR(load_material_default_doc, "Load default material (Supports: DIFFUSE, SPECULAR, NORMAL maps)");
+
+static PyObject *
+RayPy_GetModelMaterial(PyObject *Py_UNUSED(self), PyObject *args)
+{
+    RayPy_ModelObject *model;
+    int index = 0;
+    if (!PyArg_ParseTuple(args, "O!|i", &RayPy_Model_Type, &model, &index))
+        return NULL;
+    if (index < 0 || index >= model->m.materialCount)
+        return PyErr_Format(PyExc_IndexError, "material %d out of range", index);
+    return RayPy_Material_New((Material){0}, model, index);
+}
+
+PyDoc_STRVAR(get_model_material_doc, "Get a material of a model (the first one by default), changes to it apply to the model");
+
+static PyObject *
+RayPy_SetMaterialTexture(PyObject *Py_UNUSED(self), PyObject *args)
+{
+    RayPy_MaterialObject *obj;
+    RayPy_TextureObject *texture;
+    Material *material;
+    int mapType;
+    if (!PyArg_ParseTuple(args, "O!iO!", &RayPy_Material_Type, &obj, &mapType, &RayPy_Texture_Type, &texture))
+        return NULL;
+    if (mapType < 0 || mapType >= MAX_MATERIAL_MAPS)
+        return PyErr_Format(PyExc_ValueError, "invalid material map type: %d", mapType);
+    if ((material = RayPy_Material_Get(obj)) == NULL)
+        return NULL;
+    SetMaterialTexture(material, mapType, texture->t);
+    Py_RETURN_NONE;
+}
+
+PyDoc_STRVAR(set_material_texture_doc, "Set texture for a material map type (MATERIAL_MAP_DIFFUSE, MATERIAL_MAP_SPECULAR...)");
+
+/* Instanced drawing
+
+   Transforms are 16 float32 per instance in OpenGL's column-major order
+   (raylib's MatrixToFloatV()), sent to the GPU straight from the caller's
+   buffer. DrawMeshInstanced() converts and copies them on every call, this
+   is the same draw without the copy and with a vertex buffer that can be
+   kept and partially updated between frames. */
+
+#define RAYPY_INSTANCE_SIZE (16 * sizeof(float))
+
+/* rlSetVertexAttribute() takes an offset instead of a pointer since 5.5 */
+#if RAYLIB_VERSION_MAJOR == 5 && RAYLIB_VERSION_MINOR < 5
+#define RAYPY_ATTRIB_OFFSET(offset) ((const void *)(uintptr_t)(offset))
+#else
+#define RAYPY_ATTRIB_OFFSET(offset) ((int)(offset))
+#endif
+
+/* Shader used when the material's one has no instance transform attribute,
+   loaded with the first instanced draw and unloaded by close_window() */
+static Shader RayPy_instancing_shader;
+
+static const char RayPy_instancing_vs[] =
+    "in vec3 vertexPosition;\n"
+    "in vec2 vertexTexCoord;\n"
+    "in vec4 vertexColor;\n"
+    "in mat4 instanceTransform;\n"
+    "uniform mat4 mvp;\n"
+    "out vec2 fragTexCoord;\n"
+    "out vec4 fragColor;\n"
+    "void main()\n"
+    "{\n"
+    "    fragTexCoord = vertexTexCoord;\n"
+    "    fragColor = vertexColor;\n"
+    "    gl_Position = mvp*instanceTransform*vec4(vertexPosition, 1.0);\n"
+    "}\n";
+
+static const char RayPy_instancing_fs[] =
+    "in vec2 fragTexCoord;\n"
+    "in vec4 fragColor;\n"
+    "uniform sampler2D texture0;\n"
+    "uniform vec4 colDiffuse;\n"
+    "out vec4 finalColor;\n"
+    "void main()\n"
+    "{\n"
+    "    finalColor = texture(texture0, fragTexCoord)*colDiffuse*fragColor;\n"
+    "}\n";
+
+static int
+RayPy_InstancingShader_Load(void)
+{
+    const char *header;
+    char vs[sizeof(RayPy_instancing_vs) + 64], fs[sizeof(RayPy_instancing_fs) + 64];
+    if (RayPy_instancing_shader.id != 0)
+        return 0;
+    switch (rlGetVersion()) {
+    case RL_OPENGL_33:
+    case RL_OPENGL_43:
+        header = "#version 330\n";
+        break;
+    case RL_OPENGL_ES_30:
+        header = "#version 300 es\nprecision mediump float;\n";
+        break;
+    default:
+        PyErr_SetString(PyExc_RuntimeError, "instanced drawing needs OpenGL 3.3 or OpenGL ES 3.0");
+        return -1;
+    }
+    snprintf(vs, sizeof(vs), "%s%s", header, RayPy_instancing_vs);
+    snprintf(fs, sizeof(fs), "%s%s", header, RayPy_instancing_fs);
+    Shader shader = LoadShaderFromMemory(vs, fs);
+    if (shader.locs != NULL)
+        shader.locs[SHADER_LOC_MATRIX_MODEL] = GetShaderLocationAttrib(shader, "instanceTransform");
+    if (shader.id == 0 || shader.id == rlGetShaderIdDefault() || shader.locs[SHADER_LOC_MATRIX_MODEL] == -1) {
+        UnloadShader(shader);
+        PyErr_SetString(PyExc_RuntimeError, "failed to compile the instancing shader");
+        return -1;
+    }
+    RayPy_instancing_shader = shader;
+    return 0;
+}
+
+static void
+RayPy_InstancingShader_Unload(void)
+{
+    if (RayPy_instancing_shader.id != 0)
+        UnloadShader(RayPy_instancing_shader);
+    memset(&RayPy_instancing_shader, 0, sizeof(RayPy_instancing_shader));
+}
+
+/* DrawMeshInstanced() from rmodels.c with the transforms already in `vbo` */
+static int
+RayPy_DrawMeshInstancedVbo(Mesh mesh, Material material, unsigned int vbo, int instances)
+{
+    if (mesh.vaoId == 0) {
+        PyErr_SetString(PyExc_ValueError, "mesh is not uploaded");
+        return -1;
+    }
+    if (material.shader.locs == NULL || material.shader.locs[SHADER_LOC_MATRIX_MODEL] == -1) {
+        if (RayPy_InstancingShader_Load())
+            return -1;
+        material.shader = RayPy_instancing_shader;
+    }
+    if (instances == 0)
+        return 0;
+    int *locs = material.shader.locs;
+    int transform = locs[SHADER_LOC_MATRIX_MODEL];
+
+    rlEnableShader(material.shader.id);
+    if (locs[SHADER_LOC_COLOR_DIFFUSE] != -1) {
+        Color c = material.maps[MATERIAL_MAP_DIFFUSE].color;
+        float values[4] = {c.r / 255.0f, c.g / 255.0f, c.b / 255.0f, c.a / 255.0f};
+        rlSetUniform(locs[SHADER_LOC_COLOR_DIFFUSE], values, SHADER_UNIFORM_VEC4, 1);
+    }
+    if (locs[SHADER_LOC_COLOR_SPECULAR] != -1) {
+        Color c = material.maps[MATERIAL_MAP_SPECULAR].color;
+        float values[4] = {c.r / 255.0f, c.g / 255.0f, c.b / 255.0f, c.a / 255.0f};
+        rlSetUniform(locs[SHADER_LOC_COLOR_SPECULAR], values, SHADER_UNIFORM_VEC4, 1);
+    }
+    Matrix matView = rlGetMatrixModelview();
+    Matrix matProjection = rlGetMatrixProjection();
+    if (locs[SHADER_LOC_MATRIX_VIEW] != -1)
+        rlSetUniformMatrix(locs[SHADER_LOC_MATRIX_VIEW], matView);
+    if (locs[SHADER_LOC_MATRIX_PROJECTION] != -1)
+        rlSetUniformMatrix(locs[SHADER_LOC_MATRIX_PROJECTION], matProjection);
+    if (locs[SHADER_LOC_MATRIX_NORMAL] != -1)
+        rlSetUniformMatrix(locs[SHADER_LOC_MATRIX_NORMAL], MatrixIdentity());
+
+    rlEnableVertexArray(mesh.vaoId);
+    rlEnableVertexBuffer(vbo);
+    for (int i = 0; i < 4; i++) {
+        rlEnableVertexAttribute(transform + i);
+        rlSetVertexAttribute(transform + i, 4, RL_FLOAT, 0, RAYPY_INSTANCE_SIZE,
+                             RAYPY_ATTRIB_OFFSET(i * 4 * sizeof(float)));
+        rlSetVertexAttributeDivisor(transform + i, 1);
+    }
+    rlDisableVertexBuffer();
+
+    for (int i = 0; i < MAX_MATERIAL_MAPS; i++) {
+        if (material.maps[i].texture.id > 0) {
+            rlActiveTextureSlot(i);
+            if (i == MATERIAL_MAP_IRRADIANCE || i == MATERIAL_MAP_PREFILTER || i == MATERIAL_MAP_CUBEMAP)
+                rlEnableTextureCubemap(material.maps[i].texture.id);
+            else
+                rlEnableTexture(material.maps[i].texture.id);
+            rlSetUniform(locs[SHADER_LOC_MAP_DIFFUSE + i], &i, SHADER_UNIFORM_INT, 1);
+        }
+    }
+
+    /* rlPushMatrix() transforms still apply to every instance */
+    Matrix matModelView = MatrixMultiply(rlGetMatrixTransform(), matView);
+    rlSetUniformMatrix(locs[SHADER_LOC_MATRIX_MVP], MatrixMultiply(matModelView, matProjection));
+    if (mesh.indices != NULL)
+        rlDrawVertexArrayElementsInstanced(0, mesh.triangleCount * 3, 0, instances);
+    else
+        rlDrawVertexArrayInstanced(0, mesh.vertexCount, instances);
+
+    for (int i = 0; i < MAX_MATERIAL_MAPS; i++) {
+        if (material.maps[i].texture.id > 0) {
+            rlActiveTextureSlot(i);
+            if (i == MATERIAL_MAP_IRRADIANCE || i == MATERIAL_MAP_PREFILTER || i == MATERIAL_MAP_CUBEMAP)
+                rlDisableTextureCubemap();
+            else
+                rlDisableTexture();
+        }
+    }
+    /* the VAO outlives this draw, don't leave it reading our buffer */
+    for (int i = 0; i < 4; i++) {
+        rlSetVertexAttributeDivisor(transform + i, 0);
+        rlDisableVertexAttribute(transform + i);
+    }
+    rlDisableVertexArray();
+    rlDisableVertexBufferElement();
+    rlDisableShader();
+    return 0;
+}
+
+/* Get a C-contiguous float32 buffer of whole transforms, -1 if it isn't one */
+static Py_ssize_t
+RayPy_Transforms_GetBuffer(PyObject *obj, Py_buffer *view)
+{
+    if (PyObject_GetBuffer(obj, view, PyBUF_C_CONTIGUOUS | PyBUF_FORMAT))
+        return -1;
+    const char *format = view->format;
+    if (format[0] == '@' || format[0] == '=' || format[0] == '<')
+        format++;
+    if (view->itemsize != sizeof(float) || strcmp(format, "f") != 0) {
+        PyErr_Format(PyExc_TypeError, "transforms must be a float32 buffer, not format '%s'", view->format);
+        goto error;
+    }
+    if (view->len % RAYPY_INSTANCE_SIZE != 0) {
+        PyErr_SetString(PyExc_ValueError, "transforms must have 16 floats per instance");
+        goto error;
+    }
+    if (view->len > INT_MAX) {
+        PyErr_SetString(PyExc_OverflowError, "too many transforms");
+        goto error;
+    }
+    return view->len / RAYPY_INSTANCE_SIZE;
+error:
+    PyBuffer_Release(view);
+    return -1;
+}
+
+typedef struct {
+    PyObject_HEAD unsigned int id;
+    int capacity;
+    int count;
+} RayPy_InstanceBufferObject;
+
+static void
+RayPy_InstanceBuffer_dealloc(RayPy_InstanceBufferObject *self)
+{
+    RayPy_GL_Release(RAYPY_GL_VERTEX_BUFFER, self->id);
+    PyTypeObject *tp = Py_TYPE(self);
+    tp->tp_free((PyObject *)self);
+    Py_DECREF(tp);
+}
+
+static int
+RayPy_InstanceBuffer_init(RayPy_InstanceBufferObject *self, PyObject *args, PyObject *Py_UNUSED(kwds))
+{
+    PyErr_SetString(PyExc_TypeError,
+                    "raypy.InstanceBuffer cannot be instantiated directly from"
+                    " Python. Use the provided module-level functions"
+                    " instead.");
+    return -1;
+}
+
+static PyObject *
+RayPy_InstanceBuffer_get_count(RayPy_InstanceBufferObject *self, void *Py_UNUSED(closure))
+{
+    return PyLong_FromLong(self->count);
+}
+
+static int
+RayPy_InstanceBuffer_set_count(RayPy_InstanceBufferObject *self, PyObject *value, void *Py_UNUSED(closure))
+{
+    if (value == NULL) {
+        PyErr_SetString(PyExc_TypeError, "cannot delete count");
+        return -1;
+    }
+    long count = PyLong_AsLong(value);
+    if (count == -1 && PyErr_Occurred())
+        return -1;
+    if (count < 0 || count > self->capacity) {
+        PyErr_Format(PyExc_ValueError, "count must be between 0 and %d", self->capacity);
+        return -1;
+    }
+    self->count = (int)count;
+    return 0;
+}
+
+static PyMemberDef RayPy_InstanceBuffer_members[] = {
+    {"id", Py_T_UINT, offsetof(RayPy_InstanceBufferObject, id), Py_READONLY, "OpenGL vertex buffer id, 0 once unloaded"},
+    {"capacity", Py_T_INT, offsetof(RayPy_InstanceBufferObject, capacity), Py_READONLY, "Number of transforms the buffer holds"},
+    {NULL}
+};
+
+static PyGetSetDef RayPy_InstanceBuffer_getset[] = {
+    {"count", (getter)RayPy_InstanceBuffer_get_count, (setter)RayPy_InstanceBuffer_set_count, "Number of instances drawn, grows with update_instance_buffer()", NULL},
+    {NULL}
+};
+
+static PyType_Slot RayPy_InstanceBuffer_slots[] = {
+    {Py_tp_doc, PyDoc_STR("InstanceBuffer, per instance transforms kept in GPU memory (VRAM)")},
+    {Py_tp_new, PyType_GenericNew},
+    {Py_tp_init, RayPy_InstanceBuffer_init},
+    {Py_tp_dealloc, RayPy_InstanceBuffer_dealloc},
+    {Py_tp_members, RayPy_InstanceBuffer_members},
+    {Py_tp_getset, RayPy_InstanceBuffer_getset},
+    {0, NULL},
+};
+
+static PyType_Spec RayPy_InstanceBuffer_spec = {
+    .name = "raypy.InstanceBuffer",
+    .basicsize = sizeof(RayPy_InstanceBufferObject),
+    .itemsize = 0,
+    .flags = Py_TPFLAGS_DEFAULT | Py_TPFLAGS_BASETYPE | Py_TPFLAGS_IMMUTABLETYPE,
+    .slots = RayPy_InstanceBuffer_slots,
+};
+
+static PyObject *
+RayPy_LoadInstanceBuffer(PyObject *Py_UNUSED(self), PyObject *args)
+{
+    int capacity;
+    PyObject *transforms = Py_None;
+    Py_buffer view = {0};
+    Py_ssize_t count = 0;
+    if (!PyArg_ParseTuple(args, "i|O", &capacity, &transforms))
+        return NULL;
+    IS_RENDER_THREAD();
+    if (capacity <= 0 || (size_t)capacity > INT_MAX / RAYPY_INSTANCE_SIZE) {
+        PyErr_SetString(PyExc_ValueError, "invalid instance buffer capacity");
+        return NULL;
+    }
+    if (transforms != Py_None) {
+        if ((count = RayPy_Transforms_GetBuffer(transforms, &view)) < 0)
+            return NULL;
+        if (count > capacity) {
+            PyBuffer_Release(&view);
+            return PyErr_Format(PyExc_ValueError, "%zd transforms don't fit in %d", count, capacity);
+        }
+    }
+    RayPy_InstanceBufferObject *ret = PyObject_New(RayPy_InstanceBufferObject, &RayPy_InstanceBuffer_Type);
+    if (ret == NULL) {
+        PyBuffer_Release(&view);
+        return NULL;
+    }
+    ret->id = rlLoadVertexBuffer(NULL, capacity * RAYPY_INSTANCE_SIZE, true);
+    ret->capacity = capacity;
+    ret->count = (int)count;
+    if (count > 0)
+        rlUpdateVertexBuffer(ret->id, view.buf, (int)view.len, 0);
+    PyBuffer_Release(&view);
+    if (ret->id == 0) {
+        Py_DECREF(ret);
+        PyErr_SetString(PyExc_RuntimeError, "failed to create the instance buffer");
+        return NULL;
+    }
+    return (PyObject *)ret;
+}
+
+PyDoc_STRVAR(load_instance_buffer_doc,
+             "Load a buffer for `capacity` instance transforms in VRAM, filled from `transforms` if given");
+
+static PyObject *
+RayPy_UpdateInstanceBuffer(PyObject *Py_UNUSED(self), PyObject *args)
+{
+    RayPy_InstanceBufferObject *buffer;
+    PyObject *transforms;
+    int first = 0;
+    Py_buffer view;
+    Py_ssize_t count;
+    if (!PyArg_ParseTuple(args, "O!O|i", &RayPy_InstanceBuffer_Type, &buffer, &transforms, &first))
+        return NULL;
+    IS_RENDER_THREAD();
+    if (buffer->id == 0) {
+        PyErr_SetString(PyExc_ValueError, "instance buffer is unloaded");
+        return NULL;
+    }
+    if ((count = RayPy_Transforms_GetBuffer(transforms, &view)) < 0)
+        return NULL;
+    if (first < 0 || count > buffer->capacity - first) {
+        PyBuffer_Release(&view);
+        return PyErr_Format(PyExc_IndexError, "instances [%d, %zd) out of range for %d", first, first + count,
+                            buffer->capacity);
+    }
+    if (count > 0)
+        rlUpdateVertexBuffer(buffer->id, view.buf, (int)view.len, first * (int)RAYPY_INSTANCE_SIZE);
+    PyBuffer_Release(&view);
+    if (first + count > buffer->count)
+        buffer->count = first + (int)count;
+    Py_RETURN_NONE;
+}
+
+PyDoc_STRVAR(update_instance_buffer_doc,
+             "Upload transforms to an instance buffer from instance `first`, growing its count if they go past it");
+
+static PyObject *
+RayPy_UnloadInstanceBuffer(PyObject *Py_UNUSED(self), PyObject *args)
+{
+    RayPy_InstanceBufferObject *buffer;
+    if (!PyArg_ParseTuple(args, "O!", &RayPy_InstanceBuffer_Type, &buffer))
+        return NULL;
+    WINDOW_IS_READY();
+    if (buffer->id != 0)
+        rlUnloadVertexBuffer(buffer->id);
+    buffer->id = 0;
+    buffer->capacity = buffer->count = 0;
+    Py_RETURN_NONE;
+}
+
+PyDoc_STRVAR(unload_instance_buffer_doc, "Unload instance buffer from GPU memory (VRAM)");
+
+static PyObject *
+RayPy_DrawMeshInstanced(PyObject *Py_UNUSED(self), PyObject *args)
+{
+    RayPy_MeshObject *mesh;
+    RayPy_MaterialObject *obj;
+    Material *material;
+    PyObject *transforms;
+    int instances = -1, ret;
+    if (!PyArg_ParseTuple(args, "O!O!O|i", &RayPy_Mesh_Type, &mesh, &RayPy_Material_Type, &obj,
+                          &transforms, &instances))
+        return NULL;
+    IS_RENDER_THREAD();
+    if ((material = RayPy_Material_Get(obj)) == NULL)
+        return NULL;
+    if (PyObject_TypeCheck(transforms, &RayPy_InstanceBuffer_Type)) {
+        RayPy_InstanceBufferObject *buffer = (RayPy_InstanceBufferObject *)transforms;
+        if (buffer->id == 0) {
+            PyErr_SetString(PyExc_ValueError, "instance buffer is unloaded");
+            return NULL;
+        }
+        if (instances < 0)
+            instances = buffer->count;
+        if (instances > buffer->count)
+            return PyErr_Format(PyExc_ValueError, "%d instances but the buffer has %d", instances, buffer->count);
+        ret = RayPy_DrawMeshInstancedVbo(mesh->m, *material, buffer->id, instances);
+    }
+    else {
+        Py_buffer view;
+        Py_ssize_t count = RayPy_Transforms_GetBuffer(transforms, &view);
+        if (count < 0)
+            return NULL;
+        if (instances < 0)
+            instances = (int)count;
+        if (instances > count) {
+            PyBuffer_Release(&view);
+            return PyErr_Format(PyExc_ValueError, "%d instances but %zd transforms", instances, count);
+        }
+        /* a one-frame buffer, uploaded without converting like DrawMeshInstanced() does */
+        unsigned int vbo = instances > 0 ? rlLoadVertexBuffer(view.buf, instances * (int)RAYPY_INSTANCE_SIZE, false) : 0;
+        PyBuffer_Release(&view);
+        ret = RayPy_DrawMeshInstancedVbo(mesh->m, *material, vbo, instances);
+        if (vbo != 0)
+            rlUnloadVertexBuffer(vbo);
+    }
+    if (ret)
+        return NULL;
+    Py_RETURN_NONE;
+}
+
+PyDoc_STRVAR(draw_mesh_instanced_doc,
+             "Draw multiple mesh instances with material and different transforms, from a float32 (n, 16) "
+             "buffer or an InstanceBuffer");
+
+/* Shader
+
+   Uniform locations are looked up by name once per shader and cached.
+   set_layout() describes a packed struct of uniforms once, set_values()
+   then uploads a whole buffer of them (a numpy structured array, a
+   ctypes.Structure, struct.pack() bytes...) in one call. */
+
+/* one uniform of a set_layout() */
+typedef struct {
+    int location;
+    int type;   // SHADER_UNIFORM_*
+    int count;  // array elements
+    Py_ssize_t offset;
+} RayPy_ShaderField;
+
+typedef struct {
+    PyObject_HEAD Shader s;
+    PyObject *locations; // uniform name -> location, -1 included so misses aren't looked up again
+    RayPy_ShaderField *layout;
+    Py_ssize_t layout_count;
+    Py_ssize_t layout_size; // bytes
+} RayPy_ShaderObject;
+
+/* components in a SHADER_UNIFORM_* type, 0 for unknown types */
+static int
+RayPy_Uniform_Components(int type)
+{
+    switch (type) {
+    case SHADER_UNIFORM_FLOAT:
+    case SHADER_UNIFORM_INT:
+    case SHADER_UNIFORM_SAMPLER2D:
+        return 1;
+    case SHADER_UNIFORM_VEC2:
+    case SHADER_UNIFORM_IVEC2:
+        return 2;
+    case SHADER_UNIFORM_VEC3:
+    case SHADER_UNIFORM_IVEC3:
+        return 3;
+    case SHADER_UNIFORM_VEC4:
+    case SHADER_UNIFORM_IVEC4:
+        return 4;
+    }
+    return 0;
+}
+
+static int
+RayPy_Uniform_IsInt(int type)
+{
+    return type == SHADER_UNIFORM_INT || type == SHADER_UNIFORM_IVEC2 || type == SHADER_UNIFORM_IVEC3
+           || type == SHADER_UNIFORM_IVEC4 || type == SHADER_UNIFORM_SAMPLER2D;
+}
+
+static void
+RayPy_Shader_dealloc(RayPy_ShaderObject *self)
+{
+    Py_XDECREF(self->locations);
+    PyMem_Free(self->layout);
+    PyTypeObject *tp = Py_TYPE(self);
+    tp->tp_free((PyObject *)self);
+    Py_DECREF(tp);
+}
+
+static int
+RayPy_Shader_init(RayPy_ShaderObject *self, PyObject *args, PyObject *Py_UNUSED(kwds))
+{
+    PyErr_SetString(PyExc_TypeError,
+                    "raypy.Shader cannot be instantiated directly from"
+                    " Python. Use the provided module-level functions"
+                    " instead.");
+    return -1;
+}
+
+static int
+RayPy_Shader_CheckReady(RayPy_ShaderObject *self)
+{
+    if (self->s.id == 0 || self->s.locs == NULL) {
+        PyErr_SetString(PyExc_ValueError, "shader is unloaded");
+        return -1;
+    }
+    return 0;
+}
+
+/* Location of a uniform by name, cached; -2 with an exception set on errors */
+static int
+RayPy_Shader_Location(RayPy_ShaderObject *self, PyObject *name)
+{
+    PyObject *cached;
+    const char *uniformName;
+    if (!PyUnicode_Check(name)) {
+        PyErr_Format(PyExc_TypeError, "uniform name must be str, not %s", Py_TYPE(name)->tp_name);
+        return -2;
+    }
+    if ((cached = PyDict_GetItemWithError(self->locations, name)) != NULL)
+        return (int)PyLong_AsLong(cached);
+    if (PyErr_Occurred() || (uniformName = PyUnicode_AsUTF8(name)) == NULL)
+        return -2;
+    int location = GetShaderLocation(self->s, uniformName);
+    PyObject *value = PyLong_FromLong(location);
+    if (value == NULL || PyDict_SetItem(self->locations, name, value)) {
+        Py_XDECREF(value);
+        return -2;
+    }
+    Py_DECREF(value);
+    return location;
+}
+
+static PyObject *
+RayPy_Shader_get_location(RayPy_ShaderObject *self, PyObject *name)
+{
+    if (RayPy_Shader_CheckReady(self))
+        return NULL;
+    int location = RayPy_Shader_Location(self, name);
+    if (location == -2)
+        return NULL;
+    return PyLong_FromLong(location);
+}
+
+static PyObject *
+RayPy_Shader_get_location_attrib(RayPy_ShaderObject *self, PyObject *arg)
+{
+    const char *attribName = PyUnicode_AsUTF8(arg);
+    if (attribName == NULL)
+        return NULL;
+    if (RayPy_Shader_CheckReady(self))
+        return NULL;
+    return PyLong_FromLong(GetShaderLocationAttrib(self->s, attribName));
+}
+
+static PyObject *
+RayPy_Shader_get_loc(RayPy_ShaderObject *self, PyObject *arg)
+{
+    int index = PyLong_AsLong(arg);
+    if (index == -1 && PyErr_Occurred())
+        return NULL;
+    if (RayPy_Shader_CheckReady(self))
+        return NULL;
+    if (index < 0 || index >= RL_MAX_SHADER_LOCATIONS)
+        return PyErr_Format(PyExc_IndexError, "shader location index %d out of range", index);
+    return PyLong_FromLong(self->s.locs[index]);
+}
+
+static PyObject *
+RayPy_Shader_set_loc(RayPy_ShaderObject *self, PyObject *args)
+{
+    int index, location;
+    if (!PyArg_ParseTuple(args, "ii", &index, &location))
+        return NULL;
+    if (RayPy_Shader_CheckReady(self))
+        return NULL;
+    if (index < 0 || index >= RL_MAX_SHADER_LOCATIONS)
+        return PyErr_Format(PyExc_IndexError, "shader location index %d out of range", index);
+    /* the default shader's locations are shared with everything drawn with it */
+    if (self->s.id == rlGetShaderIdDefault()) {
+        PyErr_SetString(PyExc_ValueError, "the default shader locations can't be changed");
+        return NULL;
+    }
+    self->s.locs[index] = location;
+    Py_RETURN_NONE;
+}
+
+typedef union {
+    float f[16];
+    int i[16];
+} RayPy_UniformValue;
+
+/* Convert a uniform value, guessing its type from the value if type is -1:
+   float, Vector2/3/4, Color (normalized to a vec4) or a sequence of up to 4
+   numbers, Python ints included since most uniforms are floats, int and ivec
+   uniforms have to be asked for with their type */
+static int
+RayPy_Uniform_Convert(PyObject *value, int *type, RayPy_UniformValue *out)
+{
+    int n = 0;
+    if (PyObject_TypeCheck(value, &RayPy_Vector2_Type)) {
+        RayPy_Vector2Object *v = (RayPy_Vector2Object *)value;
+        out->f[0] = v->x, out->f[1] = v->y, n = 2;
+    }
+    else if (PyObject_TypeCheck(value, &RayPy_Vector3_Type)) {
+        RayPy_Vector3Object *v = (RayPy_Vector3Object *)value;
+        out->f[0] = v->x, out->f[1] = v->y, out->f[2] = v->z, n = 3;
+    }
+    else if (PyObject_TypeCheck(value, &RayPy_Vector4_Type)) {
+        RayPy_Vector4Object *v = (RayPy_Vector4Object *)value;
+        out->f[0] = v->x, out->f[1] = v->y, out->f[2] = v->z, out->f[3] = v->w, n = 4;
+    }
+    else if (PyObject_TypeCheck(value, &RayPy_Color_Type)) {
+        RayPy_ColorObject *c = (RayPy_ColorObject *)value;
+        out->f[0] = c->r / 255.0f, out->f[1] = c->g / 255.0f, out->f[2] = c->b / 255.0f, out->f[3] = c->a / 255.0f;
+        n = 4;
+    }
+    if (n > 0) {
+        static const int vec[] = {0, SHADER_UNIFORM_FLOAT, SHADER_UNIFORM_VEC2, SHADER_UNIFORM_VEC3, SHADER_UNIFORM_VEC4};
+        if (*type == -1)
+            *type = vec[n];
+        if (*type != vec[n]) {
+            PyErr_Format(PyExc_TypeError, "%s doesn't match the uniform type", Py_TYPE(value)->tp_name);
+            return -1;
+        }
+        return 0;
+    }
+
+    /* numbers, alone or in a sequence */
+    PyObject *seq = NULL, **items = &value;
+    if (!PyNumber_Check(value)) {
+        seq = PySequence_Fast(value, "uniform value must be a number, a sequence of numbers, a Vector or a Color");
+        if (seq == NULL)
+            return -1;
+        n = (int)Py_MIN(PySequence_Fast_GET_SIZE(seq), 5);
+        items = PySequence_Fast_ITEMS(seq);
+    }
+    else {
+        n = 1;
+    }
+    if (*type == -1) {
+        static const int vec[] = {SHADER_UNIFORM_FLOAT, SHADER_UNIFORM_VEC2, SHADER_UNIFORM_VEC3, SHADER_UNIFORM_VEC4};
+        if (n < 1 || n > 4) {
+            PyErr_SetString(PyExc_ValueError, "uniform values have 1 to 4 components");
+            Py_XDECREF(seq);
+            return -1;
+        }
+        *type = vec[n - 1];
+    }
+    if (n != RayPy_Uniform_Components(*type)) {
+        PyErr_Format(PyExc_ValueError, "uniform value must have %d components, not %d%s",
+                     RayPy_Uniform_Components(*type), n, n == 5 ? " or more" : "");
+        Py_XDECREF(seq);
+        return -1;
+    }
+    for (int i = 0; i < n; i++) {
+        if (RayPy_Uniform_IsInt(*type))
+            out->i[i] = PyLong_AsLong(items[i]);
+        else
+            out->f[i] = (float)PyFloat_AsDouble(items[i]);
+    }
+    Py_XDECREF(seq);
+    return PyErr_Occurred() ? -1 : 0;
+}
+
+/* Upload one named uniform, the shader must be enabled */
+static int
+RayPy_Shader_SetUniform(RayPy_ShaderObject *self, PyObject *name, PyObject *value, int type)
+{
+    RayPy_UniformValue v;
+    int location = RayPy_Shader_Location(self, name);
+    if (location == -2)
+        return -1;
+    if (PyObject_TypeCheck(value, &RayPy_Texture_Type)) {
+        if (type != -1 && type != SHADER_UNIFORM_SAMPLER2D) {
+            PyErr_SetString(PyExc_TypeError, "textures can only be set to sampler2D uniforms");
+            return -1;
+        }
+        if (location != -1)
+            rlSetUniformSampler(location, ((RayPy_TextureObject *)value)->t.id);
+        return 0;
+    }
+    if (PyObject_CheckBuffer(value)) {
+        /* arrays, with an explicit type */
+        Py_buffer view;
+        int components = RayPy_Uniform_Components(type);
+        if (components == 0) {
+            PyErr_SetString(PyExc_TypeError, "uniform_type is required for buffer values");
+            return -1;
+        }
+        if (PyObject_GetBuffer(value, &view, PyBUF_C_CONTIGUOUS))
+            return -1;
+        Py_ssize_t element = (Py_ssize_t)components * 4;
+        if (view.len == 0 || view.len % element != 0 || view.len / element > INT_MAX) {
+            PyErr_Format(PyExc_ValueError, "buffer size must be a multiple of %zd bytes", element);
+            PyBuffer_Release(&view);
+            return -1;
+        }
+        if (location != -1)
+            rlSetUniform(location, view.buf, type, (int)(view.len / element));
+        PyBuffer_Release(&view);
+        return 0;
+    }
+    if (type != -1 && RayPy_Uniform_Components(type) == 0) {
+        PyErr_Format(PyExc_ValueError, "invalid uniform type: %d", type);
+        return -1;
+    }
+    if (RayPy_Uniform_Convert(value, &type, &v))
+        return -1;
+    if (location != -1)
+        rlSetUniform(location, &v, type, 1);
+    return 0;
+}
+
+static PyObject *
+RayPy_Shader_set_value(RayPy_ShaderObject *self, PyObject *args)
+{
+    PyObject *name, *value;
+    int type = -1;
+    if (!PyArg_ParseTuple(args, "UO|i", &name, &value, &type))
+        return NULL;
+    WINDOW_IS_READY();
+    if (RayPy_Shader_CheckReady(self))
+        return NULL;
+    rlEnableShader(self->s.id);
+    if (RayPy_Shader_SetUniform(self, name, value, type))
+        return NULL;
+    Py_RETURN_NONE;
+}
+
+static PyObject *
+RayPy_Shader_set_layout(RayPy_ShaderObject *self, PyObject *arg)
+{
+    PyObject *fields = PySequence_Fast(arg, "layout must be a sequence of (name, uniform_type[, count]) tuples");
+    if (fields == NULL)
+        return NULL;
+    if (RayPy_Shader_CheckReady(self))
+        goto error;
+    Py_ssize_t count = PySequence_Fast_GET_SIZE(fields), size = 0;
+    RayPy_ShaderField *layout = PyMem_Calloc(count ? count : 1, sizeof(RayPy_ShaderField));
+    if (layout == NULL) {
+        PyErr_NoMemory();
+        goto error;
+    }
+    for (Py_ssize_t i = 0; i < count; i++) {
+        PyObject *name;
+        int type, n = 1;
+        if (!PyArg_ParseTuple(PySequence_Fast_GET_ITEM(fields, i), "Ui|i;layout fields are (name, uniform_type[, count])",
+                              &name, &type, &n))
+            goto error_layout;
+        if (RayPy_Uniform_Components(type) == 0 || n < 1) {
+            PyErr_Format(PyExc_ValueError, "invalid type or count for uniform %R", name);
+            goto error_layout;
+        }
+        if ((layout[i].location = RayPy_Shader_Location(self, name)) == -2)
+            goto error_layout;
+        layout[i].type = type;
+        layout[i].count = n;
+        layout[i].offset = size;
+        size += (Py_ssize_t)RayPy_Uniform_Components(type) * 4 * n;
+    }
+    PyMem_Free(self->layout);
+    self->layout = layout;
+    self->layout_count = count;
+    self->layout_size = size;
+    Py_DECREF(fields);
+    Py_RETURN_NONE;
+error_layout:
+    PyMem_Free(layout);
+error:
+    Py_DECREF(fields);
+    return NULL;
+}
+
+static PyObject *
+RayPy_Shader_set_values(RayPy_ShaderObject *self, PyObject *values)
+{
+    WINDOW_IS_READY();
+    if (RayPy_Shader_CheckReady(self))
+        return NULL;
+    if (PyDict_Check(values)) {
+        PyObject *name, *value;
+        Py_ssize_t pos = 0;
+        rlEnableShader(self->s.id);
+        while (PyDict_Next(values, &pos, &name, &value)) {
+            if (RayPy_Shader_SetUniform(self, name, value, -1))
+                return NULL;
+        }
+        Py_RETURN_NONE;
+    }
+    Py_buffer view;
+    if (self->layout == NULL) {
+        PyErr_SetString(PyExc_ValueError, "set_layout() must be called before setting values from a buffer");
+        return NULL;
+    }
+    if (PyObject_GetBuffer(values, &view, PyBUF_C_CONTIGUOUS))
+        return NULL;
+    if (view.len != self->layout_size) {
+        PyErr_Format(PyExc_ValueError, "buffer is %zd bytes, the layout is %zd", view.len, self->layout_size);
+        PyBuffer_Release(&view);
+        return NULL;
+    }
+    rlEnableShader(self->s.id);
+    for (Py_ssize_t i = 0; i < self->layout_count; i++) {
+        RayPy_ShaderField *field = &self->layout[i];
+        if (field->location != -1)
+            rlSetUniform(field->location, (char *)view.buf + field->offset, field->type, field->count);
+    }
+    PyBuffer_Release(&view);
+    Py_RETURN_NONE;
+}
+
+static PyMethodDef RayPy_Shader_methods[] = {
+    {"get_location", (PyCFunction)RayPy_Shader_get_location, METH_O,
+     "Get shader uniform location, cached after the first lookup"},
+    {"get_location_attrib", (PyCFunction)RayPy_Shader_get_location_attrib, METH_O,
+     "Get shader attribute location"},
+    {"get_loc", (PyCFunction)RayPy_Shader_get_loc, METH_O,
+     "Get the location raylib uses for a SHADER_LOC_* index"},
+    {"set_loc", (PyCFunction)RayPy_Shader_set_loc, METH_VARARGS,
+     "Set the location raylib uses for a SHADER_LOC_* index, e.g. SHADER_LOC_MATRIX_MODEL for instancing"},
+    {"set_value", (PyCFunction)RayPy_Shader_set_value, METH_VARARGS,
+     "Set shader uniform value, float or vecN unless uniform_type says otherwise, buffers set uniform arrays"},
+    {"set_layout", (PyCFunction)RayPy_Shader_set_layout, METH_O,
+     "Describe the packed buffers set_values() gets, as (name, uniform_type[, count]) fields"},
+    {"set_values", (PyCFunction)RayPy_Shader_set_values, METH_O,
+     "Set many uniforms at once, from a dict of name: value or a buffer packed as set_layout() describes"},
+    {NULL}
+};
+
+static PyMemberDef RayPy_Shader_members[] = {
+    {"id", Py_T_UINT, offsetof(RayPy_ShaderObject, s.id), Py_READONLY, "Shader program id, 0 once unloaded"},
+    {NULL}
+};
+
+static PyType_Slot RayPy_Shader_slots[] = {
+    {Py_tp_doc, PyDoc_STR("Shader, program with cached uniform locations")},
+    {Py_tp_new, PyType_GenericNew},
+    {Py_tp_init, RayPy_Shader_init},
+    {Py_tp_dealloc, RayPy_Shader_dealloc},
+    {Py_tp_methods, RayPy_Shader_methods},
+    {Py_tp_members, RayPy_Shader_members},
+    {0, NULL},
+};
+
+static PyType_Spec RayPy_Shader_spec = {
+    .name = "raypy.Shader",
+    .basicsize = sizeof(RayPy_ShaderObject),
+    .itemsize = 0,
+    .flags = Py_TPFLAGS_DEFAULT | Py_TPFLAGS_BASETYPE | Py_TPFLAGS_IMMUTABLETYPE,
+    .slots = RayPy_Shader_slots,
+};
+
+static PyObject *
+RayPy_Shader_FromShader(Shader shader, int custom)
+{
+    /* raylib falls back to the default shader when compiling fails */
+    if (custom && shader.id == rlGetShaderIdDefault()) {
+        UnloadShader(shader);
+        PyErr_SetString(PyExc_RuntimeError, "failed to load shader, see the log for the compiler errors");
+        return NULL;
+    }
+    RayPy_ShaderObject *ret = PyObject_New(RayPy_ShaderObject, &RayPy_Shader_Type);
+    if (ret == NULL) {
+        UnloadShader(shader);
+        return NULL;
+    }
+    ret->s = shader;
+    ret->layout = NULL;
+    ret->layout_count = ret->layout_size = 0;
+    if ((ret->locations = PyDict_New()) == NULL) {
+        Py_DECREF(ret);
+        return NULL;
+    }
+    return (PyObject *)ret;
+}
+
+static PyObject *
+RayPy_LoadShader(PyObject *Py_UNUSED(self), PyObject *args)
+{
+    const char *vsFileName, *fsFileName;
+    Shader shader;
+    if (!PyArg_ParseTuple(args, "zz", &vsFileName, &fsFileName))
+        return NULL;
+    WINDOW_IS_READY();
+    shader = LoadShader(vsFileName, fsFileName);
+    return RayPy_Shader_FromShader(shader, vsFileName != NULL || fsFileName != NULL);
+}
+
+PyDoc_STRVAR(load_shader_doc, "Load shader from files and bind default locations, None for raylib's default stage");
+
+static PyObject *
+RayPy_LoadShaderFromMemory(PyObject *Py_UNUSED(self), PyObject *args)
+{
+    const char *vsCode, *fsCode;
+    Shader shader;
+    if (!PyArg_ParseTuple(args, "zz", &vsCode, &fsCode))
+        return NULL;
+    WINDOW_IS_READY();
+    shader = LoadShaderFromMemory(vsCode, fsCode);
+    return RayPy_Shader_FromShader(shader, vsCode != NULL || fsCode != NULL);
+}
+
+PyDoc_STRVAR(load_shader_from_memory_doc, "Load shader from code strings and bind default locations");
+
+static PyObject *
+RayPy_UnloadShader(PyObject *Py_UNUSED(self), PyObject *args)
+{
+    RayPy_ShaderObject *shader;
+    if (!PyArg_ParseTuple(args, "O!", &RayPy_Shader_Type, &shader))
+        return NULL;
+    WINDOW_IS_READY();
+    UnloadShader(shader->s);
+    memset(&shader->s, 0, sizeof(shader->s));
+    PyDict_Clear(shader->locations);
+    PyMem_Free(shader->layout);
+    shader->layout = NULL;
+    shader->layout_count = shader->layout_size = 0;
+    Py_RETURN_NONE;
+}
+
+PyDoc_STRVAR(unload_shader_doc, "Unload shader from GPU memory (VRAM), after the materials using it");
+
+static PyObject *
+RayPy_BeginShaderMode(PyObject *Py_UNUSED(self), PyObject *args)
+{
+    RayPy_ShaderObject *shader;
+    if (!PyArg_ParseTuple(args, "O!", &RayPy_Shader_Type, &shader))
+        return NULL;
+    IS_RENDER_THREAD();
+    if (RayPy_Shader_CheckReady(shader))
+        return NULL;
+    BeginShaderMode(shader->s);
+    Py_RETURN_NONE;
+}
+
+PyDoc_STRVAR(begin_shader_mode_doc, "Begin custom shader drawing");
+
+static PyObject *
+RayPy_EndShaderMode(PyObject *Py_UNUSED(self), PyObject *Py_UNUSED(args))
+{
+    IS_RENDER_THREAD();
+    EndShaderMode();
+    Py_RETURN_NONE;
+}
+
+PyDoc_STRVAR(end_shader_mode_doc, "End custom shader drawing (use default shader)");
+
+static PyObject *
+RayPy_SetMaterialShader(PyObject *Py_UNUSED(self), PyObject *args)
+{
+    RayPy_MaterialObject *obj;
+    RayPy_ShaderObject *shader;
+    Material *material;
+    if (!PyArg_ParseTuple(args, "O!O!", &RayPy_Material_Type, &obj, &RayPy_Shader_Type, &shader))
+        return NULL;
+    if (RayPy_Shader_CheckReady(shader) || (material = RayPy_Material_Get(obj)) == NULL)
+        return NULL;
+    material->shader = shader->s;
+    Py_RETURN_NONE;
+}
+
+PyDoc_STRVAR(set_material_shader_doc, "Set the shader of a material, the shader must outlive it");
+
+/* Tilemap
+
+   Tiles are drawn by chunks of chunk_size x chunk_size, each a mesh in VRAM
+   made the first time the chunk is seen. Chunks keep a copy of the tiles they
+   were built from: visible chunks are compared with it when drawn and only
+   those that changed are rebuilt, so the tiles buffer can be written freely
+   from Python (or numpy) without telling the map. */
+
+#define RAYPY_TILEMAP_MAX_CHUNK 128 // 4 vertices a tile in 16-bit indices
+
+typedef struct {
+    Mesh mesh; // no vboId until built, vaoId stays 0 on GL 2.1 / GLES2
+    unsigned short *snapshot; // tiles the mesh was built from
+    int quads;
+} RayPy_TileChunk;
+
+/* vaoId is always 0 without VAO support, the vertex buffer tells instead */
+#define RAYPY_CHUNK_UPLOADED(chunk) ((chunk)->mesh.vboId != NULL && (chunk)->mesh.vboId[0] != 0)
+
+typedef struct {
+    PyObject_HEAD int width, height;
+    int tile_width, tile_height;
+    int chunk_size;
+    int chunks_x, chunks_y;
+    unsigned short *tiles;
+    RayPy_TextureObject *tileset;
+    RayPy_TileChunk *chunks;
+    Material material;
+    /* scratch arrays chunks are built in, sized for a full chunk */
+    float *vertices;
+    float *texcoords;
+    unsigned short *indices;
+} RayPy_TilemapObject;
+
+static void
+RayPy_Tilemap_UnloadChunks(RayPy_TilemapObject *self)
+{
+    for (int i = 0; i < self->chunks_x * self->chunks_y; i++) {
+        RayPy_TileChunk *chunk = &self->chunks[i];
+        /* GPU buffers can only go while the context is alive */
+        if (RAYPY_CHUNK_UPLOADED(chunk) && IsWindowReady())
+            UnloadMesh(chunk->mesh);
+        memset(&chunk->mesh, 0, sizeof(chunk->mesh));
+        PyMem_Free(chunk->snapshot);
+        chunk->snapshot = NULL;
+        chunk->quads = 0;
+    }
+}
+
+static void
+RayPy_Tilemap_dealloc(RayPy_TilemapObject *self)
+{
+    if (self->chunks != NULL)
+        RayPy_Tilemap_UnloadChunks(self);
+    PyMem_Free(self->chunks);
+    PyMem_Free(self->tiles);
+    PyMem_Free(self->vertices);
+    PyMem_Free(self->texcoords);
+    PyMem_Free(self->indices);
+    /* the tileset belongs to its Texture, only the maps are ours */
+    RL_FREE(self->material.maps);
+    Py_XDECREF(self->tileset);
+    PyTypeObject *tp = Py_TYPE(self);
+    tp->tp_free((PyObject *)self);
+    Py_DECREF(tp);
+}
+
+static int
+RayPy_Tilemap_init(RayPy_TilemapObject *self, PyObject *args, PyObject *kwds)
+{
+    int width, height, tile_width, tile_height, chunk_size = 32;
+    RayPy_TextureObject *tileset;
+    static char *kwlist[] = {"width", "height", "tileset", "tile_width", "tile_height", "chunk_size", NULL};
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "iiO!ii|i", kwlist, &width, &height, &RayPy_Texture_Type,
+                                     &tileset, &tile_width, &tile_height, &chunk_size))
+        return -1;
+    if (self->tiles != NULL) {
+        PyErr_SetString(PyExc_RuntimeError, "tilemap is already initialized");
+        return -1;
+    }
+    if (width <= 0 || height <= 0 || tile_width <= 0 || tile_height <= 0) {
+        PyErr_SetString(PyExc_ValueError, "width, height, tile_width and tile_height must be > 0");
+        return -1;
+    }
+    if (chunk_size <= 0 || chunk_size > RAYPY_TILEMAP_MAX_CHUNK) {
+        PyErr_Format(PyExc_ValueError, "chunk_size must be between 1 and %d", RAYPY_TILEMAP_MAX_CHUNK);
+        return -1;
+    }
+    if ((size_t)width * height > PY_SSIZE_T_MAX / sizeof(unsigned short)) {
+        PyErr_SetString(PyExc_OverflowError, "tilemap is too large");
+        return -1;
+    }
+    int quads = chunk_size * chunk_size;
+    self->chunks_x = (width + chunk_size - 1) / chunk_size;
+    self->chunks_y = (height + chunk_size - 1) / chunk_size;
+    self->tiles = PyMem_Calloc((size_t)width * height, sizeof(unsigned short));
+    self->chunks = PyMem_Calloc((size_t)self->chunks_x * self->chunks_y, sizeof(RayPy_TileChunk));
+    self->vertices = PyMem_Malloc((size_t)quads * 4 * 3 * sizeof(float));
+    self->texcoords = PyMem_Malloc((size_t)quads * 4 * 2 * sizeof(float));
+    self->indices = PyMem_Malloc((size_t)quads * 6 * sizeof(unsigned short));
+    if (self->tiles == NULL || self->chunks == NULL || self->vertices == NULL || self->texcoords == NULL
+        || self->indices == NULL) {
+        PyErr_NoMemory();
+        return -1;
+    }
+    /* same winding as DrawTexturePro(): top-left, bottom-left, bottom-right, top-right */
+    for (int q = 0; q < quads; q++) {
+        static const unsigned short quad[6] = {0, 1, 2, 0, 2, 3};
+        for (int k = 0; k < 6; k++)
+            self->indices[6 * q + k] = (unsigned short)(4 * q + quad[k]);
+    }
+    self->width = width;
+    self->height = height;
+    self->tile_width = tile_width;
+    self->tile_height = tile_height;
+    self->chunk_size = chunk_size;
+    self->tileset = (RayPy_TextureObject *)Py_NewRef(tileset);
+    return 0;
+}
+
+/* Rebuilds the mesh of a chunk from the tiles, 0 if nothing changed, -1 on errors */
+static int
+RayPy_Tilemap_BuildChunk(RayPy_TilemapObject *self, int cx, int cy)
+{
+    RayPy_TileChunk *chunk = &self->chunks[cy * self->chunks_x + cx];
+    int size = self->chunk_size;
+    int x0 = cx * size, y0 = cy * size;
+    int w = Py_MIN(size, self->width - x0), h = Py_MIN(size, self->height - y0);
+    if (chunk->snapshot != NULL) {
+        int same = 1;
+        for (int y = 0; y < h && same; y++)
+            same = memcmp(chunk->snapshot + y * w, self->tiles + (size_t)(y0 + y) * self->width + x0,
+                          w * sizeof(unsigned short))
+                   == 0;
+        if (same)
+            return 0;
+    }
+    else {
+        chunk->snapshot = PyMem_Malloc((size_t)w * h * sizeof(unsigned short));
+        if (chunk->snapshot == NULL) {
+            PyErr_NoMemory();
+            return -1;
+        }
+    }
+
+    Texture tileset = self->tileset->t;
+    int columns = tileset.width / self->tile_width, rows = tileset.height / self->tile_height;
+    float tw = (float)self->tile_width, th = (float)self->tile_height;
+    float du = tw / (float)tileset.width, dv = th / (float)tileset.height;
+    int quads = 0;
+    for (int y = 0; y < h; y++) {
+        const unsigned short *row = self->tiles + (size_t)(y0 + y) * self->width + x0;
+        memcpy(chunk->snapshot + y * w, row, w * sizeof(unsigned short));
+        for (int x = 0; x < w; x++) {
+            /* 0 is no tile, n is the n-th tile of the tileset */
+            int id = row[x] - 1;
+            if (id < 0 || id >= columns * rows)
+                continue;
+            float px = (x0 + x) * tw, py = (y0 + y) * th;
+            float u = (id % columns) * du, v = (id / columns) * dv;
+            float *p = self->vertices + 12 * quads, *t = self->texcoords + 8 * quads;
+            p[0] = px, p[1] = py, p[2] = 0.0f;
+            p[3] = px, p[4] = py + th, p[5] = 0.0f;
+            p[6] = px + tw, p[7] = py + th, p[8] = 0.0f;
+            p[9] = px + tw, p[10] = py, p[11] = 0.0f;
+            t[0] = u, t[1] = v;
+            t[2] = u, t[3] = v + dv;
+            t[4] = u + du, t[5] = v + dv;
+            t[6] = u + du, t[7] = v;
+            quads++;
+        }
+    }
+
+    if (!RAYPY_CHUNK_UPLOADED(chunk) && quads > 0) {
+        /* buffers for a full chunk, so rebuilds are updates of what's used */
+        Mesh mesh = {0};
+        mesh.vertexCount = size * size * 4;
+        mesh.triangleCount = size * size * 2;
+        mesh.vertices = self->vertices;
+        mesh.texcoords = self->texcoords;
+        mesh.indices = self->indices;
+        UploadMesh(&mesh, true);
+        /* the arrays are the scratch ones, UnloadMesh() must not free them */
+        mesh.vertices = mesh.texcoords = NULL;
+        mesh.indices = NULL;
+        chunk->mesh = mesh;
+    }
+    else if (quads > 0) {
+        UpdateMeshBuffer(chunk->mesh, 0, self->vertices, quads * 4 * 3 * sizeof(float), 0);
+        UpdateMeshBuffer(chunk->mesh, 1, self->texcoords, quads * 4 * 2 * sizeof(float), 0);
+    }
+    chunk->quads = quads;
+    return 1;
+}
+
+static PyObject *
+RayPy_Tilemap_get_tiles(RayPy_TilemapObject *self, void *Py_UNUSED(closure))
+{
+    return PyMemoryView_FromObject((PyObject *)self);
+}
+
+static PyObject *
+RayPy_Tilemap_get_tileset(RayPy_TilemapObject *self, void *Py_UNUSED(closure))
+{
+    return Py_NewRef(self->tileset);
+}
+
+static int
+RayPy_Tilemap_set_tileset(RayPy_TilemapObject *self, PyObject *value, void *Py_UNUSED(closure))
+{
+    if (value == NULL || !PyObject_TypeCheck(value, &RayPy_Texture_Type)) {
+        PyErr_Format(PyExc_TypeError, "must be raypy.Texture, not %s",
+                     value == NULL ? "deleting" : Py_TYPE(value)->tp_name);
+        return -1;
+    }
+    Py_SETREF(self->tileset, (RayPy_TextureObject *)Py_NewRef(value));
+    /* texture coordinates depend on the tileset size */
+    for (int i = 0; i < self->chunks_x * self->chunks_y; i++) {
+        PyMem_Free(self->chunks[i].snapshot);
+        self->chunks[i].snapshot = NULL;
+    }
+    return 0;
+}
+
+static int
+RayPy_Tilemap_getbuffer(RayPy_TilemapObject *self, Py_buffer *view, int flags)
+{
+    if (self->tiles == NULL) {
+        PyErr_SetString(PyExc_ValueError, "tilemap is not initialized");
+        return -1;
+    }
+    if (PyBuffer_FillInfo(view, (PyObject *)self, self->tiles,
+                          (Py_ssize_t)self->width * self->height * sizeof(unsigned short), 0, flags))
+        return -1;
+    view->itemsize = sizeof(unsigned short);
+    if (flags & PyBUF_FORMAT)
+        view->format = "H";
+    if (flags & PyBUF_ND) {
+        /* rows of the map, shape (height, width) then strides */
+        Py_ssize_t *shape = PyMem_Malloc(4 * sizeof(Py_ssize_t));
+        if (shape == NULL) {
+            PyBuffer_Release(view);
+            PyErr_NoMemory();
+            return -1;
+        }
+        shape[0] = self->height;
+        shape[1] = self->width;
+        shape[2] = (Py_ssize_t)self->width * sizeof(unsigned short);
+        shape[3] = sizeof(unsigned short);
+        view->ndim = 2;
+        view->shape = shape;
+        if ((flags & PyBUF_STRIDES) == PyBUF_STRIDES)
+            view->strides = shape + 2;
+        view->internal = shape;
+    }
+    return 0;
+}
+
+static void
+RayPy_Tilemap_releasebuffer(RayPy_TilemapObject *Py_UNUSED(self), Py_buffer *view)
+{
+    PyMem_Free(view->internal);
+}
+
+static PyMemberDef RayPy_Tilemap_members[] = {
+    {"width", Py_T_INT, offsetof(RayPy_TilemapObject, width), Py_READONLY, "Map width in tiles"},
+    {"height", Py_T_INT, offsetof(RayPy_TilemapObject, height), Py_READONLY, "Map height in tiles"},
+    {"tile_width", Py_T_INT, offsetof(RayPy_TilemapObject, tile_width), Py_READONLY, "Tile width in pixels"},
+    {"tile_height", Py_T_INT, offsetof(RayPy_TilemapObject, tile_height), Py_READONLY, "Tile height in pixels"},
+    {"chunk_size", Py_T_INT, offsetof(RayPy_TilemapObject, chunk_size), Py_READONLY, "Chunk width and height in tiles"},
+    {NULL}
+};
+
+static PyGetSetDef RayPy_Tilemap_getset[] = {
+    {"tiles", (getter)RayPy_Tilemap_get_tiles, NULL, "Tile ids, uint16 memoryview of shape (height, width), 0 for no tile and n for the n-th tile of the tileset", NULL},
+    {"tileset", (getter)RayPy_Tilemap_get_tileset, (setter)RayPy_Tilemap_set_tileset, "Texture of the tiles, left to right and top to bottom", NULL},
+    {NULL}
+};
+
+static PyType_Slot RayPy_Tilemap_slots[] = {
+    {Py_tp_doc, PyDoc_STR("Tilemap(width, height, tileset, tile_width, tile_height, chunk_size=32), grid of tiles "
+                        "drawn from cached chunk meshes")},
+    {Py_tp_new, PyType_GenericNew},
+    {Py_tp_init, RayPy_Tilemap_init},
+    {Py_tp_dealloc, RayPy_Tilemap_dealloc},
+    {Py_bf_getbuffer, RayPy_Tilemap_getbuffer},
+    {Py_bf_releasebuffer, RayPy_Tilemap_releasebuffer},
+    {Py_tp_members, RayPy_Tilemap_members},
+    {Py_tp_getset, RayPy_Tilemap_getset},
+    {0, NULL},
+};
+
+static PyType_Spec RayPy_Tilemap_spec = {
+    .name = "raypy.Tilemap",
+    .basicsize = sizeof(RayPy_TilemapObject),
+    .itemsize = 0,
+    .flags = Py_TPFLAGS_DEFAULT | Py_TPFLAGS_BASETYPE | Py_TPFLAGS_IMMUTABLETYPE,
+    .slots = RayPy_Tilemap_slots,
+};
+
+static PyObject *
+RayPy_DrawTilemap(PyObject *Py_UNUSED(self), PyObject *args)
+{
+    RayPy_TilemapObject *tilemap;
+    RayPy_Vector2Object *position = NULL;
+    RayPy_ColorObject *tint = NULL;
+    float view[4];
+    if (!PyArg_ParseTuple(args, "O!|O!O!", &RayPy_Tilemap_Type, &tilemap, &RayPy_Vector2_Type, &position,
+                          &RayPy_Color_Type, &tint))
+        return NULL;
+    IS_RENDER_THREAD();
+    if (tilemap->tiles == NULL) {
+        PyErr_SetString(PyExc_ValueError, "tilemap is not initialized");
+        return NULL;
+    }
+    if (tilemap->material.maps == NULL)
+        tilemap->material = LoadMaterialDefault();
+    float x = position != NULL ? position->x : 0.0f, y = position != NULL ? position->y : 0.0f;
+
+    /* chunks overlapping the view */
+    float chunk_w = (float)tilemap->chunk_size * tilemap->tile_width;
+    float chunk_h = (float)tilemap->chunk_size * tilemap->tile_height;
+    RayPy_Cull_GetView(view);
+    float fx0 = floorf((view[0] - x) / chunk_w), fx1 = floorf((view[2] - x) / chunk_w);
+    float fy0 = floorf((view[1] - y) / chunk_h), fy1 = floorf((view[3] - y) / chunk_h);
+    int cx0 = fx0 < 0.0f ? 0 : (int)fminf(fx0, (float)tilemap->chunks_x);
+    int cx1 = fx1 >= tilemap->chunks_x ? tilemap->chunks_x - 1 : (int)fmaxf(fx1, -1.0f);
+    int cy0 = fy0 < 0.0f ? 0 : (int)fminf(fy0, (float)tilemap->chunks_y);
+    int cy1 = fy1 >= tilemap->chunks_y ? tilemap->chunks_y - 1 : (int)fmaxf(fy1, -1.0f);
+
+    /* raylib batches 2D draws, what's batched goes first to keep the draw order */
+    rlDrawRenderBatchActive();
+    tilemap->material.maps[MATERIAL_MAP_DIFFUSE].texture = tilemap->tileset->t;
+    tilemap->material.maps[MATERIAL_MAP_DIFFUSE].color = tint != NULL ? RayPy_Color_AsColor(tint) : WHITE;
+    Matrix transform = MatrixIdentity();
+    transform.m12 = x;
+    transform.m13 = y;
+    int drawn = 0, culled = tilemap->chunks_x * tilemap->chunks_y;
+    for (int cy = cy0; cy <= cy1; cy++) {
+        for (int cx = cx0; cx <= cx1; cx++) {
+            RayPy_TileChunk *chunk = &tilemap->chunks[cy * tilemap->chunks_x + cx];
+            if (RayPy_Tilemap_BuildChunk(tilemap, cx, cy) < 0)
+                return NULL;
+            culled--;
+            if (chunk->quads == 0)
+                continue;
+            Mesh mesh = chunk->mesh;
+            mesh.vertexCount = chunk->quads * 4;
+            mesh.triangleCount = chunk->quads * 2;
+            DrawMesh(mesh, tilemap->material, transform);
+            drawn++;
+        }
+    }
+    RayPy_cull.chunks_drawn += drawn;
+    RayPy_cull.chunks_culled += culled;
+    return PyLong_FromLong(drawn);
+}
+
+PyDoc_STRVAR(draw_tilemap_doc,
+             "Draw the chunks of a tilemap in view at a position (0, 0 by default) with a tint, rebuilding "
+             "those whose tiles changed, returns how many chunks were drawn");
+
+static PyObject *
+RayPy_UnloadTilemap(PyObject *Py_UNUSED(self), PyObject *args)
+{
+    RayPy_TilemapObject *tilemap;
+    if (!PyArg_ParseTuple(args, "O!", &RayPy_Tilemap_Type, &tilemap))
+        return NULL;
+    if (tilemap->chunks != NULL)
+        RayPy_Tilemap_UnloadChunks(tilemap);
+    Py_RETURN_NONE;
+}
+
+PyDoc_STRVAR(unload_tilemap_doc, "Unload the chunk meshes of a tilemap from GPU memory (VRAM), drawing builds them again");
+
+/* Particle system
+
+   Particles are stored as separate float arrays (x, y, vx, vy, age, lifetime)
+   so the update runs 4 at a time and splits across the worker threads with
+   the GIL released. Colors and sizes come from the age when drawing, through
+   a color over life table and a start to end size. */
+
+#define RAYPY_PARTICLE_GRAIN 16384 // particles per task
+#define RAYPY_PARTICLE_FIELDS 6
+#define RAYPY_COLOR_CURVE_SIZE 256
+
+enum {
+    RAYPY_PARTICLE_X,
+    RAYPY_PARTICLE_Y,
+    RAYPY_PARTICLE_VX,
+    RAYPY_PARTICLE_VY,
+    RAYPY_PARTICLE_AGE,
+    RAYPY_PARTICLE_LIFETIME,
+};
+
+typedef struct {
+    PyObject_HEAD int capacity;
+    int count;
+    float *fields[RAYPY_PARTICLE_FIELDS];
+    int busy; // claimed by the method working on it, see RayPy_ParticleSystem_Claim()
+    uint32_t random;
+    /* forces */
+    float gravity_x, gravity_y;
+    float drag;
+    /* emitter */
+    float emit_x, emit_y;
+    float rate, pending; // particles per second, fraction not emitted yet
+    float speed[2], angle[2], life[2];
+    float spread;
+    /* looks */
+    float size_start, size_end;
+    Color curve[RAYPY_COLOR_CURVE_SIZE];
+} RayPy_ParticleSystemObject;
+
+/* xorshift32, in [0, 1) */
+static inline float
+RayPy_Particles_Random(RayPy_ParticleSystemObject *self)
+{
+    uint32_t x = self->random;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    self->random = x;
+    return (x >> 8) * (1.0f / 16777216.0f);
+}
+
+static inline float
+RayPy_Particles_Range(RayPy_ParticleSystemObject *self, const float range[2])
+{
+    return range[0] + (range[1] - range[0]) * RayPy_Particles_Random(self);
+}
+
+/* Spawns up to `count` particles at x, y with the emitter settings, returns how many */
+static int
+RayPy_Particles_Emit(RayPy_ParticleSystemObject *self, int count, float x, float y)
+{
+    float **f = self->fields;
+    count = Py_MIN(count, self->capacity - self->count);
+    for (int k = 0; k < count; k++) {
+        int i = self->count++;
+        float offset = self->spread * sqrtf(RayPy_Particles_Random(self));
+        float around = 2.0f * PI * RayPy_Particles_Random(self);
+        float speed = RayPy_Particles_Range(self, self->speed);
+        float angle = RayPy_Particles_Range(self, self->angle) * DEG2RAD;
+        f[RAYPY_PARTICLE_X][i] = x + offset * cosf(around);
+        f[RAYPY_PARTICLE_Y][i] = y + offset * sinf(around);
+        f[RAYPY_PARTICLE_VX][i] = speed * cosf(angle);
+        f[RAYPY_PARTICLE_VY][i] = speed * sinf(angle);
+        f[RAYPY_PARTICLE_AGE][i] = 0.0f;
+        f[RAYPY_PARTICLE_LIFETIME][i] = RayPy_Particles_Range(self, self->life);
+    }
+    return count;
+}
+
+typedef struct {
+    float **fields;
+    float dt, damping, gx, gy;
+} RayPy_ParticlesUpdateArgs;
+
+static void
+RayPy_Particles_UpdateRange(void *arg, int begin, int end)
+{
+    RayPy_ParticlesUpdateArgs *a = arg;
+    float *x = a->fields[RAYPY_PARTICLE_X], *y = a->fields[RAYPY_PARTICLE_Y];
+    float *vx = a->fields[RAYPY_PARTICLE_VX], *vy = a->fields[RAYPY_PARTICLE_VY];
+    float *age = a->fields[RAYPY_PARTICLE_AGE];
+    int i = begin;
+    RayPy_Vec4 dt = RayPy_Vec4_Set1(a->dt), damping = RayPy_Vec4_Set1(a->damping);
+    RayPy_Vec4 gx = RayPy_Vec4_Set1(a->gx * a->dt), gy = RayPy_Vec4_Set1(a->gy * a->dt);
+    for (; i + 4 <= end; i += 4) {
+        RayPy_Vec4 u = RayPy_Vec4_Add(RayPy_Vec4_Mul(RayPy_Vec4_LoadF(vx + i), damping), gx);
+        RayPy_Vec4 v = RayPy_Vec4_Add(RayPy_Vec4_Mul(RayPy_Vec4_LoadF(vy + i), damping), gy);
+        RayPy_Vec4_StoreF(vx + i, u);
+        RayPy_Vec4_StoreF(vy + i, v);
+        RayPy_Vec4_StoreF(x + i, RayPy_Vec4_Add(RayPy_Vec4_LoadF(x + i), RayPy_Vec4_Mul(u, dt)));
+        RayPy_Vec4_StoreF(y + i, RayPy_Vec4_Add(RayPy_Vec4_LoadF(y + i), RayPy_Vec4_Mul(v, dt)));
+        RayPy_Vec4_StoreF(age + i, RayPy_Vec4_Add(RayPy_Vec4_LoadF(age + i), dt));
+    }
+    for (; i < end; i++) {
+        vx[i] = vx[i] * a->damping + a->gx * a->dt;
+        vy[i] = vy[i] * a->damping + a->gy * a->dt;
+        x[i] += vx[i] * a->dt;
+        y[i] += vy[i] * a->dt;
+        age[i] += a->dt;
+    }
+}
+
+/* Removes particles past their lifetime, the last ones fill the holes */
+static void
+RayPy_Particles_Compact(RayPy_ParticleSystemObject *self)
+{
+    float **f = self->fields;
+    int count = self->count;
+    for (int i = 0; i < count;) {
+        if (f[RAYPY_PARTICLE_AGE][i] < f[RAYPY_PARTICLE_LIFETIME][i]) {
+            i++;
+            continue;
+        }
+        count--;
+        for (int k = 0; k < RAYPY_PARTICLE_FIELDS; k++)
+            f[k][i] = f[k][count];
+    }
+    self->count = count;
+}
+
+/* Marks the system busy for the caller until RayPy_ParticleSystem_Release(), like images */
+static int
+RayPy_ParticleSystem_Claim(RayPy_ParticleSystemObject *self)
+{
+    if (!RAYPY_CAS_LONG(&self->busy, 0, 1)) {
+        PyErr_SetString(PyExc_RuntimeError, "particle system is being updated by another thread");
+        return -1;
+    }
+    if (self->fields[0] == NULL) {
+        RAYPY_STORE_LONG(&self->busy, 0);
+        PyErr_SetString(PyExc_ValueError, "particle system is not initialized");
+        return -1;
+    }
+    return 0;
+}
+
+static void
+RayPy_ParticleSystem_Release(RayPy_ParticleSystemObject *self)
+{
+    RAYPY_STORE_LONG(&self->busy, 0);
+}
+
+static void
+RayPy_ParticleSystem_dealloc(RayPy_ParticleSystemObject *self)
+{
+    PyMem_Free(self->fields[0]);
+    PyTypeObject *tp = Py_TYPE(self);
+    tp->tp_free((PyObject *)self);
+    Py_DECREF(tp);
+}
+
+static int
+RayPy_ParticleSystem_init(RayPy_ParticleSystemObject *self, PyObject *args, PyObject *kwds)
+{
+    int capacity;
+    unsigned int seed = 0;
+    static char *kwlist[] = {"capacity", "seed", NULL};
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "i|I", kwlist, &capacity, &seed))
+        return -1;
+    if (self->fields[0] != NULL) {
+        PyErr_SetString(PyExc_RuntimeError, "particle system is already initialized");
+        return -1;
+    }
+    if (capacity <= 0) {
+        PyErr_SetString(PyExc_ValueError, "capacity must be > 0");
+        return -1;
+    }
+    float *data = PyMem_Calloc((size_t)capacity * RAYPY_PARTICLE_FIELDS, sizeof(float));
+    if (data == NULL) {
+        PyErr_NoMemory();
+        return -1;
+    }
+    for (int k = 0; k < RAYPY_PARTICLE_FIELDS; k++)
+        self->fields[k] = data + (size_t)k * capacity;
+    self->capacity = capacity;
+    self->random = seed != 0 ? seed : (uint32_t)RayPy_MonotonicNs() | 1;
+    self->speed[0] = self->speed[1] = 100.0f;
+    self->angle[0] = 0.0f;
+    self->angle[1] = 360.0f;
+    self->life[0] = self->life[1] = 1.0f;
+    self->size_start = self->size_end = 4.0f;
+    for (int i = 0; i < RAYPY_COLOR_CURVE_SIZE; i++)
+        self->curve[i] = WHITE;
+    return 0;
+}
+
+static PyObject *
+RayPy_ParticleSystem_set_emitter(RayPy_ParticleSystemObject *self, PyObject *args, PyObject *kwds)
+{
+    RayPy_Vector2Object *position;
+    float rate = self->rate, spread = self->spread;
+    float speed[2] = {self->speed[0], self->speed[1]}, angle[2] = {self->angle[0], self->angle[1]};
+    float life[2] = {self->life[0], self->life[1]};
+    static char *kwlist[] = {"position", "rate", "speed", "angle", "life", "spread", NULL};
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "O!|f$(ff)(ff)(ff)f", kwlist, &RayPy_Vector2_Type, &position,
+                                     &rate, &speed[0], &speed[1], &angle[0], &angle[1], &life[0], &life[1],
+                                     &spread))
+        return NULL;
+    if (!(rate >= 0.0f) || !(spread >= 0.0f) || !(life[0] > 0.0f && life[1] >= life[0])) {
+        PyErr_SetString(PyExc_ValueError, "rate and spread must be >= 0 and life a (min, max) range > 0");
+        return NULL;
+    }
+    self->emit_x = position->x;
+    self->emit_y = position->y;
+    self->rate = rate;
+    self->spread = spread;
+    memcpy(self->speed, speed, sizeof(speed));
+    memcpy(self->angle, angle, sizeof(angle));
+    memcpy(self->life, life, sizeof(life));
+    Py_RETURN_NONE;
+}
+
+static PyObject *
+RayPy_ParticleSystem_emit(RayPy_ParticleSystemObject *self, PyObject *args)
+{
+    int count;
+    RayPy_Vector2Object *position = NULL;
+    if (!PyArg_ParseTuple(args, "i|O!", &count, &RayPy_Vector2_Type, &position))
+        return NULL;
+    if (count < 0) {
+        PyErr_SetString(PyExc_ValueError, "count must be >= 0");
+        return NULL;
+    }
+    if (RayPy_ParticleSystem_Claim(self))
+        return NULL;
+    int emitted = RayPy_Particles_Emit(self, count, position != NULL ? position->x : self->emit_x,
+                                       position != NULL ? position->y : self->emit_y);
+    RayPy_ParticleSystem_Release(self);
+    return PyLong_FromLong(emitted);
+}
+
+static PyObject *
+RayPy_ParticleSystem_update(RayPy_ParticleSystemObject *self, PyObject *arg)
+{
+    float dt = (float)PyFloat_AsDouble(arg);
+    if (dt == -1.0f && PyErr_Occurred())
+        return NULL;
+    if (!(dt >= 0.0f) || !isfinite(dt)) {
+        PyErr_SetString(PyExc_ValueError, "dt must be finite and >= 0");
+        return NULL;
+    }
+    if (RayPy_ParticleSystem_Claim(self))
+        return NULL;
+    /* drag takes this fraction of the velocity per second */
+    RayPy_ParticlesUpdateArgs a = {self->fields, dt, fmaxf(1.0f - self->drag * dt, 0.0f), self->gravity_x,
+                                   self->gravity_y};
+    if (self->count > RAYPY_PARTICLE_GRAIN) {
+        if (RayPy_Pool_Start()) {
+            RayPy_ParticleSystem_Release(self);
+            return NULL;
+        }
+        Py_BEGIN_ALLOW_THREADS
+        RayPy_ParallelFor(RayPy_Particles_UpdateRange, &a, self->count, RAYPY_PARTICLE_GRAIN);
+        RayPy_Particles_Compact(self);
+        Py_END_ALLOW_THREADS
+    }
+    else {
+        RayPy_Particles_UpdateRange(&a, 0, self->count);
+        RayPy_Particles_Compact(self);
+    }
+    self->pending += self->rate * dt;
+    if (self->pending >= 1.0f) {
+        int count = self->pending < (float)INT_MAX ? (int)self->pending : INT_MAX;
+        RayPy_Particles_Emit(self, count, self->emit_x, self->emit_y);
+        self->pending -= (float)count;
+    }
+    RayPy_ParticleSystem_Release(self);
+    Py_RETURN_NONE;
+}
+
+static PyObject *
+RayPy_ParticleSystem_set_color_curve(RayPy_ParticleSystemObject *self, PyObject *arg)
+{
+    PyObject *seq = PySequence_Fast(arg, "color curve must be a sequence of (time, Color)");
+    if (seq == NULL)
+        return NULL;
+    Py_ssize_t n = PySequence_Fast_GET_SIZE(seq);
+    float times[RAYPY_COLOR_CURVE_SIZE];
+    Color colors[RAYPY_COLOR_CURVE_SIZE];
+    if (n < 1 || n > RAYPY_COLOR_CURVE_SIZE) {
+        PyErr_Format(PyExc_ValueError, "color curve must have 1 to %d stops", RAYPY_COLOR_CURVE_SIZE);
+        goto error;
+    }
+    for (Py_ssize_t i = 0; i < n; i++) {
+        RayPy_ColorObject *color;
+        if (!PyArg_ParseTuple(PySequence_Fast_GET_ITEM(seq, i), "fO!;color curve stops are (time, Color)",
+                              &times[i], &RayPy_Color_Type, &color))
+            goto error;
+        if (!(times[i] >= 0.0f && times[i] <= 1.0f) || (i > 0 && times[i] < times[i - 1])) {
+            PyErr_SetString(PyExc_ValueError, "color curve times must go up from 0.0 to 1.0");
+            goto error;
+        }
+        colors[i] = RayPy_Color_AsColor(color);
+    }
+    /* sampled at the middle of each table entry, flat before the first stop and after the last */
+    for (int k = 0, s = 0; k < RAYPY_COLOR_CURVE_SIZE; k++) {
+        float t = (k + 0.5f) / RAYPY_COLOR_CURVE_SIZE;
+        while (s < n && times[s] <= t)
+            s++;
+        if (s == 0 || s == n) {
+            self->curve[k] = colors[s == 0 ? 0 : n - 1];
+            continue;
+        }
+        float span = times[s] - times[s - 1], w = span > 0.0f ? (t - times[s - 1]) / span : 1.0f;
+        Color a = colors[s - 1], b = colors[s];
+        self->curve[k] = (Color){(unsigned char)(a.r + (b.r - a.r) * w + 0.5f),
+                                 (unsigned char)(a.g + (b.g - a.g) * w + 0.5f),
+                                 (unsigned char)(a.b + (b.b - a.b) * w + 0.5f),
+                                 (unsigned char)(a.a + (b.a - a.a) * w + 0.5f)};
+    }
+    Py_DECREF(seq);
+    Py_RETURN_NONE;
+error:
+    Py_DECREF(seq);
+    return NULL;
+}
+
+static PyObject *
+RayPy_ParticleSystem_clear(RayPy_ParticleSystemObject *self, PyObject *Py_UNUSED(args))
+{
+    if (RayPy_ParticleSystem_Claim(self))
+        return NULL;
+    self->count = 0;
+    self->pending = 0.0f;
+    RayPy_ParticleSystem_Release(self);
+    Py_RETURN_NONE;
+}
+
+static PyObject *
+RayPy_ParticleSystem_get_gravity(RayPy_ParticleSystemObject *self, void *Py_UNUSED(closure))
+{
+    return RayPy_Vector2_FromVector2((Vector2){self->gravity_x, self->gravity_y});
+}
+
+static int
+RayPy_ParticleSystem_set_gravity(RayPy_ParticleSystemObject *self, PyObject *value, void *Py_UNUSED(closure))
+{
+    if (value == NULL || !PyObject_TypeCheck(value, &RayPy_Vector2_Type)) {
+        PyErr_Format(PyExc_TypeError, "must be raypy.Vector2, not %s",
+                     value == NULL ? "deleting" : Py_TYPE(value)->tp_name);
+        return -1;
+    }
+    self->gravity_x = ((RayPy_Vector2Object *)value)->x;
+    self->gravity_y = ((RayPy_Vector2Object *)value)->y;
+    return 0;
+}
+
+/* A view of one of the particle arrays, `count` long when made */
+typedef struct {
+    PyObject_HEAD RayPy_ParticleSystemObject *system;
+    int field;
+    Py_ssize_t count; // particles alive when made, the shape
+} RayPy_ParticleArrayObject;
+
+static void
+RayPy_ParticleArray_dealloc(RayPy_ParticleArrayObject *self)
+{
+    Py_XDECREF(self->system);
+    PyTypeObject *tp = Py_TYPE(self);
+    tp->tp_free((PyObject *)self);
+    Py_DECREF(tp);
+}
+
+static int
+RayPy_ParticleArray_getbuffer(RayPy_ParticleArrayObject *self, Py_buffer *view, int flags)
+{
+    /* the arrays are never reallocated, only the particles in them move */
+    if (PyBuffer_FillInfo(view, (PyObject *)self, self->system->fields[self->field],
+                          (Py_ssize_t)self->count * sizeof(float), 0, flags))
+        return -1;
+    view->itemsize = sizeof(float);
+    if (flags & PyBUF_FORMAT)
+        view->format = "f";
+    if (flags & PyBUF_ND)
+        view->shape = &self->count;
+    return 0;
+}
+
+static PyType_Slot RayPy_ParticleArray_slots[] = {
+    {Py_tp_dealloc, RayPy_ParticleArray_dealloc},
+    {Py_bf_getbuffer, RayPy_ParticleArray_getbuffer},
+    {0, NULL},
+};
+
+static PyType_Spec RayPy_ParticleArray_spec = {
+    .name = "raypy._ParticleArray",
+    .basicsize = sizeof(RayPy_ParticleArrayObject),
+    .itemsize = 0,
+    .flags = Py_TPFLAGS_DEFAULT | Py_TPFLAGS_IMMUTABLETYPE | Py_TPFLAGS_DISALLOW_INSTANTIATION,
+    .slots = RayPy_ParticleArray_slots,
+};
+
+static PyObject *
+RayPy_ParticleSystem_get_array(RayPy_ParticleSystemObject *self, void *closure)
+{
+    if (RayPy_ParticleSystem_Claim(self))
+        return NULL;
+    RayPy_ParticleSystem_Release(self);
+    RayPy_ParticleArrayObject *array = PyObject_New(RayPy_ParticleArrayObject, &RayPy_ParticleArray_Type);
+    if (array == NULL)
+        return NULL;
+    array->system = (RayPy_ParticleSystemObject *)Py_NewRef(self);
+    array->field = (int)(intptr_t)closure;
+    array->count = self->count;
+    PyObject *ret = PyMemoryView_FromObject((PyObject *)array);
+    Py_DECREF(array);
+    return ret;
+}
+
+static PyMethodDef RayPy_ParticleSystem_methods[] = {
+    {"set_emitter", (PyCFunction)(void (*)(void))RayPy_ParticleSystem_set_emitter, METH_VARARGS | METH_KEYWORDS,
+     "Set where and how particles are emitted: position, rate per second and (min, max) ranges of speed, "
+     "angle in degrees and life in seconds, spread is the radius around the position they start in"},
+    {"emit", (PyCFunction)RayPy_ParticleSystem_emit, METH_VARARGS,
+     "Emit particles now, at the emitter or at a position, returns how many fit"},
+    {"update", (PyCFunction)RayPy_ParticleSystem_update, METH_O,
+     "Move the particles dt seconds, remove those past their life and emit at the emitter rate"},
+    {"set_color_curve", (PyCFunction)RayPy_ParticleSystem_set_color_curve, METH_O,
+     "Set the color over life as (time, Color) stops, time from 0.0 (birth) to 1.0 (death)"},
+    {"clear", (PyCFunction)RayPy_ParticleSystem_clear, METH_NOARGS,
+     "Remove every particle"},
+    {NULL}
+};
+
+static PyMemberDef RayPy_ParticleSystem_members[] = {
+    {"capacity", Py_T_INT, offsetof(RayPy_ParticleSystemObject, capacity), Py_READONLY, "Particles the system can hold"},
+    {"count", Py_T_INT, offsetof(RayPy_ParticleSystemObject, count), Py_READONLY, "Particles alive"},
+    {"drag", Py_T_FLOAT, offsetof(RayPy_ParticleSystemObject, drag), 0, "Fraction of the velocity lost per second"},
+    {"rate", Py_T_FLOAT, offsetof(RayPy_ParticleSystemObject, rate), 0, "Particles emitted per second by update()"},
+    {"size_start", Py_T_FLOAT, offsetof(RayPy_ParticleSystemObject, size_start), 0, "Particle size at birth"},
+    {"size_end", Py_T_FLOAT, offsetof(RayPy_ParticleSystemObject, size_end), 0, "Particle size at death"},
+    {NULL}
+};
+
+static PyGetSetDef RayPy_ParticleSystem_getset[] = {
+    {"gravity", (getter)RayPy_ParticleSystem_get_gravity, (setter)RayPy_ParticleSystem_set_gravity, "Acceleration of every particle", NULL},
+    {"x", (getter)RayPy_ParticleSystem_get_array, NULL, "Positions x of the particles alive, float32 memoryview", (void *)RAYPY_PARTICLE_X},
+    {"y", (getter)RayPy_ParticleSystem_get_array, NULL, "Positions y of the particles alive, float32 memoryview", (void *)RAYPY_PARTICLE_Y},
+    {"vx", (getter)RayPy_ParticleSystem_get_array, NULL, "Velocities x of the particles alive, float32 memoryview", (void *)RAYPY_PARTICLE_VX},
+    {"vy", (getter)RayPy_ParticleSystem_get_array, NULL, "Velocities y of the particles alive, float32 memoryview", (void *)RAYPY_PARTICLE_VY},
+    {"age", (getter)RayPy_ParticleSystem_get_array, NULL, "Seconds since each particle was emitted, float32 memoryview", (void *)RAYPY_PARTICLE_AGE},
+    {"lifetime", (getter)RayPy_ParticleSystem_get_array, NULL, "Seconds each particle lives, float32 memoryview", (void *)RAYPY_PARTICLE_LIFETIME},
+    {NULL}
+};
+
+static PyType_Slot RayPy_ParticleSystem_slots[] = {
+    {Py_tp_doc, PyDoc_STR("ParticleSystem(capacity, seed=0), particles in float arrays updated natively, "
+                        "a seed of 0 seeds from the clock")},
+    {Py_tp_new, PyType_GenericNew},
+    {Py_tp_init, RayPy_ParticleSystem_init},
+    {Py_tp_dealloc, RayPy_ParticleSystem_dealloc},
+    {Py_tp_methods, RayPy_ParticleSystem_methods},
+    {Py_tp_members, RayPy_ParticleSystem_members},
+    {Py_tp_getset, RayPy_ParticleSystem_getset},
+    {0, NULL},
+};
+
+static PyType_Spec RayPy_ParticleSystem_spec = {
+    .name = "raypy.ParticleSystem",
+    .basicsize = sizeof(RayPy_ParticleSystemObject),
+    .itemsize = 0,
+    .flags = Py_TPFLAGS_DEFAULT | Py_TPFLAGS_BASETYPE | Py_TPFLAGS_IMMUTABLETYPE,
+    .slots = RayPy_ParticleSystem_slots,
+};
+
+static PyObject *
+RayPy_DrawParticles(PyObject *Py_UNUSED(self), PyObject *args)
+{
+    RayPy_ParticleSystemObject *system;
+    RayPy_TextureObject *texture = NULL;
+    float view[4];
+    if (!PyArg_ParseTuple(args, "O!|O!", &RayPy_ParticleSystem_Type, &system, &RayPy_Texture_Type, &texture))
+        return NULL;
+    IS_RENDER_THREAD();
+    if (RayPy_ParticleSystem_Claim(system))
+        return NULL;
+    float **f = system->fields;
+    float max_half = fmaxf(fabsf(system->size_start), fabsf(system->size_end)) * 0.5f;
+    RayPy_Cull_GetView(view);
+    view[0] -= max_half, view[1] -= max_half, view[2] += max_half, view[3] += max_half;
+    int drawn = 0;
+    /* one texture for all, so it's all one draw unless the batch fills up */
+    rlSetTexture(texture != NULL ? texture->t.id : rlGetTextureIdDefault());
+    for (int i = 0; i < system->count; i++) {
+        float x = f[RAYPY_PARTICLE_X][i], y = f[RAYPY_PARTICLE_Y][i];
+        if (!(x >= view[0] && x <= view[2] && y >= view[1] && y <= view[3]))
+            continue;
+        float t = f[RAYPY_PARTICLE_AGE][i] / f[RAYPY_PARTICLE_LIFETIME][i];
+        t = t < 0.0f ? 0.0f : t > 1.0f ? 1.0f : t;
+        float half = (system->size_start + (system->size_end - system->size_start) * t) * 0.5f;
+        Color c = system->curve[Py_MIN((int)(t * RAYPY_COLOR_CURVE_SIZE), RAYPY_COLOR_CURVE_SIZE - 1)];
+        rlCheckRenderBatchLimit(4);
+        rlBegin(RL_QUADS);
+        rlColor4ub(c.r, c.g, c.b, c.a);
+        rlNormal3f(0.0f, 0.0f, 1.0f);
+        rlTexCoord2f(0.0f, 0.0f);
+        rlVertex2f(x - half, y - half);
+        rlTexCoord2f(0.0f, 1.0f);
+        rlVertex2f(x - half, y + half);
+        rlTexCoord2f(1.0f, 1.0f);
+        rlVertex2f(x + half, y + half);
+        rlTexCoord2f(1.0f, 0.0f);
+        rlVertex2f(x + half, y - half);
+        rlEnd();
+        drawn++;
+    }
+    rlSetTexture(0);
+    RayPy_cull.drawn += drawn;
+    RayPy_cull.culled += system->count - drawn;
+    RayPy_ParticleSystem_Release(system);
+    return PyLong_FromLong(drawn);
+}
+
+PyDoc_STRVAR(draw_particles_doc,
+             "Draw the particles in view as squares of their size and color, textured if a texture is given, "
+             "returns how many were drawn");
+
+/* Audio
+
+   Music streams decode from the file a buffer at a time, raylib never
+   holds a whole song in memory. Loaded music is refilled by a native
+   thread every few milliseconds instead of the frame loop, so a slow frame
+   doesn't make it run dry. Raw streams take buffers with
+   update_audio_stream() like in raylib, or play a queue of buffers the
+   mixer reads straight from the exporters' memory (numpy arrays, bytes,
+   ...) through a stream callback.
+
+   Locks: RayPy_audio.lock guards the Music objects and is held around
+   raylib calls, the mixer thread calls the stream callbacks with raylib's
+   own lock held, so the queues have a separate lock that is never held
+   while calling raylib. */
+
+/* Interpreter that opened the audio device, -1 for none, the others can't use it */
+static long RayPy_audio_interp = -1;
+
+#define AUDIO_IS_READY()                                                                      \
+    if (!IsAudioDeviceReady()) {                                                              \
+        PyErr_SetString(PyExc_RuntimeError, "audio device not initialized");                  \
+        return NULL;                                                                          \
+    }                                                                                         \
+    if (RAYPY_LOAD_LONG(&RayPy_audio_interp) != RayPy_InterpreterId()) {                      \
+        PyErr_SetString(PyExc_RuntimeError, "audio device owned by another interpreter");      \
+        return NULL;                                                                          \
+    }
+
+#define RAYPY_MUSIC_REFILL_NS 5000000LL // between refills of the playing music streams
+#define RAYPY_AUDIO_STREAM_SLOTS 16     // streams playing a queue at the same time
+
+
+typedef struct {
+    PyObject_HEAD Sound s;
+} RayPy_SoundObject;
+
+typedef struct {
+    PyObject_HEAD Music m;
+    int registered; // refilled by the music thread
+} RayPy_MusicObject;
+
+typedef struct {
+    Py_buffer view;
+    Py_ssize_t frames;
+} RayPy_AudioChunk;
+
+typedef struct {
+    PyObject_HEAD AudioStream s;
+    int slot;                 // stream callback, -1 until the first queue_audio_stream()
+    Py_ssize_t frame_size;    // bytes per frame
+    RayPy_AudioChunk *chunks; // queued buffers, [head, count) not fully played yet
+    Py_ssize_t count, capacity, head;
+    Py_ssize_t offset;        // frames of chunks[head] already played
+    long long silent_frames;  // played as silence for an empty queue
+} RayPy_AudioStreamObject;
+
+static struct {
+    PyThread_type_lock lock;    // guards the fields below and the registered Music objects
+    PyThread_type_lock stopped; // released by the music thread when it exits
+    int running;                // music thread started
+    int stop;                   // asks the music thread to exit, set until it did
+    RayPy_MusicObject **musics;
+    Py_ssize_t count, capacity;
+    PyThread_type_lock queue;   // guards the stream queues and streams[]
+    PyThread_type_lock device;  // held while opening or closing the audio device
+    RayPy_AudioStreamObject *streams[RAYPY_AUDIO_STREAM_SLOTS];
+} RayPy_audio = {0};
+
+/* Takes RayPy_audio.lock with the GIL held, the music thread may hold it for a
+   whole refill so it's waited for with the GIL released */
+static void
+RayPy_Audio_Lock(void)
+{
+    if (PyThread_acquire_lock(RayPy_audio.lock, NOWAIT_LOCK))
+        return;
+    Py_BEGIN_ALLOW_THREADS
+    PyThread_acquire_lock(RayPy_audio.lock, WAIT_LOCK);
+    Py_END_ALLOW_THREADS
+}
+
+static void
+RayPy_Music_Thread(void *Py_UNUSED(arg))
+{
+    for (;;) {
+        PyThread_acquire_lock(RayPy_audio.lock, WAIT_LOCK);
+        int stop = RayPy_audio.stop;
+        if (!stop) {
+            for (Py_ssize_t i = 0; i < RayPy_audio.count; i++) {
+                Music music = RayPy_audio.musics[i]->m;
+                if (IsMusicStreamPlaying(music))
+                    UpdateMusicStream(music);
+            }
+        }
+        PyThread_release_lock(RayPy_audio.lock);
+        if (stop)
+            break;
+        RayPy_SleepNs(RAYPY_MUSIC_REFILL_NS);
+    }
+    PyThread_release_lock(RayPy_audio.stopped);
+}
+
+/* Adds music to the ones the music thread refills, starting it if needed */
+static int
+RayPy_Music_Register(RayPy_MusicObject *music)
+{
+    RayPy_Audio_Lock();
+    if (RayPy_audio.count == RayPy_audio.capacity) {
+        Py_ssize_t capacity = RayPy_audio.capacity ? RayPy_audio.capacity * 2 : 8;
+        RayPy_MusicObject **musics = PyMem_Realloc(RayPy_audio.musics, capacity * sizeof(*musics));
+        if (musics == NULL) {
+            PyThread_release_lock(RayPy_audio.lock);
+            PyErr_NoMemory();
+            return -1;
+        }
+        RayPy_audio.musics = musics;
+        RayPy_audio.capacity = capacity;
+    }
+    RayPy_audio.musics[RayPy_audio.count++] = music;
+    music->registered = 1;
+    /* claimed under the lock so threads playing music at once start a single
+       thread, and none while the previous one is stopping */
+    int start = !RayPy_audio.running && !RayPy_audio.stop;
+    if (start)
+        RayPy_audio.running = 1;
+    PyThread_release_lock(RayPy_audio.lock);
+
+    if (start && PyThread_start_new_thread(RayPy_Music_Thread, NULL) == PYTHREAD_INVALID_THREAD_ID) {
+        RayPy_Audio_Lock();
+        RayPy_audio.running = 0;
+        for (Py_ssize_t i = 0; i < RayPy_audio.count; i++) {
+            if (RayPy_audio.musics[i] == music) {
+                RayPy_audio.musics[i] = RayPy_audio.musics[--RayPy_audio.count];
+                break;
+            }
+        }
+        music->registered = 0;
+        PyThread_release_lock(RayPy_audio.lock);
+        PyErr_SetString(PyExc_RuntimeError, "can't start the music thread");
+        return -1;
+    }
+    return 0;
+}
+
+static void
+RayPy_Music_Unregister(RayPy_MusicObject *music)
+{
+    if (!music->registered)
+        return;
+    RayPy_Audio_Lock();
+    for (Py_ssize_t i = 0; i < RayPy_audio.count; i++) {
+        if (RayPy_audio.musics[i] == music) {
+            RayPy_audio.musics[i] = RayPy_audio.musics[--RayPy_audio.count];
+            break;
+        }
+    }
+    music->registered = 0;
+    PyThread_release_lock(RayPy_audio.lock);
+}
+
+/* Waits for the music thread to exit, called with the GIL held. Only the
+   caller that stops it waits, stopped is released once per thread. */
+static void
+RayPy_Music_StopThread(void)
+{
+    RayPy_Audio_Lock();
+    int running = RayPy_audio.running;
+    if (running) {
+        RayPy_audio.running = 0;
+        RayPy_audio.stop = 1;
+    }
+    PyThread_release_lock(RayPy_audio.lock);
+    if (!running)
+        return;
+    Py_BEGIN_ALLOW_THREADS
+    PyThread_acquire_lock(RayPy_audio.stopped, WAIT_LOCK);
+    Py_END_ALLOW_THREADS
+    RayPy_Audio_Lock();
+    RayPy_audio.stop = 0;
+    PyThread_release_lock(RayPy_audio.lock);
+}
+
+/* Audio device */
+
+static PyObject *
+RayPy_InitAudioDevice(PyObject *Py_UNUSED(self), PyObject *Py_UNUSED(args))
+{
+    long interp = RayPy_InterpreterId();
+    if (!RAYPY_CAS_LONG(&RayPy_audio_interp, -1, interp) && RAYPY_LOAD_LONG(&RayPy_audio_interp) != interp) {
+        PyErr_SetString(PyExc_RuntimeError, "audio device owned by another interpreter");
+        return NULL;
+    }
+    Py_BEGIN_ALLOW_THREADS
+    PyThread_acquire_lock(RayPy_audio.device, WAIT_LOCK);
+    if (!IsAudioDeviceReady())
+        InitAudioDevice();
+    PyThread_release_lock(RayPy_audio.device);
+    Py_END_ALLOW_THREADS
+    if (!IsAudioDeviceReady()) {
+        RAYPY_STORE_LONG(&RayPy_audio_interp, -1);
+        PyErr_SetString(PyExc_RuntimeError, "failed to initialize the audio device");
+        return NULL;
+    }
+    Py_RETURN_NONE;
+}
+
+PyDoc_STRVAR(init_audio_device_doc, "Initialize audio device and context");
+
+/* Closes the audio device if this interpreter opened it */
+static void
+RayPy_Audio_Release(void)
+{
+    if (RAYPY_LOAD_LONG(&RayPy_audio_interp) != RayPy_InterpreterId())
+        return;
+    RayPy_Music_StopThread();
+    Py_BEGIN_ALLOW_THREADS
+    PyThread_acquire_lock(RayPy_audio.device, WAIT_LOCK);
+    if (IsAudioDeviceReady())
+        CloseAudioDevice();
+    PyThread_release_lock(RayPy_audio.device);
+    Py_END_ALLOW_THREADS
+    RAYPY_STORE_LONG(&RayPy_audio_interp, -1);
+}
+
+static PyObject *
+RayPy_CloseAudioDevice(PyObject *Py_UNUSED(self), PyObject *Py_UNUSED(args))
+{
+    AUDIO_IS_READY();
+    RayPy_Audio_Release();
+    Py_RETURN_NONE;
+}
+
+PyDoc_STRVAR(close_audio_device_doc, "Close the audio device and context, stops the music thread first");
+
+static PyObject *
+RayPy_IsAudioDeviceReady(PyObject *Py_UNUSED(self), PyObject *Py_UNUSED(args))
+{
+    return PyBool_FromLong(IsAudioDeviceReady());
+}
+
+PyDoc_STRVAR(is_audio_device_ready_doc, "Check if audio device has been initialized successfully");
+
+static PyObject *
+RayPy_SetMasterVolume(PyObject *Py_UNUSED(self), PyObject *args)
+{
+    float volume;
+    if (!PyArg_ParseTuple(args, "f", &volume))
+        return NULL;
+    AUDIO_IS_READY();
+    SetMasterVolume(volume);
+    Py_RETURN_NONE;
+}
+
+PyDoc_STRVAR(set_master_volume_doc, "Set master volume (listener), 1.0 is max level");
+
+/* Sound */
+
+static void
+RayPy_Sound_dealloc(RayPy_SoundObject *self)
+{
+    if (self->s.stream.buffer != NULL && IsAudioDeviceReady())
+        UnloadSound(self->s);
+    PyTypeObject *tp = Py_TYPE(self);
+    tp->tp_free((PyObject *)self);
+    Py_DECREF(tp);
+}
+
+static PyMemberDef RayPy_Sound_members[] = {
+    {"frame_count", Py_T_UINT, offsetof(RayPy_SoundObject, s.frameCount), Py_READONLY, "Total number of frames (considering channels)"},
+    {"sample_rate", Py_T_UINT, offsetof(RayPy_SoundObject, s.stream.sampleRate), Py_READONLY, "Frequency (samples per second)"},
+    {"sample_size", Py_T_UINT, offsetof(RayPy_SoundObject, s.stream.sampleSize), Py_READONLY, "Bit depth (bits per sample): 8, 16, 32 (24 not supported)"},
+    {"channels", Py_T_UINT, offsetof(RayPy_SoundObject, s.stream.channels), Py_READONLY, "Number of channels (1-mono, 2-stereo, ...)"},
+    {NULL}
+};
+
+static PyType_Slot RayPy_Sound_slots[] = {
+    {Py_tp_doc, PyDoc_STR("Sound, decoded audio played from memory, made by load_sound()")},
+    {Py_tp_dealloc, RayPy_Sound_dealloc},
+    {Py_tp_members, RayPy_Sound_members},
+    {0, NULL},
+};
+
+static PyType_Spec RayPy_Sound_spec = {
+    .name = "raypy.Sound",
+    .basicsize = sizeof(RayPy_SoundObject),
+    .itemsize = 0,
+    .flags = Py_TPFLAGS_DEFAULT | Py_TPFLAGS_IMMUTABLETYPE | Py_TPFLAGS_DISALLOW_INSTANTIATION,
+    .slots = RayPy_Sound_slots,
+};
+
+static PyObject *
+RayPy_LoadSound(PyObject *Py_UNUSED(self), PyObject *args)
+{
+    const char *fileName;
+    if (!PyArg_ParseTuple(args, "s", &fileName))
+        return NULL;
+    AUDIO_IS_READY();
+    Sound sound;
+    Py_BEGIN_ALLOW_THREADS
+    sound = LoadSound(fileName);
+    Py_END_ALLOW_THREADS
+    if (sound.stream.buffer == NULL)
+        return PyErr_Format(PyExc_OSError, "failed to load sound %R", PyTuple_GET_ITEM(args, 0));
+    RayPy_SoundObject *ret = PyObject_New(RayPy_SoundObject, &RayPy_Sound_Type);
+    if (ret == NULL) {
+        UnloadSound(sound);
+        return NULL;
+    }
+    ret->s = sound;
+    return (PyObject *)ret;
+}
+
+PyDoc_STRVAR(load_sound_doc, "Load sound from file, decoded whole into memory");
+
+static PyObject *
+RayPy_UnloadSound(PyObject *Py_UNUSED(self), PyObject *args)
+{
+    RayPy_SoundObject *sound;
+    if (!PyArg_ParseTuple(args, "O!", &RayPy_Sound_Type, &sound))
+        return NULL;
+    AUDIO_IS_READY();
+    if (sound->s.stream.buffer != NULL)
+        UnloadSound(sound->s);
+    memset(&sound->s, 0, sizeof(sound->s));
+    Py_RETURN_NONE;
+}
+
+PyDoc_STRVAR(unload_sound_doc, "Unload sound, also done when it's garbage collected");
+
+/* sound functions taking only the sound, `arg` is the raylib function */
+static PyObject *
+RayPy_Sound_Call(PyObject *args, void (*func)(Sound))
+{
+    RayPy_SoundObject *sound;
+    if (!PyArg_ParseTuple(args, "O!", &RayPy_Sound_Type, &sound))
+        return NULL;
+    AUDIO_IS_READY();
+    if (sound->s.stream.buffer != NULL)
+        func(sound->s);
+    Py_RETURN_NONE;
+}
+
+static PyObject *
+RayPy_PlaySound(PyObject *Py_UNUSED(self), PyObject *args)
+{
+    return RayPy_Sound_Call(args, PlaySound);
+}
+
+PyDoc_STRVAR(play_sound_doc, "Play a sound");
+
+static PyObject *
+RayPy_StopSound(PyObject *Py_UNUSED(self), PyObject *args)
+{
+    return RayPy_Sound_Call(args, StopSound);
+}
+
+PyDoc_STRVAR(stop_sound_doc, "Stop playing a sound");
+
+static PyObject *
+RayPy_PauseSound(PyObject *Py_UNUSED(self), PyObject *args)
+{
+    return RayPy_Sound_Call(args, PauseSound);
+}
+
+PyDoc_STRVAR(pause_sound_doc, "Pause a sound");
+
+static PyObject *
+RayPy_ResumeSound(PyObject *Py_UNUSED(self), PyObject *args)
+{
+    return RayPy_Sound_Call(args, ResumeSound);
+}
+
+PyDoc_STRVAR(resume_sound_doc, "Resume a paused sound");
+
+static PyObject *
+RayPy_IsSoundPlaying(PyObject *Py_UNUSED(self), PyObject *args)
+{
+    RayPy_SoundObject *sound;
+    if (!PyArg_ParseTuple(args, "O!", &RayPy_Sound_Type, &sound))
+        return NULL;
+    return PyBool_FromLong(sound->s.stream.buffer != NULL && IsAudioDeviceReady() && IsSoundPlaying(sound->s));
+}
+
+PyDoc_STRVAR(is_sound_playing_doc, "Check if a sound is currently playing");
+
+/* sound setters taking a float, `func` is the raylib function */
+static PyObject *
+RayPy_Sound_SetFloat(PyObject *args, void (*func)(Sound, float))
+{
+    RayPy_SoundObject *sound;
+    float value;
+    if (!PyArg_ParseTuple(args, "O!f", &RayPy_Sound_Type, &sound, &value))
+        return NULL;
+    AUDIO_IS_READY();
+    if (sound->s.stream.buffer != NULL)
+        func(sound->s, value);
+    Py_RETURN_NONE;
+}
+
+static PyObject *
+RayPy_SetSoundVolume(PyObject *Py_UNUSED(self), PyObject *args)
+{
+    return RayPy_Sound_SetFloat(args, SetSoundVolume);
+}
+
+PyDoc_STRVAR(set_sound_volume_doc, "Set volume for a sound (1.0 is max level)");
+
+static PyObject *
+RayPy_SetSoundPitch(PyObject *Py_UNUSED(self), PyObject *args)
+{
+    return RayPy_Sound_SetFloat(args, SetSoundPitch);
+}
+
+PyDoc_STRVAR(set_sound_pitch_doc, "Set pitch for a sound (1.0 is base level)");
+
+static PyObject *
+RayPy_SetSoundPan(PyObject *Py_UNUSED(self), PyObject *args)
+{
+    return RayPy_Sound_SetFloat(args, SetSoundPan);
+}
+
+PyDoc_STRVAR(set_sound_pan_doc, "Set pan for a sound (0.5 is center)");
+
+/* Music */
+
+static void
+RayPy_Music_dealloc(RayPy_MusicObject *self)
+{
+    RayPy_Music_Unregister(self);
+    if (self->m.ctxData != NULL && IsAudioDeviceReady())
+        UnloadMusicStream(self->m);
+    PyTypeObject *tp = Py_TYPE(self);
+    tp->tp_free((PyObject *)self);
+    Py_DECREF(tp);
+}
+
+static PyObject *
+RayPy_Music_get_looping(RayPy_MusicObject *self, void *Py_UNUSED(closure))
+{
+    return PyBool_FromLong(self->m.looping);
+}
+
+static int
+RayPy_Music_set_looping(RayPy_MusicObject *self, PyObject *value, void *Py_UNUSED(closure))
+{
+    if (value == NULL) {
+        PyErr_SetString(PyExc_TypeError, "cannot delete looping");
+        return -1;
+    }
+    int looping = PyObject_IsTrue(value);
+    if (looping < 0)
+        return -1;
+    if (self->registered)
+        RayPy_Audio_Lock();
+    self->m.looping = looping;
+    if (self->registered)
+        PyThread_release_lock(RayPy_audio.lock);
+    return 0;
+}
+
+static PyMemberDef RayPy_Music_members[] = {
+    {"frame_count", Py_T_UINT, offsetof(RayPy_MusicObject, m.frameCount), Py_READONLY, "Total number of frames (considering channels)"},
+    {"sample_rate", Py_T_UINT, offsetof(RayPy_MusicObject, m.stream.sampleRate), Py_READONLY, "Frequency (samples per second)"},
+    {"sample_size", Py_T_UINT, offsetof(RayPy_MusicObject, m.stream.sampleSize), Py_READONLY, "Bit depth (bits per sample): 8, 16, 32 (24 not supported)"},
+    {"channels", Py_T_UINT, offsetof(RayPy_MusicObject, m.stream.channels), Py_READONLY, "Number of channels (1-mono, 2-stereo, ...)"},
+    {"ctx_type", Py_T_INT, offsetof(RayPy_MusicObject, m.ctxType), Py_READONLY, "Type of music context (audio filetype)"},
+    {NULL}
+};
+
+static PyGetSetDef RayPy_Music_getset[] = {
+    {"looping", (getter)RayPy_Music_get_looping, (setter)RayPy_Music_set_looping, "Music looping enable", NULL},
+    {NULL}
+};
+
+static PyType_Slot RayPy_Music_slots[] = {
+    {Py_tp_doc, PyDoc_STR("Music, audio stream decoded from its file while playing, made by load_music_stream()")},
+    {Py_tp_dealloc, RayPy_Music_dealloc},
+    {Py_tp_members, RayPy_Music_members},
+    {Py_tp_getset, RayPy_Music_getset},
+    {0, NULL},
+};
+
+static PyType_Spec RayPy_Music_spec = {
+    .name = "raypy.Music",
+    .basicsize = sizeof(RayPy_MusicObject),
+    .itemsize = 0,
+    .flags = Py_TPFLAGS_DEFAULT | Py_TPFLAGS_IMMUTABLETYPE | Py_TPFLAGS_DISALLOW_INSTANTIATION,
+    .slots = RayPy_Music_slots,
+};
+
+static PyObject *
+RayPy_LoadMusicStream(PyObject *Py_UNUSED(self), PyObject *args)
+{
+    const char *fileName;
+    if (!PyArg_ParseTuple(args, "s", &fileName))
+        return NULL;
+    AUDIO_IS_READY();
+    Music music;
+    Py_BEGIN_ALLOW_THREADS
+    music = LoadMusicStream(fileName);
+    Py_END_ALLOW_THREADS
+    if (music.ctxData == NULL)
+        return PyErr_Format(PyExc_OSError, "failed to load music %R", PyTuple_GET_ITEM(args, 0));
+    RayPy_MusicObject *ret = PyObject_New(RayPy_MusicObject, &RayPy_Music_Type);
+    if (ret == NULL) {
+        UnloadMusicStream(music);
+        return NULL;
+    }
+    ret->m = music;
+    ret->registered = 0;
+    if (RayPy_Music_Register(ret) < 0) {
+        Py_DECREF(ret);
+        return NULL;
+    }
+    return (PyObject *)ret;
+}
+
+PyDoc_STRVAR(load_music_stream_doc,
+             "Load music stream from file, decoded a buffer at a time while playing and refilled by the "
+             "music thread");
+
+static PyObject *
+RayPy_UnloadMusicStream(PyObject *Py_UNUSED(self), PyObject *args)
+{
+    RayPy_MusicObject *music;
+    if (!PyArg_ParseTuple(args, "O!", &RayPy_Music_Type, &music))
+        return NULL;
+    AUDIO_IS_READY();
+    RayPy_Music_Unregister(music);
+    if (music->m.ctxData != NULL)
+        UnloadMusicStream(music->m);
+    memset(&music->m, 0, sizeof(music->m));
+    Py_RETURN_NONE;
+}
+
+PyDoc_STRVAR(unload_music_stream_doc, "Unload music stream, also done when it's garbage collected");
+
+/* music functions taking only the music, run under the music thread's lock */
+static PyObject *
+RayPy_Music_Call(PyObject *args, void (*func)(Music))
+{
+    RayPy_MusicObject *music;
+    if (!PyArg_ParseTuple(args, "O!", &RayPy_Music_Type, &music))
+        return NULL;
+    AUDIO_IS_READY();
+    if (music->m.ctxData == NULL)
+        Py_RETURN_NONE;
+    RayPy_Audio_Lock();
+    func(music->m);
+    PyThread_release_lock(RayPy_audio.lock);
+    Py_RETURN_NONE;
+}
+
+static PyObject *
+RayPy_PlayMusicStream(PyObject *Py_UNUSED(self), PyObject *args)
+{
+    return RayPy_Music_Call(args, PlayMusicStream);
+}
+
+PyDoc_STRVAR(play_music_stream_doc, "Start music playing, the music thread keeps it fed");
+
+static PyObject *
+RayPy_IsMusicStreamPlaying(PyObject *Py_UNUSED(self), PyObject *args)
+{
+    RayPy_MusicObject *music;
+    if (!PyArg_ParseTuple(args, "O!", &RayPy_Music_Type, &music))
+        return NULL;
+    return PyBool_FromLong(music->m.ctxData != NULL && IsAudioDeviceReady() && IsMusicStreamPlaying(music->m));
+}
+
+PyDoc_STRVAR(is_music_stream_playing_doc, "Check if music is playing");
+
+static PyObject *
+RayPy_UpdateMusicStream(PyObject *Py_UNUSED(self), PyObject *args)
+{
+    return RayPy_Music_Call(args, UpdateMusicStream);
+}
+
+PyDoc_STRVAR(update_music_stream_doc,
+             "Updates buffers for music streaming, not needed as the music thread does it already");
+
+static PyObject *
+RayPy_StopMusicStream(PyObject *Py_UNUSED(self), PyObject *args)
+{
+    return RayPy_Music_Call(args, StopMusicStream);
+}
+
+PyDoc_STRVAR(stop_music_stream_doc, "Stop music playing");
+
+static PyObject *
+RayPy_PauseMusicStream(PyObject *Py_UNUSED(self), PyObject *args)
+{
+    return RayPy_Music_Call(args, PauseMusicStream);
+}
+
+PyDoc_STRVAR(pause_music_stream_doc, "Pause music playing");
+
+static PyObject *
+RayPy_ResumeMusicStream(PyObject *Py_UNUSED(self), PyObject *args)
+{
+    return RayPy_Music_Call(args, ResumeMusicStream);
+}
+
+PyDoc_STRVAR(resume_music_stream_doc, "Resume playing paused music");
+
+/* music setters taking a float, run under the music thread's lock */
+static PyObject *
+RayPy_Music_SetFloat(PyObject *args, void (*func)(Music, float))
+{
+    RayPy_MusicObject *music;
+    float value;
+    if (!PyArg_ParseTuple(args, "O!f", &RayPy_Music_Type, &music, &value))
+        return NULL;
+    AUDIO_IS_READY();
+    if (music->m.ctxData == NULL)
+        Py_RETURN_NONE;
+    RayPy_Audio_Lock();
+    func(music->m, value);
+    PyThread_release_lock(RayPy_audio.lock);
+    Py_RETURN_NONE;
+}
+
+static PyObject *
+RayPy_SeekMusicStream(PyObject *Py_UNUSED(self), PyObject *args)
+{
+    return RayPy_Music_SetFloat(args, SeekMusicStream);
+}
+
+PyDoc_STRVAR(seek_music_stream_doc, "Seek music to a position (in seconds)");
+
+static PyObject *
+RayPy_SetMusicVolume(PyObject *Py_UNUSED(self), PyObject *args)
+{
+    return RayPy_Music_SetFloat(args, SetMusicVolume);
+}
+
+PyDoc_STRVAR(set_music_volume_doc, "Set volume for music (1.0 is max level)");
+
+static PyObject *
+RayPy_SetMusicPitch(PyObject *Py_UNUSED(self), PyObject *args)
+{
+    return RayPy_Music_SetFloat(args, SetMusicPitch);
+}
+
+PyDoc_STRVAR(set_music_pitch_doc, "Set pitch for a music (1.0 is base level)");
+
+static PyObject *
+RayPy_SetMusicPan(PyObject *Py_UNUSED(self), PyObject *args)
+{
+    return RayPy_Music_SetFloat(args, SetMusicPan);
+}
+
+PyDoc_STRVAR(set_music_pan_doc, "Set pan for a music (0.5 is center)");
+
+static PyObject *
+RayPy_GetMusicTimeLength(PyObject *Py_UNUSED(self), PyObject *args)
+{
+    RayPy_MusicObject *music;
+    if (!PyArg_ParseTuple(args, "O!", &RayPy_Music_Type, &music))
+        return NULL;
+    return PyFloat_FromDouble(music->m.ctxData != NULL ? GetMusicTimeLength(music->m) : 0.0);
+}
+
+PyDoc_STRVAR(get_music_time_length_doc, "Get music time length (in seconds)");
+
+static PyObject *
+RayPy_GetMusicTimePlayed(PyObject *Py_UNUSED(self), PyObject *args)
+{
+    RayPy_MusicObject *music;
+    if (!PyArg_ParseTuple(args, "O!", &RayPy_Music_Type, &music))
+        return NULL;
+    AUDIO_IS_READY();
+    if (music->m.ctxData == NULL)
+        return PyFloat_FromDouble(0.0);
+    RayPy_Audio_Lock();
+    float played = GetMusicTimePlayed(music->m);
+    PyThread_release_lock(RayPy_audio.lock);
+    return PyFloat_FromDouble(played);
+}
+
+PyDoc_STRVAR(get_music_time_played_doc, "Get current music time played (in seconds)");
+
+/* AudioStream */
+
+/* Fills `data` with the next `frames` frames queued on the stream in `slot`,
+   silence past the end of the queue. Called by raylib's mixer thread. */
+static void
+RayPy_AudioStream_Pull(int slot, void *data, unsigned int frames)
+{
+    unsigned char *out = data;
+    PyThread_acquire_lock(RayPy_audio.queue, WAIT_LOCK);
+    RayPy_AudioStreamObject *self = RayPy_audio.streams[slot];
+    if (self == NULL) {
+        PyThread_release_lock(RayPy_audio.queue);
+        return;
+    }
+    Py_ssize_t frame_size = self->frame_size;
+    Py_ssize_t remaining = frames;
+    while (remaining > 0 && self->head < self->count) {
+        RayPy_AudioChunk *chunk = &self->chunks[self->head];
+        Py_ssize_t n = chunk->frames - self->offset;
+        if (n > remaining)
+            n = remaining;
+        memcpy(out, (const unsigned char *)chunk->view.buf + self->offset * frame_size, n * frame_size);
+        out += n * frame_size;
+        remaining -= n;
+        self->offset += n;
+        if (self->offset == chunk->frames) {
+            self->head++;
+            self->offset = 0;
+        }
+    }
+    if (remaining > 0) {
+        /* 8 bit samples are unsigned */
+        memset(out, self->s.sampleSize == 8 ? 0x80 : 0, remaining * frame_size);
+        self->silent_frames += remaining;
+    }
+    PyThread_release_lock(RayPy_audio.queue);
+}
+
+/* AudioCallback has no user data, each slot gets its own function */
+#define RAYPY_AUDIO_STREAM_CALLBACK(i)                                                        \
+    static void RayPy_AudioStream_Callback##i(void *data, unsigned int frames)                \
+    {                                                                                         \
+        RayPy_AudioStream_Pull(i, data, frames);                                              \
+    }
+
+RAYPY_AUDIO_STREAM_CALLBACK(0)
+RAYPY_AUDIO_STREAM_CALLBACK(1)
+RAYPY_AUDIO_STREAM_CALLBACK(2)
+RAYPY_AUDIO_STREAM_CALLBACK(3)
+RAYPY_AUDIO_STREAM_CALLBACK(4)
+RAYPY_AUDIO_STREAM_CALLBACK(5)
+RAYPY_AUDIO_STREAM_CALLBACK(6)
+RAYPY_AUDIO_STREAM_CALLBACK(7)
+RAYPY_AUDIO_STREAM_CALLBACK(8)
+RAYPY_AUDIO_STREAM_CALLBACK(9)
+RAYPY_AUDIO_STREAM_CALLBACK(10)
+RAYPY_AUDIO_STREAM_CALLBACK(11)
+RAYPY_AUDIO_STREAM_CALLBACK(12)
+RAYPY_AUDIO_STREAM_CALLBACK(13)
+RAYPY_AUDIO_STREAM_CALLBACK(14)
+RAYPY_AUDIO_STREAM_CALLBACK(15)
+
+static const AudioCallback RayPy_audio_stream_callbacks[RAYPY_AUDIO_STREAM_SLOTS] = {
+    RayPy_AudioStream_Callback0, RayPy_AudioStream_Callback1, RayPy_AudioStream_Callback2,
+    RayPy_AudioStream_Callback3, RayPy_AudioStream_Callback4, RayPy_AudioStream_Callback5,
+    RayPy_AudioStream_Callback6, RayPy_AudioStream_Callback7, RayPy_AudioStream_Callback8,
+    RayPy_AudioStream_Callback9, RayPy_AudioStream_Callback10, RayPy_AudioStream_Callback11,
+    RayPy_AudioStream_Callback12, RayPy_AudioStream_Callback13, RayPy_AudioStream_Callback14,
+    RayPy_AudioStream_Callback15,
+};
+
+/* Releases the buffers the mixer is done with, needs the GIL */
+static void
+RayPy_AudioStream_ReleasePlayed(RayPy_AudioStreamObject *self)
+{
+    if (self->count == 0)
+        return;
+    PyThread_acquire_lock(RayPy_audio.queue, WAIT_LOCK);
+    Py_ssize_t played = self->head;
+    PyThread_release_lock(RayPy_audio.queue);
+    if (played == 0)
+        return;
+    for (Py_ssize_t i = 0; i < played; i++)
+        PyBuffer_Release(&self->chunks[i].view);
+    PyThread_acquire_lock(RayPy_audio.queue, WAIT_LOCK);
+    memmove(self->chunks, self->chunks + played, (self->count - played) * sizeof(RayPy_AudioChunk));
+    self->count -= played;
+    self->head -= played;
+    PyThread_release_lock(RayPy_audio.queue);
+}
+
+/* Detaches the stream from its callback slot and drops its queue, the
+   mixer must not be reading it anymore (stream unloaded or device closed) */
+static void
+RayPy_AudioStream_ClearQueue(RayPy_AudioStreamObject *self)
+{
+    if (self->slot >= 0) {
+        PyThread_acquire_lock(RayPy_audio.queue, WAIT_LOCK);
+        RayPy_audio.streams[self->slot] = NULL;
+        PyThread_release_lock(RayPy_audio.queue);
+        self->slot = -1;
+    }
+    for (Py_ssize_t i = 0; i < self->count; i++)
+        PyBuffer_Release(&self->chunks[i].view);
+    PyMem_Free(self->chunks);
+    self->chunks = NULL;
+    self->count = self->capacity = self->head = self->offset = 0;
+}
+
+static void
+RayPy_AudioStream_dealloc(RayPy_AudioStreamObject *self)
+{
+    if (self->s.buffer != NULL && IsAudioDeviceReady())
+        UnloadAudioStream(self->s);
+    RayPy_AudioStream_ClearQueue(self);
+    PyTypeObject *tp = Py_TYPE(self);
+    tp->tp_free((PyObject *)self);
+    Py_DECREF(tp);
+}
+
+static PyObject *
+RayPy_AudioStream_get_queued_frames(RayPy_AudioStreamObject *self, void *Py_UNUSED(closure))
+{
+    Py_ssize_t frames = 0;
+    if (self->slot >= 0) {
+        PyThread_acquire_lock(RayPy_audio.queue, WAIT_LOCK);
+        for (Py_ssize_t i = self->head; i < self->count; i++)
+            frames += self->chunks[i].frames;
+        if (self->head < self->count)
+            frames -= self->offset;
+        PyThread_release_lock(RayPy_audio.queue);
+    }
+    return PyLong_FromSsize_t(frames);
+}
+
+static PyObject *
+RayPy_AudioStream_get_silent_frames(RayPy_AudioStreamObject *self, void *Py_UNUSED(closure))
+{
+    long long frames = 0;
+    if (self->slot >= 0) {
+        PyThread_acquire_lock(RayPy_audio.queue, WAIT_LOCK);
+        frames = self->silent_frames;
+        PyThread_release_lock(RayPy_audio.queue);
+    }
+    return PyLong_FromLongLong(frames);
+}
+
+static PyMemberDef RayPy_AudioStream_members[] = {
+    {"sample_rate", Py_T_UINT, offsetof(RayPy_AudioStreamObject, s.sampleRate), Py_READONLY, "Frequency (samples per second)"},
+    {"sample_size", Py_T_UINT, offsetof(RayPy_AudioStreamObject, s.sampleSize), Py_READONLY, "Bit depth (bits per sample): 8, 16, 32 (24 not supported)"},
+    {"channels", Py_T_UINT, offsetof(RayPy_AudioStreamObject, s.channels), Py_READONLY, "Number of channels (1-mono, 2-stereo, ...)"},
+    {NULL}
+};
+
+static PyGetSetDef RayPy_AudioStream_getset[] = {
+    {"queued_frames", (getter)RayPy_AudioStream_get_queued_frames, NULL, "Frames queued with queue_audio_stream() not played yet", NULL},
+    {"silent_frames", (getter)RayPy_AudioStream_get_silent_frames, NULL, "Frames played as silence because the queue ran out", NULL},
+    {NULL}
+};
+
+static PyType_Slot RayPy_AudioStream_slots[] = {
+    {Py_tp_doc, PyDoc_STR("AudioStream, custom audio stream fed with PCM buffers, made by load_audio_stream()")},
+    {Py_tp_dealloc, RayPy_AudioStream_dealloc},
+    {Py_tp_members, RayPy_AudioStream_members},
+    {Py_tp_getset, RayPy_AudioStream_getset},
+    {0, NULL},
+};
+
+static PyType_Spec RayPy_AudioStream_spec = {
+    .name = "raypy.AudioStream",
+    .basicsize = sizeof(RayPy_AudioStreamObject),
+    .itemsize = 0,
+    .flags = Py_TPFLAGS_DEFAULT | Py_TPFLAGS_IMMUTABLETYPE | Py_TPFLAGS_DISALLOW_INSTANTIATION,
+    .slots = RayPy_AudioStream_slots,
+};
+
+/* Gets a C-contiguous buffer of whole frames in the stream's sample format,
+   returns the frame count or -1 with an exception set */
+static Py_ssize_t
+RayPy_AudioStream_GetBuffer(RayPy_AudioStreamObject *stream, PyObject *obj, Py_buffer *view)
+{
+    if (PyObject_GetBuffer(obj, view, PyBUF_C_CONTIGUOUS | PyBUF_FORMAT) < 0)
+        return -1;
+    const char *format = view->format ? view->format : "B";
+    if (*format == '@' || *format == '=' || *format == '<')
+        format++;
+    const char *expected = stream->s.sampleSize == 8 ? "B" : stream->s.sampleSize == 16 ? "h" : "f";
+    int raw = view->itemsize == 1 && (strcmp(format, "B") == 0 || strcmp(format, "b") == 0 || strcmp(format, "c") == 0);
+    if (!raw && strcmp(format, expected) != 0) {
+        PyErr_Format(PyExc_ValueError, "buffer must hold bytes or '%s' samples for %u bit audio, not '%s'",
+                     expected, stream->s.sampleSize, view->format);
+        PyBuffer_Release(view);
+        return -1;
+    }
+    if (view->len % stream->frame_size != 0) {
+        PyErr_Format(PyExc_ValueError, "buffer size must be a multiple of the frame size (%zd bytes)",
+                     stream->frame_size);
+        PyBuffer_Release(view);
+        return -1;
+    }
+    return view->len / stream->frame_size;
+}
+
+static PyObject *
+RayPy_LoadAudioStream(PyObject *Py_UNUSED(self), PyObject *args)
+{
+    unsigned int sampleRate, sampleSize, channels;
+    if (!PyArg_ParseTuple(args, "III", &sampleRate, &sampleSize, &channels))
+        return NULL;
+    AUDIO_IS_READY();
+    if (sampleSize != 8 && sampleSize != 16 && sampleSize != 32)
+        return PyErr_Format(PyExc_ValueError, "sample size must be 8, 16 or 32, not %u", sampleSize);
+    if (channels < 1 || channels > 2)
+        return PyErr_Format(PyExc_ValueError, "channels must be 1 or 2, not %u", channels);
+    AudioStream stream = LoadAudioStream(sampleRate, sampleSize, channels);
+    if (stream.buffer == NULL) {
+        PyErr_SetString(PyExc_RuntimeError, "failed to load audio stream");
+        return NULL;
+    }
+    RayPy_AudioStreamObject *ret = PyObject_New(RayPy_AudioStreamObject, &RayPy_AudioStream_Type);
+    if (ret == NULL) {
+        UnloadAudioStream(stream);
+        return NULL;
+    }
+    ret->s = stream;
+    ret->slot = -1;
+    ret->frame_size = sampleSize / 8 * channels;
+    ret->chunks = NULL;
+    ret->count = ret->capacity = ret->head = ret->offset = 0;
+    ret->silent_frames = 0;
+    return (PyObject *)ret;
+}
+
+PyDoc_STRVAR(load_audio_stream_doc,
+             "Load audio stream (to stream raw audio pcm data), sample size is 8 (uint8), 16 (int16) or 32 (float32)");
+
+static PyObject *
+RayPy_UnloadAudioStream(PyObject *Py_UNUSED(self), PyObject *args)
+{
+    RayPy_AudioStreamObject *stream;
+    if (!PyArg_ParseTuple(args, "O!", &RayPy_AudioStream_Type, &stream))
+        return NULL;
+    AUDIO_IS_READY();
+    if (stream->s.buffer != NULL)
+        UnloadAudioStream(stream->s);
+    RayPy_AudioStream_ClearQueue(stream);
+    memset(&stream->s, 0, sizeof(stream->s));
+    Py_RETURN_NONE;
+}
+
+PyDoc_STRVAR(unload_audio_stream_doc, "Unload audio stream and free memory, also done when it's garbage collected");
+
+static PyObject *
+RayPy_UpdateAudioStream(PyObject *Py_UNUSED(self), PyObject *args)
+{
+    RayPy_AudioStreamObject *stream;
+    PyObject *data;
+    if (!PyArg_ParseTuple(args, "O!O", &RayPy_AudioStream_Type, &stream, &data))
+        return NULL;
+    AUDIO_IS_READY();
+    if (stream->s.buffer == NULL) {
+        PyErr_SetString(PyExc_ValueError, "audio stream is unloaded");
+        return NULL;
+    }
+    if (stream->slot >= 0) {
+        PyErr_SetString(PyExc_RuntimeError, "audio stream is fed by queue_audio_stream()");
+        return NULL;
+    }
+    Py_buffer view;
+    Py_ssize_t frames = RayPy_AudioStream_GetBuffer(stream, data, &view);
+    if (frames < 0)
+        return NULL;
+    if (frames > INT_MAX) {
+        PyBuffer_Release(&view);
+        PyErr_SetString(PyExc_OverflowError, "too many frames");
+        return NULL;
+    }
+    UpdateAudioStream(stream->s, view.buf, (int)frames);
+    PyBuffer_Release(&view);
+    Py_RETURN_NONE;
+}
+
+PyDoc_STRVAR(update_audio_stream_doc,
+             "Update audio stream buffers with data, any C-contiguous buffer in the stream's sample format");
+
+static PyObject *
+RayPy_QueueAudioStream(PyObject *Py_UNUSED(self), PyObject *args)
+{
+    RayPy_AudioStreamObject *stream;
+    PyObject *data;
+    if (!PyArg_ParseTuple(args, "O!O", &RayPy_AudioStream_Type, &stream, &data))
+        return NULL;
+    AUDIO_IS_READY();
+    if (stream->s.buffer == NULL) {
+        PyErr_SetString(PyExc_ValueError, "audio stream is unloaded");
+        return NULL;
+    }
+    RayPy_AudioStream_ReleasePlayed(stream);
+    Py_buffer view;
+    Py_ssize_t frames = RayPy_AudioStream_GetBuffer(stream, data, &view);
+    if (frames < 0)
+        return NULL;
+    if (frames == 0) {
+        PyBuffer_Release(&view);
+        Py_RETURN_NONE;
+    }
+    if (stream->count == stream->capacity) {
+        Py_ssize_t capacity = stream->capacity ? stream->capacity * 2 : 8;
+        PyThread_acquire_lock(RayPy_audio.queue, WAIT_LOCK);
+        RayPy_AudioChunk *chunks = PyMem_Realloc(stream->chunks, capacity * sizeof(RayPy_AudioChunk));
+        if (chunks != NULL) {
+            stream->chunks = chunks;
+            stream->capacity = capacity;
+        }
+        PyThread_release_lock(RayPy_audio.queue);
+        if (chunks == NULL) {
+            PyBuffer_Release(&view);
+            return PyErr_NoMemory();
+        }
+    }
+    if (stream->slot < 0) {
+        int slot = -1;
+        PyThread_acquire_lock(RayPy_audio.queue, WAIT_LOCK);
+        for (int i = 0; i < RAYPY_AUDIO_STREAM_SLOTS && slot < 0; i++)
+            if (RayPy_audio.streams[i] == NULL)
+                slot = i;
+        if (slot >= 0)
+            RayPy_audio.streams[slot] = stream;
+        PyThread_release_lock(RayPy_audio.queue);
+        if (slot < 0) {
+            PyBuffer_Release(&view);
+            return PyErr_Format(PyExc_RuntimeError, "can't queue on more than %d audio streams at once",
+                                RAYPY_AUDIO_STREAM_SLOTS);
+        }
+        stream->slot = slot;
+        SetAudioStreamCallback(stream->s, RayPy_audio_stream_callbacks[slot]);
+    }
+    PyThread_acquire_lock(RayPy_audio.queue, WAIT_LOCK);
+    stream->chunks[stream->count].view = view;
+    stream->chunks[stream->count].frames = frames;
+    stream->count++;
+    PyThread_release_lock(RayPy_audio.queue);
+    Py_RETURN_NONE;
+}
+
+PyDoc_STRVAR(queue_audio_stream_doc,
+             "Queue a buffer to play after the ones already queued, the mixer reads it in place so it "
+             "must not change until played (see queued_frames)");
+
+static PyObject *
+RayPy_IsAudioStreamProcessed(PyObject *Py_UNUSED(self), PyObject *args)
+{
+    RayPy_AudioStreamObject *stream;
+    if (!PyArg_ParseTuple(args, "O!", &RayPy_AudioStream_Type, &stream))
+        return NULL;
+    return PyBool_FromLong(stream->s.buffer != NULL && IsAudioDeviceReady() && IsAudioStreamProcessed(stream->s));
+}
+
+PyDoc_STRVAR(is_audio_stream_processed_doc, "Check if any audio stream buffers requires refill");
+
+/* stream functions taking only the stream */
+static PyObject *
+RayPy_AudioStream_Call(PyObject *args, void (*func)(AudioStream))
+{
+    RayPy_AudioStreamObject *stream;
+    if (!PyArg_ParseTuple(args, "O!", &RayPy_AudioStream_Type, &stream))
+        return NULL;
+    AUDIO_IS_READY();
+    if (stream->s.buffer != NULL)
+        func(stream->s);
+    Py_RETURN_NONE;
+}
+
+static PyObject *
+RayPy_PlayAudioStream(PyObject *Py_UNUSED(self), PyObject *args)
+{
+    return RayPy_AudioStream_Call(args, PlayAudioStream);
+}
+
+PyDoc_STRVAR(play_audio_stream_doc, "Play audio stream");
+
+static PyObject *
+RayPy_PauseAudioStream(PyObject *Py_UNUSED(self), PyObject *args)
+{
+    return RayPy_AudioStream_Call(args, PauseAudioStream);
+}
+
+PyDoc_STRVAR(pause_audio_stream_doc, "Pause audio stream");
+
+static PyObject *
+RayPy_ResumeAudioStream(PyObject *Py_UNUSED(self), PyObject *args)
+{
+    return RayPy_AudioStream_Call(args, ResumeAudioStream);
+}
+
+PyDoc_STRVAR(resume_audio_stream_doc, "Resume audio stream");
+
+static PyObject *
+RayPy_StopAudioStream(PyObject *Py_UNUSED(self), PyObject *args)
+{
+    return RayPy_AudioStream_Call(args, StopAudioStream);
+}
+
+PyDoc_STRVAR(stop_audio_stream_doc, "Stop audio stream, a queue keeps its position");
+
+static PyObject *
+RayPy_IsAudioStreamPlaying(PyObject *Py_UNUSED(self), PyObject *args)
+{
+    RayPy_AudioStreamObject *stream;
+    if (!PyArg_ParseTuple(args, "O!", &RayPy_AudioStream_Type, &stream))
+        return NULL;
+    return PyBool_FromLong(stream->s.buffer != NULL && IsAudioDeviceReady() && IsAudioStreamPlaying(stream->s));
+}
+
+PyDoc_STRVAR(is_audio_stream_playing_doc, "Check if audio stream is playing");
+
+/* stream setters taking a float */
+static PyObject *
+RayPy_AudioStream_SetFloat(PyObject *args, void (*func)(AudioStream, float))
+{
+    RayPy_AudioStreamObject *stream;
+    float value;
+    if (!PyArg_ParseTuple(args, "O!f", &RayPy_AudioStream_Type, &stream, &value))
+        return NULL;
+    AUDIO_IS_READY();
+    if (stream->s.buffer != NULL)
+        func(stream->s, value);
+    Py_RETURN_NONE;
+}
+
+static PyObject *
+RayPy_SetAudioStreamVolume(PyObject *Py_UNUSED(self), PyObject *args)
+{
+    return RayPy_AudioStream_SetFloat(args, SetAudioStreamVolume);
+}
+
+PyDoc_STRVAR(set_audio_stream_volume_doc, "Set volume for audio stream (1.0 is max level)");
+
+static PyObject *
+RayPy_SetAudioStreamPitch(PyObject *Py_UNUSED(self), PyObject *args)
+{
+    return RayPy_AudioStream_SetFloat(args, SetAudioStreamPitch);
+}
+
+PyDoc_STRVAR(set_audio_stream_pitch_doc, "Set pitch for audio stream (1.0 is base level)");
+
+static PyObject *
+RayPy_SetAudioStreamPan(PyObject *Py_UNUSED(self), PyObject *args)
+{
+    return RayPy_AudioStream_SetFloat(args, SetAudioStreamPan);
+}
+
+PyDoc_STRVAR(set_audio_stream_pan_doc, "Set pan for audio stream (0.5 is centered)");
+
+static PyObject *
+RayPy_SetAudioStreamBufferSizeDefault(PyObject *Py_UNUSED(self), PyObject *args)
+{
+    int size;
+    if (!PyArg_ParseTuple(args, "i", &size))
+        return NULL;
+    if (size < 0)
+        return PyErr_Format(PyExc_ValueError, "size must be >= 0, not %d", size);
+    SetAudioStreamBufferSizeDefault(size);
+    Py_RETURN_NONE;
+}
+
+PyDoc_STRVAR(set_audio_stream_buffer_size_default_doc,
+             "Default size in frames for new audio streams' buffers, 0 lets raylib pick");
+
+/* Wave and PCM kernels
+
+   Mixing, resampling and sample format conversion over interleaved PCM,
+   for raypy.audio and wave_format(). Samples are converted to float
+   blocks, processed 4 at a time and converted back saturating, int16
+   samples map [-32768, 32767] to [-1.0, 1.0). All of it runs without the
+   GIL. */
+
+#define RAYPY_PCM_BLOCK 1024      // frames converted to float at a time
+#define RAYPY_PCM_MAX_CHANNELS 8
+
+#ifdef RAYPY_SSE2
+static inline RayPy_Vec4 RayPy_Vec4_Set(float a, float b, float c, float d) { return _mm_setr_ps(a, b, c, d); }
+
+static inline RayPy_Vec4
+RayPy_Vec4_LoadS16(const int16_t *p)
+{
+    __m128i x = _mm_loadl_epi64((const __m128i *)p);
+    return _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(x, x), 16));
+}
+
+static inline void
+RayPy_Vec4_StoreS16(int16_t *p, RayPy_Vec4 v)
+{
+    v = _mm_min_ps(_mm_max_ps(v, _mm_set1_ps(-32768.0f)), _mm_set1_ps(32767.0f));
+    __m128i x = _mm_cvtps_epi32(v);
+    _mm_storel_epi64((__m128i *)p, _mm_packs_epi32(x, x));
+}
+#else
+static inline RayPy_Vec4
+RayPy_Vec4_Set(float a, float b, float c, float d)
+{
+    RayPy_Vec4 r = {{a, b, c, d}};
+    return r;
+}
+
+static inline RayPy_Vec4
+RayPy_Vec4_LoadS16(const int16_t *p)
+{
+    RayPy_Vec4 r = {{p[0], p[1], p[2], p[3]}};
+    return r;
+}
+
+static inline void
+RayPy_Vec4_StoreS16(int16_t *p, RayPy_Vec4 v)
+{
+    for (int i = 0; i < 4; i++) {
+        float f = v.v[i];
+        p[i] = f <= -32768.0f ? -32768 : f >= 32767.0f ? 32767 : (int16_t)lrintf(f);
+    }
+}
+#endif
+
+static inline int16_t
+RayPy_Pcm_ToS16(float f)
+{
+    f *= 32768.0f;
+    return f <= -32768.0f ? -32768 : f >= 32767.0f ? 32767 : (int16_t)lrintf(f);
+}
+
+/* n samples of `sample_size` bits to float times `scale` */
+static void
+RayPy_Pcm_ToFloat(const void *src, int sample_size, Py_ssize_t n, float scale, float *out)
+{
+    Py_ssize_t i = 0;
+    if (sample_size == 16) {
+        const int16_t *s = src;
+        RayPy_Vec4 k = RayPy_Vec4_Set1(scale / 32768.0f);
+        for (; i + 4 <= n; i += 4)
+            RayPy_Vec4_StoreF(out + i, RayPy_Vec4_Mul(RayPy_Vec4_LoadS16(s + i), k));
+        for (; i < n; i++)
+            out[i] = s[i] * (scale / 32768.0f);
+    }
+    else if (sample_size == 32) {
+        const float *s = src;
+        RayPy_Vec4 k = RayPy_Vec4_Set1(scale);
+        for (; i + 4 <= n; i += 4)
+            RayPy_Vec4_StoreF(out + i, RayPy_Vec4_Mul(RayPy_Vec4_LoadF(s + i), k));
+        for (; i < n; i++)
+            out[i] = s[i] * scale;
+    }
+    else {
+        /* 8 bit samples are unsigned */
+        const unsigned char *s = src;
+        for (; i < n; i++)
+            out[i] = (s[i] - 128) * (scale / 128.0f);
+    }
+}
+
+/* n float samples to `sample_size` bits, saturating */
+static void
+RayPy_Pcm_FromFloat(const float *src, Py_ssize_t n, int sample_size, void *out)
+{
+    Py_ssize_t i = 0;
+    if (sample_size == 16) {
+        int16_t *d = out;
+        RayPy_Vec4 k = RayPy_Vec4_Set1(32768.0f);
+        for (; i + 4 <= n; i += 4)
+            RayPy_Vec4_StoreS16(d + i, RayPy_Vec4_Mul(RayPy_Vec4_LoadF(src + i), k));
+        for (; i < n; i++)
+            d[i] = RayPy_Pcm_ToS16(src[i]);
+    }
+    else if (sample_size == 32) {
+        memcpy(out, src, n * sizeof(float));
+    }
+    else {
+        unsigned char *d = out;
+        for (; i < n; i++) {
+            float f = src[i] * 128.0f + 128.0f;
+            d[i] = f <= 0.0f ? 0 : f >= 255.0f ? 255 : (unsigned char)lrintf(f);
+        }
+    }
+}
+
+/* adds n float samples to int16 or float32 ones, int16 saturating */
+static void
+RayPy_Pcm_AddFloat(void *dst, int sample_size, Py_ssize_t n, const float *in)
+{
+    Py_ssize_t i = 0;
+    if (sample_size == 16) {
+        int16_t *d = dst;
+        RayPy_Vec4 k = RayPy_Vec4_Set1(32768.0f);
+        for (; i + 4 <= n; i += 4) {
+            RayPy_Vec4 v = RayPy_Vec4_Add(RayPy_Vec4_LoadS16(d + i), RayPy_Vec4_Mul(RayPy_Vec4_LoadF(in + i), k));
+            RayPy_Vec4_StoreS16(d + i, v);
+        }
+        for (; i < n; i++)
+            d[i] = RayPy_Pcm_ToS16(d[i] / 32768.0f + in[i]);
+    }
+    else {
+        float *d = dst;
+        for (; i + 4 <= n; i += 4)
+            RayPy_Vec4_StoreF(d + i, RayPy_Vec4_Add(RayPy_Vec4_LoadF(d + i), RayPy_Vec4_LoadF(in + i)));
+        for (; i < n; i++)
+            d[i] += in[i];
+    }
+}
+
+/* Changes the channel count of float frames: down to mono averages,
+   up from mono copies, otherwise channels are kept or dropped and new
+   ones are silent. `in` and `out` don't overlap. */
+static void
+RayPy_Pcm_Remix(const float *in, int in_channels, float *out, int out_channels, Py_ssize_t frames)
+{
+    for (Py_ssize_t f = 0; f < frames; f++) {
+        const float *s = in + f * in_channels;
+        float *d = out + f * out_channels;
+        if (out_channels == 1) {
+            float sum = 0.0f;
+            for (int c = 0; c < in_channels; c++)
+                sum += s[c];
+            d[0] = sum / in_channels;
+        }
+        else if (in_channels == 1) {
+            for (int c = 0; c < out_channels; c++)
+                d[c] = s[0];
+        }
+        else {
+            for (int c = 0; c < out_channels; c++)
+                d[c] = c < in_channels ? s[c] : 0.0f;
+        }
+    }
+}
+
+/* Resampled length, frames * to_rate / from_rate rounded down */
+static Py_ssize_t
+RayPy_Pcm_ResampledFrames(Py_ssize_t frames, unsigned int from_rate, unsigned int to_rate)
+{
+    return (Py_ssize_t)((unsigned long long)frames * to_rate / from_rate);
+}
+
+/* Linear interpolation of float frames at `from_rate` to `out_frames`
+   frames at `to_rate`, positions in 32.32 fixed point so long buffers
+   don't drift. Outputs 4 frames at a time per channel. */
+static void
+RayPy_Pcm_Resample(const float *in, Py_ssize_t frames, int channels, unsigned int from_rate,
+                   unsigned int to_rate, float *out, Py_ssize_t out_frames)
+{
+    uint64_t step = ((uint64_t)from_rate << 32) / to_rate;
+    Py_ssize_t last = frames - 1;
+    Py_ssize_t i = 0;
+    for (; i + 4 <= out_frames; i += 4) {
+        Py_ssize_t index[4];
+        float frac[4];
+        for (int k = 0; k < 4; k++) {
+            uint64_t pos = (uint64_t)(i + k) * step;
+            index[k] = (Py_ssize_t)(pos >> 32);
+            frac[k] = (float)(pos & 0xFFFFFFFFu) * (1.0f / 4294967296.0f);
+        }
+        RayPy_Vec4 t = RayPy_Vec4_Set(frac[0], frac[1], frac[2], frac[3]);
+        for (int c = 0; c < channels; c++) {
+            float a[4], b[4], r[4];
+            for (int k = 0; k < 4; k++) {
+                Py_ssize_t next = index[k] < last ? index[k] + 1 : last;
+                a[k] = in[index[k] * channels + c];
+                b[k] = in[next * channels + c];
+            }
+            RayPy_Vec4 va = RayPy_Vec4_LoadF(a);
+            RayPy_Vec4_StoreF(r, RayPy_Vec4_Add(va, RayPy_Vec4_Mul(RayPy_Vec4_Sub(RayPy_Vec4_LoadF(b), va), t)));
+            for (int k = 0; k < 4; k++)
+                out[(i + k) * channels + c] = r[k];
+        }
+    }
+    for (; i < out_frames; i++) {
+        uint64_t pos = (uint64_t)i * step;
+        Py_ssize_t index = (Py_ssize_t)(pos >> 32);
+        Py_ssize_t next = index < last ? index + 1 : last;
+        float t = (float)(pos & 0xFFFFFFFFu) * (1.0f / 4294967296.0f);
+        for (int c = 0; c < channels; c++) {
+            float a = in[index * channels + c];
+            out[i * channels + c] = a + (in[next * channels + c] - a) * t;
+        }
+    }
+}
+
+/* Converts interleaved samples between sample sizes, channel counts and
+   rates into `out`, allocated with RL_MALLOC. Returns the frames written,
+   -1 when out of memory. */
+static Py_ssize_t
+RayPy_Pcm_Convert(const void *in, Py_ssize_t frames, int sample_size, int channels, unsigned int rate,
+                  int to_sample_size, int to_channels, unsigned int to_rate, void **out)
+{
+    Py_ssize_t out_frames = rate == to_rate ? frames : RayPy_Pcm_ResampledFrames(frames, rate, to_rate);
+    float *samples = PyMem_RawMalloc(((size_t)frames * channels + 1) * sizeof(float));
+    float *remixed = channels != to_channels ? PyMem_RawMalloc(((size_t)frames * to_channels + 1) * sizeof(float)) : NULL;
+    float *resampled = rate != to_rate ? PyMem_RawMalloc(((size_t)out_frames * to_channels + 1) * sizeof(float)) : NULL;
+    *out = RL_MALLOC((size_t)out_frames * to_channels * (to_sample_size / 8) + 1);
+    if (samples == NULL || (channels != to_channels && remixed == NULL)
+        || (rate != to_rate && resampled == NULL) || *out == NULL) {
+        PyMem_RawFree(samples);
+        PyMem_RawFree(remixed);
+        PyMem_RawFree(resampled);
+        RL_FREE(*out);
+        *out = NULL;
+        return -1;
+    }
+    const float *data = samples;
+    RayPy_Pcm_ToFloat(in, sample_size, frames * channels, 1.0f, samples);
+    if (remixed != NULL) {
+        RayPy_Pcm_Remix(data, channels, remixed, to_channels, frames);
+        data = remixed;
+    }
+    if (resampled != NULL && frames > 0) {
+        RayPy_Pcm_Resample(data, frames, to_channels, rate, to_rate, resampled, out_frames);
+        data = resampled;
+    }
+    RayPy_Pcm_FromFloat(data, out_frames * to_channels, to_sample_size, *out);
+    PyMem_RawFree(samples);
+    PyMem_RawFree(remixed);
+    PyMem_RawFree(resampled);
+    return out_frames;
+}
+
+/* Mixes src into dst, gain and a left-right balance: 0.0 left, 0.5 both
+   at full level, 1.0 right. Mono into stereo is panned, stereo into mono
+   averaged. */
+static void
+RayPy_Pcm_Mix(void *dst, int dst_size, int dst_channels, const void *src, int src_size, int src_channels,
+              Py_ssize_t frames, float gain, float pan)
+{
+    float left = gain * (pan < 0.5f ? 1.0f : 2.0f * (1.0f - pan));
+    float right = gain * (pan > 0.5f ? 1.0f : 2.0f * pan);
+    float block[RAYPY_PCM_BLOCK * 2];
+    float panned[RAYPY_PCM_BLOCK * 2];
+    for (Py_ssize_t first = 0; first < frames; first += RAYPY_PCM_BLOCK) {
+        Py_ssize_t n = frames - first < RAYPY_PCM_BLOCK ? frames - first : RAYPY_PCM_BLOCK;
+        const unsigned char *s = (const unsigned char *)src + first * src_channels * (src_size / 8);
+        unsigned char *d = (unsigned char *)dst + first * dst_channels * (dst_size / 8);
+        const float *mixed = block;
+        if (src_channels == dst_channels) {
+            if (dst_channels == 1 || left == right) {
+                RayPy_Pcm_ToFloat(s, src_size, n * src_channels, dst_channels == 1 ? gain : left, block);
+            }
+            else {
+                /* frames start on even samples, lanes are left, right, left, right */
+                RayPy_Pcm_ToFloat(s, src_size, n * 2, 1.0f, block);
+                RayPy_Vec4 k = RayPy_Vec4_Set(left, right, left, right);
+                Py_ssize_t i = 0;
+                for (; i + 4 <= n * 2; i += 4)
+                    RayPy_Vec4_StoreF(block + i, RayPy_Vec4_Mul(RayPy_Vec4_LoadF(block + i), k));
+                for (; i < n * 2; i++)
+                    block[i] *= i & 1 ? right : left;
+            }
+        }
+        else if (src_channels == 1) {
+            RayPy_Pcm_ToFloat(s, src_size, n, 1.0f, block);
+            for (Py_ssize_t i = 0; i < n; i++) {
+                panned[2 * i] = block[i] * left;
+                panned[2 * i + 1] = block[i] * right;
+            }
+            mixed = panned;
+        }
+        else {
+            RayPy_Pcm_ToFloat(s, src_size, n * 2, 0.5f * gain, block);
+            for (Py_ssize_t i = 0; i < n; i++)
+                panned[i] = block[2 * i] + block[2 * i + 1];
+            mixed = panned;
+        }
+        RayPy_Pcm_AddFloat(d, dst_size, n * dst_channels, mixed);
+    }
+}
+
+/* Interleaved int16 or float32 samples from a buffer, 1-D for mono or
+   (frames, channels) */
+typedef struct {
+    Py_buffer view;
+    int sample_size;
+    int channels;
+    Py_ssize_t frames;
+} RayPy_Pcm;
+
+static int
+RayPy_Pcm_Get(PyObject *obj, RayPy_Pcm *pcm, int writable, const char *name)
+{
+    if (PyObject_GetBuffer(obj, &pcm->view, PyBUF_C_CONTIGUOUS | PyBUF_FORMAT | (writable ? PyBUF_WRITABLE : 0)) < 0)
+        return -1;
+    const char *format = pcm->view.format ? pcm->view.format : "B";
+    if (*format == '@' || *format == '=' || *format == '<')
+        format++;
+    pcm->sample_size = strcmp(format, "h") == 0 ? 16 : strcmp(format, "f") == 0 ? 32 : 0;
+    if (pcm->sample_size == 0) {
+        PyErr_Format(PyExc_ValueError, "%s must hold int16 or float32 samples, not '%s'", name, pcm->view.format);
+        goto error;
+    }
+    if (pcm->view.ndim > 2 || pcm->view.ndim < 1) {
+        PyErr_Format(PyExc_ValueError, "%s must have 1 (mono) or 2 (frames, channels) dimensions, not %d",
+                     name, pcm->view.ndim);
+        goto error;
+    }
+    pcm->channels = pcm->view.ndim == 2 ? (int)Py_MIN(pcm->view.shape[1], INT_MAX) : 1;
+    if (pcm->channels < 1 || pcm->channels > RAYPY_PCM_MAX_CHANNELS) {
+        PyErr_Format(PyExc_ValueError, "%s must have 1 to %d channels, not %zd", name, RAYPY_PCM_MAX_CHANNELS,
+                     pcm->view.shape[1]);
+        goto error;
+    }
+    pcm->frames = pcm->view.len / (pcm->sample_size / 8) / pcm->channels;
+    return 0;
+error:
+    PyBuffer_Release(&pcm->view);
+    return -1;
+}
+
+/* Results of raypy.audio, int16 or float32 memoryviews shaped like the input */
+typedef struct {
+    PyObject_HEAD void *data;
+    int sample_size;
+    int ndim;
+    Py_ssize_t shape[2];
+    Py_ssize_t strides[2];
+} RayPy_PcmBufferObject;
+
+static void
+RayPy_PcmBuffer_dealloc(RayPy_PcmBufferObject *self)
+{
+    RL_FREE(self->data);
+    PyTypeObject *tp = Py_TYPE(self);
+    tp->tp_free((PyObject *)self);
+    Py_DECREF(tp);
+}
+
+static int
+RayPy_PcmBuffer_getbuffer(RayPy_PcmBufferObject *self, Py_buffer *view, int flags)
+{
+    if (PyBuffer_FillInfo(view, (PyObject *)self, self->data, self->shape[0] * self->strides[0], 0, flags))
+        return -1;
+    view->itemsize = self->sample_size / 8;
+    if (flags & PyBUF_FORMAT)
+        view->format = self->sample_size == 16 ? "h" : "f";
+    if (flags & PyBUF_ND) {
+        view->ndim = self->ndim;
+        view->shape = self->shape;
+        if ((flags & PyBUF_STRIDES) == PyBUF_STRIDES)
+            view->strides = self->ndim == 2 ? self->strides : self->strides + 1;
+    }
+    return 0;
+}
+
+static PyType_Slot RayPy_PcmBuffer_slots[] = {
+    {Py_tp_dealloc, RayPy_PcmBuffer_dealloc},
+    {Py_bf_getbuffer, RayPy_PcmBuffer_getbuffer},
+    {0, NULL},
+};
+
+static PyType_Spec RayPy_PcmBuffer_spec = {
+    .name = "raypy._PcmBuffer",
+    .basicsize = sizeof(RayPy_PcmBufferObject),
+    .itemsize = 0,
+    .flags = Py_TPFLAGS_DEFAULT | Py_TPFLAGS_IMMUTABLETYPE | Py_TPFLAGS_DISALLOW_INSTANTIATION,
+    .slots = RayPy_PcmBuffer_slots,
+};
+
+/* Steals `data` (RL_MALLOC'd) */
+static PyObject *
+RayPy_PcmBuffer_ToMemoryview(void *data, Py_ssize_t frames, int sample_size, int channels, int ndim)
+{
+    RayPy_PcmBufferObject *buffer = PyObject_New(RayPy_PcmBufferObject, &RayPy_PcmBuffer_Type);
+    if (buffer == NULL) {
+        RL_FREE(data);
+        return NULL;
+    }
+    buffer->data = data;
+    buffer->sample_size = sample_size;
+    buffer->ndim = ndim;
+    buffer->shape[0] = ndim == 2 ? frames : frames * channels;
+    buffer->shape[1] = channels;
+    buffer->strides[0] = (ndim == 2 ? channels : 1) * (sample_size / 8);
+    buffer->strides[1] = sample_size / 8;
+    PyObject *ret = PyMemoryView_FromObject((PyObject *)buffer);
+    Py_DECREF(buffer);
+    return ret;
+}
+
+static PyObject *
+RayPy_AudioMix(PyObject *Py_UNUSED(self), PyObject *args)
+{
+    PyObject *dst_obj, *src_obj;
+    float gain = 1.0f, pan = 0.5f;
+    if (!PyArg_ParseTuple(args, "OO|ff", &dst_obj, &src_obj, &gain, &pan))
+        return NULL;
+    if (!(pan >= 0.0f && pan <= 1.0f))
+        return PyErr_Format(PyExc_ValueError, "pan must be in [0.0, 1.0], not %R", PyTuple_GET_ITEM(args, 3));
+    RayPy_Pcm dst, src;
+    if (RayPy_Pcm_Get(dst_obj, &dst, 1, "dst") < 0)
+        return NULL;
+    if (RayPy_Pcm_Get(src_obj, &src, 0, "src") < 0) {
+        PyBuffer_Release(&dst.view);
+        return NULL;
+    }
+    if (dst.channels > 2 || src.channels > 2) {
+        PyBuffer_Release(&src.view);
+        PyBuffer_Release(&dst.view);
+        PyErr_SetString(PyExc_ValueError, "mix() takes mono or stereo buffers");
+        return NULL;
+    }
+    Py_ssize_t frames = Py_MIN(dst.frames, src.frames);
+    Py_BEGIN_ALLOW_THREADS
+    RayPy_Pcm_Mix(dst.view.buf, dst.sample_size, dst.channels, src.view.buf, src.sample_size, src.channels,
+                  frames, gain, pan);
+    Py_END_ALLOW_THREADS
+    PyBuffer_Release(&src.view);
+    PyBuffer_Release(&dst.view);
+    return PyLong_FromSsize_t(frames);
+}
+
+PyDoc_STRVAR(_audio_mix_doc, "raypy.audio.mix() implementation");
+
+static PyObject *
+RayPy_AudioResample(PyObject *Py_UNUSED(self), PyObject *args)
+{
+    PyObject *src_obj;
+    unsigned int from_rate, to_rate;
+    if (!PyArg_ParseTuple(args, "OII", &src_obj, &from_rate, &to_rate))
+        return NULL;
+    if (from_rate == 0 || to_rate == 0)
+        return PyErr_Format(PyExc_ValueError, "sample rates must be > 0");
+    RayPy_Pcm src;
+    if (RayPy_Pcm_Get(src_obj, &src, 0, "src") < 0)
+        return NULL;
+    void *out;
+    Py_ssize_t frames;
+    Py_BEGIN_ALLOW_THREADS
+    frames = RayPy_Pcm_Convert(src.view.buf, src.frames, src.sample_size, src.channels, from_rate,
+                               src.sample_size, src.channels, to_rate, &out);
+    Py_END_ALLOW_THREADS
+    int sample_size = src.sample_size, channels = src.channels, ndim = src.view.ndim;
+    PyBuffer_Release(&src.view);
+    if (frames < 0)
+        return PyErr_NoMemory();
+    return RayPy_PcmBuffer_ToMemoryview(out, frames, sample_size, channels, ndim);
+}
+
+PyDoc_STRVAR(_audio_resample_doc, "raypy.audio.resample() implementation");
+
+static PyObject *
+RayPy_AudioConvert(PyObject *Py_UNUSED(self), PyObject *args)
+{
+    PyObject *src_obj;
+    int sample_size;
+    if (!PyArg_ParseTuple(args, "Oi", &src_obj, &sample_size))
+        return NULL;
+    if (sample_size != 16 && sample_size != 32)
+        return PyErr_Format(PyExc_ValueError, "sample size must be 16 or 32, not %d", sample_size);
+    RayPy_Pcm src;
+    if (RayPy_Pcm_Get(src_obj, &src, 0, "src") < 0)
+        return NULL;
+    Py_ssize_t count = src.frames * src.channels;
+    void *out = RL_MALLOC((size_t)count * (sample_size / 8) + 1);
+    float *block = PyMem_Malloc(RAYPY_PCM_BLOCK * sizeof(float));
+    if (out == NULL || block == NULL) {
+        RL_FREE(out);
+        PyMem_Free(block);
+        PyBuffer_Release(&src.view);
+        return PyErr_NoMemory();
+    }
+    Py_BEGIN_ALLOW_THREADS
+    for (Py_ssize_t first = 0; first < count; first += RAYPY_PCM_BLOCK) {
+        Py_ssize_t n = Py_MIN(count - first, RAYPY_PCM_BLOCK);
+        RayPy_Pcm_ToFloat((const char *)src.view.buf + first * (src.sample_size / 8), src.sample_size, n, 1.0f,
+                          block);
+        RayPy_Pcm_FromFloat(block, n, sample_size, (char *)out + first * (sample_size / 8));
+    }
+    Py_END_ALLOW_THREADS
+    PyMem_Free(block);
+    Py_ssize_t frames = src.frames;
+    int channels = src.channels, ndim = src.view.ndim;
+    PyBuffer_Release(&src.view);
+    return RayPy_PcmBuffer_ToMemoryview(out, frames, sample_size, channels, ndim);
+}
+
+PyDoc_STRVAR(_audio_convert_doc, "raypy.audio.convert() implementation");
+
+/* Wave */
+
+
+typedef struct {
+    PyObject_HEAD Wave w;
+    Py_ssize_t exports; // buffers handed out, the samples can't be replaced meanwhile
+} RayPy_WaveObject;
+
+static void
+RayPy_Wave_dealloc(RayPy_WaveObject *self)
+{
+    UnloadWave(self->w);
+    PyTypeObject *tp = Py_TYPE(self);
+    tp->tp_free((PyObject *)self);
+    Py_DECREF(tp);
+}
+
+static PyObject *
+RayPy_Wave_FromWave(Wave wave)
+{
+    RayPy_WaveObject *ret = PyObject_New(RayPy_WaveObject, &RayPy_Wave_Type);
+    if (ret == NULL) {
+        UnloadWave(wave);
+        return NULL;
+    }
+    ret->w = wave;
+    ret->exports = 0;
+    return (PyObject *)ret;
+}
+
+static int
+RayPy_Wave_getbuffer(RayPy_WaveObject *self, Py_buffer *view, int flags)
+{
+    if (self->w.data == NULL) {
+        PyErr_SetString(PyExc_ValueError, "wave is unloaded");
+        return -1;
+    }
+    Py_ssize_t itemsize = self->w.sampleSize / 8;
+    if (PyBuffer_FillInfo(view, (PyObject *)self, self->w.data,
+                          (Py_ssize_t)self->w.frameCount * self->w.channels * itemsize, 0, flags))
+        return -1;
+    view->itemsize = itemsize;
+    if (flags & PyBUF_FORMAT)
+        view->format = itemsize == 1 ? "B" : itemsize == 2 ? "h" : "f";
+    if (flags & PyBUF_ND) {
+        /* frames of samples, shape (frame_count, channels) then strides */
+        Py_ssize_t *shape = PyMem_Malloc(4 * sizeof(Py_ssize_t));
+        if (shape == NULL) {
+            PyBuffer_Release(view);
+            PyErr_NoMemory();
+            return -1;
+        }
+        shape[0] = self->w.frameCount;
+        shape[1] = self->w.channels;
+        shape[2] = self->w.channels * itemsize;
+        shape[3] = itemsize;
+        view->ndim = 2;
+        view->shape = shape;
+        if ((flags & PyBUF_STRIDES) == PyBUF_STRIDES)
+            view->strides = shape + 2;
+        view->internal = shape;
+    }
+    self->exports++;
+    return 0;
+}
+
+static void
+RayPy_Wave_releasebuffer(RayPy_WaveObject *self, Py_buffer *view)
+{
+    PyMem_Free(view->internal);
+    self->exports--;
+}
+
+static PyMemberDef RayPy_Wave_members[] = {
+    {"frame_count", Py_T_UINT, offsetof(RayPy_WaveObject, w.frameCount), Py_READONLY, "Total number of frames (considering channels)"},
+    {"sample_rate", Py_T_UINT, offsetof(RayPy_WaveObject, w.sampleRate), Py_READONLY, "Frequency (samples per second)"},
+    {"sample_size", Py_T_UINT, offsetof(RayPy_WaveObject, w.sampleSize), Py_READONLY, "Bit depth (bits per sample): 8, 16, 32 (24 not supported)"},
+    {"channels", Py_T_UINT, offsetof(RayPy_WaveObject, w.channels), Py_READONLY, "Number of channels (1-mono, 2-stereo, ...)"},
+    {NULL}
+};
+
+static PyType_Slot RayPy_Wave_slots[] = {
+    {Py_tp_doc, PyDoc_STR("Wave, audio wave data, a buffer of shape (frame_count, channels)")},
+    {Py_tp_dealloc, RayPy_Wave_dealloc},
+    {Py_tp_members, RayPy_Wave_members},
+    {Py_bf_getbuffer, RayPy_Wave_getbuffer},
+    {Py_bf_releasebuffer, RayPy_Wave_releasebuffer},
+    {0, NULL},
+};
+
+static PyType_Spec RayPy_Wave_spec = {
+    .name = "raypy.Wave",
+    .basicsize = sizeof(RayPy_WaveObject),
+    .itemsize = 0,
+    .flags = Py_TPFLAGS_DEFAULT | Py_TPFLAGS_IMMUTABLETYPE | Py_TPFLAGS_DISALLOW_INSTANTIATION,
+    .slots = RayPy_Wave_slots,
+};
+
+static PyObject *
+RayPy_LoadWave(PyObject *Py_UNUSED(self), PyObject *args)
+{
+    const char *fileName;
+    if (!PyArg_ParseTuple(args, "s", &fileName))
+        return NULL;
+    Wave wave;
+    Py_BEGIN_ALLOW_THREADS
+    wave = LoadWave(fileName);
+    Py_END_ALLOW_THREADS
+    if (wave.data == NULL)
+        return PyErr_Format(PyExc_OSError, "failed to load wave %R", PyTuple_GET_ITEM(args, 0));
+    return RayPy_Wave_FromWave(wave);
+}
+
+PyDoc_STRVAR(load_wave_doc, "Load wave data from file");
+
+static PyObject *
+RayPy_LoadWaveFromMemory(PyObject *Py_UNUSED(self), PyObject *args)
+{
+    const char *fileType;
+    Py_buffer data;
+    if (!PyArg_ParseTuple(args, "sy*", &fileType, &data))
+        return NULL;
+    if (data.len > INT_MAX) {
+        PyBuffer_Release(&data);
+        PyErr_SetString(PyExc_OverflowError, "data is too large");
+        return NULL;
+    }
+    Wave wave;
+    Py_BEGIN_ALLOW_THREADS
+    wave = LoadWaveFromMemory(fileType, data.buf, (int)data.len);
+    Py_END_ALLOW_THREADS
+    PyBuffer_Release(&data);
+    if (wave.data == NULL) {
+        PyErr_SetString(PyExc_ValueError, "failed to load wave from memory");
+        return NULL;
+    }
+    return RayPy_Wave_FromWave(wave);
+}
+
+PyDoc_STRVAR(load_wave_from_memory_doc, "Load wave from memory buffer, fileType refers to extension: i.e. '.wav'");
+
+static PyObject *
+RayPy_UnloadWave(PyObject *Py_UNUSED(self), PyObject *args)
+{
+    RayPy_WaveObject *wave;
+    if (!PyArg_ParseTuple(args, "O!", &RayPy_Wave_Type, &wave))
+        return NULL;
+    if (wave->exports > 0) {
+        PyErr_SetString(PyExc_BufferError, "wave samples are in use by a memoryview");
+        return NULL;
+    }
+    UnloadWave(wave->w);
+    memset(&wave->w, 0, sizeof(wave->w));
+    Py_RETURN_NONE;
+}
+
+PyDoc_STRVAR(unload_wave_doc, "Unload wave data, also done when it's garbage collected");
+
+static PyObject *
+RayPy_WaveCopy(PyObject *Py_UNUSED(self), PyObject *args)
+{
+    RayPy_WaveObject *wave;
+    if (!PyArg_ParseTuple(args, "O!", &RayPy_Wave_Type, &wave))
+        return NULL;
+    if (wave->w.data == NULL) {
+        PyErr_SetString(PyExc_ValueError, "wave is unloaded");
+        return NULL;
+    }
+    Wave copy = WaveCopy(wave->w);
+    if (copy.data == NULL)
+        return PyErr_NoMemory();
+    return RayPy_Wave_FromWave(copy);
+}
+
+PyDoc_STRVAR(wave_copy_doc, "Copy a wave to a new wave");
+
+static PyObject *
+RayPy_WaveFormat(PyObject *Py_UNUSED(self), PyObject *args)
+{
+    RayPy_WaveObject *wave;
+    unsigned int sampleRate, sampleSize, channels;
+    if (!PyArg_ParseTuple(args, "O!III", &RayPy_Wave_Type, &wave, &sampleRate, &sampleSize, &channels))
+        return NULL;
+    if (wave->w.data == NULL) {
+        PyErr_SetString(PyExc_ValueError, "wave is unloaded");
+        return NULL;
+    }
+    if (sampleRate == 0)
+        return PyErr_Format(PyExc_ValueError, "sample rate must be > 0");
+    if (sampleSize != 8 && sampleSize != 16 && sampleSize != 32)
+        return PyErr_Format(PyExc_ValueError, "sample size must be 8, 16 or 32, not %u", sampleSize);
+    if (channels < 1 || channels > RAYPY_PCM_MAX_CHANNELS)
+        return PyErr_Format(PyExc_ValueError, "channels must be 1 to %d, not %u", RAYPY_PCM_MAX_CHANNELS, channels);
+    if (wave->w.sampleSize != 8 && wave->w.sampleSize != 16 && wave->w.sampleSize != 32) {
+        PyErr_SetString(PyExc_ValueError, "wave has an unsupported sample size");
+        return NULL;
+    }
+    if (wave->exports > 0) {
+        PyErr_SetString(PyExc_BufferError, "wave samples are in use by a memoryview");
+        return NULL;
+    }
+    Wave w = wave->w;
+    void *out;
+    Py_ssize_t frames;
+    Py_BEGIN_ALLOW_THREADS
+    frames = RayPy_Pcm_Convert(w.data, w.frameCount, w.sampleSize, w.channels, w.sampleRate,
+                               sampleSize, channels, sampleRate, &out);
+    Py_END_ALLOW_THREADS
+    if (frames < 0)
+        return PyErr_NoMemory();
+    if (frames > UINT_MAX) {
+        RL_FREE(out);
+        PyErr_SetString(PyExc_OverflowError, "too many frames");
+        return NULL;
+    }
+    RL_FREE(wave->w.data);
+    wave->w.data = out;
+    wave->w.frameCount = (unsigned int)frames;
+    wave->w.sampleRate = sampleRate;
+    wave->w.sampleSize = sampleSize;
+    wave->w.channels = channels;
+    Py_RETURN_NONE;
+}
+
+PyDoc_STRVAR(wave_format_doc,
+             "Convert wave data to desired format, channels are averaged down to mono, copied up from mono and "
+             "resampled with linear interpolation");
+
+static PyObject *
+RayPy_LoadSoundFromWave(PyObject *Py_UNUSED(self), PyObject *args)
+{
+    RayPy_WaveObject *wave;
+    if (!PyArg_ParseTuple(args, "O!", &RayPy_Wave_Type, &wave))
+        return NULL;
+    AUDIO_IS_READY();
+    if (wave->w.data == NULL) {
+        PyErr_SetString(PyExc_ValueError, "wave is unloaded");
+        return NULL;
+    }
+    Sound sound = LoadSoundFromWave(wave->w);
+    if (sound.stream.buffer == NULL) {
+        PyErr_SetString(PyExc_RuntimeError, "failed to load sound from wave");
+        return NULL;
+    }
+    RayPy_SoundObject *ret = PyObject_New(RayPy_SoundObject, &RayPy_Sound_Type);
+    if (ret == NULL) {
+        UnloadSound(sound);
+        return NULL;
+    }
+    ret->s = sound;
+    return (PyObject *)ret;
+}
+
+PyDoc_STRVAR(load_sound_from_wave_doc, "Load sound from wave data, the samples are copied");
+
+static PyObject *
+RayPy_ExportWave(PyObject *Py_UNUSED(self), PyObject *args)
+{
+    RayPy_WaveObject *wave;
+    const char *fileName;
+    if (!PyArg_ParseTuple(args, "O!s", &RayPy_Wave_Type, &wave, &fileName))
+        return NULL;
+    if (wave->w.data == NULL) {
+        PyErr_SetString(PyExc_ValueError, "wave is unloaded");
+        return NULL;
+    }
+    bool ok;
+    Py_BEGIN_ALLOW_THREADS
+    ok = ExportWave(wave->w, fileName);
+    Py_END_ALLOW_THREADS
+    return PyBool_FromLong(ok);
+}
+
+PyDoc_STRVAR(export_wave_doc, "Export wave data to file, returns true on success");
+
+/* Virtual file system
+
+   Directories and archives (zip, stored or deflated, and Quake style PACK
+   files) mounted under pak://, served through raylib's LoadFileData() and
+   LoadFileText() callbacks so every loader accepts pak:// paths. Archives
+   are memory mapped and indexed when mounted, reading from them is a hash
+   lookup and a copy or an inflate, without opening or stat'ing anything. */
+
+#define RAYPY_VFS_SCHEME "pak://"
+
+typedef struct {
+    const char *name; // in the mapping, not NUL-terminated
+    size_t name_len;
+    size_t offset;    // zip: local file header, PACK: file data
+    size_t size;      // size in the archive
+    size_t raw_size;  // uncompressed size
+    int method;       // zip compression method, 0: stored
+} RayPy_VfsEntry;
+
+typedef struct {
+    char *source; // as passed to vfs_mount()
+    char *prefix; // mount point, "" or ending with '/'
+    size_t prefix_len;
+    int is_dir;
+    int is_pack;
+    const unsigned char *data; // archives: the whole file mapped
+    size_t size;
+    void *handle;              // file mapping handle on Windows
+    RayPy_VfsEntry *entries;
+    size_t count;
+    size_t *table; // open addressing on the names, entry index + 1, 0 when empty
+    size_t mask;
+    long refs;     // the mount and the readers using it, freed at 0
+} RayPy_VfsSource;
+
+static struct {
+    PyThread_type_lock lock; // taken by readers to look mounts up, they run on any thread without the GIL
+    RayPy_VfsSource **mounts; // searched last mounted first
+    int count, capacity;
+} RayPy_vfs = {0};
+
+static const char *
+RayPy_MapFile(const char *path, const unsigned char **data, size_t *size, void **handle)
+{
+#if defined(_WIN32)
+    void *file = CreateFileA(path, 0x80000000 /* GENERIC_READ */, 1 /* FILE_SHARE_READ */, NULL,
+                             3 /* OPEN_EXISTING */, 0x80 /* FILE_ATTRIBUTE_NORMAL */, NULL);
+    long long n = 0;
+    if (file == (void *)(intptr_t)-1)
+        return "failed to open file";
+    if (!GetFileSizeEx(file, &n) || n <= 0 || (unsigned long long)n > SIZE_MAX) {
+        CloseHandle(file);
+        return "failed to read file";
+    }
+    void *mapping = CreateFileMappingA(file, NULL, 2 /* PAGE_READONLY */, 0, 0, NULL);
+    CloseHandle(file);
+    if (mapping == NULL)
+        return "failed to map file";
+    void *view = MapViewOfFile(mapping, 4 /* FILE_MAP_READ */, 0, 0, 0);
+    if (view == NULL) {
+        CloseHandle(mapping);
+        return "failed to map file";
+    }
+    *data = view;
+    *size = (size_t)n;
+    *handle = mapping;
+#else
+    struct stat st;
+    int fd = open(path, O_RDONLY);
+    if (fd == -1)
+        return "failed to open file";
+    if (fstat(fd, &st) == -1 || st.st_size <= 0 || (unsigned long long)st.st_size > SIZE_MAX) {
+        close(fd);
+        return "failed to read file";
+    }
+    void *view = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (view == MAP_FAILED)
+        return "failed to map file";
+    *data = view;
+    *size = (size_t)st.st_size;
+    *handle = NULL;
+#endif
+    return NULL;
+}
+
+static void
+RayPy_UnmapFile(const unsigned char *data, size_t size, void *handle)
+{
+#if defined(_WIN32)
+    UnmapViewOfFile(data);
+    CloseHandle(handle);
+#else
+    munmap((void *)data, size);
+#endif
+}
+
+static size_t
+RayPy_Vfs_Hash(const char *name, size_t len)
+{
+    size_t h = 2166136261u; // FNV-1a
+    for (size_t i = 0; i < len; i++)
+        h = (h ^ (unsigned char)name[i]) * 16777619u;
+    return h;
+}
+
+static const RayPy_VfsEntry *
+RayPy_VfsSource_Find(const RayPy_VfsSource *m, const char *name, size_t len)
+{
+    if (m->table == NULL)
+        return NULL;
+    for (size_t i = RayPy_Vfs_Hash(name, len) & m->mask; m->table[i] != 0; i = (i + 1) & m->mask) {
+        const RayPy_VfsEntry *e = &m->entries[m->table[i] - 1];
+        if (e->name_len == len && memcmp(e->name, name, len) == 0)
+            return e;
+    }
+    return NULL;
+}
+
+static const char *
+RayPy_VfsSource_Index(RayPy_VfsSource *m)
+{
+    size_t slots = 16;
+    while (slots < m->count * 2)
+        slots *= 2;
+    m->table = calloc(slots, sizeof(size_t));
+    if (m->table == NULL)
+        return "out of memory";
+    m->mask = slots - 1;
+    for (size_t k = 0; k < m->count; k++) {
+        const RayPy_VfsEntry *e = &m->entries[k];
+        if (RayPy_VfsSource_Find(m, e->name, e->name_len) != NULL)
+            continue; // first one wins like in unzip
+        size_t i = RayPy_Vfs_Hash(e->name, e->name_len) & m->mask;
+        while (m->table[i] != 0)
+            i = (i + 1) & m->mask;
+        m->table[i] = k + 1;
+    }
+    return NULL;
+}
+
+/* Reads the central directory, data offsets are resolved when files are read */
+static const char *
+RayPy_VfsSource_ParseZip(RayPy_VfsSource *m)
+{
+    const unsigned char *data = m->data, *eocd = NULL;
+    size_t size = m->size;
+    if (size < 22)
+        return "not a zip file";
+    size_t stop = size > 22 + 65535 ? size - 22 - 65535 : 0;
+    for (size_t i = size - 22 + 1; i-- > stop;) {
+        if (RayPy_ReadU32(data + i, 0) == 0x06054b50) {
+            eocd = data + i;
+            break;
+        }
+    }
+    if (eocd == NULL)
+        return "not a zip file";
+    size_t count = eocd[10] | eocd[11] << 8;
+    size_t dir_size = RayPy_ReadU32(eocd + 12, 0), dir_offset = RayPy_ReadU32(eocd + 16, 0);
+    if (count == 0xFFFF || dir_offset == 0xFFFFFFFF)
+        return "zip64 archives are not supported";
+    if (dir_offset > size || dir_size > size - dir_offset)
+        return "truncated zip file";
+
+    m->entries = calloc(count ? count : 1, sizeof(RayPy_VfsEntry));
+    if (m->entries == NULL)
+        return "out of memory";
+    const unsigned char *p = data + dir_offset, *end = p + dir_size;
+    for (size_t k = 0; k < count; k++) {
+        if (end - p < 46 || RayPy_ReadU32(p, 0) != 0x02014b50)
+            return "invalid zip central directory";
+        int flags = p[8] | p[9] << 8, method = p[10] | p[11] << 8;
+        size_t name_len = p[28] | p[29] << 8;
+        size_t skip = 46 + name_len + (p[30] | p[31] << 8) + (p[32] | p[33] << 8);
+        if ((size_t)(end - p) < skip)
+            return "invalid zip central directory";
+        RayPy_VfsEntry e = {(const char *)p + 46, name_len, RayPy_ReadU32(p + 42, 0),
+                            RayPy_ReadU32(p + 20, 0), RayPy_ReadU32(p + 24, 0), method};
+        p += skip;
+        if (name_len == 0 || e.name[name_len - 1] == '/' || (flags & 1))
+            continue; // directories, encrypted files
+        if (e.size == 0xFFFFFFFF || e.raw_size == 0xFFFFFFFF || e.offset == 0xFFFFFFFF)
+            return "zip64 archives are not supported";
+        if (e.raw_size > INT_MAX)
+            continue; // LoadFileData() sizes are ints
+        m->entries[m->count++] = e;
+    }
+    return RayPy_VfsSource_Index(m);
+}
+
+/* "PACK", directory offset and size, then 64 bytes per file: 56 bytes of
+   NUL-padded name, data offset and size */
+static const char *
+RayPy_VfsSource_ParsePack(RayPy_VfsSource *m)
+{
+    size_t dir_offset = RayPy_ReadU32(m->data + 4, 0), dir_size = RayPy_ReadU32(m->data + 8, 0);
+    if (dir_offset > m->size || dir_size > m->size - dir_offset || dir_size % 64 != 0)
+        return "invalid PACK directory";
+    m->entries = calloc(dir_size / 64 + 1, sizeof(RayPy_VfsEntry));
+    if (m->entries == NULL)
+        return "out of memory";
+    for (size_t k = 0; k < dir_size / 64; k++) {
+        const unsigned char *p = m->data + dir_offset + k * 64;
+        RayPy_VfsEntry e = {(const char *)p, 0, RayPy_ReadU32(p + 56, 0), RayPy_ReadU32(p + 60, 0), 0, 0};
+        while (e.name_len < 56 && e.name[e.name_len] != '\0')
+            e.name_len++;
+        if (e.offset > m->size || e.size > m->size - e.offset || e.size > INT_MAX)
+            return "invalid PACK directory";
+        e.raw_size = e.size;
+        if (e.name_len > 0)
+            m->entries[m->count++] = e;
+    }
+    return RayPy_VfsSource_Index(m);
+}
+
+/* Drops a reference, the last one unmaps the source */
+static void
+RayPy_VfsSource_Free(RayPy_VfsSource *m)
+{
+    if (RAYPY_ADD_LONG(&m->refs, -1) > 0)
+        return;
+    if (m->data != NULL)
+        RayPy_UnmapFile(m->data, m->size, m->handle);
+    free(m->entries);
+    free(m->table);
+    free(m->source);
+    free(m->prefix);
+    free(m);
+}
+
+/* Mounts a directory or archive, returns an error message or NULL */
+static const char *
+RayPy_VfsSource_Open(const char *source, const char *mount_point, RayPy_VfsSource **out)
+{
+    const char *err = NULL;
+    RayPy_VfsSource *m = calloc(1, sizeof(RayPy_VfsSource));
+    if (m == NULL)
+        return "out of memory";
+    m->refs = 1;
+    while (*mount_point == '/')
+        mount_point++;
+    size_t source_len = strlen(source), prefix_len = strlen(mount_point);
+    m->source = malloc(source_len + 2);
+    m->prefix = malloc(prefix_len + 2);
+    if (m->source == NULL || m->prefix == NULL) {
+        err = "out of memory";
+        goto done;
+    }
+    memcpy(m->source, source, source_len + 1);
+    memcpy(m->prefix, mount_point, prefix_len + 1);
+    if (prefix_len > 0 && mount_point[prefix_len - 1] != '/')
+        memcpy(m->prefix + prefix_len++, "/", 2);
+    m->prefix_len = prefix_len;
+
+    if (DirectoryExists(source)) {
+        m->is_dir = 1;
+        goto done;
+    }
+    err = RayPy_MapFile(source, &m->data, &m->size, &m->handle);
+    if (err != NULL) {
+        m->data = NULL;
+        goto done;
+    }
+    m->is_pack = m->size >= 12 && memcmp(m->data, "PACK", 4) == 0;
+    if (m->is_pack)
+        err = RayPy_VfsSource_ParsePack(m);
+    else
+        err = RayPy_VfsSource_ParseZip(m);
+
+done:
+    if (err != NULL)
+        RayPy_VfsSource_Free(m);
+    else
+        *out = m;
+    return err;
+}
+
+/* Reads a file of an archive mount into a buffer for UnloadFileData() */
+static unsigned char *
+RayPy_VfsSource_Read(const RayPy_VfsSource *m, const RayPy_VfsEntry *e, int *dataSize)
+{
+    size_t offset = e->offset;
+    if (!m->is_pack) {
+        /* zip: skip the local file header, its extra field may differ from the central one */
+        if (offset > m->size || m->size - offset < 30 || RayPy_ReadU32(m->data + offset, 0) != 0x04034b50)
+            return NULL;
+        const unsigned char *h = m->data + offset;
+        offset += 30 + (size_t)(h[26] | h[27] << 8) + (size_t)(h[28] | h[29] << 8);
+        if (offset > m->size || e->size > m->size - offset)
+            return NULL;
+    }
+    if (e->method == 8) {
+        int size = 0;
+        unsigned char *data = DecompressData(m->data + offset, (int)e->size, &size);
+        if (data != NULL && (size_t)size != e->raw_size) {
+            RL_FREE(data);
+            return NULL;
+        }
+        *dataSize = size;
+        return data;
+    }
+    if (e->method != 0)
+        return NULL;
+    unsigned char *data = RL_MALLOC(e->size ? e->size : 1);
+    if (data != NULL) {
+        memcpy(data, m->data + offset, e->size);
+        *dataSize = (int)e->size;
+    }
+    return data;
+}
+
+static unsigned char *
+RayPy_ReadFile(const char *fileName, int *dataSize)
+{
+    unsigned char *data = NULL;
+    FILE *file = fopen(fileName, "rb");
+    if (file == NULL)
+        return NULL;
+    if (fseek(file, 0, SEEK_END) == 0) {
+        long size = ftell(file);
+        if (size >= 0 && size <= INT_MAX && fseek(file, 0, SEEK_SET) == 0) {
+            data = RL_MALLOC(size ? (size_t)size : 1);
+            if (data != NULL && fread(data, 1, (size_t)size, file) != (size_t)size) {
+                RL_FREE(data);
+                data = NULL;
+            }
+            *dataSize = (int)size;
+        }
+    }
+    fclose(file);
+    return data;
+}
+
+/* 1 if a path under a directory mount stays in it: relative, no drive and no ".." segment */
+static int
+RayPy_VfsPath_IsContained(const char *path)
+{
+    if (path[0] == '/' || path[0] == '\\' || strchr(path, ':') != NULL)
+        return 0;
+    for (const char *p = path; *p != '\0';) {
+        size_t n = strcspn(p, "/\\");
+        if (n == 2 && p[0] == '.' && p[1] == '.')
+            return 0;
+        p += n;
+        if (*p != '\0')
+            p++;
+    }
+    return 1;
+}
+
+/* Reads a pak:// path from the mounts, the last mounted first. The lock is
+   only held to find the next mount that may have the file, which is kept
+   alive by a reference while it's read from. */
+static unsigned char *
+RayPy_Vfs_Read(const char *path, int *dataSize)
+{
+    unsigned char *data = NULL;
+    size_t len = strlen(path);
+    int i = INT_MAX;
+    while (data == NULL) {
+        RayPy_VfsSource *m = NULL;
+        const RayPy_VfsEntry *e = NULL;
+        PyThread_acquire_lock(RayPy_vfs.lock, WAIT_LOCK);
+        /* mounts may have changed since the last one, carry on from its position */
+        for (i = Py_MIN(i - 1, RayPy_vfs.count - 1); i >= 0; i--) {
+            RayPy_VfsSource *candidate = RayPy_vfs.mounts[i];
+            if (len < candidate->prefix_len || memcmp(path, candidate->prefix, candidate->prefix_len) != 0)
+                continue;
+            if (candidate->is_dir ? !RayPy_VfsPath_IsContained(path + candidate->prefix_len)
+                                  : (e = RayPy_VfsSource_Find(candidate, path + candidate->prefix_len,
+                                                              len - candidate->prefix_len)) == NULL)
+                continue;
+            m = candidate;
+            RAYPY_ADD_LONG(&m->refs, 1);
+            break;
+        }
+        PyThread_release_lock(RayPy_vfs.lock);
+        if (m == NULL)
+            break;
+        if (m->is_dir) {
+            char buffer[4096];
+            int n = snprintf(buffer, sizeof(buffer), "%s/%s", m->source, path + m->prefix_len);
+            if (n > 0 && n < (int)sizeof(buffer))
+                data = RayPy_ReadFile(buffer, dataSize);
+        }
+        else
+            data = RayPy_VfsSource_Read(m, e, dataSize);
+        RayPy_VfsSource_Free(m);
+    }
+    return data;
+}
+
+static unsigned char *
+RayPy_Vfs_LoadFileData(const char *fileName, int *dataSize)
+{
+    unsigned char *data;
+    *dataSize = 0;
+    if (strncmp(fileName, RAYPY_VFS_SCHEME, sizeof(RAYPY_VFS_SCHEME) - 1) == 0)
+        data = RayPy_Vfs_Read(fileName + sizeof(RAYPY_VFS_SCHEME) - 1, dataSize);
+    else
+        data = RayPy_ReadFile(fileName, dataSize);
+    if (data == NULL)
+        TraceLog(LOG_WARNING, "FILEIO: [%s] Failed to open file", fileName);
+    return data;
+}
+
+static char *
+RayPy_Vfs_LoadFileText(const char *fileName)
+{
+    int size = 0;
+    unsigned char *data = RayPy_Vfs_LoadFileData(fileName, &size);
+    if (data == NULL)
+        return NULL;
+    char *text = RL_REALLOC(data, (size_t)size + 1);
+    if (text == NULL) {
+        RL_FREE(data);
+        return NULL;
+    }
+    text[size] = '\0';
+    return text;
+}
+
+static PyObject *
+RayPy_VfsMount(PyObject *Py_UNUSED(self), PyObject *args)
+{
+    const char *source, *mount_point = "", *err;
+    RayPy_VfsSource *m = NULL;
+    if (!PyArg_ParseTuple(args, "s|s", &source, &mount_point))
+        return NULL;
+    Py_BEGIN_ALLOW_THREADS
+    err = RayPy_VfsSource_Open(source, mount_point, &m);
+    Py_END_ALLOW_THREADS
+    if (err != NULL)
+        return PyErr_Format(PyExc_OSError, "%s: %s", source, err);
+    /* other threads mount while this one opened its source, and readers walk
+       the array without the GIL, so it only changes under the lock */
+    PyThread_acquire_lock(RayPy_vfs.lock, WAIT_LOCK);
+    if (RayPy_vfs.count == RayPy_vfs.capacity) {
+        int capacity = RayPy_vfs.capacity ? RayPy_vfs.capacity * 2 : 8;
+        RayPy_VfsSource **mounts = PyMem_RawMalloc(capacity * sizeof(RayPy_VfsSource *));
+        if (mounts == NULL) {
+            PyThread_release_lock(RayPy_vfs.lock);
+            RayPy_VfsSource_Free(m);
+            return PyErr_NoMemory();
+        }
+        if (RayPy_vfs.count)
+            memcpy(mounts, RayPy_vfs.mounts, RayPy_vfs.count * sizeof(RayPy_VfsSource *));
+        PyMem_RawFree(RayPy_vfs.mounts);
+        RayPy_vfs.mounts = mounts;
+        RayPy_vfs.capacity = capacity;
+    }
+    RayPy_vfs.mounts[RayPy_vfs.count++] = m;
+    SetLoadFileDataCallback(RayPy_Vfs_LoadFileData);
+    SetLoadFileTextCallback(RayPy_Vfs_LoadFileText);
+    PyThread_release_lock(RayPy_vfs.lock);
+    Py_RETURN_NONE;
+}
+
+PyDoc_STRVAR(vfs_mount_doc,
+             "Mount a directory or a zip or PACK archive under pak://mount_point/, files in the last mounted source shadow the earlier ones");
+
+static PyObject *
+RayPy_VfsUnmount(PyObject *Py_UNUSED(self), PyObject *args)
+{
+    const char *source;
+    RayPy_VfsSource *m = NULL;
+    if (!PyArg_ParseTuple(args, "s", &source))
+        return NULL;
+    PyThread_acquire_lock(RayPy_vfs.lock, WAIT_LOCK);
+    for (int i = RayPy_vfs.count - 1; i >= 0; i--) {
+        if (strcmp(RayPy_vfs.mounts[i]->source, source) == 0) {
+            m = RayPy_vfs.mounts[i];
+            memmove(&RayPy_vfs.mounts[i], &RayPy_vfs.mounts[i + 1],
+                    (RayPy_vfs.count - i - 1) * sizeof(RayPy_VfsSource *));
+            RayPy_vfs.count--;
+            break;
+        }
+    }
+    if (RayPy_vfs.count == 0) {
+        SetLoadFileDataCallback(NULL);
+        SetLoadFileTextCallback(NULL);
+    }
+    PyThread_release_lock(RayPy_vfs.lock);
+    if (m == NULL)
+        Py_RETURN_FALSE;
+    RayPy_VfsSource_Free(m);
+    Py_RETURN_TRUE;
+}
+
+PyDoc_STRVAR(vfs_unmount_doc, "Unmount the last mounted directory or archive with that path, returns true if it was mounted");
+
+static PyObject *
+RayPy_VfsReadFile(PyObject *Py_UNUSED(self), PyObject *args)
+{
+    const char *fileName;
+    unsigned char *data;
+    int size = 0;
+    if (!PyArg_ParseTuple(args, "s", &fileName))
+        return NULL;
+    Py_BEGIN_ALLOW_THREADS
+    data = LoadFileData(fileName, &size);
+    Py_END_ALLOW_THREADS
+    if (data == NULL)
+        return PyErr_Format(PyExc_FileNotFoundError, "failed to read file '%s'", fileName);
+    PyObject *ret = PyBytes_FromStringAndSize((const char *)data, size);
+    UnloadFileData(data);
+    return ret;
+}
+
+PyDoc_STRVAR(vfs_read_file_doc, "Read a file, pak:// paths from the mounted directories and archives, as bytes");
+
+/* Frame export
+
+   Finished frames (or a texture) published into a named shared memory
+   ring for other local processes, read with raypy.frameshm.FrameReader.
+   Native endian layout, a 64 byte header then `slots` slots of a 64 byte
+   slot header and `capacity` bytes of R8G8B8A8 pixels:
+
+   header: u32 magic 'RPYF', u32 version, u32 slots, u32 header size,
+           u64 slot size, u64 capacity, u64 latest frame (0: none yet),
+           u64 frames dropped for being larger than capacity
+   slot:   u64 sequence (odd while being written), u64 frame,
+           i64 time (time.monotonic_ns() clock), u32 width, u32 height,
+           u32 format, u32 stride
+
+   Frame n goes to slot n % slots. The writer never waits for readers,
+   they copy a slot and check its sequence didn't change meanwhile. */
+
+#define RAYPY_FRAME_EXPORT_MAGIC 0x46595052u // "RPYF"
+#define RAYPY_FRAME_EXPORT_VERSION 1
+#define RAYPY_FRAME_EXPORT_HEADER 64
+
+typedef struct {
+    unsigned int magic, version, slots, header_size;
+    unsigned long long slot_size, capacity, latest, dropped;
+} RayPy_FrameExportHeader;
+
+typedef struct {
+    unsigned long long seq, frame;
+    long long time_ns;
+    unsigned int width, height, format, stride;
+} RayPy_FrameExportSlot;
+
+static struct {
+    char *name;                  // shared memory object name, '/'-prefixed on POSIX
+    unsigned char *base;         // the mapping, NULL when not exporting
+    size_t size;
+    void *handle;                // file mapping handle on Windows
+    RayPy_TextureObject *texture; // exported instead of the screen when set
+    unsigned long long frame;
+} RayPy_frame_export = {0};
+
+static void
+RayPy_FrameExport_Close(void)
+{
+    if (RayPy_frame_export.base != NULL) {
+#if defined(_WIN32)
+        UnmapViewOfFile(RayPy_frame_export.base);
+        CloseHandle(RayPy_frame_export.handle);
+#else
+        munmap(RayPy_frame_export.base, RayPy_frame_export.size);
+        shm_unlink(RayPy_frame_export.name);
+#endif
+    }
+    PyMem_RawFree(RayPy_frame_export.name);
+    Py_CLEAR(RayPy_frame_export.texture);
+    RayPy_frame_export.name = NULL;
+    RayPy_frame_export.base = NULL;
+    RayPy_frame_export.frame = 0;
+}
+
+/* Creates the shared memory object, returns an error message or NULL, with
+   `exists` set when another object has the name */
+static const char *
+RayPy_FrameExport_Create(const char *name, size_t size, int *exists)
+{
+    *exists = 0;
+#if defined(_WIN32)
+    void *mapping = CreateFileMappingA((void *)(intptr_t)-1 /* INVALID_HANDLE_VALUE */, NULL,
+                                       4 /* PAGE_READWRITE */, (unsigned long)((unsigned long long)size >> 32),
+                                       (unsigned long)size, name);
+    if (mapping == NULL)
+        return "failed to create shared memory";
+    if (GetLastError() == 183 /* ERROR_ALREADY_EXISTS */) {
+        CloseHandle(mapping);
+        *exists = 1;
+        return "shared memory already exists";
+    }
+    void *view = MapViewOfFile(mapping, 2 /* FILE_MAP_WRITE */, 0, 0, size);
+    if (view == NULL) {
+        CloseHandle(mapping);
+        return "failed to map shared memory";
+    }
+    RayPy_frame_export.handle = mapping;
+#else
+    /* the name may be another process's live segment, never unlink it */
+    int fd = shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0600);
+    if (fd == -1) {
+        *exists = errno == EEXIST;
+        return *exists ? "shared memory already exists" : "failed to create shared memory";
+    }
+    if (ftruncate(fd, (off_t)size) == -1) {
+        close(fd);
+        shm_unlink(name);
+        return "failed to size shared memory";
+    }
+    void *view = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (view == MAP_FAILED) {
+        shm_unlink(name);
+        return "failed to map shared memory";
+    }
+#endif
+    RayPy_frame_export.base = view;
+    RayPy_frame_export.size = size;
+    return NULL;
+}
+
+/* Reads back the frame drawn so far and publishes it. Runs without the GIL
+   on the GL thread, `source` is the exported texture or id 0 for the screen */
+static void
+RayPy_FrameExport_Publish(Texture source, int use_texture)
+{
+    RayPy_FrameExportHeader *header = (RayPy_FrameExportHeader *)RayPy_frame_export.base;
+    unsigned char *pixels;
+    int width, height;
+
+    rlDrawRenderBatchActive();
+    if (use_texture) {
+        if (source.id == 0 || source.format != PIXELFORMAT_UNCOMPRESSED_R8G8B8A8)
+            return;
+        width = source.width;
+        height = source.height;
+        pixels = rlReadTexturePixels(source.id, width, height, source.format);
+    }
+    else {
+        width = GetRenderWidth();
+        height = GetRenderHeight();
+        pixels = rlReadScreenPixels(width, height);
+    }
+    if (pixels == NULL)
+        return;
+    size_t stride = (size_t)width * 4;
+    if (stride * height > header->capacity) {
+        RAYPY_STORE_RELEASE(&header->dropped, header->dropped + 1);
+        RL_FREE(pixels);
+        return;
+    }
+
+    unsigned long long frame = ++RayPy_frame_export.frame;
+    RayPy_FrameExportSlot *slot = (RayPy_FrameExportSlot *)(RayPy_frame_export.base + header->header_size
+                                                            + (frame % header->slots) * header->slot_size);
+    unsigned long long seq = slot->seq;
+    slot->seq = seq + 1;
+    RAYPY_FENCE_RELEASE();
+    slot->frame = frame;
+    slot->time_ns = RayPy_MonotonicNs();
+    slot->width = (unsigned int)width;
+    slot->height = (unsigned int)height;
+    slot->format = PIXELFORMAT_UNCOMPRESSED_R8G8B8A8;
+    slot->stride = (unsigned int)stride;
+    memcpy((unsigned char *)slot + RAYPY_FRAME_EXPORT_HEADER, pixels, stride * height);
+    RAYPY_STORE_RELEASE(&slot->seq, seq + 2);
+    RAYPY_STORE_RELEASE(&header->latest, frame);
+    RL_FREE(pixels);
+}
+
+/* EndDrawing() with the GIL released, publishing the frame first when exporting */
+static void
+RayPy_SwapFrame(void)
+{
+    int exporting = RayPy_frame_export.base != NULL;
+    int use_texture = RayPy_frame_export.texture != NULL;
+    Texture source = use_texture ? RayPy_frame_export.texture->t : (Texture){0};
+    Py_BEGIN_ALLOW_THREADS
+    if (exporting)
+        RayPy_FrameExport_Publish(source, use_texture);
+    EndDrawing();
+    Py_END_ALLOW_THREADS
+    RayPy_last_frame_ns = RayPy_MonotonicNs();
+    RayPy_redraw.skipped = 0;
+}
+
+static PyObject *
+RayPy_EnableFrameExport(PyObject *Py_UNUSED(self), PyObject *args, PyObject *keywds)
+{
+    const char *name, *err;
+    int slots = 3, exists;
+    PyObject *texture = Py_None;
+    static char *kwlist[] = {"name", "slots", "texture", NULL};
+    if (!PyArg_ParseTupleAndKeywords(args, keywds, "s|iO", kwlist, &name, &slots, &texture))
+        return NULL;
+    WINDOW_IS_READY();
+    if (texture != Py_None && !PyObject_TypeCheck(texture, &RayPy_Texture_Type))
+        return PyErr_Format(PyExc_TypeError, "texture must be a Texture or None, not %.200s",
+                            Py_TYPE(texture)->tp_name);
+    if (slots < 1 || slots > 64)
+        return PyErr_Format(PyExc_ValueError, "slots must be between 1 and 64, not %d", slots);
+    if (name[0] == '\0' || strchr(name + 1, '/') != NULL || strlen(name) > 200)
+        return PyErr_Format(PyExc_ValueError, "invalid shared memory name '%s'", name);
+
+    int width, height;
+    if (texture != Py_None) {
+        Texture t = ((RayPy_TextureObject *)texture)->t;
+        if (t.format != PIXELFORMAT_UNCOMPRESSED_R8G8B8A8) {
+            PyErr_SetString(PyExc_ValueError, "only R8G8B8A8 textures can be exported");
+            return NULL;
+        }
+        width = t.width;
+        height = t.height;
+    }
+    else {
+        width = GetRenderWidth();
+        height = GetRenderHeight();
+    }
+    size_t capacity = ((size_t)width * height * 4 + 63) & ~(size_t)63;
+    size_t slot_size = RAYPY_FRAME_EXPORT_HEADER + capacity;
+
+    RayPy_FrameExport_Close();
+    RayPy_frame_export.name = PyMem_RawMalloc(strlen(name) + 2);
+    if (RayPy_frame_export.name == NULL)
+        return PyErr_NoMemory();
+#if defined(_WIN32)
+    strcpy(RayPy_frame_export.name, name[0] == '/' ? name + 1 : name);
+#else
+    sprintf(RayPy_frame_export.name, "%s%s", name[0] == '/' ? "" : "/", name);
+#endif
+    err = RayPy_FrameExport_Create(RayPy_frame_export.name,
+                                   RAYPY_FRAME_EXPORT_HEADER + (size_t)slots * slot_size, &exists);
+    if (err != NULL) {
+        PyErr_Format(exists ? PyExc_FileExistsError : PyExc_OSError, "%s: %s", name, err);
+        RayPy_FrameExport_Close();
+        return NULL;
+    }
+    RayPy_FrameExportHeader *header = (RayPy_FrameExportHeader *)RayPy_frame_export.base;
+    header->version = RAYPY_FRAME_EXPORT_VERSION;
+    header->slots = (unsigned int)slots;
+    header->header_size = RAYPY_FRAME_EXPORT_HEADER;
+    header->slot_size = slot_size;
+    header->capacity = capacity;
+    RAYPY_FENCE_RELEASE();
+    header->magic = RAYPY_FRAME_EXPORT_MAGIC;
+    if (texture != Py_None)
+        RayPy_frame_export.texture = (RayPy_TextureObject *)Py_NewRef(texture);
+    Py_RETURN_NONE;
+}
+
+PyDoc_STRVAR(enable_frame_export_doc,
+             "Publish every finished frame, or a texture, into a shared memory ring read with raypy.frameshm.FrameReader, "
+             "raises FileExistsError when the name is taken");
+
+static PyObject *
+RayPy_DisableFrameExport(PyObject *Py_UNUSED(self), PyObject *Py_UNUSED(args))
+{
+    /* the render thread writes into the mapping with the GIL released */
+    IS_RENDER_THREAD();
+    RayPy_FrameExport_Close();
+    Py_RETURN_NONE;
+}
+
+PyDoc_STRVAR(disable_frame_export_doc, "Stop publishing frames and remove the shared memory");
+
+static PyObject *
+RayPy_IsFrameExportEnabled(PyObject *Py_UNUSED(self), PyObject *Py_UNUSED(args))
+{
+    return PyBool_FromLong(RayPy_frame_export.base != NULL);
+}
+
+PyDoc_STRVAR(is_frame_export_enabled_doc, "Check if frames are published to shared memory");
+
+static PyObject *
+RayPy_InitWindow(PyObject *Py_UNUSED(self), PyObject *args, PyObject *keywds)
+{
+    int width, height;
+    const char *title;
+    if (!PyArg_ParseTuple(args, "iis", &width, &height, &title))
+        return NULL;
+    /* claimed first, two threads opening windows at once would both get into raylib */
+    if (!RAYPY_CAS_LONG(&RayPy_render_thread, 0, PyThread_get_thread_ident())) {
+        long owner = RAYPY_LOAD_LONG(&RayPy_render_interp);
+        PyErr_SetString(PyExc_RuntimeError, owner != -1 && owner != RayPy_InterpreterId()
+                                                ? "window already initialized by another interpreter"
+                                                : "window already initialized");
+        return NULL;
+    }
+    RAYPY_STORE_LONG(&RayPy_render_interp, RayPy_InterpreterId());
+    InitWindow(width, height, title);
+    if (!IsWindowReady()) {
+        RAYPY_STORE_LONG(&RayPy_render_interp, -1);
+        RAYPY_STORE_LONG(&RayPy_render_thread, 0);
+    }
+    else
+        RAYPY_ADD_LONG(&RayPy_window_generation, 1);
+    RayPy_time_base_ns = RayPy_MonotonicNs();
+    Py_RETURN_NONE;
+}
+
+PyDoc_STRVAR(init_window_doc, "Initialize window and OpenGL context");
+
+static PyObject *
+RayPy_WindowShouldClose(PyObject *Py_UNUSED(self), PyObject *Py_UNUSED(args))
+{
+    IS_RENDER_THREAD();
+    return PyBool_FromLong(WindowShouldClose());
+}
+
+PyDoc_STRVAR(window_should_close_doc, "Check if KEY_ESCAPE pressed or Close icon pressed");
+
+static void RayPy_CommandQueue_Discard(void);
+
+static PyObject *
+RayPy_CloseWindow(PyObject *Py_UNUSED(self), PyObject *Py_UNUSED(args))
+{
+    IS_RENDER_THREAD();
+    if (!IsWindowReady())
+        return (PyErr_SetString(PyExc_TypeError, ""), NULL);
+    RayPy_Redraw_Reset();
+    RayPy_FrameExport_Close();
+    RayPy_InstancingShader_Unload();
+    RayPy_CommandQueue_Discard();
+    RayPy_GL_ReleaseQueued(1);
+    memset(RayPy_format_support, 0, sizeof(RayPy_format_support));
+    CloseWindow();
+    RayPy_frame_open = 0;
+    RAYPY_STORE_LONG(&RayPy_render_interp, -1);
+    RAYPY_STORE_LONG(&RayPy_render_thread, 0);
+    Py_RETURN_NONE;
+}
+
+PyDoc_STRVAR(close_window_doc, "Close window and unload OpenGL context");
+
+static PyObject *
+RayPy_IsWindowReady(PyObject *Py_UNUSED(self), PyObject *Py_UNUSED(args))
+{
+    return PyBool_FromLong(IsWindowReady());
+}
+
+PyDoc_STRVAR(is_window_ready_doc, "Check if window has been initialized successfully");
+
+static PyObject *
+RayPy_IsWindowFullscreen(PyObject *Py_UNUSED(self), PyObject *Py_UNUSED(args))
+{
+    return PyBool_FromLong(IsWindowFullscreen());
 }
 
 PyDoc_STRVAR(is_window_fullscreen_doc, "Check if window is currently fullscreen");
 
 static PyObject *
-RayPy_IsWindowHidden(PyObject *Py_UNUSED(self), PyObject *Py_UNUSED(args))
+RayPy_IsWindowHidden(PyObject *Py_UNUSED(self), PyObject *Py_UNUSED(args))
+{
+    return PyBool_FromLong(IsWindowHidden());
+}
+
+PyDoc_STRVAR(is_window_hidden_doc,
+             "Check if window is currently hidden (only PLATFORM_DESKTOP)");
+
+static PyObject *
+RayPy_IsWindowMinimized(PyObject *Py_UNUSED(self), PyObject *Py_UNUSED(args))
+{
+    return PyBool_FromLong(IsWindowMinimized());
+}
+
+PyDoc_STRVAR(is_window_minimized_doc,
+             "Check if window is currently minimized (only PLATFORM_DESKTOP)");
+
+static PyObject *
+RayPy_IsWindowMaximized(PyObject *Py_UNUSED(self), PyObject *Py_UNUSED(args))
+{
+    return PyBool_FromLong(IsWindowMaximized());
+}
+
+PyDoc_STRVAR(is_window_maximized_doc,
+             "Check if window is currently maximized (only PLATFORM_DESKTOP)");
+
+static PyObject *
+RayPy_IsWindowFocused(PyObject *Py_UNUSED(self), PyObject *Py_UNUSED(args))
+{
+    return PyBool_FromLong(IsWindowFocused());
+}
+
+PyDoc_STRVAR(is_window_focused_doc,
+             "Check if window is currently focused (only PLATFORM_DESKTOP)");
+
+static PyObject *
+RayPy_IsWindowResized(PyObject *Py_UNUSED(self), PyObject *Py_UNUSED(args))
+{
+    return PyBool_FromLong(IsWindowResized());
+}
+
+PyDoc_STRVAR(is_window_resized_doc, "Check if window has been resized last frame");
+
+static PyObject *
+RayPy_IsWindowState(PyObject *Py_UNUSED(self), PyObject *obj)
+{
+    unsigned int flag = PyLong_AsUnsignedLong(obj);
+    METH_O_TYPE_ERROR(obj, "int");
+    return PyBool_FromLong(IsWindowState(flag));
+}
+
+PyDoc_STRVAR(is_window_state_doc, "Check if one specific window flag is enabled");
+
+static PyObject *
+RayPy_SetWindowState(PyObject *Py_UNUSED(self), PyObject *obj)
+{
+    WINDOW_IS_READY();
+    unsigned int flag = PyLong_AsUnsignedLong(obj);
+    METH_O_TYPE_ERROR(obj, "int");
+    SetWindowState(flag);
+    Py_RETURN_NONE;
+}
+
+PyDoc_STRVAR(set_window_state_doc, "Set window configuration state using flags");
+
+static PyObject *
+RayPy_ClearWindowState(PyObject *Py_UNUSED(self), PyObject *obj)
+{
+    unsigned int flag = PyLong_AsUnsignedLong(obj);
+    METH_O_TYPE_ERROR(obj, "int");
+    ClearWindowState(flag);
+    Py_RETURN_NONE;
+}
+
+PyDoc_STRVAR(clear_window_state_doc, "Clear window configuration state flags");
+
+static PyObject *
+RayPy_ToggleFullscreen(PyObject *Py_UNUSED(self), PyObject *Py_UNUSED(args))
+{
+    WINDOW_IS_READY();
+    ToggleFullscreen();
+    Py_RETURN_NONE;
+}
+
+PyDoc_STRVAR(toggle_fullscreen_doc,
+             "Toggle window state: fullscreen/windowed (only PLATFORM_DESKTOP)");
+
+static PyObject *
+RayPy_MaximizeWindow(PyObject *Py_UNUSED(self), PyObject *Py_UNUSED(args))
+{
+    WINDOW_IS_READY();
+    MaximizeWindow();
+    Py_RETURN_NONE;
+}
+
+PyDoc_STRVAR(maximize_window_doc,
+             "Set window state: maximized, if resizable (only PLATFORM_DESKTOP)");
+
+static PyObject *
+RayPy_MinimizeWindow(PyObject *Py_UNUSED(self), PyObject *Py_UNUSED(args))
+{
+    WINDOW_IS_READY();
+    MinimizeWindow();
+    Py_RETURN_NONE;
+}
+
+PyDoc_STRVAR(minimize_window_doc,
+             "Set window state: minimized, if resizable (only PLATFORM_DESKTOP)");
+
+static PyObject *
+RayPy_RestoreWindow(PyObject *Py_UNUSED(self), PyObject *Py_UNUSED(args))
+{
+    WINDOW_IS_READY();
+    RestoreWindow();
+    Py_RETURN_NONE;
+}
+
+PyDoc_STRVAR(restore_window_doc,
+             "Set window state: not minimized/maximized (only PLATFORM_DESKTOP)");
+
+static PyObject *
+RayPy_SetWindowIcon(PyObject *Py_UNUSED(self), PyObject *Py_UNUSED(obj)) // TODO
+{
+    Py_RETURN_NONE;
+}
+
+PyDoc_STRVAR(set_window_icon_doc, "Set icon for window (only PLATFORM_DESKTOP)");
+
+static PyObject *
+RayPy_SetWindowTitle(PyObject *Py_UNUSED(self), PyObject *obj)
+{
+    WINDOW_IS_READY();
+    Py_ssize_t len;
+    const char *title = PyUnicode_AsUTF8AndSize(obj, &len);
+    METH_O_TYPE_ERROR(obj, "str");
+    SetWindowTitle(title);
+    Py_RETURN_NONE;
+}
+
+PyDoc_STRVAR(set_window_title_doc, "Set title for window (only PLATFORM_DESKTOP)");
+
+static PyObject *
+RayPy_SetWindowPosition(PyObject *Py_UNUSED(self), PyObject *args)
+{
+    int x, y;
+    WINDOW_IS_READY();
+    if (!PyArg_ParseTuple(args, "ii", &x, &y))
+        return NULL;
+    SetWindowPosition(x, y);
+    Py_RETURN_NONE;
+}
+
+PyDoc_STRVAR(set_window_position_doc, "Set window position on screen (only PLATFORM_DESKTOP)");
+
+static PyObject *
+RayPy_SetWindowMonitor(PyObject *Py_UNUSED(self), PyObject *obj)
+{
+    int monitor = PyLong_AsLong(obj);
+    METH_O_TYPE_ERROR(obj, "int");
+    SetWindowMonitor(monitor);
+    Py_RETURN_NONE;
+}
+
+PyDoc_STRVAR(set_window_monitor_doc, "Set monitor for the current window (fullscreen mode)");
+
+static PyObject *
+RayPy_SetWindowMinSize(PyObject *Py_UNUSED(self), PyObject *args, PyObject *keywds)
+{
+    WINDOW_IS_READY();
+    int width, height;
+    static char *kwlist[] = {"width", "height", NULL};
+    if (!PyArg_ParseTupleAndKeywords(args, keywds, "ii", kwlist, &width, &height))
+        return NULL;
+    SetWindowMinSize(width, height);
+    Py_RETURN_NONE;
+}
+
+PyDoc_STRVAR(set_window_min_size_doc,
+             "Set window minimum dimensions (for FLAG_WINDOW_RESIZABLE)");
+
+static PyObject *
+RayPy_SetWindowSize(PyObject *Py_UNUSED(self), PyObject *args, PyObject *keywds)
+{
+    WINDOW_IS_READY();
+    int width, height;
+    static char *kwlist[] = {"width", "height", NULL};
+    if (!PyArg_ParseTupleAndKeywords(args, keywds, "ii", kwlist, &width, &height))
+        return NULL;
+    SetWindowSize(width, height);
+    Py_RETURN_NONE;
+}
+
+PyDoc_STRVAR(set_window_size_doc, "Set window dimensions");
+
+static PyObject *
+RayPy_GetWindowHandle(PyObject *Py_UNUSED(self), PyObject *Py_UNUSED(args))
+{
+    PyObject *obj = PyLong_FromVoidPtr(GetWindowHandle());
+    if (obj == NULL) {
+        PyErr_SetString(PyExc_ValueError,
+                        "couldn't convert internal 'GetWindowHandle' type to python object");
+        return NULL;
+    }
+    return obj;
+}
+
+PyDoc_STRVAR(get_window_handle_doc, "Get native window handle");
+
+static PyObject *
+RayPy_GetScreenWidth(PyObject *Py_UNUSED(self), PyObject *Py_UNUSED(args))
+{
+    return PyLong_FromLong(GetScreenWidth());
+}
+
+PyDoc_STRVAR(get_screen_width_doc, "Get current screen width");
+
+static PyObject *
+RayPy_GetScreenHeight(PyObject *Py_UNUSED(self), PyObject *Py_UNUSED(args))
+{
+    return PyLong_FromLong(GetScreenHeight());
+}
+
+PyDoc_STRVAR(get_screen_height_doc, "Get current screen height");
+
+static PyObject *
+RayPy_GetMonitorCount(PyObject *Py_UNUSED(self), PyObject *Py_UNUSED(args))
+{
+    return PyLong_FromLong(GetMonitorCount());
+}
+
+PyDoc_STRVAR(get_monitor_count_doc, "Get number of connected monitors");
+
+static PyObject *
+RayPy_GetCurrentMonitor(PyObject *Py_UNUSED(self), PyObject *Py_UNUSED(args))
+{
+    WINDOW_IS_READY();
+    return PyLong_FromLong(GetCurrentMonitor());
+}
+
+PyDoc_STRVAR(get_current_monitor_doc, "Get current connected monitor");
+
+static PyObject *
+RayPy_GetMonitorPosition(PyObject *Py_UNUSED(self), PyObject *obj)
+{
+    int monitor = PyLong_AsLong(obj);
+    METH_O_TYPE_ERROR(obj, "int");
+    Vector2 pos = GetMonitorPosition(monitor);
+    return PyObject_CallFunction((PyObject *)&RayPy_Vector2_Type, "dd", pos.x, pos.y);
+}
+
+PyDoc_STRVAR(get_monitor_position_doc, "Get specified monitor position");
+
+static PyObject *
+RayPy_GetMonitorWidth(PyObject *Py_UNUSED(self), PyObject *obj)
 {
-    return PyBool_FromLong(IsWindowHidden());
+    int monitor = PyLong_AsLong(obj);
+    METH_O_TYPE_ERROR(obj, "int");
+    return PyLong_FromLong(GetMonitorWidth(monitor));
 }
 
-PyDoc_STRVAR(is_window_hidden_doc,
-             "Check if window is currently hidden (only PLATFORM_DESKTOP)");
+PyDoc_STRVAR(get_monitor_width_doc, "Get specified monitor width (max available by monitor)");
 
 static PyObject *
-RayPy_IsWindowMinimized(PyObject *Py_UNUSED(self), PyObject *Py_UNUSED(args))
+RayPy_GetMonitorHeight(PyObject *Py_UNUSED(self), PyObject *obj)
 {
-    return PyBool_FromLong(IsWindowMinimized());
+    int monitor = PyLong_AsLong(obj);
+    METH_O_TYPE_ERROR(obj, "int");
+    return PyLong_FromLong(GetMonitorHeight(monitor));
 }
 
-PyDoc_STRVAR(is_window_minimized_doc,
-             "Check if window is currently minimized (only PLATFORM_DESKTOP)");
+PyDoc_STRVAR(get_monitor_height_doc,
+             "Get specified monitor height (max available by monitor)");
 
 static PyObject *
-RayPy_IsWindowMaximized(PyObject *Py_UNUSED(self), PyObject *Py_UNUSED(args))
+RayPy_GetMonitorPhysicalWidth(PyObject *Py_UNUSED(self), PyObject *obj)
 {
-    return PyBool_FromLong(IsWindowMaximized());
+    int monitor = PyLong_AsLong(obj);
+    METH_O_TYPE_ERROR(obj, "int");
+    return PyLong_FromLong(GetMonitorPhysicalWidth(monitor));
 }
 
-PyDoc_STRVAR(is_window_maximized_doc,
-             "Check if window is currently maximized (only PLATFORM_DESKTOP)");
+PyDoc_STRVAR(get_monitor_physical_width_doc,
+             "Get specified monitor physical width in millimetres");
 
 static PyObject *
-RayPy_IsWindowFocused(PyObject *Py_UNUSED(self), PyObject *Py_UNUSED(args))
+RayPy_GetMonitorPhysicalHeight(PyObject *Py_UNUSED(self), PyObject *obj)
 {
-    return PyBool_FromLong(IsWindowFocused());
+    int monitor = PyLong_AsLong(obj);
+    METH_O_TYPE_ERROR(obj, "int");
+    return PyLong_FromLong(GetMonitorPhysicalHeight(monitor));
 }
 
-PyDoc_STRVAR(is_window_focused_doc,
-             "Check if window is currently focused (only PLATFORM_DESKTOP)");
+PyDoc_STRVAR(get_monitor_physical_height_doc,
+             "Get specified monitor physical height in millimetres");
 
 static PyObject *
-RayPy_IsWindowResized(PyObject *Py_UNUSED(self), PyObject *Py_UNUSED(args))
+RayPy_GetMonitorRefreshRate(PyObject *Py_UNUSED(self), PyObject *obj)
 {
-    return PyBool_FromLong(IsWindowResized());
+    int monitor = PyLong_AsLong(obj);
+    METH_O_TYPE_ERROR(obj, "int");
+    return PyLong_FromLong(GetMonitorRefreshRate(monitor));
 }
 
-PyDoc_STRVAR(is_window_resized_doc, "Check if window has been resized last frame");
+PyDoc_STRVAR(get_monitor_refresh_rate_doc, "Get specified monitor refresh rate");
 
 static PyObject *
-RayPy_IsWindowState(PyObject *Py_UNUSED(self), PyObject *obj)
+RayPy_GetWindowPosition(PyObject *Py_UNUSED(self), PyObject *Py_UNUSED(args))
 {
-    unsigned int flag = PyLong_AsUnsignedLong(obj);
-    METH_O_TYPE_ERROR(obj, "int");
-    return PyBool_FromLong(IsWindowState(flag));
+    WINDOW_IS_READY();
+    Vector2 pos = GetWindowPosition();
+    return PyObject_CallFunction((PyObject *)&RayPy_Vector2_Type, "dd", pos.x, pos.y);
 }
 
-PyDoc_STRVAR(is_window_state_doc, "Check if one specific window flag is enabled");
+PyDoc_STRVAR(get_window_position_doc, "Get window position XY on monitor");
 
 static PyObject *
-RayPy_SetWindowState(PyObject *Py_UNUSED(self), PyObject *obj)
+RayPy_GetWindowScaleDPI(PyObject *Py_UNUSED(self), PyObject *Py_UNUSED(args))
 {
     WINDOW_IS_READY();
-    unsigned int flag = PyLong_AsUnsignedLong(obj);
+    Vector2 scale = GetWindowScaleDPI();
+    return PyObject_CallFunction((PyObject *)&RayPy_Vector2_Type, "dd", scale.x, scale.y);
+}
+
+PyDoc_STRVAR(get_window_scale_dpi_doc, "Get window scale DPI factor");
+
+static PyObject *
+RayPy_GetMonitorName(PyObject *Py_UNUSED(self), PyObject *obj)
+{
+    int monitor = PyLong_AsLong(obj);
     METH_O_TYPE_ERROR(obj, "int");
-    SetWindowState(flag);
+    return PyUnicode_FromString(GetMonitorName(monitor));
+}
+
+PyDoc_STRVAR(get_monitor_name_doc,
+             "Get the human-readable, UTF-8 encoded name of the primary monitor");
+
+static PyObject *
+RayPy_SetClipboardText(PyObject *Py_UNUSED(self), PyObject *obj)
+{
+    Py_ssize_t len;
+    const char *text = PyUnicode_AsUTF8AndSize(obj, &len);
+    METH_O_TYPE_ERROR(obj, "str");
+    SetClipboardText(text);
     Py_RETURN_NONE;
 }
 
-PyDoc_STRVAR(set_window_state_doc, "Set window configuration state using flags");
+PyDoc_STRVAR(set_clipboard_text_doc, "Set clipboard text content");
 
 static PyObject *
-RayPy_ClearWindowState(PyObject *Py_UNUSED(self), PyObject *obj)
+RayPy_GetClipboardText(PyObject *Py_UNUSED(self), PyObject *Py_UNUSED(args))
 {
-    unsigned int flag = PyLong_AsUnsignedLong(obj);
-    METH_O_TYPE_ERROR(obj, "int");
-    ClearWindowState(flag);
+    const char *text = GetClipboardText();
+    if (text == NULL) {
+        PyErr_SetString(PyExc_RuntimeError, "window not initialized");
+        return NULL;
+    }
+    return PyUnicode_FromString(text);
+}
+
+PyDoc_STRVAR(get_clipboard_text_doc, "Get clipboard text content");
+
+static int RayPy_event_waiting = 0;
+
+static PyObject *
+RayPy_EnableEventWaiting(PyObject *Py_UNUSED(self), PyObject *Py_UNUSED(args))
+{
+    EnableEventWaiting();
+    RayPy_event_waiting = 1;
     Py_RETURN_NONE;
 }
 
-PyDoc_STRVAR(clear_window_state_doc, "Clear window configuration state flags");
+PyDoc_STRVAR(enable_event_waiting_doc,
+             "Enable waiting for events on EndDrawing(), no automatic event polling");
 
 static PyObject *
-RayPy_ToggleFullscreen(PyObject *Py_UNUSED(self), PyObject *Py_UNUSED(args))
+RayPy_DisableEventWaiting(PyObject *Py_UNUSED(self), PyObject *Py_UNUSED(args))
 {
-    WINDOW_IS_READY();
-    ToggleFullscreen();
+    DisableEventWaiting();
+    RayPy_event_waiting = 0;
     Py_RETURN_NONE;
 }
 
-PyDoc_STRVAR(toggle_fullscreen_doc,
-             "Toggle window state: fullscreen/windowed (only PLATFORM_DESKTOP)");
+PyDoc_STRVAR(disable_event_waiting_doc,
+             "Disable waiting for events on EndDrawing(), automatic events polling");
 
 static PyObject *
-RayPy_MaximizeWindow(PyObject *Py_UNUSED(self), PyObject *Py_UNUSED(args))
+RayPy_IsEventWaiting(PyObject *Py_UNUSED(self), PyObject *Py_UNUSED(args))
+{
+    return PyBool_FromLong(RayPy_event_waiting);
+}
+
+PyDoc_STRVAR(is_event_waiting_doc, "Check if waiting for events on EndDrawing() is enabled");
+
+static PyObject *
+RayPy_SwapScreenBuffer(PyObject *Py_UNUSED(self), PyObject *Py_UNUSED(args))
 {
     WINDOW_IS_READY();
-    MaximizeWindow();
+    SwapScreenBuffer();
     Py_RETURN_NONE;
 }
 
-PyDoc_STRVAR(maximize_window_doc,
-             "Set window state: maximized, if resizable (only PLATFORM_DESKTOP)");
+PyDoc_STRVAR(swap_screen_buffer_doc, "Swap back buffer with front buffer (screen drawing)");
 
 static PyObject *
-RayPy_MinimizeWindow(PyObject *Py_UNUSED(self), PyObject *Py_UNUSED(args))
+RayPy_PollInputEvents(PyObject *Py_UNUSED(self), PyObject *Py_UNUSED(args))
 {
-    WINDOW_IS_READY();
-    MinimizeWindow();
+    PollInputEvents();
     Py_RETURN_NONE;
 }
 
-PyDoc_STRVAR(minimize_window_doc,
-             "Set window state: minimized, if resizable (only PLATFORM_DESKTOP)");
+PyDoc_STRVAR(poll_input_events_doc, "Register all input events");
+
+#define RAYPY_MAX_KEYBOARD_KEYS 512 // raylib's MAX_KEYBOARD_KEYS
+#define RAYPY_MAX_MOUSE_BUTTONS 7   // raylib's MAX_MOUSE_BUTTONS
+
+static int
+RayPy_InputChanged(void)
+{
+    static int was_focused = -1;
+    int focused = IsWindowFocused();
+    int changed = was_focused != -1 && focused != was_focused;
+    was_focused = focused;
+    if (changed || IsWindowResized() || IsFileDropped() || GetMouseWheelMove() != 0.0f)
+        return 1;
+    Vector2 delta = GetMouseDelta();
+    if (delta.x != 0.0f || delta.y != 0.0f)
+        return 1;
+    for (int button = 0; button < RAYPY_MAX_MOUSE_BUTTONS; button++) {
+        if (IsMouseButtonPressed(button) || IsMouseButtonReleased(button))
+            return 1;
+    }
+    for (int key = 1; key < RAYPY_MAX_KEYBOARD_KEYS; key++) {
+        if (IsKeyPressed(key) || IsKeyReleased(key) || IsKeyPressedRepeat(key))
+            return 1;
+    }
+    return 0;
+}
 
 static PyObject *
-RayPy_RestoreWindow(PyObject *Py_UNUSED(self), PyObject *Py_UNUSED(args))
+RayPy_HasInputEvents(PyObject *Py_UNUSED(self), PyObject *Py_UNUSED(args))
 {
     WINDOW_IS_READY();
-    RestoreWindow();
-    Py_RETURN_NONE;
+    return PyBool_FromLong(RayPy_InputChanged());
 }
 
-PyDoc_STRVAR(restore_window_doc,
-             "Set window state: not minimized/maximized (only PLATFORM_DESKTOP)");
+PyDoc_STRVAR(has_input_events_doc,
+             "Check if the last input events poll (PollInputEvents() or EndDrawing()) "
+             "registered any keyboard, mouse or window event");
 
 static PyObject *
-RayPy_SetWindowIcon(PyObject *Py_UNUSED(self), PyObject *Py_UNUSED(obj)) // TODO
+RayPy_WaitTime(PyObject *Py_UNUSED(self), PyObject *args)
 {
+    /* only sleeps, any thread may wait */
+    if (!IsWindowReady()) {
+        PyErr_SetString(PyExc_RuntimeError, "window not initialized");
+        return NULL;
+    }
+    double monitor = PyFloat_AsDouble(args);
+    METH_O_TYPE_ERROR(args, "float");
+    WaitTime((float)monitor);
     Py_RETURN_NONE;
 }
 
-PyDoc_STRVAR(set_window_icon_doc, "Set icon for window (only PLATFORM_DESKTOP)");
+PyDoc_STRVAR(wait_time_doc, "Wait for some milliseconds (halt program execution)");
 
-static PyObject *
-RayPy_SetWindowTitle(PyObject *Py_UNUSED(self), PyObject *obj)
+PyObject *
+RayPy_ShowCursor(PyObject *Py_UNUSED(self), PyObject *Py_UNUSED(args))
 {
     WINDOW_IS_READY();
-    Py_ssize_t len;
-    const char *title = PyUnicode_AsUTF8AndSize(obj, &len);
-    METH_O_TYPE_ERROR(obj, "str");
-    SetWindowTitle(title);
+    ShowCursor();
     Py_RETURN_NONE;
 }
 
-PyDoc_STRVAR(set_window_title_doc, "Set title for window (only PLATFORM_DESKTOP)");
+PyDoc_STRVAR(show_cursor_doc, "Shows cursor");
 
-static PyObject *
-RayPy_SetWindowPosition(PyObject *Py_UNUSED(self), PyObject *args)
+PyObject *
+RayPy_HideCursor(PyObject *Py_UNUSED(self), PyObject *Py_UNUSED(args))
 {
-    int x, y;
     WINDOW_IS_READY();
-    if (!PyArg_ParseTuple(args, "ii", &x, &y))
-        return NULL;
-    SetWindowPosition(x, y);
+    HideCursor();
     Py_RETURN_NONE;
 }
 
-PyDoc_STRVAR(set_window_position_doc, "Set window position on screen (only PLATFORM_DESKTOP)");
+PyDoc_STRVAR(hide_cursor_doc, "Hides cursor");
+
+PyObject *
+RayPy_IsCursorHidden(PyObject *Py_UNUSED(self), PyObject *Py_UNUSED(args))
+{
+    return PyBool_FromLong(IsCursorHidden());
+}
+
+PyDoc_STRVAR(is_cursor_hidden_doc, "Check if cursor is not visible");
+
+PyObject *
+RayPy_EnableCursor(PyObject *Py_UNUSED(self), PyObject *Py_UNUSED(args))
+{
+    WINDOW_IS_READY();
+    EnableCursor();
+    Py_RETURN_NONE;
+}
+
+PyDoc_STRVAR(enable_cursor_doc, "Enables cursor (unlock cursor)");
+
+PyObject *
+RayPy_DisableCursor(PyObject *Py_UNUSED(self), PyObject *Py_UNUSED(args))
+{
+    WINDOW_IS_READY();
+    DisableCursor();
+    Py_RETURN_NONE;
+}
+
+PyDoc_STRVAR(disable_cursor_doc, "Disables cursor (lock cursor)");
+
+PyObject *
+RayPy_IsCursorOnScreen(PyObject *Py_UNUSED(self), PyObject *Py_UNUSED(args))
+{
+    return PyBool_FromLong(IsCursorOnScreen());
+}
+
+PyDoc_STRVAR(is_cursor_on_screen_doc, "Check if cursor is on the screen");
 
 static PyObject *
-RayPy_SetWindowMonitor(PyObject *Py_UNUSED(self), PyObject *obj)
+RayPy_ClearBackground(PyObject *Py_UNUSED(self), PyObject *obj)
 {
-    int monitor = PyLong_AsLong(obj);
-    METH_O_TYPE_ERROR(obj, "int");
-    SetWindowMonitor(monitor);
+    WINDOW_IS_READY();
+    Color color = RayPy_Color_AsColor((RayPy_ColorObject *)obj);
+    METH_O_TYPE_ERROR(obj, "raypy.Color");
+    ClearBackground(color);
+    Py_RETURN_NONE;
+}
+
+PyDoc_STRVAR(clear_background_doc, "Set background color (framebuffer clear color)");
+
+/* Render on demand */
+
+static void
+RayPy_Redraw_Request(Rectangle rec)
+{
+    if (!RayPy_redraw.has_dirty) {
+        RayPy_redraw.dirty = rec;
+        RayPy_redraw.has_dirty = 1;
+        return;
+    }
+    Rectangle *d = &RayPy_redraw.dirty;
+    float x0 = d->x < rec.x ? d->x : rec.x;
+    float y0 = d->y < rec.y ? d->y : rec.y;
+    float x1 = d->x + d->width > rec.x + rec.width ? d->x + d->width : rec.x + rec.width;
+    float y1 = d->y + d->height > rec.y + rec.height ? d->y + d->height : rec.y + rec.height;
+    *d = (Rectangle){x0, y0, x1 - x0, y1 - y0};
+}
+
+/* BeginDrawing() honoring render on demand, returns 0 when the frame is skipped */
+static int
+RayPy_BeginFrame(void)
+{
+    RayPy_GL_ReleaseQueued(1);
+    RayPy_cull.camera_active = 0;
+    RayPy_cull.target_width = RayPy_cull.target_height = 0;
+    RayPy_cull.drawn = RayPy_cull.culled = 0;
+    RayPy_cull.chunks_drawn = RayPy_cull.chunks_culled = 0;
+    if (!RayPy_redraw.enabled) {
+        BeginDrawing();
+        RayPy_frame_open = 1;
+        return 1;
+    }
+
+    /* the canvas has the framebuffer's pixels, which HiDPI screens have more
+       of than screen units */
+    int width = GetRenderWidth(), height = GetRenderHeight();
+    RenderTexture2D *canvas = &RayPy_redraw.canvas;
+    if (canvas->id == 0 || canvas->texture.width != width || canvas->texture.height != height) {
+        if (canvas->id != 0)
+            UnloadRenderTexture(*canvas);
+        *canvas = LoadRenderTexture(width, height);
+        RayPy_redraw.full = 1;
+    }
+    if (IsWindowResized())
+        RayPy_redraw.full = 1;
+
+    if (!RayPy_redraw.full && !RayPy_redraw.has_dirty) {
+        RayPy_redraw.drawing = 0;
+        return 0;
+    }
+
+    BeginTextureMode(*canvas);
+    /* draws stay in screen units like on the screen, so does culling */
+    int screen_width = GetScreenWidth(), screen_height = GetScreenHeight();
+    float sx = screen_width > 0 ? (float)width / screen_width : 1.0f;
+    float sy = screen_height > 0 ? (float)height / screen_height : 1.0f;
+    if (sx != 1.0f || sy != 1.0f)
+        rlScalef(sx, sy, 1.0f);
+    if (RayPy_redraw.full) {
+        RayPy_redraw.drawing = 1;
+    }
+    else {
+        /* BeginScissorMode() scales for HiDPI only on the screen, the canvas takes pixels */
+        Rectangle d = RayPy_redraw.dirty;
+        int x0 = (int)floorf(d.x * sx), y0 = (int)floorf(d.y * sy);
+        int x1 = (int)ceilf((d.x + d.width) * sx), y1 = (int)ceilf((d.y + d.height) * sy);
+        rlDrawRenderBatchActive();
+        rlEnableScissorTest();
+        rlScissor(x0, height - y1, x1 - x0, y1 - y0);
+        RayPy_redraw.drawing = 2;
+    }
+    /* requests made while drawing this frame are for the next one */
+    RayPy_redraw.full = RayPy_redraw.has_dirty = 0;
+    RayPy_frame_open = 1;
+    return 1;
+}
+
+/* EndDrawing() honoring render on demand. Must be called with the GIL held, it's
+   released while raylib waits for vsync, the target FPS or input events. */
+static void
+RayPy_EndFrame(void)
+{
+    RayPy_frame_open = 0;
+    RayPy_frame_count++;
+    if (!RayPy_redraw.enabled) {
+        RayPy_SwapFrame();
+        return;
+    }
+
+    if (RayPy_redraw.drawing) {
+        RenderTexture2D canvas = RayPy_redraw.canvas;
+        if (RayPy_redraw.drawing == 2)
+            EndScissorMode();
+        EndTextureMode();
+        RayPy_cull.target_width = RayPy_cull.target_height = 0;
+        RayPy_redraw.drawing = 0;
+
+        BeginDrawing();
+        /* render textures are stored upside down, drawn in screen units */
+        DrawTexturePro(canvas.texture,
+                       (Rectangle){0, 0, (float)canvas.texture.width, -(float)canvas.texture.height},
+                       (Rectangle){0, 0, (float)GetScreenWidth(), (float)GetScreenHeight()},
+                       (Vector2){0, 0}, 0.0f, WHITE);
+        RayPy_SwapFrame();
+        return;
+    }
+
+    /* nothing changed: no GPU work and no buffer swap, only keep input and timing going,
+       paced like vsync would when there's no target so idle apps don't spin */
+    int fps = RayPy_target_fps;
+    if (fps <= 0)
+        fps = GetMonitorRefreshRate(GetCurrentMonitor());
+    if (fps <= 0)
+        fps = RAYPY_IDLE_FPS;
+    int64_t deadline = RayPy_last_frame_ns + 1000000000LL / fps;
+    Py_BEGIN_ALLOW_THREADS
+    RayPy_WaitUntilNs(deadline, RAYPY_DEFAULT_SPIN_NS);
+    PollInputEvents();
+    Py_END_ALLOW_THREADS
+    int64_t now = RayPy_MonotonicNs();
+    RayPy_redraw.frame_time = (float)((now - RayPy_last_frame_ns) / 1e9);
+    RayPy_redraw.skipped = 1;
+    RayPy_last_frame_ns = now;
+}
+
+static PyObject *
+RayPy_EnableRenderOnDemand(PyObject *Py_UNUSED(self), PyObject *Py_UNUSED(args))
+{
+    WINDOW_IS_READY();
+    RayPy_redraw.enabled = 1;
+    RayPy_redraw.full = 1;
     Py_RETURN_NONE;
 }
 
-PyDoc_STRVAR(set_window_monitor_doc, "Set monitor for the current window (fullscreen mode)");
+PyDoc_STRVAR(enable_render_on_demand_doc,
+             "Only render frames after request_redraw(), skipped frames don't touch the GPU and wait out "
+             "the target FPS, or the monitor refresh rate without one");
 
 static PyObject *
-RayPy_SetWindowMinSize(PyObject *Py_UNUSED(self), PyObject *args, PyObject *keywds)
+RayPy_DisableRenderOnDemand(PyObject *Py_UNUSED(self), PyObject *Py_UNUSED(args))
 {
-    WINDOW_IS_READY();
-    int width, height;
-    static char *kwlist[] = {"width", "height", NULL};
-    if (!PyArg_ParseTupleAndKeywords(args, keywds, "ii", kwlist, &width, &height))
-        return NULL;
-    SetWindowMinSize(width, height);
+    RayPy_Redraw_Reset();
     Py_RETURN_NONE;
 }
 
-PyDoc_STRVAR(set_window_min_size_doc,
-             "Set window minimum dimensions (for FLAG_WINDOW_RESIZABLE)");
+PyDoc_STRVAR(disable_render_on_demand_doc, "Render every frame (default)");
 
 static PyObject *
-RayPy_SetWindowSize(PyObject *Py_UNUSED(self), PyObject *args, PyObject *keywds)
+RayPy_IsRenderOnDemand(PyObject *Py_UNUSED(self), PyObject *Py_UNUSED(args))
 {
-    WINDOW_IS_READY();
-    int width, height;
-    static char *kwlist[] = {"width", "height", NULL};
-    if (!PyArg_ParseTupleAndKeywords(args, keywds, "ii", kwlist, &width, &height))
-        return NULL;
-    SetWindowSize(width, height);
-    Py_RETURN_NONE;
+    return PyBool_FromLong(RayPy_redraw.enabled);
 }
 
-PyDoc_STRVAR(set_window_size_doc, "Set window dimensions");
+PyDoc_STRVAR(is_render_on_demand_doc, "Check if render on demand is enabled");
 
 static PyObject *
-RayPy_GetWindowHandle(PyObject *Py_UNUSED(self), PyObject *Py_UNUSED(args))
+RayPy_RequestRedraw(PyObject *Py_UNUSED(self), PyObject *const *args, Py_ssize_t nargs)
 {
-    PyObject *obj = PyLong_FromVoidPtr(GetWindowHandle());
-    if (obj == NULL) {
-        PyErr_SetString(PyExc_ValueError,
-                        "couldn't convert internal 'GetWindowHandle' type to python object");
+    if (nargs > 1) {
+        PyErr_Format(PyExc_TypeError, "function takes at most 1 argument (%zd given)", nargs);
         return NULL;
     }
-    return obj;
+    if (nargs == 0 || args[0] == Py_None) {
+        RayPy_redraw.full = 1;
+        Py_RETURN_NONE;
+    }
+    if (!PyObject_TypeCheck(args[0], &RayPy_Rectangle_Type)) {
+        RayPyErr_ArgTypeError(0, &RayPy_Rectangle_Type, args);
+        return NULL;
+    }
+    RayPy_RectangleObject *rec = (RayPy_RectangleObject *)args[0];
+    if (rec->width > 0 && rec->height > 0)
+        RayPy_Redraw_Request((Rectangle){rec->x, rec->y, rec->width, rec->height});
+    Py_RETURN_NONE;
 }
 
-PyDoc_STRVAR(get_window_handle_doc, "Get native window handle");
+PyDoc_STRVAR(request_redraw_doc,
+             "Mark a region (or the whole screen if None) as damaged, the next frame "
+             "redraws it");
 
 static PyObject *
-RayPy_GetScreenWidth(PyObject *Py_UNUSED(self), PyObject *Py_UNUSED(args))
+RayPy_IsRedrawRequested(PyObject *Py_UNUSED(self), PyObject *Py_UNUSED(args))
 {
-    return PyLong_FromLong(GetScreenWidth());
+    return PyBool_FromLong(RayPy_redraw.full || RayPy_redraw.has_dirty);
 }
 
-PyDoc_STRVAR(get_screen_width_doc, "Get current screen width");
+PyDoc_STRVAR(is_redraw_requested_doc, "Check if any region is waiting to be redrawn");
 
 static PyObject *
-RayPy_GetScreenHeight(PyObject *Py_UNUSED(self), PyObject *Py_UNUSED(args))
+RayPy_GetDirtyRect(PyObject *Py_UNUSED(self), PyObject *Py_UNUSED(args))
 {
-    return PyLong_FromLong(GetScreenHeight());
+    Rectangle d = RayPy_redraw.dirty;
+    if (RayPy_redraw.full)
+        d = (Rectangle){0, 0, (float)GetScreenWidth(), (float)GetScreenHeight()};
+    else if (!RayPy_redraw.has_dirty)
+        Py_RETURN_NONE;
+    return PyObject_CallFunction((PyObject *)&RayPy_Rectangle_Type, "dddd", d.x, d.y, d.width,
+                                 d.height);
 }
 
-PyDoc_STRVAR(get_screen_height_doc, "Get current screen height");
+PyDoc_STRVAR(get_dirty_rect_doc,
+             "Get the bounding rectangle of the regions to redraw, None if nothing changed");
 
 static PyObject *
-RayPy_GetMonitorCount(PyObject *Py_UNUSED(self), PyObject *Py_UNUSED(args))
+RayPy_BeginDrawing(PyObject *Py_UNUSED(self), PyObject *Py_UNUSED(args))
 {
-    return PyLong_FromLong(GetMonitorCount());
+    IS_RENDER_THREAD();
+    return PyBool_FromLong(RayPy_BeginFrame());
 }
 
-PyDoc_STRVAR(get_monitor_count_doc, "Get number of connected monitors");
+PyDoc_STRVAR(begin_drawing_doc,
+             "Setup canvas (framebuffer) to start drawing, returns False when render on "
+             "demand skips this frame");
 
 static PyObject *
-RayPy_GetCurrentMonitor(PyObject *Py_UNUSED(self), PyObject *Py_UNUSED(args))
+RayPy_EndDrawing(PyObject *Py_UNUSED(self), PyObject *Py_UNUSED(args))
 {
-    WINDOW_IS_READY();
-    return PyLong_FromLong(GetCurrentMonitor());
+    IS_RENDER_THREAD();
+    RayPy_EndFrame();
+    Py_RETURN_NONE;
 }
 
-PyDoc_STRVAR(get_current_monitor_doc, "Get current connected monitor");
+PyDoc_STRVAR(end_drawing_doc, "End canvas drawing and swap buffers (double buffering)");
 
 static PyObject *
-RayPy_GetMonitorPosition(PyObject *Py_UNUSED(self), PyObject *obj)
+RayPy_SetTargetFPS(PyObject *Py_UNUSED(self), PyObject *obj)
 {
-    int monitor = PyLong_AsLong(obj);
+    int fps = PyLong_AsLong(obj);
     METH_O_TYPE_ERROR(obj, "int");
-    Vector2 pos = GetMonitorPosition(monitor);
-    return PyObject_CallFunction((PyObject *)&RayPy_Vector2_Type, "dd", pos.x, pos.y);
+    SetTargetFPS(fps);
+    RayPy_target_fps = fps;
+    Py_RETURN_NONE;
 }
 
-PyDoc_STRVAR(get_monitor_position_doc, "Get specified monitor position");
+PyDoc_STRVAR(set_target_fps_doc, "Set target FPS (maximum)");
 
 static PyObject *
-RayPy_GetMonitorWidth(PyObject *Py_UNUSED(self), PyObject *obj)
+RayPy_GetTargetFPS(PyObject *Py_UNUSED(self), PyObject *Py_UNUSED(args))
 {
-    int monitor = PyLong_AsLong(obj);
-    METH_O_TYPE_ERROR(obj, "int");
-    return PyLong_FromLong(GetMonitorWidth(monitor));
+    return PyLong_FromLong(RayPy_target_fps);
 }
 
-PyDoc_STRVAR(get_monitor_width_doc, "Get specified monitor width (max available by monitor)");
+PyDoc_STRVAR(get_target_fps_doc, "Get the target FPS set with set_target_fps(), 0 for none");
 
 static PyObject *
-RayPy_GetMonitorHeight(PyObject *Py_UNUSED(self), PyObject *obj)
+RayPy_GetFPS(PyObject *Py_UNUSED(self), PyObject *Py_UNUSED(args))
 {
-    int monitor = PyLong_AsLong(obj);
-    METH_O_TYPE_ERROR(obj, "int");
-    return PyLong_FromLong(GetMonitorHeight(monitor));
+    if (RayPy_redraw.skipped && RayPy_redraw.frame_time > 0.0f)
+        return PyLong_FromLong((long)(1.0f / RayPy_redraw.frame_time + 0.5f));
+    return PyLong_FromLong(GetFPS());
 }
 
-PyDoc_STRVAR(get_monitor_height_doc,
-             "Get specified monitor height (max available by monitor)");
+PyDoc_STRVAR(get_fps_doc, "Get current FPS");
 
 static PyObject *
-RayPy_GetMonitorPhysicalWidth(PyObject *Py_UNUSED(self), PyObject *obj)
+RayPy_GetFrameTime(PyObject *Py_UNUSED(self), PyObject *Py_UNUSED(args))
 {
-    int monitor = PyLong_AsLong(obj);
-    METH_O_TYPE_ERROR(obj, "int");
-    return PyLong_FromLong(GetMonitorPhysicalWidth(monitor));
+    /* raylib only times the frames it swapped */
+    if (RayPy_redraw.skipped)
+        return PyFloat_FromDouble((double)RayPy_redraw.frame_time);
+    return PyFloat_FromDouble((double)GetFrameTime());
 }
 
-PyDoc_STRVAR(get_monitor_physical_width_doc,
-             "Get specified monitor physical width in millimetres");
+PyDoc_STRVAR(get_frame_time_doc, "Get time in seconds for last frame drawn (delta time)");
 
 static PyObject *
-RayPy_GetMonitorPhysicalHeight(PyObject *Py_UNUSED(self), PyObject *obj)
+RayPy_GetTime(PyObject *Py_UNUSED(self), PyObject *Py_UNUSED(args))
 {
-    int monitor = PyLong_AsLong(obj);
-    METH_O_TYPE_ERROR(obj, "int");
-    return PyLong_FromLong(GetMonitorPhysicalHeight(monitor));
+    return PyFloat_FromDouble(GetTime());
 }
 
-PyDoc_STRVAR(get_monitor_physical_height_doc,
-             "Get specified monitor physical height in millimetres");
+PyDoc_STRVAR(get_time_doc, "Get elapsed time in seconds since InitWindow()");
 
 static PyObject *
-RayPy_GetMonitorRefreshRate(PyObject *Py_UNUSED(self), PyObject *obj)
+RayPy_GetTimeNs(PyObject *Py_UNUSED(self), PyObject *Py_UNUSED(args))
 {
-    int monitor = PyLong_AsLong(obj);
-    METH_O_TYPE_ERROR(obj, "int");
-    return PyLong_FromLong(GetMonitorRefreshRate(monitor));
+    return PyLong_FromLongLong(RayPy_MonotonicNs() - RayPy_time_base_ns);
 }
 
-PyDoc_STRVAR(get_monitor_refresh_rate_doc, "Get specified monitor refresh rate");
+PyDoc_STRVAR(get_time_ns_doc,
+             "Get elapsed time in nanoseconds since InitWindow() (monotonic clock)");
 
-static PyObject *
-RayPy_GetWindowPosition(PyObject *Py_UNUSED(self), PyObject *Py_UNUSED(args))
+/* FramePacer */
+
+typedef struct {
+    double target_fps;
+    double fixed_dt;
+    double max_frame_time;
+    long long spin_threshold_ns;
+    long long period_ns;
+    long long deadline_ns;
+    long long last_ns;
+    double frame_time;
+    double accumulator;
+    unsigned long long frame_count;
+} RayPy_Pacer;
+
+static void
+RayPy_Pacer_Init(RayPy_Pacer *p, double target_fps)
 {
-    WINDOW_IS_READY();
-    Vector2 pos = GetWindowPosition();
-    return PyObject_CallFunction((PyObject *)&RayPy_Vector2_Type, "dd", pos.x, pos.y);
+    memset(p, 0, sizeof(*p));
+    p->target_fps = target_fps;
+    p->period_ns = target_fps > 0.0 ? (long long)(1e9 / target_fps) : 0;
+    p->max_frame_time = 0.25;
+    p->spin_threshold_ns = RAYPY_DEFAULT_SPIN_NS;
 }
 
-PyDoc_STRVAR(get_window_position_doc, "Get window position XY on monitor");
-
-static PyObject *
-RayPy_GetWindowScaleDPI(PyObject *Py_UNUSED(self), PyObject *Py_UNUSED(args))
+/* Wait until the next deadline, returns the frame time in seconds.
+   Must be called with the GIL held, releases it while waiting. */
+static double
+RayPy_Pacer_Wait(RayPy_Pacer *p)
 {
-    WINDOW_IS_READY();
-    Vector2 scale = GetWindowScaleDPI();
-    return PyObject_CallFunction((PyObject *)&RayPy_Vector2_Type, "dd", scale.x, scale.y);
+    int64_t now = RayPy_MonotonicNs();
+    if (p->last_ns == 0)
+        p->last_ns = now;
+
+    if (p->period_ns > 0) {
+        if (p->deadline_ns == 0)
+            p->deadline_ns = p->last_ns + p->period_ns;
+        int64_t deadline = p->deadline_ns, spin = p->spin_threshold_ns;
+        Py_BEGIN_ALLOW_THREADS
+        RayPy_WaitUntilNs(deadline, spin);
+        Py_END_ALLOW_THREADS
+        now = RayPy_MonotonicNs();
+        p->deadline_ns += p->period_ns;
+        /* missed a whole frame, don't try to catch up with a burst of short frames */
+        if (p->deadline_ns <= now)
+            p->deadline_ns = now + p->period_ns;
+    }
+
+    p->frame_time = (double)(now - p->last_ns) * 1e-9;
+    p->last_ns = now;
+    p->frame_count++;
+    if (p->fixed_dt > 0.0) {
+        double dt = p->frame_time;
+        if (p->max_frame_time > 0.0 && dt > p->max_frame_time)
+            dt = p->max_frame_time;
+        p->accumulator += dt;
+    }
+    return p->frame_time;
 }
 
-PyDoc_STRVAR(get_window_scale_dpi_doc, "Get window scale DPI factor");
+static int
+RayPy_Pacer_Step(RayPy_Pacer *p)
+{
+    if (p->fixed_dt > 0.0 && p->accumulator >= p->fixed_dt) {
+        p->accumulator -= p->fixed_dt;
+        return 1;
+    }
+    return 0;
+}
 
-static PyObject *
-RayPy_GetMonitorName(PyObject *Py_UNUSED(self), PyObject *obj)
+/* 1.0 at most, when steps weren't consumed (no update callback, a lowered fixed_dt) */
+static double
+RayPy_Pacer_Alpha(RayPy_Pacer *p)
 {
-    int monitor = PyLong_AsLong(obj);
-    METH_O_TYPE_ERROR(obj, "int");
-    return PyUnicode_FromString(GetMonitorName(monitor));
+    return p->fixed_dt > 0.0 ? Py_MIN(p->accumulator / p->fixed_dt, 1.0) : 1.0;
 }
 
-PyDoc_STRVAR(get_monitor_name_doc,
-             "Get the human-readable, UTF-8 encoded name of the primary monitor");
+typedef struct {
+    PyObject_HEAD RayPy_Pacer p;
+} RayPy_FramePacerObject;
 
-static PyObject *
-RayPy_SetClipboardText(PyObject *Py_UNUSED(self), PyObject *obj)
+static void
+RayPy_FramePacer_dealloc(RayPy_FramePacerObject *self)
 {
-    Py_ssize_t len;
-    const char *text = PyUnicode_AsUTF8AndSize(obj, &len);
-    METH_O_TYPE_ERROR(obj, "str");
-    SetClipboardText(text);
-    Py_RETURN_NONE;
+    PyTypeObject *tp = Py_TYPE(self);
+    tp->tp_free((PyObject *)self);
+    Py_DECREF(tp);
 }
 
-PyDoc_STRVAR(set_clipboard_text_doc, "Set clipboard text content");
+static int
+RayPy_FramePacer_SetTargetFPS(RayPy_FramePacerObject *self, double fps)
+{
+    if (fps < 0.0) {
+        PyErr_SetString(PyExc_ValueError, "target_fps must be >= 0");
+        return -1;
+    }
+    self->p.target_fps = fps;
+    self->p.period_ns = fps > 0.0 ? (long long)(1e9 / fps) : 0;
+    self->p.deadline_ns = 0;
+    return 0;
+}
 
-static PyObject *
-RayPy_GetClipboardText(PyObject *Py_UNUSED(self), PyObject *Py_UNUSED(args))
+static RayPy_FramePacerObject *
+RayPy_FramePacer_new(PyTypeObject *type, PyObject *Py_UNUSED(args), PyObject *Py_UNUSED(kwds))
 {
-    const char *text = GetClipboardText();
-    if (text == NULL) {
-        PyErr_SetString(PyExc_RuntimeError, "window not initialized");
+    RayPy_FramePacerObject *self = (RayPy_FramePacerObject *)type->tp_alloc(type, 0);
+    if (self == NULL)
         return NULL;
-    }
-    return PyUnicode_FromString(text);
+    RayPy_Pacer_Init(&self->p, 60.0);
+    return self;
 }
 
-PyDoc_STRVAR(get_clipboard_text_doc, "Get clipboard text content");
+static int
+RayPy_FramePacer_init(RayPy_FramePacerObject *self, PyObject *args, PyObject *kwds)
+{
+    double target_fps = self->p.target_fps;
+    static char *kwlist[] = {"target_fps", "fixed_dt", "spin_threshold_ns", "max_frame_time", NULL};
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "|ddLd", kwlist, &target_fps, &self->p.fixed_dt,
+                                     &self->p.spin_threshold_ns, &self->p.max_frame_time))
+        return -1;
+    if (!(self->p.fixed_dt >= 0.0 && isfinite(self->p.fixed_dt))) {
+        PyErr_SetString(PyExc_ValueError, "fixed_dt must be a finite number >= 0");
+        return -1;
+    }
+    if (!(self->p.max_frame_time >= 0.0 && isfinite(self->p.max_frame_time))) {
+        PyErr_SetString(PyExc_ValueError, "max_frame_time must be a finite number >= 0");
+        return -1;
+    }
+    if (self->p.spin_threshold_ns < 0) {
+        PyErr_SetString(PyExc_ValueError, "spin_threshold_ns must be >= 0");
+        return -1;
+    }
+    return RayPy_FramePacer_SetTargetFPS(self, target_fps);
+}
 
 static PyObject *
-RayPy_SwapScreenBuffer(PyObject *Py_UNUSED(self), PyObject *Py_UNUSED(args))
+RayPy_FramePacer_wait(RayPy_FramePacerObject *self, PyObject *Py_UNUSED(args))
 {
-    WINDOW_IS_READY();
-    SwapScreenBuffer();
-    Py_RETURN_NONE;
+    return PyFloat_FromDouble(RayPy_Pacer_Wait(&self->p));
 }
 
-PyDoc_STRVAR(swap_screen_buffer_doc, "Swap back buffer with front buffer (screen drawing)");
-
 static PyObject *
-RayPy_PollInputEvents(PyObject *Py_UNUSED(self), PyObject *Py_UNUSED(args))
+RayPy_FramePacer_step(RayPy_FramePacerObject *self, PyObject *Py_UNUSED(args))
 {
-    PollInputEvents();
-    Py_RETURN_NONE;
+    return PyBool_FromLong(RayPy_Pacer_Step(&self->p));
 }
 
-PyDoc_STRVAR(poll_input_events_doc, "Register all input events");
-
 static PyObject *
-RayPy_WaitTime(PyObject *Py_UNUSED(self), PyObject *args)
+RayPy_FramePacer_reset(RayPy_FramePacerObject *self, PyObject *Py_UNUSED(args))
 {
-    WINDOW_IS_READY();
-    double monitor = PyFloat_AsDouble(args);
-    METH_O_TYPE_ERROR(args, "float");
-    WaitTime((float)monitor);
+    self->p.deadline_ns = 0;
+    self->p.last_ns = 0;
+    self->p.frame_time = 0.0;
+    self->p.accumulator = 0.0;
+    self->p.frame_count = 0;
     Py_RETURN_NONE;
 }
 
-PyDoc_STRVAR(wait_time_doc, "Wait for some milliseconds (halt program execution)");
-
-PyObject *
-RayPy_ShowCursor(PyObject *Py_UNUSED(self), PyObject *Py_UNUSED(args))
+static PyObject *
+RayPy_FramePacer_get_target_fps(RayPy_FramePacerObject *self, void *Py_UNUSED(closure))
 {
-    WINDOW_IS_READY();
-    ShowCursor();
-    Py_RETURN_NONE;
+    return PyFloat_FromDouble(self->p.target_fps);
 }
 
-PyDoc_STRVAR(show_cursor_doc, "Shows cursor");
-
-PyObject *
-RayPy_HideCursor(PyObject *Py_UNUSED(self), PyObject *Py_UNUSED(args))
+static int
+RayPy_FramePacer_set_target_fps(RayPy_FramePacerObject *self, PyObject *value,
+                                void *Py_UNUSED(closure))
 {
-    WINDOW_IS_READY();
-    HideCursor();
-    Py_RETURN_NONE;
+    if (value == NULL) {
+        PyErr_SetString(PyExc_TypeError, "cannot delete target_fps");
+        return -1;
+    }
+    double fps = PyFloat_AsDouble(value);
+    if (fps == -1.0 && PyErr_Occurred())
+        return -1;
+    return RayPy_FramePacer_SetTargetFPS(self, fps);
 }
 
-PyDoc_STRVAR(hide_cursor_doc, "Hides cursor");
-
-PyObject *
-RayPy_IsCursorHidden(PyObject *Py_UNUSED(self), PyObject *Py_UNUSED(args))
+/* fixed_dt and max_frame_time, seconds >= 0 where 0 turns them off */
+static PyObject *
+RayPy_FramePacer_get_seconds(RayPy_FramePacerObject *self, void *closure)
 {
-    return PyBool_FromLong(IsCursorHidden());
+    return PyFloat_FromDouble(*(double *)((char *)&self->p + (size_t)closure));
 }
 
-PyDoc_STRVAR(is_cursor_hidden_doc, "Check if cursor is not visible");
-
-PyObject *
-RayPy_EnableCursor(PyObject *Py_UNUSED(self), PyObject *Py_UNUSED(args))
+static int
+RayPy_FramePacer_set_seconds(RayPy_FramePacerObject *self, PyObject *value, void *closure)
 {
-    WINDOW_IS_READY();
-    EnableCursor();
-    Py_RETURN_NONE;
+    if (value == NULL) {
+        PyErr_SetString(PyExc_TypeError, "cannot delete attribute");
+        return -1;
+    }
+    double seconds = PyFloat_AsDouble(value);
+    if (seconds == -1.0 && PyErr_Occurred())
+        return -1;
+    if (!(seconds >= 0.0 && isfinite(seconds))) {
+        PyErr_Format(PyExc_ValueError, "%s must be a finite number >= 0",
+                     (size_t)closure == offsetof(RayPy_Pacer, fixed_dt) ? "fixed_dt" : "max_frame_time");
+        return -1;
+    }
+    *(double *)((char *)&self->p + (size_t)closure) = seconds;
+    return 0;
 }
 
-PyDoc_STRVAR(enable_cursor_doc, "Enables cursor (unlock cursor)");
-
-PyObject *
-RayPy_DisableCursor(PyObject *Py_UNUSED(self), PyObject *Py_UNUSED(args))
+static PyObject *
+RayPy_FramePacer_get_spin_threshold_ns(RayPy_FramePacerObject *self, void *Py_UNUSED(closure))
 {
-    WINDOW_IS_READY();
-    DisableCursor();
-    Py_RETURN_NONE;
+    return PyLong_FromLongLong(self->p.spin_threshold_ns);
 }
 
-PyDoc_STRVAR(disable_cursor_doc, "Disables cursor (lock cursor)");
-
-PyObject *
-RayPy_IsCursorOnScreen(PyObject *Py_UNUSED(self), PyObject *Py_UNUSED(args))
+static int
+RayPy_FramePacer_set_spin_threshold_ns(RayPy_FramePacerObject *self, PyObject *value,
+                                       void *Py_UNUSED(closure))
 {
-    return PyBool_FromLong(IsCursorOnScreen());
+    if (value == NULL) {
+        PyErr_SetString(PyExc_TypeError, "cannot delete spin_threshold_ns");
+        return -1;
+    }
+    long long ns = PyLong_AsLongLong(value);
+    if (ns == -1 && PyErr_Occurred())
+        return -1;
+    if (ns < 0) {
+        PyErr_SetString(PyExc_ValueError, "spin_threshold_ns must be >= 0");
+        return -1;
+    }
+    self->p.spin_threshold_ns = ns;
+    return 0;
 }
 
-PyDoc_STRVAR(is_cursor_on_screen_doc, "Check if cursor is on the screen");
-
 static PyObject *
-RayPy_ClearBackground(PyObject *Py_UNUSED(self), PyObject *obj)
+RayPy_FramePacer_get_alpha(RayPy_FramePacerObject *self, void *Py_UNUSED(closure))
 {
-    WINDOW_IS_READY();
-    Color color = RayPy_Color_AsColor((RayPy_ColorObject *)obj);
-    METH_O_TYPE_ERROR(obj, "raypy.Color");
-    ClearBackground(color);
-    Py_RETURN_NONE;
+    return PyFloat_FromDouble(RayPy_Pacer_Alpha(&self->p));
 }
 
-PyDoc_STRVAR(clear_background_doc, "Set background color (framebuffer clear color)");
+static PyMethodDef RayPy_FramePacer_methods[] = {
+    {"wait", (PyCFunction)RayPy_FramePacer_wait, METH_NOARGS,
+     "Wait until the next frame is due and return the last frame time in seconds"},
+    {"step", (PyCFunction)RayPy_FramePacer_step, METH_NOARGS,
+     "Consume one fixed_dt from the accumulator, False when there's not enough time left"},
+    {"reset", (PyCFunction)RayPy_FramePacer_reset, METH_NOARGS,
+     "Forget the previous frame time and empty the accumulator"},
+    {NULL}
+};
+
+static PyMemberDef RayPy_FramePacer_members[] = {
+    {"frame_time", Py_T_DOUBLE, offsetof(RayPy_FramePacerObject, p.frame_time), Py_READONLY, "Time in seconds for last frame (delta time)"},
+    {"accumulator", Py_T_DOUBLE, offsetof(RayPy_FramePacerObject, p.accumulator), Py_READONLY, "Time in seconds not yet consumed by step()"},
+    {"frame_count", Py_T_ULONGLONG, offsetof(RayPy_FramePacerObject, p.frame_count), Py_READONLY, "Frames waited for since creation or reset()"},
+    {NULL}
+};
+
+static PyGetSetDef RayPy_FramePacer_getset[] = {
+    {"target_fps", (getter)RayPy_FramePacer_get_target_fps, (setter)RayPy_FramePacer_set_target_fps, "Frames per second to pace at, 0 for no limit", NULL},
+    {"alpha", (getter)RayPy_FramePacer_get_alpha, NULL, "Interpolation factor between the last two fixed steps [0.0..1.0]", NULL},
+    {"fixed_dt", (getter)RayPy_FramePacer_get_seconds, (setter)RayPy_FramePacer_set_seconds,
+     "Fixed update timestep in seconds, 0 disables the accumulator", (void *)offsetof(RayPy_Pacer, fixed_dt)},
+    {"max_frame_time", (getter)RayPy_FramePacer_get_seconds, (setter)RayPy_FramePacer_set_seconds,
+     "Longest frame time fed to the accumulator, 0 for no limit", (void *)offsetof(RayPy_Pacer, max_frame_time)},
+    {"spin_threshold_ns", (getter)RayPy_FramePacer_get_spin_threshold_ns, (setter)RayPy_FramePacer_set_spin_threshold_ns,
+     "Busy-wait this many nanoseconds before a deadline instead of sleeping", NULL},
+    {NULL}
+};
+
+static PyType_Slot RayPy_FramePacer_slots[] = {
+    {Py_tp_doc, PyDoc_STR("FramePacer, hybrid sleep/spin frame limiter with a fixed timestep accumulator")},
+    {Py_tp_new, RayPy_FramePacer_new},
+    {Py_tp_init, RayPy_FramePacer_init},
+    {Py_tp_dealloc, RayPy_FramePacer_dealloc},
+    {Py_tp_methods, RayPy_FramePacer_methods},
+    {Py_tp_members, RayPy_FramePacer_members},
+    {Py_tp_getset, RayPy_FramePacer_getset},
+    {0, NULL},
+};
 
-static PyObject *
-RayPy_BeginDrawing(PyObject *Py_UNUSED(self), PyObject *Py_UNUSED(args))
-{
-    BeginDrawing();
-    Py_RETURN_NONE;
-}
+static PyType_Spec RayPy_FramePacer_spec = {
+    .name = "raypy.FramePacer",
+    .basicsize = sizeof(RayPy_FramePacerObject),
+    .itemsize = 0,
+    .flags = Py_TPFLAGS_DEFAULT | Py_TPFLAGS_BASETYPE | Py_TPFLAGS_IMMUTABLETYPE,
+    .slots = RayPy_FramePacer_slots,
+};
 
-PyDoc_STRVAR(begin_drawing_doc, "Setup canvas (framebuffer) to start drawing");
+/* Game loop */
 
-static PyObject *
-RayPy_EndDrawing(PyObject *Py_UNUSED(self), PyObject *Py_UNUSED(args))
-{
-    EndDrawing();
-    Py_RETURN_NONE;
-}
+typedef struct {
+    double wait;
+    double update;
+    double draw;
+    double present;
+    int updates;
+} RayPy_FrameTimings;
 
-PyDoc_STRVAR(end_drawing_doc, "End canvas drawing and swap buffers (double buffering)");
+/* timings of the last frame completed by run() */
+static RayPy_FrameTimings RayPy_frame_timings = {0};
+static int RayPy_running = 0;
 
-static PyObject *
-RayPy_SetTargetFPS(PyObject *Py_UNUSED(self), PyObject *obj)
+static int
+RayPy_CallCallback(PyObject *callback, double arg)
 {
-    int fps = PyLong_AsLong(obj);
-    METH_O_TYPE_ERROR(obj, "int");
-    SetTargetFPS(fps);
-    Py_RETURN_NONE;
+    PyObject *argv[1], *res;
+    argv[0] = PyFloat_FromDouble(arg);
+    if (argv[0] == NULL)
+        return -1;
+    res = PyObject_Vectorcall(callback, argv, 1, NULL);
+    Py_DECREF(argv[0]);
+    if (res == NULL)
+        return -1;
+    Py_DECREF(res);
+    return 0;
 }
 
-PyDoc_STRVAR(set_target_fps_doc, "Set target FPS (maximum)");
-
 static PyObject *
-RayPy_GetFPS(PyObject *Py_UNUSED(self), PyObject *Py_UNUSED(args))
+RayPy_Run(PyObject *Py_UNUSED(self), PyObject *args, PyObject *keywds)
 {
-    return PyLong_FromLong(GetFPS());
+    PyObject *update = Py_None, *draw = Py_None, *fixed_dt_obj = Py_None, *clear_obj = Py_None;
+    RayPy_FramePacerObject *pacer_obj = NULL;
+    RayPy_Pacer local_pacer, *pacer = &local_pacer;
+    double saved_fixed_dt;
+    Color clear_color = {0};
+    int64_t t0, t1, t2, t3, t4;
+    static char *kwlist[] = {"update", "draw", "fixed_dt", "clear_color", "pacer", NULL};
+    if (!PyArg_ParseTupleAndKeywords(args, keywds, "|OOO$OO!", kwlist, &update, &draw,
+                                     &fixed_dt_obj, &clear_obj, &RayPy_FramePacer_Type,
+                                     &pacer_obj))
+        return NULL;
+    WINDOW_IS_READY();
+    if (update != Py_None && !PyCallable_Check(update)) {
+        PyErr_Format(PyExc_TypeError, "update must be callable or None, not %s",
+                     Py_TYPE(update)->tp_name);
+        return NULL;
+    }
+    if (draw != Py_None && !PyCallable_Check(draw)) {
+        PyErr_Format(PyExc_TypeError, "draw must be callable or None, not %s",
+                     Py_TYPE(draw)->tp_name);
+        return NULL;
+    }
+    if (clear_obj != Py_None) {
+        clear_color = RayPy_Color_AsColor((RayPy_ColorObject *)clear_obj);
+        if (PyErr_Occurred())
+            return NULL;
+    }
+    if (RayPy_running) {
+        PyErr_SetString(PyExc_RuntimeError, "run() is already running");
+        return NULL;
+    }
+
+    /* without a pacer, frame rate is limited by set_target_fps() inside EndDrawing() */
+    if (pacer_obj != NULL)
+        pacer = &pacer_obj->p;
+    else
+        RayPy_Pacer_Init(pacer, 0.0);
+    /* fixed_dt only overrides the pacer's for this run */
+    saved_fixed_dt = pacer->fixed_dt;
+    if (fixed_dt_obj != Py_None) {
+        double fixed_dt = PyFloat_AsDouble(fixed_dt_obj);
+        if (fixed_dt == -1.0 && PyErr_Occurred())
+            return NULL;
+        if (fixed_dt <= 0.0) {
+            PyErr_SetString(PyExc_ValueError, "fixed_dt must be > 0 or None");
+            return NULL;
+        }
+        pacer->fixed_dt = fixed_dt;
+    }
+
+    /* callbacks may drop their last reference to the pacer */
+    Py_XINCREF(pacer_obj);
+    RayPy_running = 1;
+    while (!WindowShouldClose()) {
+        RayPy_FrameTimings timings = {0};
+        t0 = RayPy_MonotonicNs();
+        double dt = RayPy_Pacer_Wait(pacer);
+        t1 = RayPy_MonotonicNs();
+
+        if (update != Py_None) {
+            if (pacer->fixed_dt > 0.0) {
+                while (RayPy_Pacer_Step(pacer)) {
+                    if (RayPy_CallCallback(update, pacer->fixed_dt))
+                        goto error;
+                    timings.updates++;
+                }
+            }
+            else {
+                if (RayPy_CallCallback(update, dt))
+                    goto error;
+                timings.updates++;
+            }
+        }
+        t2 = RayPy_MonotonicNs();
+
+        if (RayPy_BeginFrame()) {
+            if (clear_obj != Py_None)
+                ClearBackground(clear_color);
+            if (draw != Py_None && RayPy_CallCallback(draw, RayPy_Pacer_Alpha(pacer))) {
+                RayPy_EndFrame();
+                goto error;
+            }
+        }
+        t3 = RayPy_MonotonicNs();
+
+        RayPy_EndFrame();
+        t4 = RayPy_MonotonicNs();
+
+        timings.wait = (double)(t1 - t0) * 1e-9;
+        timings.update = (double)(t2 - t1) * 1e-9;
+        timings.draw = (double)(t3 - t2) * 1e-9;
+        timings.present = (double)(t4 - t3) * 1e-9;
+        RayPy_frame_timings = timings;
+
+        if (PyErr_CheckSignals())
+            goto error;
+    }
+    RayPy_running = 0;
+    pacer->fixed_dt = saved_fixed_dt;
+    Py_XDECREF(pacer_obj);
+    Py_RETURN_NONE;
+
+error:
+    RayPy_running = 0;
+    pacer->fixed_dt = saved_fixed_dt;
+    Py_XDECREF(pacer_obj);
+    return NULL;
 }
 
-PyDoc_STRVAR(get_fps_doc, "Get current FPS");
+PyDoc_STRVAR(run_doc,
+             "Run the game loop until the window should close: update(dt) is called once per\n"
+             "frame, or once per fixed_dt step, then draw(alpha) between BeginDrawing() and\n"
+             "EndDrawing() after clearing the background with clear_color");
 
 static PyObject *
-RayPy_GetFrameTime(PyObject *Py_UNUSED(self), PyObject *Py_UNUSED(args))
+RayPy_GetFrameTimings(PyObject *Py_UNUSED(self), PyObject *Py_UNUSED(args))
 {
-    return PyFloat_FromDouble((double)GetFrameTime());
+    RayPy_FrameTimings t = RayPy_frame_timings;
+    return Py_BuildValue("{sdsdsdsdsi}", "wait", t.wait, "update", t.update, "draw", t.draw,
+                         "present", t.present, "updates", t.updates);
 }
 
-PyDoc_STRVAR(get_frame_time_doc, "Get time in seconds for last frame drawn (delta time)");
+PyDoc_STRVAR(get_frame_timings_doc,
+             "Get time in seconds spent per phase (wait, update, draw, present) of the last "
+             "frame run() completed");
 
 static PyObject *
-RayPy_GetTime(PyObject *Py_UNUSED(self), PyObject *Py_UNUSED(args))
+RayPy_NextFrame(PyObject *Py_UNUSED(self), PyObject *args, PyObject *keywds)
 {
-    return PyFloat_FromDouble(GetTime());
+    /* asyncio is only imported once it's needed */
+    PyObject *aio = PyImport_ImportModule("raypy.aio");
+    if (aio == NULL)
+        return NULL;
+    PyObject *next_frame = PyObject_GetAttrString(aio, "next_frame");
+    Py_DECREF(aio);
+    if (next_frame == NULL)
+        return NULL;
+    PyObject *coro = PyObject_Call(next_frame, args, keywds);
+    Py_DECREF(next_frame);
+    return coro;
 }
 
-PyDoc_STRVAR(get_time_doc, "Get elapsed time in seconds since InitWindow()");
+PyDoc_STRVAR(next_frame_doc,
+             "Awaitable, yields to the asyncio event loop until the next frame is due "
+             "(see raypy.aio.next_frame)");
 
 static PyObject *
 RayPy_GetRandomValue(PyObject *Py_UNUSED(self), PyObject *args)
@@ -1252,6 +13273,7 @@ static PyObject *
 RayPy_TakeScreenshot(PyObject *Py_UNUSED(self), PyObject *obj)
 {
     Py_ssize_t len;
+    IS_RENDER_THREAD();
     const char *file_name = PyUnicode_AsUTF8AndSize(obj, &len);
     METH_O_TYPE_ERROR(obj, "str");
     TakeScreenshot(file_name);
@@ -1386,6 +13408,7 @@ RayPy_DrawFPS(PyObject *Py_UNUSED(self), PyObject *args)
     int pos_x, pos_y;
     if (!PyArg_ParseTuple(args, "ii", &pos_x, &pos_y))
         return NULL;
+    IS_RENDER_THREAD();
     DrawFPS(pos_x, pos_y);
     Py_RETURN_NONE;
 }
@@ -1402,6 +13425,7 @@ RayPy_DrawText(PyObject *Py_UNUSED(self), PyObject *args, PyObject *keywds)
     if (!PyArg_ParseTupleAndKeywords(args, keywds, "siiiO", kwlist, &text, &pos_x, &pos_y,
                                      &font_size, &color_obj))
         return NULL;
+    IS_RENDER_THREAD();
     Color color = RayPy_Color_AsColor((RayPy_ColorObject *)color_obj);
     METH_O_TYPE_ERROR(color_obj, "raypy.Color");
     DrawText(text, pos_x, pos_y, font_size, color);
@@ -1410,9 +13434,650 @@ RayPy_DrawText(PyObject *Py_UNUSED(self), PyObject *args, PyObject *keywds)
 
 PyDoc_STRVAR(draw_text_doc, "Draw text (using default font)");
 
+/* Command lists
+
+   Other threads can't call into raylib, they record draw and upload
+   commands in their own CommandList and hand them over with
+   submit_commands(), a lock-free push of the recorded buffer onto a stack
+   of batches. The render thread takes the whole stack at once in
+   replay_commands() and runs the batches in submission order. Commands
+   are packed in a byte buffer, the objects they use in an array of
+   references released once replayed. */
+
+enum {
+    RAYPY_COMMAND_CLEAR_BACKGROUND,
+    RAYPY_COMMAND_DRAW_TEXT,
+    RAYPY_COMMAND_DRAW_TEXTURE,
+    RAYPY_COMMAND_DRAW_FPS,
+    RAYPY_COMMAND_CALL,
+};
+
+typedef struct {
+    uint32_t op;
+    uint32_t size; // of the whole command, a multiple of 8
+} RayPy_CommandHeader;
+
+typedef struct {
+    int pos_x, pos_y, font_size;
+    Color color;
+    char text[]; // NUL-terminated
+} RayPy_DrawTextCommand;
+
+typedef struct {
+    Py_ssize_t texture; // in objects
+    int pos_x, pos_y;
+    Color tint;
+} RayPy_DrawTextureCommand;
+
+typedef struct {
+    Py_ssize_t func, args; // in objects
+} RayPy_CallCommand;
+
+/* recorded commands, moved as is from a CommandList into a batch */
+typedef struct {
+    unsigned char *data;
+    size_t size, capacity;
+    PyObject **objects;
+    Py_ssize_t object_count, object_capacity;
+    Py_ssize_t count;
+} RayPy_Commands;
+
+typedef struct RayPy_CommandBatch {
+    struct RayPy_CommandBatch *next;
+    long interp; // the objects belong to the interpreter that submitted them
+    RayPy_Commands commands;
+} RayPy_CommandBatch;
+
+/* submitted batches, newest first */
+static RayPy_CommandBatch *RayPy_command_queue = NULL;
+
+static void
+RayPy_Commands_Clear(RayPy_Commands *commands)
+{
+    for (Py_ssize_t i = 0; i < commands->object_count; i++)
+        Py_DECREF(commands->objects[i]);
+    PyMem_Free(commands->objects);
+    PyMem_Free(commands->data);
+    memset(commands, 0, sizeof(*commands));
+}
+
+/* Appends a command with `size` bytes of zeroed payload, returns the
+   payload or NULL with an exception set */
+static void *
+RayPy_Commands_Append(RayPy_Commands *commands, uint32_t op, size_t size)
+{
+    size_t total = (sizeof(RayPy_CommandHeader) + size + 7) & ~(size_t)7;
+    if (total > UINT32_MAX) {
+        PyErr_SetString(PyExc_OverflowError, "command is too large");
+        return NULL;
+    }
+    if (commands->size + total > commands->capacity) {
+        size_t capacity = commands->capacity ? commands->capacity * 2 : 4096;
+        while (capacity < commands->size + total)
+            capacity *= 2;
+        unsigned char *data = PyMem_Realloc(commands->data, capacity);
+        if (data == NULL) {
+            PyErr_NoMemory();
+            return NULL;
+        }
+        commands->data = data;
+        commands->capacity = capacity;
+    }
+    RayPy_CommandHeader *header = (RayPy_CommandHeader *)(commands->data + commands->size);
+    header->op = op;
+    header->size = (uint32_t)total;
+    memset(header + 1, 0, total - sizeof(*header));
+    commands->size += total;
+    commands->count++;
+    return header + 1;
+}
+
+/* Keeps a reference to obj, returns its index or -1 with an exception set */
+static Py_ssize_t
+RayPy_Commands_AddObject(RayPy_Commands *commands, PyObject *obj)
+{
+    if (commands->object_count == commands->object_capacity) {
+        Py_ssize_t capacity = commands->object_capacity ? commands->object_capacity * 2 : 64;
+        PyObject **objects = PyMem_Realloc(commands->objects, capacity * sizeof(PyObject *));
+        if (objects == NULL) {
+            PyErr_NoMemory();
+            return -1;
+        }
+        commands->objects = objects;
+        commands->object_capacity = capacity;
+    }
+    commands->objects[commands->object_count] = Py_NewRef(obj);
+    return commands->object_count++;
+}
+
+/* Drops the last command appended, when recording it failed half way */
+static void
+RayPy_Commands_Pop(RayPy_Commands *commands, void *payload)
+{
+    commands->size = (unsigned char *)payload - sizeof(RayPy_CommandHeader) - commands->data;
+    commands->count--;
+}
+
+/* Runs the commands, on the render thread with the GIL held, adding how many
+   ran to `ran`. Returns -1 with an exception set when a call fails and 1 when
+   a call ended the frame or closed the window, the commands after those don't
+   run. */
+static int
+RayPy_Commands_Replay(RayPy_Commands *commands, Py_ssize_t *ran)
+{
+    size_t offset = 0;
+    while (offset < commands->size) {
+        RayPy_CommandHeader *header = (RayPy_CommandHeader *)(commands->data + offset);
+        void *payload = header + 1;
+        offset += header->size;
+        ++*ran;
+        switch (header->op) {
+        case RAYPY_COMMAND_CLEAR_BACKGROUND:
+            ClearBackground(*(Color *)payload);
+            break;
+        case RAYPY_COMMAND_DRAW_TEXT: {
+            RayPy_DrawTextCommand *cmd = payload;
+            DrawText(cmd->text, cmd->pos_x, cmd->pos_y, cmd->font_size, cmd->color);
+            break;
+        }
+        case RAYPY_COMMAND_DRAW_TEXTURE: {
+            RayPy_DrawTextureCommand *cmd = payload;
+            RayPy_TextureObject *texture = (RayPy_TextureObject *)commands->objects[cmd->texture];
+            DrawTexture(texture->t, cmd->pos_x, cmd->pos_y, cmd->tint);
+            break;
+        }
+        case RAYPY_COMMAND_DRAW_FPS: {
+            int *pos = payload;
+            DrawFPS(pos[0], pos[1]);
+            break;
+        }
+        case RAYPY_COMMAND_CALL: {
+            RayPy_CallCommand *cmd = payload;
+            PyObject *ret = PyObject_Call(commands->objects[cmd->func], commands->objects[cmd->args], NULL);
+            if (ret == NULL)
+                return -1;
+            Py_DECREF(ret);
+            if (!IsWindowReady() || !RayPy_frame_open)
+                return 1;
+            break;
+        }
+        }
+    }
+    return 0;
+}
+
+static void
+RayPy_CommandQueue_Push(RayPy_CommandBatch *batch)
+{
+#if defined(_MSC_VER)
+    void *head;
+    do {
+        head = *(void *volatile *)&RayPy_command_queue;
+        batch->next = head;
+    } while (_InterlockedCompareExchangePointer((void *volatile *)&RayPy_command_queue, batch, head) != head);
+#else
+    RayPy_CommandBatch *head = __atomic_load_n(&RayPy_command_queue, __ATOMIC_RELAXED);
+    do
+        batch->next = head;
+    while (!__atomic_compare_exchange_n(&RayPy_command_queue, &head, batch, 1, __ATOMIC_RELEASE,
+                                        __ATOMIC_RELAXED));
+#endif
+}
+
+/* Takes every submitted batch, oldest first */
+static RayPy_CommandBatch *
+RayPy_CommandQueue_TakeAll(void)
+{
+#if defined(_MSC_VER)
+    RayPy_CommandBatch *batch = _InterlockedExchangePointer((void *volatile *)&RayPy_command_queue, NULL);
+#else
+    RayPy_CommandBatch *batch = __atomic_exchange_n(&RayPy_command_queue, NULL, __ATOMIC_ACQUIRE);
+#endif
+    RayPy_CommandBatch *oldest = NULL;
+    while (batch != NULL) {
+        RayPy_CommandBatch *next = batch->next;
+        batch->next = oldest;
+        oldest = batch;
+        batch = next;
+    }
+    return oldest;
+}
+
+/* Takes the batches the current interpreter submitted, oldest first. Those of
+   others go back in the queue, only their own interpreter may touch them. */
+static RayPy_CommandBatch *
+RayPy_CommandQueue_TakeOwn(void)
+{
+    long interp = RayPy_InterpreterId();
+    RayPy_CommandBatch *own = NULL, **tail = &own;
+    RayPy_CommandBatch *batch = RayPy_CommandQueue_TakeAll();
+    while (batch != NULL) {
+        RayPy_CommandBatch *next = batch->next;
+        if (batch->interp == interp) {
+            batch->next = NULL;
+            *tail = batch;
+            tail = &batch->next;
+        }
+        else
+            RayPy_CommandQueue_Push(batch);
+        batch = next;
+    }
+    return own;
+}
+
+static void
+RayPy_CommandQueue_Free(RayPy_CommandBatch *batch)
+{
+    while (batch != NULL) {
+        RayPy_CommandBatch *next = batch->next;
+        RayPy_Commands_Clear(&batch->commands);
+        PyMem_Free(batch);
+        batch = next;
+    }
+}
+
+/* Drops the commands of this interpreter nobody replayed, when the window closes or the module goes */
+static void
+RayPy_CommandQueue_Discard(void)
+{
+    RayPy_CommandQueue_Free(RayPy_CommandQueue_TakeOwn());
+}
+
+typedef struct {
+    PyObject_HEAD RayPy_Commands commands;
+} RayPy_CommandListObject;
+
+/* call() records functions and arguments that may refer back to the list */
+static int
+RayPy_CommandList_traverse(RayPy_CommandListObject *self, visitproc visit, void *arg)
+{
+    Py_VISIT(Py_TYPE(self));
+    for (Py_ssize_t i = 0; i < self->commands.object_count; i++)
+        Py_VISIT(self->commands.objects[i]);
+    return 0;
+}
+
+static int
+RayPy_CommandList_clear(RayPy_CommandListObject *self)
+{
+    /* the commands index the objects, they go together */
+    RayPy_Commands commands = self->commands;
+    memset(&self->commands, 0, sizeof(self->commands));
+    RayPy_Commands_Clear(&commands);
+    return 0;
+}
+
+static void
+RayPy_CommandList_dealloc(RayPy_CommandListObject *self)
+{
+    PyObject_GC_UnTrack(self);
+    RayPy_Commands_Clear(&self->commands);
+    PyTypeObject *tp = Py_TYPE(self);
+    tp->tp_free((PyObject *)self);
+    Py_DECREF(tp);
+}
+
+static Py_ssize_t
+RayPy_CommandList_length(RayPy_CommandListObject *self)
+{
+    return self->commands.count;
+}
+
+static PyObject *
+RayPy_CommandList_clear_background(RayPy_CommandListObject *self, PyObject *obj)
+{
+    Color color = RayPy_Color_AsColor((RayPy_ColorObject *)obj);
+    METH_O_TYPE_ERROR(obj, "raypy.Color");
+    Color *cmd = RayPy_Commands_Append(&self->commands, RAYPY_COMMAND_CLEAR_BACKGROUND, sizeof(Color));
+    if (cmd == NULL)
+        return NULL;
+    *cmd = color;
+    Py_RETURN_NONE;
+}
+
+static PyObject *
+RayPy_CommandList_draw_text(RayPy_CommandListObject *self, PyObject *args, PyObject *keywds)
+{
+    const char *text;
+    int pos_x, pos_y, font_size;
+    RayPy_ColorObject *color;
+    static char *kwlist[] = {"text", "pos_x", "pos_y", "font_size", "color", NULL};
+    if (!PyArg_ParseTupleAndKeywords(args, keywds, "siiiO!", kwlist, &text, &pos_x, &pos_y, &font_size,
+                                     &RayPy_Color_Type, &color))
+        return NULL;
+    size_t length = strlen(text);
+    RayPy_DrawTextCommand *cmd = RayPy_Commands_Append(&self->commands, RAYPY_COMMAND_DRAW_TEXT,
+                                                       sizeof(RayPy_DrawTextCommand) + length + 1);
+    if (cmd == NULL)
+        return NULL;
+    cmd->pos_x = pos_x;
+    cmd->pos_y = pos_y;
+    cmd->font_size = font_size;
+    cmd->color = RayPy_Color_AsColor(color);
+    memcpy(cmd->text, text, length);
+    Py_RETURN_NONE;
+}
+
+static PyObject *
+RayPy_CommandList_draw_texture(RayPy_CommandListObject *self, PyObject *args)
+{
+    PyObject *texture;
+    int pos_x, pos_y;
+    RayPy_ColorObject *tint;
+    if (!PyArg_ParseTuple(args, "O!iiO!", &RayPy_Texture_Type, &texture, &pos_x, &pos_y, &RayPy_Color_Type, &tint))
+        return NULL;
+    RayPy_DrawTextureCommand *cmd = RayPy_Commands_Append(&self->commands, RAYPY_COMMAND_DRAW_TEXTURE,
+                                                          sizeof(RayPy_DrawTextureCommand));
+    if (cmd == NULL)
+        return NULL;
+    cmd->texture = RayPy_Commands_AddObject(&self->commands, texture);
+    if (cmd->texture < 0) {
+        RayPy_Commands_Pop(&self->commands, cmd);
+        return NULL;
+    }
+    cmd->pos_x = pos_x;
+    cmd->pos_y = pos_y;
+    cmd->tint = RayPy_Color_AsColor(tint);
+    Py_RETURN_NONE;
+}
+
+static PyObject *
+RayPy_CommandList_draw_fps(RayPy_CommandListObject *self, PyObject *args)
+{
+    int pos_x, pos_y;
+    if (!PyArg_ParseTuple(args, "ii", &pos_x, &pos_y))
+        return NULL;
+    int *cmd = RayPy_Commands_Append(&self->commands, RAYPY_COMMAND_DRAW_FPS, 2 * sizeof(int));
+    if (cmd == NULL)
+        return NULL;
+    cmd[0] = pos_x;
+    cmd[1] = pos_y;
+    Py_RETURN_NONE;
+}
+
+static PyObject *
+RayPy_CommandList_call(RayPy_CommandListObject *self, PyObject *args)
+{
+    if (PyTuple_GET_SIZE(args) < 1 || !PyCallable_Check(PyTuple_GET_ITEM(args, 0))) {
+        PyErr_SetString(PyExc_TypeError, "call() takes a callable and its arguments");
+        return NULL;
+    }
+    PyObject *call_args = PyTuple_GetSlice(args, 1, PyTuple_GET_SIZE(args));
+    if (call_args == NULL)
+        return NULL;
+    RayPy_CallCommand *cmd = RayPy_Commands_Append(&self->commands, RAYPY_COMMAND_CALL, sizeof(RayPy_CallCommand));
+    if (cmd == NULL) {
+        Py_DECREF(call_args);
+        return NULL;
+    }
+    Py_ssize_t objects = self->commands.object_count;
+    cmd->func = RayPy_Commands_AddObject(&self->commands, PyTuple_GET_ITEM(args, 0));
+    cmd->args = cmd->func < 0 ? -1 : RayPy_Commands_AddObject(&self->commands, call_args);
+    Py_DECREF(call_args);
+    if (cmd->args < 0) {
+        while (self->commands.object_count > objects)
+            Py_DECREF(self->commands.objects[--self->commands.object_count]);
+        RayPy_Commands_Pop(&self->commands, cmd);
+        return NULL;
+    }
+    Py_RETURN_NONE;
+}
+
+static PyObject *
+RayPy_CommandList_clear_method(RayPy_CommandListObject *self, PyObject *Py_UNUSED(args))
+{
+    RayPy_Commands_Clear(&self->commands);
+    Py_RETURN_NONE;
+}
+
+RAYPY_LOCKED_METHOD(RayPy_CommandListObject, RayPy_CommandList_clear_background)
+RAYPY_LOCKED_METHOD(RayPy_CommandListObject, RayPy_CommandList_draw_texture)
+RAYPY_LOCKED_METHOD(RayPy_CommandListObject, RayPy_CommandList_draw_fps)
+RAYPY_LOCKED_METHOD(RayPy_CommandListObject, RayPy_CommandList_call)
+RAYPY_LOCKED_METHOD(RayPy_CommandListObject, RayPy_CommandList_clear_method)
+RAYPY_LOCKED_METHOD_KW(RayPy_CommandListObject, RayPy_CommandList_draw_text)
+
+static Py_ssize_t
+RayPy_CommandList_length_Locked(RayPy_CommandListObject *self)
+{
+    Py_ssize_t ret;
+    Py_BEGIN_CRITICAL_SECTION(self);
+    ret = RayPy_CommandList_length(self);
+    Py_END_CRITICAL_SECTION();
+    return ret;
+}
+
+static PyMethodDef RayPy_CommandList_methods[] = {
+    {"clear_background", (PyCFunction)RayPy_CommandList_clear_background_Locked, METH_O, "Record clear_background(color)"},
+    {"draw_text", (PyCFunction)(void (*)(void))RayPy_CommandList_draw_text_Locked, METH_VARARGS | METH_KEYWORDS, "Record draw_text(text, pos_x, pos_y, font_size, color)"},
+    {"draw_texture", (PyCFunction)RayPy_CommandList_draw_texture_Locked, METH_VARARGS, "Record draw_texture(texture, pos_x, pos_y, tint)"},
+    {"draw_fps", (PyCFunction)RayPy_CommandList_draw_fps_Locked, METH_VARARGS, "Record draw_fps(pos_x, pos_y)"},
+    {"call", (PyCFunction)RayPy_CommandList_call_Locked, METH_VARARGS, "Record call(func, *args), func(*args) called on the render thread, for any other draw or upload function"},
+    {"clear", (PyCFunction)RayPy_CommandList_clear_method_Locked, METH_NOARGS, "Drop the commands recorded"},
+    {NULL}
+};
+
+static PyType_Slot RayPy_CommandList_slots[] = {
+    {Py_tp_doc, PyDoc_STR("CommandList(), draw and upload commands recorded on any thread for the render thread, "
+                        "a list shared between threads keeps each command whole")},
+    {Py_tp_new, PyType_GenericNew},
+    {Py_tp_dealloc, RayPy_CommandList_dealloc},
+    {Py_tp_traverse, RayPy_CommandList_traverse},
+    {Py_tp_clear, RayPy_CommandList_clear},
+    {Py_tp_methods, RayPy_CommandList_methods},
+    {Py_sq_length, RayPy_CommandList_length_Locked},
+    {0, NULL},
+};
+
+static PyType_Spec RayPy_CommandList_spec = {
+    .name = "raypy.CommandList",
+    .basicsize = sizeof(RayPy_CommandListObject),
+    .itemsize = 0,
+    .flags = Py_TPFLAGS_DEFAULT | Py_TPFLAGS_BASETYPE | Py_TPFLAGS_HAVE_GC | Py_TPFLAGS_IMMUTABLETYPE,
+    .slots = RayPy_CommandList_slots,
+};
+
+static PyObject *
+RayPy_SubmitCommands(PyObject *Py_UNUSED(self), PyObject *args)
+{
+    RayPy_CommandListObject *list;
+    if (!PyArg_ParseTuple(args, "O!", &RayPy_CommandList_Type, &list))
+        return NULL;
+    /* commands hold objects of the interpreter recording them, only its own render thread may run them */
+    long owner = RAYPY_LOAD_LONG(&RayPy_render_interp);
+    if (owner == -1 ? RayPy_InterpreterId() != 0 : owner != RayPy_InterpreterId()) {
+        PyErr_SetString(PyExc_RuntimeError,
+                        "commands can only be submitted from the interpreter that owns the window, "
+                        "or the main one before a window is open");
+        return NULL;
+    }
+    RayPy_CommandBatch *batch = PyMem_Malloc(sizeof(RayPy_CommandBatch));
+    if (batch == NULL)
+        return PyErr_NoMemory();
+    /* another thread may be recording into the list */
+    Py_BEGIN_CRITICAL_SECTION(list);
+    batch->commands = list->commands;
+    memset(&list->commands, 0, sizeof(list->commands));
+    Py_END_CRITICAL_SECTION();
+    if (batch->commands.count == 0) {
+        PyMem_Free(batch);
+        Py_RETURN_NONE;
+    }
+    batch->interp = RayPy_InterpreterId();
+    RayPy_CommandQueue_Push(batch);
+    Py_RETURN_NONE;
+}
+
+PyDoc_STRVAR(submit_commands_doc,
+             "Hand the commands recorded in a CommandList over to the render thread, from any thread, "
+             "the list is left empty");
+
+static PyObject *
+RayPy_ReplayCommands(PyObject *Py_UNUSED(self), PyObject *Py_UNUSED(args))
+{
+    IS_RENDER_THREAD();
+    if (!RayPy_frame_open) {
+        PyErr_SetString(PyExc_RuntimeError, "replay_commands() must be called between begin_drawing() and end_drawing()");
+        return NULL;
+    }
+    RayPy_CommandBatch *batches = RayPy_CommandQueue_TakeOwn();
+    Py_ssize_t count = 0;
+    int status = 0;
+    for (RayPy_CommandBatch *batch = batches; batch != NULL && status == 0; batch = batch->next)
+        status = RayPy_Commands_Replay(&batch->commands, &count);
+    RayPy_CommandQueue_Free(batches);
+    if (status < 0)
+        return NULL;
+    return PyLong_FromSsize_t(count);
+}
+
+PyDoc_STRVAR(replay_commands_doc,
+             "Run the commands submitted since the last call in submission order, on the render thread while "
+             "drawing, returns how many ran. A failing call raises and drops the commands after it, so does a call "
+             "ending the frame or closing the window, without raising");
+
+static PyObject *
+RayPy_IsRenderThread(PyObject *Py_UNUSED(self), PyObject *Py_UNUSED(args))
+{
+    unsigned long render_thread = RAYPY_LOAD_LONG(&RayPy_render_thread);
+    return PyBool_FromLong(render_thread != 0 && !RayPy_OffRenderThread());
+}
+
+PyDoc_STRVAR(is_render_thread_doc,
+             "Check if this thread and interpreter called init_window() and can call into raylib");
+
 static PyMethodDef raypymethods[] = {
     {"unload_texture", (PyCFunction)RayPy_UnloadTexture, METH_VARARGS, set_window_position_doc},
     {"load_texture", (PyCFunction)RayPy_LoadTexture, METH_VARARGS, set_window_position_doc},
+    {"load_texture_from_image", (PyCFunction)RayPy_LoadTextureFromImage, METH_VARARGS, load_texture_from_image_doc},
+    {"gen_texture_mipmaps", (PyCFunction)RayPy_GenTextureMipmaps, METH_VARARGS, gen_texture_mipmaps_doc},
+    {"set_texture_filter", (PyCFunction)RayPy_SetTextureFilter, METH_VARARGS, set_texture_filter_doc},
+    {"set_texture_wrap", (PyCFunction)RayPy_SetTextureWrap, METH_VARARGS, set_texture_wrap_doc},
+    {"load_image", (PyCFunction)RayPy_LoadImage, METH_VARARGS, load_image_doc},
+    {"load_image_from_memory", (PyCFunction)RayPy_LoadImageFromMemory, METH_VARARGS, load_image_from_memory_doc},
+    {"unload_image", (PyCFunction)RayPy_UnloadImage, METH_VARARGS, unload_image_doc},
+    {"gen_image_color", (PyCFunction)RayPy_GenImageColor, METH_VARARGS, gen_image_color_doc},
+    {"image_copy", (PyCFunction)RayPy_ImageCopy, METH_VARARGS, image_copy_doc},
+    {"image_resize", (PyCFunction)RayPy_ImageResize, METH_VARARGS, image_resize_doc},
+    {"image_resize_bilinear", (PyCFunction)RayPy_ImageResizeBilinear, METH_VARARGS, image_resize_bilinear_doc},
+    {"image_resize_nn", (PyCFunction)RayPy_ImageResizeNN, METH_VARARGS, image_resize_nn_doc},
+    {"image_crop", (PyCFunction)RayPy_ImageCrop, METH_VARARGS, image_crop_doc},
+    {"image_flip_vertical", (PyCFunction)RayPy_ImageFlipVertical, METH_VARARGS, image_flip_vertical_doc},
+    {"image_flip_horizontal", (PyCFunction)RayPy_ImageFlipHorizontal, METH_VARARGS, image_flip_horizontal_doc},
+    {"image_rotate", (PyCFunction)RayPy_ImageRotate, METH_VARARGS, image_rotate_doc},
+    {"image_rotate_cw", (PyCFunction)RayPy_ImageRotateCW, METH_VARARGS, image_rotate_cw_doc},
+    {"image_rotate_ccw", (PyCFunction)RayPy_ImageRotateCCW, METH_VARARGS, image_rotate_ccw_doc},
+    {"image_color_tint", (PyCFunction)RayPy_ImageColorTint, METH_VARARGS, image_color_tint_doc},
+    {"image_alpha_premultiply", (PyCFunction)RayPy_ImageAlphaPremultiply, METH_VARARGS, image_alpha_premultiply_doc},
+    {"image_format", (PyCFunction)RayPy_ImageFormat, METH_VARARGS, image_format_doc},
+    {"image_blur_gaussian", (PyCFunction)RayPy_ImageBlurGaussian, METH_VARARGS, image_blur_gaussian_doc},
+    {"image_mipmaps", (PyCFunction)RayPy_ImageMipmaps, METH_VARARGS, image_mipmaps_doc},
+    {"set_worker_threads", (PyCFunction)RayPy_SetWorkerThreads, METH_O, set_worker_threads_doc},
+    {"get_worker_threads", (PyCFunction)RayPy_GetWorkerThreads, METH_NOARGS, get_worker_threads_doc},
+    {"load_image_compressed", (PyCFunction)RayPy_LoadImageCompressed, METH_VARARGS, load_image_compressed_doc},
+    {"load_texture_compressed", (PyCFunction)RayPy_LoadTextureCompressed, METH_VARARGS, load_texture_compressed_doc},
+    {"is_texture_format_supported", (PyCFunction)RayPy_IsTextureFormatSupported, METH_O, is_texture_format_supported_doc},
+    {"image_compress", (PyCFunction)RayPy_ImageCompress, METH_VARARGS, image_compress_doc},
+    {"export_image_compressed", (PyCFunction)RayPy_ExportImageCompressed, METH_VARARGS, export_image_compressed_doc},
+    {"check_collision_recs", (PyCFunction)RayPy_CheckCollisionRecs, METH_VARARGS, check_collision_recs_doc},
+    {"check_collision_circles", (PyCFunction)RayPy_CheckCollisionCircles, METH_VARARGS, check_collision_circles_doc},
+    {"check_collision_circle_rec", (PyCFunction)RayPy_CheckCollisionCircleRec, METH_VARARGS, check_collision_circle_rec_doc},
+    {"check_collision_point_rec", (PyCFunction)RayPy_CheckCollisionPointRec, METH_VARARGS, check_collision_point_rec_doc},
+    {"check_collision_point_circle", (PyCFunction)RayPy_CheckCollisionPointCircle, METH_VARARGS, check_collision_point_circle_doc},
+    {"get_collision_rec", (PyCFunction)RayPy_GetCollisionRec, METH_VARARGS, get_collision_rec_doc},
+    {"begin_mode_2d", (PyCFunction)RayPy_BeginMode2D, METH_VARARGS, begin_mode_2d_doc},
+    {"end_mode_2d", (PyCFunction)RayPy_EndMode2D, METH_NOARGS, end_mode_2d_doc},
+    {"get_screen_to_world_2d", (PyCFunction)RayPy_GetScreenToWorld2D, METH_VARARGS, get_screen_to_world_2d_doc},
+    {"get_world_to_screen_2d", (PyCFunction)RayPy_GetWorldToScreen2D, METH_VARARGS, get_world_to_screen_2d_doc},
+    {"set_cull_rect", (PyCFunction)RayPy_SetCullRect, METH_O, set_cull_rect_doc},
+    {"get_cull_stats", (PyCFunction)RayPy_GetCullStats, METH_NOARGS, get_cull_stats_doc},
+    {"draw_texture_batch", (PyCFunction)(void (*)(void))RayPy_DrawTextureBatch, METH_VARARGS | METH_KEYWORDS, draw_texture_batch_doc},
+    {"begin_mode_3d", (PyCFunction)RayPy_BeginMode3D, METH_VARARGS, begin_mode_3d_doc},
+    {"end_mode_3d", (PyCFunction)RayPy_EndMode3D, METH_NOARGS, end_mode_3d_doc},
+    {"update_camera", (PyCFunction)RayPy_UpdateCamera, METH_VARARGS, update_camera_doc},
+    {"draw_grid", (PyCFunction)RayPy_DrawGrid, METH_VARARGS, draw_grid_doc},
+    {"upload_mesh", (PyCFunction)RayPy_UploadMesh, METH_VARARGS, upload_mesh_doc},
+    {"update_mesh_buffer", (PyCFunction)RayPy_UpdateMeshBuffer, METH_VARARGS, update_mesh_buffer_doc},
+    {"unload_mesh", (PyCFunction)RayPy_UnloadMesh, METH_VARARGS, unload_mesh_doc},
+    {"gen_mesh_plane", (PyCFunction)RayPy_GenMeshPlane, METH_VARARGS, gen_mesh_plane_doc},
+    {"gen_mesh_cube", (PyCFunction)RayPy_GenMeshCube, METH_VARARGS, gen_mesh_cube_doc},
+    {"load_model", (PyCFunction)RayPy_LoadModel, METH_VARARGS, load_model_doc},
+    {"load_model_from_mesh", (PyCFunction)RayPy_LoadModelFromMesh, METH_VARARGS, load_model_from_mesh_doc},
+    {"unload_model", (PyCFunction)RayPy_UnloadModel, METH_VARARGS, unload_model_doc},
+    {"draw_model", (PyCFunction)RayPy_DrawModel, METH_VARARGS, draw_model_doc},
+    {"draw_model_wires", (PyCFunction)RayPy_DrawModelWires, METH_VARARGS, draw_model_wires_doc},
+    {"set_model_texture", (PyCFunction)RayPy_SetModelTexture, METH_VARARGS, set_model_texture_doc},
+    {"load_material_default", (PyCFunction)RayPy_LoadMaterialDefault, METH_NOARGS, load_material_default_doc},
+    {"get_model_material", (PyCFunction)RayPy_GetModelMaterial, METH_VARARGS, get_model_material_doc},
+    {"set_material_texture", (PyCFunction)RayPy_SetMaterialTexture, METH_VARARGS, set_material_texture_doc},
+    {"load_instance_buffer", (PyCFunction)RayPy_LoadInstanceBuffer, METH_VARARGS, load_instance_buffer_doc},
+    {"update_instance_buffer", (PyCFunction)RayPy_UpdateInstanceBuffer, METH_VARARGS, update_instance_buffer_doc},
+    {"unload_instance_buffer", (PyCFunction)RayPy_UnloadInstanceBuffer, METH_VARARGS, unload_instance_buffer_doc},
+    {"draw_mesh_instanced", (PyCFunction)RayPy_DrawMeshInstanced, METH_VARARGS, draw_mesh_instanced_doc},
+    {"draw_tilemap", (PyCFunction)RayPy_DrawTilemap, METH_VARARGS, draw_tilemap_doc},
+    {"unload_tilemap", (PyCFunction)RayPy_UnloadTilemap, METH_VARARGS, unload_tilemap_doc},
+    {"draw_particles", (PyCFunction)RayPy_DrawParticles, METH_VARARGS, draw_particles_doc},
+    {"load_shader", (PyCFunction)RayPy_LoadShader, METH_VARARGS, load_shader_doc},
+    {"load_shader_from_memory", (PyCFunction)RayPy_LoadShaderFromMemory, METH_VARARGS, load_shader_from_memory_doc},
+    {"unload_shader", (PyCFunction)RayPy_UnloadShader, METH_VARARGS, unload_shader_doc},
+    {"begin_shader_mode", (PyCFunction)RayPy_BeginShaderMode, METH_VARARGS, begin_shader_mode_doc},
+    {"end_shader_mode", (PyCFunction)RayPy_EndShaderMode, METH_NOARGS, end_shader_mode_doc},
+    {"set_material_shader", (PyCFunction)RayPy_SetMaterialShader, METH_VARARGS, set_material_shader_doc},
+    {"init_audio_device", (PyCFunction)RayPy_InitAudioDevice, METH_NOARGS, init_audio_device_doc},
+    {"close_audio_device", (PyCFunction)RayPy_CloseAudioDevice, METH_NOARGS, close_audio_device_doc},
+    {"is_audio_device_ready", (PyCFunction)RayPy_IsAudioDeviceReady, METH_NOARGS, is_audio_device_ready_doc},
+    {"set_master_volume", (PyCFunction)RayPy_SetMasterVolume, METH_VARARGS, set_master_volume_doc},
+    {"load_sound", (PyCFunction)RayPy_LoadSound, METH_VARARGS, load_sound_doc},
+    {"unload_sound", (PyCFunction)RayPy_UnloadSound, METH_VARARGS, unload_sound_doc},
+    {"play_sound", (PyCFunction)RayPy_PlaySound, METH_VARARGS, play_sound_doc},
+    {"stop_sound", (PyCFunction)RayPy_StopSound, METH_VARARGS, stop_sound_doc},
+    {"pause_sound", (PyCFunction)RayPy_PauseSound, METH_VARARGS, pause_sound_doc},
+    {"resume_sound", (PyCFunction)RayPy_ResumeSound, METH_VARARGS, resume_sound_doc},
+    {"is_sound_playing", (PyCFunction)RayPy_IsSoundPlaying, METH_VARARGS, is_sound_playing_doc},
+    {"set_sound_volume", (PyCFunction)RayPy_SetSoundVolume, METH_VARARGS, set_sound_volume_doc},
+    {"set_sound_pitch", (PyCFunction)RayPy_SetSoundPitch, METH_VARARGS, set_sound_pitch_doc},
+    {"set_sound_pan", (PyCFunction)RayPy_SetSoundPan, METH_VARARGS, set_sound_pan_doc},
+    {"load_music_stream", (PyCFunction)RayPy_LoadMusicStream, METH_VARARGS, load_music_stream_doc},
+    {"unload_music_stream", (PyCFunction)RayPy_UnloadMusicStream, METH_VARARGS, unload_music_stream_doc},
+    {"play_music_stream", (PyCFunction)RayPy_PlayMusicStream, METH_VARARGS, play_music_stream_doc},
+    {"is_music_stream_playing", (PyCFunction)RayPy_IsMusicStreamPlaying, METH_VARARGS, is_music_stream_playing_doc},
+    {"update_music_stream", (PyCFunction)RayPy_UpdateMusicStream, METH_VARARGS, update_music_stream_doc},
+    {"stop_music_stream", (PyCFunction)RayPy_StopMusicStream, METH_VARARGS, stop_music_stream_doc},
+    {"pause_music_stream", (PyCFunction)RayPy_PauseMusicStream, METH_VARARGS, pause_music_stream_doc},
+    {"resume_music_stream", (PyCFunction)RayPy_ResumeMusicStream, METH_VARARGS, resume_music_stream_doc},
+    {"seek_music_stream", (PyCFunction)RayPy_SeekMusicStream, METH_VARARGS, seek_music_stream_doc},
+    {"set_music_volume", (PyCFunction)RayPy_SetMusicVolume, METH_VARARGS, set_music_volume_doc},
+    {"set_music_pitch", (PyCFunction)RayPy_SetMusicPitch, METH_VARARGS, set_music_pitch_doc},
+    {"set_music_pan", (PyCFunction)RayPy_SetMusicPan, METH_VARARGS, set_music_pan_doc},
+    {"get_music_time_length", (PyCFunction)RayPy_GetMusicTimeLength, METH_VARARGS, get_music_time_length_doc},
+    {"get_music_time_played", (PyCFunction)RayPy_GetMusicTimePlayed, METH_VARARGS, get_music_time_played_doc},
+    {"load_audio_stream", (PyCFunction)RayPy_LoadAudioStream, METH_VARARGS, load_audio_stream_doc},
+    {"unload_audio_stream", (PyCFunction)RayPy_UnloadAudioStream, METH_VARARGS, unload_audio_stream_doc},
+    {"update_audio_stream", (PyCFunction)RayPy_UpdateAudioStream, METH_VARARGS, update_audio_stream_doc},
+    {"queue_audio_stream", (PyCFunction)RayPy_QueueAudioStream, METH_VARARGS, queue_audio_stream_doc},
+    {"is_audio_stream_processed", (PyCFunction)RayPy_IsAudioStreamProcessed, METH_VARARGS, is_audio_stream_processed_doc},
+    {"play_audio_stream", (PyCFunction)RayPy_PlayAudioStream, METH_VARARGS, play_audio_stream_doc},
+    {"pause_audio_stream", (PyCFunction)RayPy_PauseAudioStream, METH_VARARGS, pause_audio_stream_doc},
+    {"resume_audio_stream", (PyCFunction)RayPy_ResumeAudioStream, METH_VARARGS, resume_audio_stream_doc},
+    {"is_audio_stream_playing", (PyCFunction)RayPy_IsAudioStreamPlaying, METH_VARARGS, is_audio_stream_playing_doc},
+    {"stop_audio_stream", (PyCFunction)RayPy_StopAudioStream, METH_VARARGS, stop_audio_stream_doc},
+    {"set_audio_stream_volume", (PyCFunction)RayPy_SetAudioStreamVolume, METH_VARARGS, set_audio_stream_volume_doc},
+    {"set_audio_stream_pitch", (PyCFunction)RayPy_SetAudioStreamPitch, METH_VARARGS, set_audio_stream_pitch_doc},
+    {"set_audio_stream_pan", (PyCFunction)RayPy_SetAudioStreamPan, METH_VARARGS, set_audio_stream_pan_doc},
+    {"set_audio_stream_buffer_size_default", (PyCFunction)RayPy_SetAudioStreamBufferSizeDefault, METH_VARARGS, set_audio_stream_buffer_size_default_doc},
+    {"load_wave", (PyCFunction)RayPy_LoadWave, METH_VARARGS, load_wave_doc},
+    {"load_wave_from_memory", (PyCFunction)RayPy_LoadWaveFromMemory, METH_VARARGS, load_wave_from_memory_doc},
+    {"unload_wave", (PyCFunction)RayPy_UnloadWave, METH_VARARGS, unload_wave_doc},
+    {"wave_copy", (PyCFunction)RayPy_WaveCopy, METH_VARARGS, wave_copy_doc},
+    {"wave_format", (PyCFunction)RayPy_WaveFormat, METH_VARARGS, wave_format_doc},
+    {"export_wave", (PyCFunction)RayPy_ExportWave, METH_VARARGS, export_wave_doc},
+    {"load_sound_from_wave", (PyCFunction)RayPy_LoadSoundFromWave, METH_VARARGS, load_sound_from_wave_doc},
+    {"_audio_mix", (PyCFunction)RayPy_AudioMix, METH_VARARGS, _audio_mix_doc},
+    {"_audio_resample", (PyCFunction)RayPy_AudioResample, METH_VARARGS, _audio_resample_doc},
+    {"_audio_convert", (PyCFunction)RayPy_AudioConvert, METH_VARARGS, _audio_convert_doc},
+    {"vfs_mount", (PyCFunction)RayPy_VfsMount, METH_VARARGS, vfs_mount_doc},
+    {"vfs_unmount", (PyCFunction)RayPy_VfsUnmount, METH_VARARGS, vfs_unmount_doc},
+    {"vfs_read_file", (PyCFunction)RayPy_VfsReadFile, METH_VARARGS, vfs_read_file_doc},
     {"draw_texture", (PyCFunction)RayPy_DrawTexture, METH_FASTCALL, set_window_position_doc},
 
     {"init_window", (PyCFunction)RayPy_InitWindow, METH_VARARGS, init_window_doc},
@@ -1455,8 +14120,12 @@ static PyMethodDef raypymethods[] = {
     {"get_monitor_name", (PyCFunction)RayPy_GetMonitorName, METH_O, get_monitor_name_doc},
     {"set_clipboard_text", (PyCFunction)RayPy_SetClipboardText, METH_O, set_clipboard_text_doc},
     {"get_clipboard_text", (PyCFunction)RayPy_GetClipboardText, METH_NOARGS, get_clipboard_text_doc},
+    {"enable_event_waiting", (PyCFunction)RayPy_EnableEventWaiting, METH_NOARGS, enable_event_waiting_doc},
+    {"disable_event_waiting", (PyCFunction)RayPy_DisableEventWaiting, METH_NOARGS, disable_event_waiting_doc},
+    {"is_event_waiting", (PyCFunction)RayPy_IsEventWaiting, METH_NOARGS, is_event_waiting_doc},
     {"swap_screen_buffer", (PyCFunction)RayPy_SwapScreenBuffer, METH_NOARGS, swap_screen_buffer_doc},
     {"poll_input_events", (PyCFunction)RayPy_PollInputEvents, METH_NOARGS, poll_input_events_doc},
+    {"has_input_events", (PyCFunction)RayPy_HasInputEvents, METH_NOARGS, has_input_events_doc},
     {"wait_time", (PyCFunction)RayPy_WaitTime, METH_O, wait_time_doc},
     {"show_cursor", (PyCFunction)RayPy_ShowCursor, METH_NOARGS, show_cursor_doc},
     {"hide_cursor", (PyCFunction)RayPy_HideCursor, METH_NOARGS, hide_cursor_doc},
@@ -1468,9 +14137,23 @@ static PyMethodDef raypymethods[] = {
     {"begin_drawing", (PyCFunction)RayPy_BeginDrawing, METH_NOARGS, begin_drawing_doc},
     {"end_drawing", (PyCFunction)RayPy_EndDrawing, METH_NOARGS, end_drawing_doc},
     {"set_target_fps", (PyCFunction)RayPy_SetTargetFPS, METH_O, set_target_fps_doc},
+    {"get_target_fps", (PyCFunction)RayPy_GetTargetFPS, METH_NOARGS, get_target_fps_doc},
+    {"enable_frame_export", (PyCFunction)(void (*)(void))RayPy_EnableFrameExport, METH_VARARGS | METH_KEYWORDS, enable_frame_export_doc},
+    {"disable_frame_export", (PyCFunction)RayPy_DisableFrameExport, METH_NOARGS, disable_frame_export_doc},
+    {"is_frame_export_enabled", (PyCFunction)RayPy_IsFrameExportEnabled, METH_NOARGS, is_frame_export_enabled_doc},
+    {"enable_render_on_demand", (PyCFunction)RayPy_EnableRenderOnDemand, METH_NOARGS, enable_render_on_demand_doc},
+    {"disable_render_on_demand", (PyCFunction)RayPy_DisableRenderOnDemand, METH_NOARGS, disable_render_on_demand_doc},
+    {"is_render_on_demand", (PyCFunction)RayPy_IsRenderOnDemand, METH_NOARGS, is_render_on_demand_doc},
+    {"request_redraw", (PyCFunction)(void (*)(void))RayPy_RequestRedraw, METH_FASTCALL, request_redraw_doc},
+    {"is_redraw_requested", (PyCFunction)RayPy_IsRedrawRequested, METH_NOARGS, is_redraw_requested_doc},
+    {"get_dirty_rect", (PyCFunction)RayPy_GetDirtyRect, METH_NOARGS, get_dirty_rect_doc},
     {"get_fps", (PyCFunction)RayPy_GetFPS, METH_NOARGS, get_fps_doc},
     {"get_frame_time", (PyCFunction)RayPy_GetFrameTime, METH_NOARGS, get_frame_time_doc},
     {"get_time", (PyCFunction)RayPy_GetTime, METH_NOARGS, get_time_doc},
+    {"get_time_ns", (PyCFunction)RayPy_GetTimeNs, METH_NOARGS, get_time_ns_doc},
+    {"run", (PyCFunction)(void (*)(void))RayPy_Run, METH_VARARGS | METH_KEYWORDS, run_doc},
+    {"get_frame_timings", (PyCFunction)RayPy_GetFrameTimings, METH_NOARGS, get_frame_timings_doc},
+    {"next_frame", (PyCFunction)(void (*)(void))RayPy_NextFrame, METH_VARARGS | METH_KEYWORDS, next_frame_doc},
     {"get_random_value", (PyCFunction)RayPy_GetRandomValue, METH_VARARGS, get_random_value_doc},
     {"set_random_seed", (PyCFunction)RayPy_SetRandomSeed, METH_O, set_random_seed_doc},
     {"take_screenshot", (PyCFunction)RayPy_TakeScreenshot, METH_O, take_screenshot_doc},
@@ -1485,6 +14168,9 @@ static PyMethodDef raypymethods[] = {
     {"set_exit_key", (PyCFunction)RayPy_SetExitKey, METH_O, set_exit_key_doc},
     {"get_key_pressed", (PyCFunction)RayPy_GetKeyPressed, METH_NOARGS, get_key_pressed_doc},
     {"get_char_pressed", (PyCFunction)RayPy_GetCharPressed, METH_NOARGS, get_char_pressed_doc},
+    {"submit_commands", (PyCFunction)RayPy_SubmitCommands, METH_VARARGS, submit_commands_doc},
+    {"replay_commands", (PyCFunction)RayPy_ReplayCommands, METH_NOARGS, replay_commands_doc},
+    {"is_render_thread", (PyCFunction)RayPy_IsRenderThread, METH_NOARGS, is_render_thread_doc},
     {"draw_fps", (PyCFunction)RayPy_DrawFPS, METH_VARARGS, draw_fps_doc},
     {"draw_text", (PyCFunction)(void (*)(void))RayPy_DrawText, METH_VARARGS | METH_KEYWORDS, draw_text_doc},
     {NULL, NULL, 0, NULL}};
@@ -1492,24 +14178,88 @@ static PyMethodDef raypymethods[] = {
 #define RayPyModule_AddColorMacro(m, c) (PyModule_AddObject((m), #c, PyObject_CallFunction((PyObject *)&RayPy_Color_Type, "bbbb", (c).r, (c).g, (c).b, (c).a)))
 #define RayPyModule_AddDoubleMacro(m, d) (PyModule_AddObject((m), #d, PyFloat_FromDouble((d))))
 
+/* Module instances alive across all interpreters, the last one freed stops the worker threads */
+static long RayPy_modules = 0;
+
+/* Allocates the process-wide locks once, for whichever thread imports the
+   module first, the others wait for it to finish */
+static int
+RayPy_Locks_Init(void)
+{
+    static long state = 0; // 0: not done, 1: in progress, 2: done
+    if (RAYPY_LOAD_LONG(&state) == 2)
+        return 0;
+    if (!RAYPY_CAS_LONG(&state, 0, 1)) {
+        while (RAYPY_LOAD_LONG(&state) != 2)
+            RAYPY_CPU_RELAX();
+        return 0;
+    }
+    RayPy_audio.lock = PyThread_allocate_lock();
+    RayPy_audio.stopped = PyThread_allocate_lock();
+    RayPy_audio.queue = PyThread_allocate_lock();
+    RayPy_audio.device = PyThread_allocate_lock();
+    RayPy_vfs.lock = PyThread_allocate_lock();
+    if (RayPy_audio.lock == NULL || RayPy_audio.stopped == NULL || RayPy_audio.queue == NULL
+        || RayPy_audio.device == NULL || RayPy_vfs.lock == NULL) {
+        PyThread_type_lock *locks[] = {&RayPy_audio.lock, &RayPy_audio.stopped, &RayPy_audio.queue,
+                                       &RayPy_audio.device, &RayPy_vfs.lock};
+        for (size_t i = 0; i < sizeof(locks) / sizeof(locks[0]); i++) {
+            if (*locks[i] != NULL)
+                PyThread_free_lock(*locks[i]);
+            *locks[i] = NULL;
+        }
+        RAYPY_STORE_LONG(&state, 0);
+        PyErr_NoMemory();
+        return -1;
+    }
+    PyThread_acquire_lock(RayPy_audio.stopped, WAIT_LOCK);
+    /* process-wide like the window, later imports in subinterpreters keep it */
+    RayPy_time_base_ns = RayPy_MonotonicNs();
+    RAYPY_STORE_LONG(&state, 2);
+    return 0;
+}
+
+/* Creates the types, or shares those of the module imported first in this
+   interpreter so objects from either pass the other's type checks */
+static int
+RayPy_State_Init(PyObject *m, RayPy_State *state)
+{
+    PyObject *dict = PyInterpreterState_GetDict(PyInterpreterState_Get());
+    if (dict == NULL) {
+        PyErr_SetString(PyExc_RuntimeError, "interpreter has no state dict");
+        return -1;
+    }
+    PyObject *first = PyDict_GetItemString(dict, RAYPY_STATE_KEY);
+    if (first != NULL) {
+        RayPy_State *shared = PyModule_GetState(first);
+#define RAYPY_SHARE_TYPE(name) state->name##_Type = (PyTypeObject *)Py_NewRef(shared->name##_Type);
+        RAYPY_TYPES(RAYPY_SHARE_TYPE)
+#undef RAYPY_SHARE_TYPE
+        return 0;
+    }
+#define RAYPY_NEW_TYPE(name)                                                                         \
+    state->name##_Type = (PyTypeObject *)PyType_FromModuleAndSpec(m, &RayPy_##name##_spec, NULL); \
+    if (state->name##_Type == NULL)                                                                  \
+        return -1;
+    RAYPY_TYPES(RAYPY_NEW_TYPE)
+#undef RAYPY_NEW_TYPE
+    return PyDict_SetItemString(dict, RAYPY_STATE_KEY, m);
+}
+
 static int
 RayPy_exec(PyObject *m)
 {
-#define PASTER(x,y) x ## _ ## y
-#define EVALUATOR(x,y)  PASTER(x,y)
-#define TYPENAME(name) EVALUATOR(RayPy, EVALUATOR(name, Type))
+    RayPy_State *state = PyModule_GetState(m);
+    /* counted before anything can fail, RayPy_free() runs for failed imports too */
+    RAYPY_ADD_LONG(&RayPy_modules, 1);
+    if (RayPy_Locks_Init() || RayPy_State_Init(m, state))
+        goto error;
 
 #define ADD_TYPE_ALIAS(type, name) \
-    if (PyModule_AddObject(m, name, (PyObject *)&TYPENAME(type))) { \
-        Py_DECREF(&TYPENAME(type)); \
-        goto error; \
-    } 
-
-#define ADD_TYPE(type) \
-    if (PyType_Ready(&TYPENAME(type))) goto error; \
-    Py_INCREF(&TYPENAME(type)); \
-    ADD_TYPE_ALIAS(type, #type)
-    
+    if (PyModule_AddObjectRef(m, name, (PyObject *)state->type##_Type)) goto error;
+
+#define ADD_TYPE(type) ADD_TYPE_ALIAS(type, #type)
+
     if (PyModule_AddStringMacro(m, RAYLIB_VERSION)) goto error;
     if (PyModule_AddIntMacro(m, RAYLIB_VERSION_MAJOR)) goto error;
     if (PyModule_AddIntMacro(m, RAYLIB_VERSION_MINOR)) goto error;
@@ -1528,9 +14278,28 @@ RayPy_exec(PyObject *m)
     ADD_TYPE(Color);
     ADD_TYPE(Rectangle);
     ADD_TYPE(Image);
+    ADD_TYPE(ImagePipeline);
     ADD_TYPE(Texture);
     ADD_TYPE_ALIAS(Texture, "Texture2D")
     ADD_TYPE_ALIAS(Texture, "TextureCubemap")
+    ADD_TYPE(TextureCache);
+    ADD_TYPE(FramePacer);
+    ADD_TYPE(SpatialIndex);
+    ADD_TYPE(Camera2D);
+    ADD_TYPE(Camera3D);
+    ADD_TYPE_ALIAS(Camera3D, "Camera")
+    ADD_TYPE(Mesh);
+    ADD_TYPE(Model);
+    ADD_TYPE(Material);
+    ADD_TYPE(InstanceBuffer);
+    ADD_TYPE(Shader);
+    ADD_TYPE(Tilemap);
+    ADD_TYPE(ParticleSystem);
+    ADD_TYPE(Sound);
+    ADD_TYPE(Music);
+    ADD_TYPE(AudioStream);
+    ADD_TYPE(Wave);
+    ADD_TYPE(CommandList);
 
     /* Basic Colors */
     if (RayPyModule_AddColorMacro(m, LIGHTGRAY)) goto error;
@@ -1884,6 +14653,14 @@ RayPy_exec(PyObject *m)
     // Camera projection
     if (PyModule_AddIntMacro(m, CAMERA_PERSPECTIVE)) goto error;
     if (PyModule_AddIntMacro(m, CAMERA_ORTHOGRAPHIC)) goto error;
+    // Mesh vertex buffers, for update_mesh_buffer()
+    if (PyModule_AddIntConstant(m, "MESH_BUFFER_VERTICES", RAYPY_MESH_BUFFER_VERTICES)) goto error;
+    if (PyModule_AddIntConstant(m, "MESH_BUFFER_TEXCOORDS", RAYPY_MESH_BUFFER_TEXCOORDS)) goto error;
+    if (PyModule_AddIntConstant(m, "MESH_BUFFER_NORMALS", RAYPY_MESH_BUFFER_NORMALS)) goto error;
+    if (PyModule_AddIntConstant(m, "MESH_BUFFER_COLORS", RAYPY_MESH_BUFFER_COLORS)) goto error;
+    if (PyModule_AddIntConstant(m, "MESH_BUFFER_TANGENTS", RAYPY_MESH_BUFFER_TANGENTS)) goto error;
+    if (PyModule_AddIntConstant(m, "MESH_BUFFER_TEXCOORDS2", RAYPY_MESH_BUFFER_TEXCOORDS2)) goto error;
+    if (PyModule_AddIntConstant(m, "MESH_BUFFER_INDICES", RAYPY_MESH_BUFFER_INDICES)) goto error;
     // N-patch layout
     if (PyModule_AddIntMacro(m, NPATCH_NINE_PATCH)) goto error;
     if (PyModule_AddIntMacro(m, NPATCH_THREE_PATCH_VERTICAL)) goto error;
@@ -1896,16 +14673,51 @@ error:
     return -1;
 }
 
+static int
+RayPy_traverse(PyObject *m, visitproc visit, void *arg)
+{
+    RayPy_State *state = PyModule_GetState(m);
+#define RAYPY_VISIT_TYPE(name) Py_VISIT(state->name##_Type);
+    RAYPY_TYPES(RAYPY_VISIT_TYPE)
+#undef RAYPY_VISIT_TYPE
+    return 0;
+}
+
 int
-RayPy_clear(PyObject *Py_UNUSED(self))
+RayPy_clear(PyObject *m)
 {
-    if (IsWindowReady())
+    RayPy_State *state = PyModule_GetState(m);
+    /* only the interpreter that owns the window or the audio device closes them */
+    if (IsWindowReady() && RAYPY_LOAD_LONG(&RayPy_render_interp) == RayPy_InterpreterId()) {
+        RayPy_Redraw_Reset();
+        RayPy_FrameExport_Close();
+        RayPy_GL_ReleaseQueued(1);
         CloseWindow();
+        RAYPY_STORE_LONG(&RayPy_render_interp, -1);
+        RAYPY_STORE_LONG(&RayPy_render_thread, 0);
+    }
+    RayPy_CommandQueue_Discard();
+    RayPy_Audio_Release();
+#define RAYPY_CLEAR_TYPE(name) Py_CLEAR(state->name##_Type);
+    RAYPY_TYPES(RAYPY_CLEAR_TYPE)
+#undef RAYPY_CLEAR_TYPE
     return 0;
 }
 
+static void
+RayPy_free(void *m)
+{
+    RayPy_clear((PyObject *)m);
+    if (RAYPY_ADD_LONG(&RayPy_modules, -1) == 0)
+        RayPy_Pool_Stop();
+}
+
 static struct PyModuleDef_Slot RayPy_slots[] = {
     {Py_mod_exec, RayPy_exec},
+    {Py_mod_multiple_interpreters, Py_MOD_PER_INTERPRETER_GIL_SUPPORTED},
+#ifdef Py_mod_gil
+    {Py_mod_gil, Py_MOD_GIL_NOT_USED},
+#endif
     {0, NULL},
 };
 
@@ -1913,10 +14725,12 @@ static struct PyModuleDef RayPy_module = {
     PyModuleDef_HEAD_INIT,
     .m_name = "raypy",
     .m_doc = "CPython native bindings for Raylib",
-    .m_size = 0,
+    .m_size = sizeof(RayPy_State),
     .m_methods = raypymethods,
     .m_slots = RayPy_slots,
+    .m_traverse = RayPy_traverse,
     .m_clear = RayPy_clear,
+    .m_free = RayPy_free,
 };
 
 PyMODINIT_FUNC